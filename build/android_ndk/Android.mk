@@ -111,7 +111,9 @@ LOCAL_SRC_FILES += \
 	libopenmpt/libopenmpt_cxx.cpp \
 	libopenmpt/libopenmpt_impl.cpp \
 	libopenmpt/libopenmpt_ext_impl.cpp \
+	soundbase/SampleFormatCopySIMD.cpp \
 	soundlib/AudioCriticalSection.cpp \
+	soundlib/BackgroundSampleDecoder.cpp \
 	soundlib/ContainerMMCMP.cpp \
 	soundlib/ContainerPP20.cpp \
 	soundlib/ContainerUMX.cpp \
@@ -162,6 +164,7 @@ LOCAL_SRC_FILES += \
 	soundlib/MixerLoops.cpp \
 	soundlib/MixerSettings.cpp \
 	soundlib/MixFuncTable.cpp \
+	soundlib/MixThreadPool.cpp \
 	soundlib/ModChannel.cpp \
 	soundlib/modcommand.cpp \
 	soundlib/ModInstrument.cpp \
@@ -177,6 +180,7 @@ LOCAL_SRC_FILES += \
 	soundlib/pattern.cpp \
 	soundlib/RowVisitor.cpp \
 	soundlib/S3MTools.cpp \
+	soundlib/SampleDataPool.cpp \
 	soundlib/SampleFormats.cpp \
 	soundlib/SampleFormatFLAC.cpp \
 	soundlib/SampleFormatMediaFoundation.cpp \
@@ -184,6 +188,7 @@ LOCAL_SRC_FILES += \
 	soundlib/SampleFormatOpus.cpp \
 	soundlib/SampleFormatVorbis.cpp \
 	soundlib/SampleIO.cpp \
+	soundlib/SeekIndex.cpp \
 	soundlib/Sndfile.cpp \
 	soundlib/Snd_flt.cpp \
 	soundlib/Snd_fx.cpp \
@@ -26,6 +26,10 @@ LDFLAGS  +=
 LDLIBS   += -lm
 ARFLAGS  := rcs
 
+# libopenmpt uses std::thread (see MPT_ENABLE_THREAD in common/BuildSettings.h)
+CXXFLAGS_THREADS = -pthread
+LDFLAGS_THREADS  = -pthread
+
 ifeq ($(CHECKED_ADDRESS),1)
 CXXFLAGS += -fsanitize=address
 CFLAGS   += -fsanitize=address
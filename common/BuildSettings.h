@@ -509,6 +509,16 @@
 #endif // arch
 #endif // ENABLE_ASM
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+// SSE2 is part of the target baseline (always the case for amd64), so SSE2 intrinsics can be used without a runtime check.
+#define ENABLE_SSE2_BASELINE
+#endif
+
+#if defined(ENABLE_SSE2) || defined(ENABLE_SSE2_BASELINE)
+// Generate SSE2 intrinsics code paths (see CanUseSSE2() in mptCPU.h).
+#define ENABLE_SSE2_INTRINSICS
+#endif
+
 #if defined(MPT_WITH_LAME) && defined(MPT_BUILD_MSVC) && defined(MPT_BUILD_MSVC_STATIC) && defined(MODPLUG_TRACKER) && !MPT_OS_WINDOWS_WINRT
 #define MPT_ENABLE_LAME_DELAYLOAD
 #endif
@@ -578,6 +588,10 @@
 #define MPT_FILEREADER_STD_ISTREAM // MMAP is only supported on Windows
 #endif
 
+#if (MPT_OS_LINUX || MPT_OS_ANDROID || MPT_OS_MACOSX_OR_IOS || MPT_OS_FREEBSD || MPT_OS_DRAGONFLYBSD || MPT_OS_OPENBSD || MPT_OS_NETBSD || MPT_OS_GENERIC_UNIX) && defined(MPT_FILEREADER_STD_ISTREAM) && !defined(MPT_FILEREADER_MMAP)
+#define MPT_FILEREADER_MMAP // POSIX mmap for files that are opened by path or file descriptor
+#endif
+
 #if defined(MODPLUG_TRACKER) && !defined(MPT_ENABLE_FILEIO)
 #define MPT_ENABLE_FILEIO // Tracker requires disk file io
 #endif
@@ -586,6 +600,10 @@
 #define MPT_ENABLE_THREAD // Tracker requires threads
 #endif
 
+#if defined(LIBOPENMPT_BUILD) && MPT_PLATFORM_MULTITHREADED && !(defined(__MINGW32__) || defined(__MINGW64__)) && !defined(MPT_ENABLE_THREAD)
+#define MPT_ENABLE_THREAD // Parallel channel mixing (MinGW is excluded because std::thread availability depends on its threading model)
+#endif
+
 #if defined(MPT_EXTERNAL_SAMPLES) && !defined(MPT_ENABLE_FILEIO)
 #define MPT_ENABLE_FILEIO // External samples require disk file io
 #endif
@@ -960,6 +960,7 @@ public:
 			if(file.DataContainer().HasPinnedView())
 			{
 				pinnedData = file.DataContainer().GetRawData() + file.GetPosition();
+				file.DataContainer().PrefetchSequential(file.GetPosition(), size_);
 			} else
 			{
 				cache.resize(size_);
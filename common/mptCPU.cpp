@@ -97,6 +97,19 @@ static cpuid_result cpuid(uint32 function)
 }
 
 
+static cpuid_result cpuidex(uint32 function_a, uint32 function_c)
+{
+	cpuid_result result;
+	int CPUInfo[4];
+	__cpuidex(CPUInfo, function_a, function_c);
+	result.a = CPUInfo[0];
+	result.b = CPUInfo[1];
+	result.c = CPUInfo[2];
+	result.d = CPUInfo[3];
+	return result;
+}
+
+
 void InitProcSupport()
 {
 
@@ -145,7 +158,14 @@ void InitProcSupport()
 			if(StandardFeatureFlags.c & (1<< 9)) ProcSupport |= PROCSUPPORT_SSSE3;
 			if(StandardFeatureFlags.c & (1<<19)) ProcSupport |= PROCSUPPORT_SSE4_1;
 			if(StandardFeatureFlags.c & (1<<20)) ProcSupport |= PROCSUPPORT_SSE4_2;
-			if(StandardFeatureFlags.c & (1<<28)) ProcSupport |= PROCSUPPORT_AVX;
+			// AVX registers are only usable if the OS saves their state
+			const bool osSupportsAVX = (StandardFeatureFlags.c & (1<<27)) && ((_xgetbv(0) & 0x6) == 0x6);
+			if((StandardFeatureFlags.c & (1<<28)) && osSupportsAVX) ProcSupport |= PROCSUPPORT_AVX;
+			if(VendorString.a >= 0x00000007u)
+			{
+				cpuid_result ExtendedFeatureFlags = cpuidex(0x00000007u, 0x00000000u);
+				if((ExtendedFeatureFlags.b & (1<< 5)) && osSupportsAVX) ProcSupport |= PROCSUPPORT_AVX2;
+			}
 		}
 
 		cpuid_result ExtendedVendorString = cpuid(0x80000000u);
@@ -157,11 +177,6 @@ void InitProcSupport()
 		if(ExtendedVendorString.a >= 0x80000004u)
 		{
 			mpt::String::WriteAutoBuf(ProcBrandID) = cpuid(0x80000002u).as_string4() + cpuid(0x80000003u).as_string4() + cpuid(0x80000004u).as_string4();
-			if(ExtendedVendorString.a >= 0x80000007u)
-			{
-				cpuid_result ExtendedFeatures = cpuid(0x80000007u);
-				if(ExtendedFeatures.b & (1<< 5)) ProcSupport |= PROCSUPPORT_AVX2;
-			}
 		}
 
 	}
@@ -66,6 +66,20 @@ static inline uint32 GetRealProcSupport()
 #endif // ENABLE_ASM
 
 
+#ifdef ENABLE_SSE2_INTRINSICS
+// Whether SSE2 intrinsics code paths may be used.
+// With ENABLE_ASM, this honours the runtime processor feature selection, otherwise SSE2 is part of the target baseline.
+static inline bool CanUseSSE2()
+{
+#ifdef ENABLE_SSE2
+	return (GetProcSupport() & PROCSUPPORT_SSE2) != 0;
+#else
+	return true;
+#endif
+}
+#endif // ENABLE_SSE2_INTRINSICS
+
+
 #ifdef MODPLUG_TRACKER
 uint32 GetMinimumProcSupportFlags();
 int GetMinimumSSEVersion();
@@ -18,6 +18,12 @@
 #include <ostream>
 #include <sstream>
 
+#if defined(MPT_FILEREADER_MMAP)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // MPT_FILEREADER_MMAP
+
 
 OPENMPT_NAMESPACE_BEGIN
 
@@ -558,6 +564,109 @@ IFileDataContainer::off_t FileDataContainerCallbackStream::InternalRead(mpt::byt
 #endif // MPT_FILEREADER_CALLBACK_STREAM
 
 
+
+
+#if defined(MPT_FILEREADER_MMAP)
+
+
+FileDataContainerMappedFile::FileDataContainerMappedFile(int fd)
+	: mappedData(nullptr)
+	, mappedLength(0)
+{
+	struct stat st;
+	if(fstat(fd, &st) != 0)
+	{
+		return;
+	}
+	if(!S_ISREG(st.st_mode) || st.st_size <= 0)
+	{
+		return;
+	}
+	if(static_cast<uint64>(st.st_size) > static_cast<uint64>(std::numeric_limits<off_t>::max()))
+	{
+		return;
+	}
+	void *data = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	if(data == MAP_FAILED)
+	{
+		return;
+	}
+	mappedData = static_cast<const mpt::byte *>(data);
+	mappedLength = static_cast<off_t>(st.st_size);
+}
+
+
+FileDataContainerMappedFile::~FileDataContainerMappedFile()
+{
+	if(mappedData)
+	{
+		munmap(const_cast<mpt::byte *>(mappedData), mappedLength);
+	}
+}
+
+
+bool FileDataContainerMappedFile::IsValid() const
+{
+	return mappedData != nullptr;
+}
+
+
+bool FileDataContainerMappedFile::HasFastGetLength() const
+{
+	return true;
+}
+
+
+bool FileDataContainerMappedFile::HasPinnedView() const
+{
+	return true;
+}
+
+
+const mpt::byte *FileDataContainerMappedFile::GetRawData() const
+{
+	return mappedData;
+}
+
+
+IFileDataContainer::off_t FileDataContainerMappedFile::GetLength() const
+{
+	return mappedLength;
+}
+
+
+IFileDataContainer::off_t FileDataContainerMappedFile::Read(mpt::byte *dst, IFileDataContainer::off_t pos, IFileDataContainer::off_t count) const
+{
+	if(pos >= mappedLength)
+	{
+		return 0;
+	}
+	off_t avail = std::min<off_t>(mappedLength - pos, count);
+	std::copy(mappedData + pos, mappedData + pos + avail, dst);
+	return avail;
+}
+
+
+void FileDataContainerMappedFile::PrefetchSequential(IFileDataContainer::off_t pos, IFileDataContainer::off_t length) const
+{
+	// Not worth a system call for headers and strings
+	if(pos >= mappedLength || length < mpt::IO::BUFFERSIZE_NORMAL)
+	{
+		return;
+	}
+	length = std::min(length, mappedLength - pos);
+	static const off_t pageSize = static_cast<off_t>(std::max(sysconf(_SC_PAGESIZE), 1L));
+	const off_t alignedPos = pos - (pos % pageSize);
+	void *start = const_cast<mpt::byte *>(mappedData + alignedPos);
+	// Purely advisory, errors can be ignored.
+	madvise(start, length + (pos - alignedPos), MADV_SEQUENTIAL);
+	madvise(start, length + (pos - alignedPos), MADV_WILLNEED);
+}
+
+
+#endif // MPT_FILEREADER_MMAP
+
+
 #endif
 
 
@@ -718,6 +718,12 @@ public:
 		}
 		return std::min<off_t>(length, dataLength - pos);
 	}
+
+	// Hint that the given range of a pinned view is about to be read sequentially, e.g. sample data.
+	virtual void PrefetchSequential(off_t /*pos*/, off_t /*length*/) const
+	{
+		return;
+	}
 };
 
 
@@ -813,6 +819,14 @@ public:
 		}
 		return std::min(length, dataLength - pos);
 	}
+	void PrefetchSequential(off_t pos, off_t length) const override
+	{
+		if(pos >= dataLength)
+		{
+			return;
+		}
+		data->PrefetchSequential(dataOffset + pos, std::min(length, dataLength - pos));
+	}
 };
 
 
@@ -979,6 +993,39 @@ private:
 #endif // MPT_FILEREADER_CALLBACK_STREAM
 
 
+
+
+#if defined(MPT_FILEREADER_MMAP)
+
+
+// Read-only memory mapping of a whole file.
+// As the data is pinned, loaders can read sample data straight from the mapping without any intermediate caching.
+class FileDataContainerMappedFile : public IFileDataContainer
+{
+private:
+	const mpt::byte *mappedData;
+	off_t mappedLength;
+public:
+	// Maps the file referred to by the file descriptor. The mapping stays valid after the file descriptor is closed.
+	// If the file cannot be mapped (e.g. because it is a pipe), the container is invalid.
+	FileDataContainerMappedFile(int fd);
+	~FileDataContainerMappedFile();
+	FileDataContainerMappedFile(const FileDataContainerMappedFile &) = delete;
+	FileDataContainerMappedFile & operator=(const FileDataContainerMappedFile &) = delete;
+public:
+	bool IsValid() const override;
+	bool HasFastGetLength() const override;
+	bool HasPinnedView() const override;
+	const mpt::byte *GetRawData() const override;
+	off_t GetLength() const override;
+	off_t Read(mpt::byte *dst, off_t pos, off_t count) const override;
+	void PrefetchSequential(off_t pos, off_t length) const override;
+};
+
+
+#endif // MPT_FILEREADER_MMAP
+
+
 #endif
 
 
@@ -1073,6 +1120,11 @@ public:
 		return std::min<off_t>(length, streamLength - pos);
 	}
 
+	void PrefetchSequential(off_t /*pos*/, off_t /*length*/) const MPT_FILEDATACONTAINERMEMORY_OVERRIDE
+	{
+		return;
+	}
+
 };
 
 
@@ -0,0 +1,163 @@
+/*
+ * mptPagedArray.h
+ * ---------------
+ * Purpose: Fixed-size array that only allocates memory for the parts that are actually used.
+ * Notes  : Elements are allocated in pages of PageSize elements when they are accessed for the first time,
+ *          so a large array of which only the first few elements are used only costs a few pages.
+ *          Accessing any element (even through a const reference) always yields a real element, i.e. the semantics
+ *          are the same as for a plain array of N value-initialized elements. In particular, element addresses stay
+ *          valid for the lifetime of the array. Allocating pages is thread-safe, so concurrent read access is
+ *          as safe as it is for a plain array.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "BuildSettings.h"
+
+#include "mptAssert.h"
+#include "mptMemory.h"
+
+#include <atomic>
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+namespace mpt
+{
+
+
+template <typename T, std::size_t N, std::size_t PageSize = 64>
+class paged_array
+{
+	MPT_STATIC_ASSERT(N > 0);
+	MPT_STATIC_ASSERT(PageSize > 0 && (PageSize & (PageSize - 1)) == 0);
+
+public:
+	typedef T value_type;
+	typedef std::size_t size_type;
+
+	enum : std::size_t { num_pages = (N + PageSize - 1) / PageSize };
+
+private:
+	mutable std::atomic<T *> m_pages[num_pages];
+
+	T *GetPage(std::size_t page) const
+	{
+		T *p = m_pages[page].load(std::memory_order_acquire);
+		if(p == nullptr)
+		{
+			T *newPage = new T[PageSize]();
+			if(m_pages[page].compare_exchange_strong(p, newPage, std::memory_order_acq_rel, std::memory_order_acquire))
+			{
+				p = newPage;
+			} else
+			{
+				// Another thread was faster
+				delete[] newPage;
+			}
+		}
+		return p;
+	}
+
+public:
+	paged_array()
+	{
+		for(auto &page : m_pages)
+		{
+			page.store(nullptr, std::memory_order_relaxed);
+		}
+	}
+
+	paged_array(const paged_array &) = delete;
+	paged_array &operator=(const paged_array &) = delete;
+
+	~paged_array()
+	{
+		for(auto &page : m_pages)
+		{
+			delete[] page.load(std::memory_order_relaxed);
+		}
+	}
+
+	static constexpr std::size_t size() noexcept { return N; }
+
+	T &operator[](std::size_t i)
+	{
+		MPT_ASSERT(i < N);
+		return GetPage(i / PageSize)[i % PageSize];
+	}
+
+	const T &operator[](std::size_t i) const
+	{
+		MPT_ASSERT(i < N);
+		return GetPage(i / PageSize)[i % PageSize];
+	}
+
+	// Returns true if memory for this element has been allocated already.
+	// Elements that have not been allocated yet are guaranteed to be value-initialized.
+	bool is_allocated(std::size_t i) const noexcept
+	{
+		return m_pages[i / PageSize].load(std::memory_order_acquire) != nullptr;
+	}
+
+	// Returns the index of the given element, or N if it does not belong to this array.
+	std::size_t index_of(const T *element) const noexcept
+	{
+		for(std::size_t page = 0; page < num_pages; page++)
+		{
+			const T *p = m_pages[page].load(std::memory_order_acquire);
+			if(p != nullptr && element >= p && element < p + PageSize)
+			{
+				return page * PageSize + static_cast<std::size_t>(element - p);
+			}
+		}
+		return N;
+	}
+
+	// Number of bytes of element memory that has been allocated so far.
+	std::size_t allocated_bytes() const noexcept
+	{
+		std::size_t bytes = 0;
+		for(const auto &page : m_pages)
+		{
+			if(page.load(std::memory_order_acquire) != nullptr)
+				bytes += PageSize * sizeof(T);
+		}
+		return bytes;
+	}
+
+	// Value-initialize all elements. Element addresses stay valid.
+	void clear()
+	{
+		for(auto &page : m_pages)
+		{
+			T *p = page.load(std::memory_order_acquire);
+			if(p != nullptr)
+			{
+				for(std::size_t i = 0; i < PageSize; i++)
+				{
+					p[i] = T();
+				}
+			}
+		}
+	}
+
+};
+
+
+} // namespace mpt
+
+
+template <typename T, std::size_t N, std::size_t PageSize>
+struct value_initializer<mpt::paged_array<T, N, PageSize>>
+{
+	inline void operator () (mpt::paged_array<T, N, PageSize> & a)
+	{
+		a.clear();
+	}
+};
+
+
+OPENMPT_NAMESPACE_END
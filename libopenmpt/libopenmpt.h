@@ -54,11 +54,14 @@
  *
  * \section libopenmpt_c_fileio File I/O
  *
- * libopenmpt can use 3 different strategies for file I/O.
+ * libopenmpt can use 4 different strategies for file I/O.
  *
  * - openmpt_module_create_from_memory2() will load the module from the provided
  * memory buffer, which will require loading all data upfront by the library
  * caller.
+ * - openmpt_module_create_from_filename() and openmpt_module_create_from_fd()
+ * will memory-map the file on POSIX systems and load the module directly from
+ * the mapping without making any intermediate copies of the file data.
  * - openmpt_module_create2() with a seekable stream will load the module via
  * callbacks to the stream interface. libopenmpt will not implement an
  * additional buffering layer in this case which means the callbacks are assumed
@@ -72,6 +75,7 @@
  * | create function                                 | speed  | memory consumption |
  * | ----------------------------------------------: | :----: | :----------------: |
  * | openmpt_module_create_from_memory2()            | <p style="background-color:green" >fast  </p> | <p style="background-color:yellow">medium</p> | 
+ * | openmpt_module_create_from_fd() (POSIX)         | <p style="background-color:green" >fast  </p> | <p style="background-color:green" >low   </p> |
  * | openmpt_module_create2() with seekable stream   | <p style="background-color:red"   >slow  </p> | <p style="background-color:green" >low   </p> |
  * | openmpt_module_create2() with unseekable stream | <p style="background-color:yellow">medium</p> | <p style="background-color:red"   >high  </p> |
  *
@@ -82,7 +86,7 @@
  * \section libopenmpt_c_outputformat Output Format
  *
  * libopenmpt supports a wide range of PCM output formats:
- * [8000..192000]/[mono|stereo|quad]/[f32|i16].
+ * [8000..192000]/[mono|stereo|quad]/[f32|i32|i24|i16].
  *
  * Unless you have some very specific requirements demanding a particular aspect
  * of the output format, you should always prefer 48000/stereo/f32 as the
@@ -654,6 +658,91 @@ LIBOPENMPT_API int openmpt_probe_file_header_without_filesize( uint64_t flags, c
  */
 LIBOPENMPT_API int openmpt_probe_file_header_from_stream( uint64_t flags, openmpt_stream_callbacks stream_callbacks, void * stream, openmpt_log_func logfunc, void * loguser, openmpt_error_func errfunc, void * erruser, int * error, const char * * error_message );
 
+/*! Also determine the duration of the module in openmpt_read_metadata_from_memory() and openmpt_read_metadata_from_stream(). This requires parsing all pattern data. \since 0.5.0 */
+#define OPENMPT_READ_METADATA_FLAGS_DURATION 0x1ul
+/*! Only read the basic metadata in openmpt_read_metadata_from_memory() and openmpt_read_metadata_from_stream(). \since 0.5.0 */
+#define OPENMPT_READ_METADATA_FLAGS_DEFAULT  0x0ul
+
+/*! \brief Basic information about a module file, as returned by openmpt_read_metadata_from_memory() and openmpt_read_metadata_from_stream()
+ *
+ * All strings are UTF-8 encoded. The struct and everything it points to must be freed with openmpt_free_metadata().
+ * \since 0.5.0
+ */
+typedef struct openmpt_module_metadata {
+	/*! Format name abbreviation, see openmpt_module_get_metadata() key "type" */
+	const char * type;
+	/*! Full format name, see openmpt_module_get_metadata() key "type_long" */
+	const char * type_long;
+	/*! Container format name abbreviation (if any), see openmpt_module_get_metadata() key "container" */
+	const char * container;
+	/*! Tracker that was (most likely) used to save the module, see openmpt_module_get_metadata() key "tracker" */
+	const char * tracker;
+	/*! Author of the module, see openmpt_module_get_metadata() key "artist" */
+	const char * artist;
+	/*! Module title, see openmpt_module_get_metadata() key "title" */
+	const char * title;
+	/*! Song message, see openmpt_module_get_metadata() key "message_raw" */
+	const char * message;
+	/*! Number of pattern channels, see openmpt_module_get_num_channels() */
+	int32_t num_channels;
+	/*! Number of samples, see openmpt_module_get_num_samples() */
+	int32_t num_samples;
+	/*! num_samples sample names followed by a NULL pointer, see openmpt_module_get_sample_name() */
+	const char * const * sample_names;
+	/*! Number of instruments, see openmpt_module_get_num_instruments() */
+	int32_t num_instruments;
+	/*! num_instruments instrument names followed by a NULL pointer, see openmpt_module_get_instrument_name() */
+	const char * const * instrument_names;
+	/*! Duration of the first sub-song in seconds (see openmpt_module_get_duration_seconds()), or -1.0 if OPENMPT_READ_METADATA_FLAGS_DURATION was not requested */
+	double duration_seconds;
+} openmpt_module_metadata;
+
+/*! \brief Read the basic metadata of a module from memory without fully loading it
+ *
+ * This is considerably faster than openmpt_module_create_from_memory2(), as sample data, plugins and (unless the duration is requested) pattern data are skipped.
+ * \param filedata Data to load the module from.
+ * \param filesize Amount of data available.
+ * \param flags OPENMPT_READ_METADATA_FLAGS_DEFAULT, or OPENMPT_READ_METADATA_FLAGS_DURATION to also determine the duration of the first sub-song.
+ * \param logfunc Logging function where warning and errors are written. May be NULL.
+ * \param loguser Logging function user context. Used to pass any user-defined data associated with this module to the logging function.
+ * \param errfunc Error function to define error behaviour. May be NULL.
+ * \param erruser Error function user context. Used to pass any user-defined data associated with this module to the logging function.
+ * \param error Pointer to an integer where an error may get stored. May be NULL.
+ * \param error_message Pointer to a string pointer where an error message may get stored. May be NULL.
+ * \return The metadata of the module, or NULL on failure. Must be freed with openmpt_free_metadata().
+ * \sa openmpt_read_metadata_from_stream()
+ * \sa openmpt_free_metadata()
+ * \since 0.5.0
+ */
+LIBOPENMPT_API openmpt_module_metadata * openmpt_read_metadata_from_memory( const void * filedata, size_t filesize, uint64_t flags, openmpt_log_func logfunc, void * loguser, openmpt_error_func errfunc, void * erruser, int * error, const char * * error_message );
+
+/*! \brief Read the basic metadata of a module from a stream without fully loading it
+ *
+ * This is considerably faster than openmpt_module_create2(), as sample data, plugins and (unless the duration is requested) pattern data are skipped.
+ * \param stream_callbacks Input stream callback operations.
+ * \param stream Input stream to load the module from.
+ * \param flags OPENMPT_READ_METADATA_FLAGS_DEFAULT, or OPENMPT_READ_METADATA_FLAGS_DURATION to also determine the duration of the first sub-song.
+ * \param logfunc Logging function where warning and errors are written. May be NULL.
+ * \param loguser Logging function user context. Used to pass any user-defined data associated with this module to the logging function.
+ * \param errfunc Error function to define error behaviour. May be NULL.
+ * \param erruser Error function user context. Used to pass any user-defined data associated with this module to the logging function.
+ * \param error Pointer to an integer where an error may get stored. May be NULL.
+ * \param error_message Pointer to a string pointer where an error message may get stored. May be NULL.
+ * \return The metadata of the module, or NULL on failure. Must be freed with openmpt_free_metadata().
+ * \remarks The stream is left in an unspecified state when this function returns.
+ * \sa openmpt_read_metadata_from_memory()
+ * \sa openmpt_free_metadata()
+ * \since 0.5.0
+ */
+LIBOPENMPT_API openmpt_module_metadata * openmpt_read_metadata_from_stream( openmpt_stream_callbacks stream_callbacks, void * stream, uint64_t flags, openmpt_log_func logfunc, void * loguser, openmpt_error_func errfunc, void * erruser, int * error, const char * * error_message );
+
+/*! \brief Free module metadata
+ *
+ * \param metadata Metadata returned by openmpt_read_metadata_from_memory() or openmpt_read_metadata_from_stream(). May be NULL.
+ * \since 0.5.0
+ */
+LIBOPENMPT_API void openmpt_free_metadata( openmpt_module_metadata * metadata );
+
 
 /*! \brief Opaque type representing a libopenmpt module
  */
@@ -730,6 +819,42 @@ LIBOPENMPT_API LIBOPENMPT_DEPRECATED openmpt_module * openmpt_module_create_from
  */
 LIBOPENMPT_API openmpt_module * openmpt_module_create_from_memory2( const void * filedata, size_t filesize, openmpt_log_func logfunc, void * loguser, openmpt_error_func errfunc, void * erruser, int * error, const char * * error_message, const openmpt_module_initial_ctl * ctls );
 
+/*! \brief Construct an openmpt_module from a file
+ *
+ * \param filename Path of the file to load the module from. The path is passed to the operating system as-is.
+ * \param logfunc Logging function where warning and errors are written. The logging function may be called throughout the lifetime of openmpt_module.
+ * \param loguser User-defined data associated with this module. This value will be passed to the logging callback function (logfunc)
+ * \param errfunc Error function to define error behaviour. May be NULL.
+ * \param erruser Error function user context. Used to pass any user-defined data associated with this module to the logging function.
+ * \param error Pointer to an integer where an error may get stored. May be NULL.
+ * \param error_message Pointer to a string pointer where an error message may get stored. May be NULL.
+ * \param ctls A map of initial ctl values. See openmpt_module_get_ctls()
+ * \return A pointer to the constructed openmpt_module, or NULL on failure.
+ * \remarks On POSIX systems, the file is memory-mapped while the module is being loaded. The file must not be truncated during that time.
+ * \remarks The file is closed again before this function returns.
+ * \sa \ref libopenmpt_c_fileio
+ * \since 0.5.0
+ */
+LIBOPENMPT_API openmpt_module * openmpt_module_create_from_filename( const char * filename, openmpt_log_func logfunc, void * loguser, openmpt_error_func errfunc, void * erruser, int * error, const char * * error_message, const openmpt_module_initial_ctl * ctls );
+
+/*! \brief Construct an openmpt_module from a POSIX file descriptor
+ *
+ * \param fd File descriptor to load the module from. Regular files are memory-mapped, other file types (e.g. pipes) are read sequentially from the current position.
+ * \param logfunc Logging function where warning and errors are written. The logging function may be called throughout the lifetime of openmpt_module.
+ * \param loguser User-defined data associated with this module. This value will be passed to the logging callback function (logfunc)
+ * \param errfunc Error function to define error behaviour. May be NULL.
+ * \param erruser Error function user context. Used to pass any user-defined data associated with this module to the logging function.
+ * \param error Pointer to an integer where an error may get stored. May be NULL.
+ * \param error_message Pointer to a string pointer where an error message may get stored. May be NULL.
+ * \param ctls A map of initial ctl values. See openmpt_module_get_ctls()
+ * \return A pointer to the constructed openmpt_module, or NULL on failure.
+ * \remarks The file descriptor is not closed and can be closed by the caller after an openmpt_module has been constructed. The file must not be truncated while the module is being loaded.
+ * \remarks This function is only supported on POSIX systems and always fails on other platforms.
+ * \sa \ref libopenmpt_c_fileio
+ * \since 0.5.0
+ */
+LIBOPENMPT_API openmpt_module * openmpt_module_create_from_fd( int fd, openmpt_log_func logfunc, void * loguser, openmpt_error_func errfunc, void * erruser, int * error, const char * * error_message, const openmpt_module_initial_ctl * ctls );
+
 /*! \brief Unload a previously created openmpt_module from memory.
  *
  * \param mod The module to unload.
@@ -1108,6 +1233,174 @@ LIBOPENMPT_API size_t openmpt_module_read_interleaved_float_stereo( openmpt_modu
  * \sa \ref libopenmpt_c_outputformat
 */
 LIBOPENMPT_API size_t openmpt_module_read_interleaved_float_quad(   openmpt_module * mod, int32_t samplerate, size_t count, float * interleaved_quad   );
+/*! \brief Render audio data
+ *
+ * \param mod The module handle to work on.
+ * \param samplerate Sample rate to render output. Should be in [8000,192000], but this is not enforced.
+ * \param count Number of audio frames to render per channel.
+ * \param mono Pointer to a buffer of at least count elements that receives the mono/center output.
+ * \return The number of frames actually rendered.
+ * \retval 0 The end of song has been reached.
+ * \remarks The output buffers are only written to up to the returned number of elements.
+ * \remarks You can freely switch between any of the "openmpt_module_read*" variants if you see a need to do so. libopenmpt tries to introduce as little switching annoyances as possible. Normally, you would only use a single one of these functions for rendering a particular module.
+ * \remarks Samples are signed 32bit integers, converted directly from the internal mix buffer and dithered according to the "dither" ctl. The internal mix buffer provides 28 bits of resolution, the remaining bits are zero.
+ * \remarks It is recommended to use the floating point API because of the greater dynamic range and no implied clipping.
+ * \sa \ref libopenmpt_c_outputformat
+ * \since 0.5.0
+ */
+LIBOPENMPT_API size_t openmpt_module_read_int32_mono(   openmpt_module * mod, int32_t samplerate, size_t count, int32_t * mono );
+/*! \brief Render audio data
+ *
+ * \param mod The module handle to work on.
+ * \param samplerate Sample rate to render output. Should be in [8000,192000], but this is not enforced.
+ * \param count Number of audio frames to render per channel.
+ * \param left Pointer to a buffer of at least count elements that receives the left output.
+ * \param right Pointer to a buffer of at least count elements that receives the right output.
+ * \return The number of frames actually rendered.
+ * \retval 0 The end of song has been reached.
+ * \remarks The output buffers are only written to up to the returned number of elements.
+ * \remarks You can freely switch between any of the "openmpt_module_read*" variants if you see a need to do so. libopenmpt tries to introduce as little switching annoyances as possible. Normally, you would only use a single one of these functions for rendering a particular module.
+ * \remarks Samples are signed 32bit integers, converted directly from the internal mix buffer and dithered according to the "dither" ctl. The internal mix buffer provides 28 bits of resolution, the remaining bits are zero.
+ * \remarks It is recommended to use the floating point API because of the greater dynamic range and no implied clipping.
+ * \sa \ref libopenmpt_c_outputformat
+ * \since 0.5.0
+ */
+LIBOPENMPT_API size_t openmpt_module_read_int32_stereo( openmpt_module * mod, int32_t samplerate, size_t count, int32_t * left, int32_t * right );
+/*! \brief Render audio data
+ *
+ * \param mod The module handle to work on.
+ * \param samplerate Sample rate to render output. Should be in [8000,192000], but this is not enforced.
+ * \param count Number of audio frames to render per channel.
+ * \param left Pointer to a buffer of at least count elements that receives the left output.
+ * \param right Pointer to a buffer of at least count elements that receives the right output.
+ * \param rear_left Pointer to a buffer of at least count elements that receives the rear left output.
+ * \param rear_right Pointer to a buffer of at least count elements that receives the rear right output.
+ * \return The number of frames actually rendered.
+ * \retval 0 The end of song has been reached.
+ * \remarks The output buffers are only written to up to the returned number of elements.
+ * \remarks You can freely switch between any of the "openmpt_module_read*" variants if you see a need to do so. libopenmpt tries to introduce as little switching annoyances as possible. Normally, you would only use a single one of these functions for rendering a particular module.
+ * \remarks Samples are signed 32bit integers, converted directly from the internal mix buffer and dithered according to the "dither" ctl. The internal mix buffer provides 28 bits of resolution, the remaining bits are zero.
+ * \remarks It is recommended to use the floating point API because of the greater dynamic range and no implied clipping.
+ * \sa \ref libopenmpt_c_outputformat
+ * \since 0.5.0
+ */
+LIBOPENMPT_API size_t openmpt_module_read_int32_quad(   openmpt_module * mod, int32_t samplerate, size_t count, int32_t * left, int32_t * right, int32_t * rear_left, int32_t * rear_right );
+/*! \brief Render audio data
+ *
+ * \param mod The module handle to work on.
+ * \param samplerate Sample rate to render output. Should be in [8000,192000], but this is not enforced.
+ * \param count Number of audio frames to render per channel.
+ * \param interleaved_stereo Pointer to a buffer of at least count*2 elements that receives the interleaved stereo output in the order (L,R).
+ * \return The number of frames actually rendered.
+ * \retval 0 The end of song has been reached.
+ * \remarks The output buffers are only written to up to the returned number of elements.
+ * \remarks You can freely switch between any of the "openmpt_module_read*" variants if you see a need to do so. libopenmpt tries to introduce as little switching annoyances as possible. Normally, you would only use a single one of these functions for rendering a particular module.
+ * \remarks Samples are signed 32bit integers, converted directly from the internal mix buffer and dithered according to the "dither" ctl. The internal mix buffer provides 28 bits of resolution, the remaining bits are zero.
+ * \remarks It is recommended to use the floating point API because of the greater dynamic range and no implied clipping.
+ * \sa \ref libopenmpt_c_outputformat
+ * \since 0.5.0
+ */
+LIBOPENMPT_API size_t openmpt_module_read_interleaved_int32_stereo( openmpt_module * mod, int32_t samplerate, size_t count, int32_t * interleaved_stereo );
+/*! \brief Render audio data
+ *
+ * \param mod The module handle to work on.
+ * \param samplerate Sample rate to render output. Should be in [8000,192000], but this is not enforced.
+ * \param count Number of audio frames to render per channel.
+ * \param interleaved_quad Pointer to a buffer of at least count*4 elements that receives the interleaved quad surround output in the order (L,R,RL,RR).
+ * \return The number of frames actually rendered.
+ * \retval 0 The end of song has been reached.
+ * \remarks The output buffers are only written to up to the returned number of elements.
+ * \remarks You can freely switch between any of the "openmpt_module_read*" variants if you see a need to do so. libopenmpt tries to introduce as little switching annoyances as possible. Normally, you would only use a single one of these functions for rendering a particular module.
+ * \remarks Samples are signed 32bit integers, converted directly from the internal mix buffer and dithered according to the "dither" ctl. The internal mix buffer provides 28 bits of resolution, the remaining bits are zero.
+ * \remarks It is recommended to use the floating point API because of the greater dynamic range and no implied clipping.
+ * \sa \ref libopenmpt_c_outputformat
+ * \since 0.5.0
+ */
+LIBOPENMPT_API size_t openmpt_module_read_interleaved_int32_quad(   openmpt_module * mod, int32_t samplerate, size_t count, int32_t * interleaved_quad   );
+/*! \brief Render audio data
+ *
+ * \param mod The module handle to work on.
+ * \param samplerate Sample rate to render output. Should be in [8000,192000], but this is not enforced.
+ * \param count Number of audio frames to render per channel.
+ * \param mono Pointer to a buffer of at least count*3 bytes that receives the mono/center output.
+ * \return The number of frames actually rendered.
+ * \retval 0 The end of song has been reached.
+ * \remarks The output buffers are only written to up to the returned number of elements.
+ * \remarks You can freely switch between any of the "openmpt_module_read*" variants if you see a need to do so. libopenmpt tries to introduce as little switching annoyances as possible. Normally, you would only use a single one of these functions for rendering a particular module.
+ * \remarks Samples are packed signed 24bit integers in native byte order (3 bytes per sample), converted directly from the internal mix buffer and dithered according to the "dither" ctl.
+ * \remarks It is recommended to use the floating point API because of the greater dynamic range and no implied clipping.
+ * \sa \ref libopenmpt_c_outputformat
+ * \since 0.5.0
+ */
+LIBOPENMPT_API size_t openmpt_module_read_int24_mono(   openmpt_module * mod, int32_t samplerate, size_t count, uint8_t * mono );
+/*! \brief Render audio data
+ *
+ * \param mod The module handle to work on.
+ * \param samplerate Sample rate to render output. Should be in [8000,192000], but this is not enforced.
+ * \param count Number of audio frames to render per channel.
+ * \param left Pointer to a buffer of at least count*3 bytes that receives the left output.
+ * \param right Pointer to a buffer of at least count*3 bytes that receives the right output.
+ * \return The number of frames actually rendered.
+ * \retval 0 The end of song has been reached.
+ * \remarks The output buffers are only written to up to the returned number of elements.
+ * \remarks You can freely switch between any of the "openmpt_module_read*" variants if you see a need to do so. libopenmpt tries to introduce as little switching annoyances as possible. Normally, you would only use a single one of these functions for rendering a particular module.
+ * \remarks Samples are packed signed 24bit integers in native byte order (3 bytes per sample), converted directly from the internal mix buffer and dithered according to the "dither" ctl.
+ * \remarks It is recommended to use the floating point API because of the greater dynamic range and no implied clipping.
+ * \sa \ref libopenmpt_c_outputformat
+ * \since 0.5.0
+ */
+LIBOPENMPT_API size_t openmpt_module_read_int24_stereo( openmpt_module * mod, int32_t samplerate, size_t count, uint8_t * left, uint8_t * right );
+/*! \brief Render audio data
+ *
+ * \param mod The module handle to work on.
+ * \param samplerate Sample rate to render output. Should be in [8000,192000], but this is not enforced.
+ * \param count Number of audio frames to render per channel.
+ * \param left Pointer to a buffer of at least count*3 bytes that receives the left output.
+ * \param right Pointer to a buffer of at least count*3 bytes that receives the right output.
+ * \param rear_left Pointer to a buffer of at least count*3 bytes that receives the rear left output.
+ * \param rear_right Pointer to a buffer of at least count*3 bytes that receives the rear right output.
+ * \return The number of frames actually rendered.
+ * \retval 0 The end of song has been reached.
+ * \remarks The output buffers are only written to up to the returned number of elements.
+ * \remarks You can freely switch between any of the "openmpt_module_read*" variants if you see a need to do so. libopenmpt tries to introduce as little switching annoyances as possible. Normally, you would only use a single one of these functions for rendering a particular module.
+ * \remarks Samples are packed signed 24bit integers in native byte order (3 bytes per sample), converted directly from the internal mix buffer and dithered according to the "dither" ctl.
+ * \remarks It is recommended to use the floating point API because of the greater dynamic range and no implied clipping.
+ * \sa \ref libopenmpt_c_outputformat
+ * \since 0.5.0
+ */
+LIBOPENMPT_API size_t openmpt_module_read_int24_quad(   openmpt_module * mod, int32_t samplerate, size_t count, uint8_t * left, uint8_t * right, uint8_t * rear_left, uint8_t * rear_right );
+/*! \brief Render audio data
+ *
+ * \param mod The module handle to work on.
+ * \param samplerate Sample rate to render output. Should be in [8000,192000], but this is not enforced.
+ * \param count Number of audio frames to render per channel.
+ * \param interleaved_stereo Pointer to a buffer of at least count*2*3 bytes that receives the interleaved stereo output in the order (L,R).
+ * \return The number of frames actually rendered.
+ * \retval 0 The end of song has been reached.
+ * \remarks The output buffers are only written to up to the returned number of elements.
+ * \remarks You can freely switch between any of the "openmpt_module_read*" variants if you see a need to do so. libopenmpt tries to introduce as little switching annoyances as possible. Normally, you would only use a single one of these functions for rendering a particular module.
+ * \remarks Samples are packed signed 24bit integers in native byte order (3 bytes per sample), converted directly from the internal mix buffer and dithered according to the "dither" ctl.
+ * \remarks It is recommended to use the floating point API because of the greater dynamic range and no implied clipping.
+ * \sa \ref libopenmpt_c_outputformat
+ * \since 0.5.0
+ */
+LIBOPENMPT_API size_t openmpt_module_read_interleaved_int24_stereo( openmpt_module * mod, int32_t samplerate, size_t count, uint8_t * interleaved_stereo );
+/*! \brief Render audio data
+ *
+ * \param mod The module handle to work on.
+ * \param samplerate Sample rate to render output. Should be in [8000,192000], but this is not enforced.
+ * \param count Number of audio frames to render per channel.
+ * \param interleaved_quad Pointer to a buffer of at least count*4*3 bytes that receives the interleaved quad surround output in the order (L,R,RL,RR).
+ * \return The number of frames actually rendered.
+ * \retval 0 The end of song has been reached.
+ * \remarks The output buffers are only written to up to the returned number of elements.
+ * \remarks You can freely switch between any of the "openmpt_module_read*" variants if you see a need to do so. libopenmpt tries to introduce as little switching annoyances as possible. Normally, you would only use a single one of these functions for rendering a particular module.
+ * \remarks Samples are packed signed 24bit integers in native byte order (3 bytes per sample), converted directly from the internal mix buffer and dithered according to the "dither" ctl.
+ * \remarks It is recommended to use the floating point API because of the greater dynamic range and no implied clipping.
+ * \sa \ref libopenmpt_c_outputformat
+ * \since 0.5.0
+ */
+LIBOPENMPT_API size_t openmpt_module_read_interleaved_int24_quad(   openmpt_module * mod, int32_t samplerate, size_t count, uint8_t * interleaved_quad   );
 /*@}*/
 
 /*! \brief Get the list of supported metadata item keys
@@ -1400,7 +1693,14 @@ LIBOPENMPT_API const char * openmpt_module_highlight_pattern_row_channel( openmp
  *          - load.skip_patterns: Set to "1" to avoid loading patterns into memory
  *          - load.skip_plugins: Set to "1" to avoid loading plugins
  *          - load.skip_subsongs_init: Set to "1" to avoid pre-initializing sub-songs. Skipping results in faster module loading but slower seeking.
+ *          - load.subsongs_init_threads: Set the number of threads that are used for pre-initializing sub-songs of modules with several sequences. "0" (the default) uses one thread per CPU core, "1" scans all sequences on the calling thread. The result does not depend on this setting. Only one thread is used if the library has been built without thread support.
+ *          - load.subsongs_cache: Cached sub-song information, to avoid determining the sub-songs and their durations again when the same file is loaded another time. Pass this ctl as an initial ctl when creating the module: if the value was obtained from an earlier instance that loaded the same file with the same library version and load settings, it is used instead of scanning the module, otherwise it is silently ignored. Pass an empty value if no cached information is available yet. After loading, getting this ctl returns the cached information for the loaded file, which can be stored by the application. The value is empty if the ctl was not passed when loading the file.
+ *          - load.share_sample_data: Set to "1" to share sample data with other modules in the same process that were loaded from identical file contents with this ctl enabled. Only identical sample data is shared. This reduces memory usage when the same file is opened many times at once. Sample data is still decoded for every module.
+ *          - load.sample_decode_threads: Set the number of threads that are used for decoding compressed samples while loading. "0" (the default) uses one thread per CPU core, "1" decodes all samples on the calling thread. The result does not depend on this setting. Currently only MO3 files are decoded in parallel. Only one thread is used if the library has been built without thread support.
+ *          - load.lazy_sample_decoding: Set to "1" to postpone decoding of compressed samples until they are played for the first time, which makes loading faster. Memory for the samples is still allocated while loading. Decoding happens on the thread that renders audio. Affects compressed samples in IT, MPTM and DMF files as well as Ogg Vorbis samples in MO3 files. While samples are pending, a copy of the module data is kept in memory.
+ *          - load.progressive: Set to "1" to make the module ready for playback as soon as the pattern data has been loaded, which minimizes the time until the first audio can be rendered. Implies load.lazy_sample_decoding, and postponed samples are decoded on a background thread. Samples that are played before the background thread got to them are decoded on the thread that renders audio. Unless load.skip_subsongs_init is set or a matching load.subsongs_cache is supplied, the sub-songs and their durations are determined on a background thread, and functions that return information about sub-songs or durations wait for it to finish. Results are identical to loading without this option.
  *          - seek.sync_samples: Set to "1" to sync sample playback when using openmpt_module_set_position_seconds or openmpt_module_set_position_order_row.
+ *          - seek.index_interval_seconds: Set to a positive floating point value to store a seek checkpoint every this many seconds of song time while the song length is calculated, including the sub-song scan at load time if set as an initial ctl. Subsequent calls to openmpt_module_set_position_seconds or openmpt_module_set_position_order_row resume from the nearest checkpoint instead of the song start. The number of checkpoints per sub-song is limited; the interval grows for very long songs. "0" (the default) disables the seek index. The index is not used if seek.sync_samples is enabled.
  *          - subsong: The current subsong. Setting it has identical semantics as openmpt_module_select_subsong(), getting it returns the currently selected subsong.
  *          - play.at_end: Chooses the behaviour when the end of song is reached:
  *                         - "fadeout": Fades the module out for a short while. Subsequent reads after the fadeout will return 0 rendered frames.
@@ -1410,7 +1710,10 @@ LIBOPENMPT_API const char * openmpt_module_highlight_pattern_row_channel( openmp
  *          - play.pitch_factor: Set a floating point pitch factor. "1.0" is the default pitch.
  *          - render.resampler.emulate_amiga: Set to "1" to enable the Amiga resampler for Amiga modules. This emulates the sound characteristics of the Paula chip and overrides the selected interpolation filter. Non-Amiga module formats are not affected by this setting.
  *          - render.opl.volume_factor: Set volume factor applied to synthesized OPL sounds, relative to the default OPL volume.
- *          - dither: Set the dither algorithm that is used for the 16 bit versions of openmpt_module_read. Supported values are:
+ *          - render.mix_threads: Set the number of threads that are used for mixing the module channels. "0" uses one thread per CPU core, "1" (the default) mixes all channels on the thread that calls openmpt_module_read. The output does not depend on this setting. If the library has been built without thread support, this setting has no effect and reading it always returns "1".
+ *          - render.mix_block_size: Set the maximum number of frames that are rendered at once. Larger values reduce the processing overhead when reading large chunks of audio data at once, e.g. when rendering to a file. "0" restores the default (512). The value is rounded up to a multiple of 16 and limited to 16384. While mix plugins are loaded, at most 512 frames are rendered at once. The output does not depend on this setting.
+ *          - render.cull_threshold_db: Voices whose level stays below this threshold (in dBFS, negative value, e.g. "-90") are not mixed. Their play position is still advanced exactly as if they had been mixed, so they continue seamlessly once they get louder again. Voices that are ramping their volume or use a resonant filter are always mixed. The level is measured before applying the master gain, DSP effects and plugins. "0" (the default) only skips completely silent voices.
+ *          - dither: Set the dither algorithm that is used for the integer versions of openmpt_module_read. Supported values are:
  *                    - 0: No dithering.
  *                    - 1: Default mode. Chosen by OpenMPT code, might change.
  *                    - 2: Rectangular, 0.5 bit depth, no noise shaping (original ModPlug Tracker).
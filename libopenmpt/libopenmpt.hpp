@@ -45,12 +45,15 @@
  *
  * \section libopenmpt_cpp_fileio File I/O
  *
- * libopenmpt can use 3 different strategies for file I/O.
+ * libopenmpt can use 4 different strategies for file I/O.
  *
  * - openmpt::module::module() with any kind of memory buffer as parameter will
  * load the module from the provided memory buffer, which will require loading
  * all data upfront by the library
  * caller.
+ * - openmpt::module::module() with a filename or a file descriptor as parameter
+ * will memory-map the file on POSIX systems and load the module directly from
+ * the mapping without making any intermediate copies of the file data.
  * - openmpt::module::module() with a seekable std::istream as parameter will
  * load the module via the stream interface. libopenmpt will not implement an
  * additional buffering layer in this case whih means the callbacks are assumed
@@ -64,6 +67,7 @@
  * | constructor       | speed  | memory consumption |
  * | ----------------: | :----: | :----------------: |
  * | memory buffer     | <p style="background-color:green" >fast  </p> | <p style="background-color:yellow">medium</p> | 
+ * | file (POSIX)      | <p style="background-color:green" >fast  </p> | <p style="background-color:green" >low   </p> |
  * | seekable stream   | <p style="background-color:red"   >slow  </p> | <p style="background-color:green" >low   </p> |
  * | unseekable stream | <p style="background-color:yellow">medium</p> | <p style="background-color:red"   >high  </p> |
  *
@@ -74,7 +78,7 @@
  * \section libopenmpt_cpp_outputformat Output Format
  *
  * libopenmpt supports a wide range of PCM output formats:
- * [8000..192000]/[mono|stereo|quad]/[f32|i16].
+ * [8000..192000]/[mono|stereo|quad]/[f32|i32|i24|i16].
  *
  * Unless you have some very specific requirements demanding a particular aspect
  * of the output format, you should always prefer 48000/stereo/f32 as the
@@ -330,6 +334,68 @@ LIBOPENMPT_CXX_API int probe_file_header( std::uint64_t flags, const std::uint8_
 */
 LIBOPENMPT_CXX_API int probe_file_header( std::uint64_t flags, std::istream & stream );
 
+//! Also determine the duration of the module in openmpt::read_metadata(). This requires parsing all pattern data. \since 0.5.0
+static const std::uint64_t read_metadata_flags_duration = 0x1ul;
+
+//! Only read the basic metadata in openmpt::read_metadata(). \since 0.5.0
+static const std::uint64_t read_metadata_flags_default  = 0x0ul;
+
+//! Basic information about a module file, as returned by openmpt::read_metadata()
+/*!
+  \since 0.5.0
+*/
+struct module_metadata {
+	//! Format name abbreviation, see openmpt::module::get_metadata() key "type"
+	std::string type;
+	//! Full format name, see openmpt::module::get_metadata() key "type_long"
+	std::string type_long;
+	//! Container format name abbreviation (if any), see openmpt::module::get_metadata() key "container"
+	std::string container;
+	//! Tracker that was (most likely) used to save the module, see openmpt::module::get_metadata() key "tracker"
+	std::string tracker;
+	//! Author of the module, see openmpt::module::get_metadata() key "artist"
+	std::string artist;
+	//! Module title, see openmpt::module::get_metadata() key "title"
+	std::string title;
+	//! Song message, see openmpt::module::get_metadata() key "message_raw"
+	std::string message;
+	//! Number of pattern channels, see openmpt::module::get_num_channels()
+	std::int32_t num_channels = 0;
+	//! Sample names, see openmpt::module::get_sample_names()
+	std::vector<std::string> sample_names;
+	//! Instrument names, see openmpt::module::get_instrument_names()
+	std::vector<std::string> instrument_names;
+	//! Duration of the first sub-song in seconds (see openmpt::module::get_duration_seconds()), or -1.0 if openmpt::read_metadata_flags_duration was not requested
+	double duration_seconds = -1.0;
+};
+
+//! Read the basic metadata of a module without fully loading it
+/*!
+  This is considerably faster than constructing an openmpt::module, as sample data, plugins and (unless the duration is requested) pattern data are skipped.
+  \param stream Input stream from which the module is read.
+  \param flags openmpt::read_metadata_flags_default, or openmpt::read_metadata_flags_duration to also determine the duration of the first sub-song.
+  \param log Log where any warnings or errors are printed to. The lifetime of the reference has to be as long as the lifetime of the call.
+  \return The metadata of the module.
+  \throws openmpt::exception Throws an exception derived from openmpt::exception in case the provided file cannot be opened.
+  \sa openmpt::module_metadata
+  \since 0.5.0
+*/
+LIBOPENMPT_CXX_API module_metadata read_metadata( std::istream & stream, std::uint64_t flags = read_metadata_flags_default, std::ostream & log = std::clog );
+
+//! Read the basic metadata of a module without fully loading it
+/*!
+  This is considerably faster than constructing an openmpt::module, as sample data, plugins and (unless the duration is requested) pattern data are skipped.
+  \param data Data to load the module from.
+  \param size Amount of data available.
+  \param flags openmpt::read_metadata_flags_default, or openmpt::read_metadata_flags_duration to also determine the duration of the first sub-song.
+  \param log Log where any warnings or errors are printed to. The lifetime of the reference has to be as long as the lifetime of the call.
+  \return The metadata of the module.
+  \throws openmpt::exception Throws an exception derived from openmpt::exception in case the provided file cannot be opened.
+  \sa openmpt::module_metadata
+  \since 0.5.0
+*/
+LIBOPENMPT_CXX_API module_metadata read_metadata( const void * data, std::size_t size, std::uint64_t flags = read_metadata_flags_default, std::ostream & log = std::clog );
+
 class module_impl;
 
 class module_ext;
@@ -485,6 +551,26 @@ public:
 	  \sa \ref libopenmpt_cpp_fileio
 	*/
 	module( const void * data, std::size_t size, std::ostream & log = std::clog, const std::map< std::string, std::string > & ctls = detail::initial_ctls_map() );
+	/*!
+	  \param filename Path of the file to load the module from. The path is passed to the operating system as-is.
+	  \param log Log where any warnings or errors are printed to. The lifetime of the reference has to be as long as the lifetime of the module instance.
+	  \param ctls A map of initial ctl values, see openmpt::module::get_ctls.
+	  \throws openmpt::exception Throws an exception derived from openmpt::exception in case the provided file cannot be opened.
+	  \remarks On POSIX systems, the file is memory-mapped while the module is being loaded. The file must not be truncated during that time.
+	  \sa \ref libopenmpt_cpp_fileio
+	  \since 0.5.0
+	*/
+	module( const std::string & filename, std::ostream & log = std::clog, const std::map< std::string, std::string > & ctls = detail::initial_ctls_map() );
+	/*!
+	  \param fd POSIX file descriptor to load the module from. Regular files are memory-mapped, other file types (e.g. pipes) are read sequentially from the current position.
+	  \param log Log where any warnings or errors are printed to. The lifetime of the reference has to be as long as the lifetime of the module instance.
+	  \param ctls A map of initial ctl values, see openmpt::module::get_ctls.
+	  \throws openmpt::exception Throws an exception derived from openmpt::exception in case the provided file cannot be opened, or if file descriptors are not supported on this platform.
+	  \remarks The file descriptor is not closed and can be closed by the caller after an openmpt::module has been constructed. The file must not be truncated while the module is being loaded.
+	  \sa \ref libopenmpt_cpp_fileio
+	  \since 0.5.0
+	*/
+	module( int fd, std::ostream & log = std::clog, const std::map< std::string, std::string > & ctls = detail::initial_ctls_map() );
 	virtual ~module();
 public:
 
@@ -711,6 +797,164 @@ public:
 	  \sa \ref libopenmpt_cpp_outputformat
 	*/
 	std::size_t read_interleaved_quad( std::int32_t samplerate, std::size_t count, float * interleaved_quad );
+	//! Render audio data
+	/*!
+	  \param samplerate Sample rate to render output. Should be in [8000,192000], but this is not enforced.
+	  \param count Number of audio frames to render per channel.
+	  \param mono Pointer to a buffer of at least count elements that receives the mono/center output.
+	  \return The number of frames actually rendered.
+	  \retval 0 The end of song has been reached.
+	  \remarks The output buffers are only written to up to the returned number of elements.
+	  \remarks You can freely switch between any of the "read*" variants if you see a need to do so. libopenmpt tries to introduce as little switching annoyances as possible. Normally, you would only use a single one of these functions for rendering a particular module.
+	  \remarks Samples are signed 32bit integers, converted directly from the internal mix buffer and dithered according to the "dither" ctl. The internal mix buffer provides 28 bits of resolution, the remaining bits are zero.
+	  \remarks It is recommended to use the floating point API because of the greater dynamic range and no implied clipping.
+	  \sa \ref libopenmpt_cpp_outputformat
+	  \since 0.5.0
+	*/
+	std::size_t read( std::int32_t samplerate, std::size_t count, std::int32_t * mono );
+	//! Render audio data
+	/*!
+	  \param samplerate Sample rate to render output. Should be in [8000,192000], but this is not enforced.
+	  \param count Number of audio frames to render per channel.
+	  \param left Pointer to a buffer of at least count elements that receives the left output.
+	  \param right Pointer to a buffer of at least count elements that receives the right output.
+	  \return The number of frames actually rendered.
+	  \retval 0 The end of song has been reached.
+	  \remarks The output buffers are only written to up to the returned number of elements.
+	  \remarks You can freely switch between any of the "read*" variants if you see a need to do so. libopenmpt tries to introduce as little switching annoyances as possible. Normally, you would only use a single one of these functions for rendering a particular module.
+	  \remarks Samples are signed 32bit integers, converted directly from the internal mix buffer and dithered according to the "dither" ctl. The internal mix buffer provides 28 bits of resolution, the remaining bits are zero.
+	  \remarks It is recommended to use the floating point API because of the greater dynamic range and no implied clipping.
+	  \sa \ref libopenmpt_cpp_outputformat
+	  \since 0.5.0
+	*/
+	std::size_t read( std::int32_t samplerate, std::size_t count, std::int32_t * left, std::int32_t * right );
+	//! Render audio data
+	/*!
+	  \param samplerate Sample rate to render output. Should be in [8000,192000], but this is not enforced.
+	  \param count Number of audio frames to render per channel.
+	  \param left Pointer to a buffer of at least count elements that receives the left output.
+	  \param right Pointer to a buffer of at least count elements that receives the right output.
+	  \param rear_left Pointer to a buffer of at least count elements that receives the rear left output.
+	  \param rear_right Pointer to a buffer of at least count elements that receives the rear right output.
+	  \return The number of frames actually rendered.
+	  \retval 0 The end of song has been reached.
+	  \remarks The output buffers are only written to up to the returned number of elements.
+	  \remarks You can freely switch between any of the "read*" variants if you see a need to do so. libopenmpt tries to introduce as little switching annoyances as possible. Normally, you would only use a single one of these functions for rendering a particular module.
+	  \remarks Samples are signed 32bit integers, converted directly from the internal mix buffer and dithered according to the "dither" ctl. The internal mix buffer provides 28 bits of resolution, the remaining bits are zero.
+	  \remarks It is recommended to use the floating point API because of the greater dynamic range and no implied clipping.
+	  \sa \ref libopenmpt_cpp_outputformat
+	  \since 0.5.0
+	*/
+	std::size_t read( std::int32_t samplerate, std::size_t count, std::int32_t * left, std::int32_t * right, std::int32_t * rear_left, std::int32_t * rear_right );
+	//! Render audio data
+	/*!
+	  \param samplerate Sample rate to render output. Should be in [8000,192000], but this is not enforced.
+	  \param count Number of audio frames to render per channel.
+	  \param interleaved_stereo Pointer to a buffer of at least count*2 elements that receives the interleaved stereo output in the order (L,R).
+	  \return The number of frames actually rendered.
+	  \retval 0 The end of song has been reached.
+	  \remarks The output buffers are only written to up to the returned number of elements.
+	  \remarks You can freely switch between any of the "read*" variants if you see a need to do so. libopenmpt tries to introduce as little switching annoyances as possible. Normally, you would only use a single one of these functions for rendering a particular module.
+	  \remarks Samples are signed 32bit integers, converted directly from the internal mix buffer and dithered according to the "dither" ctl. The internal mix buffer provides 28 bits of resolution, the remaining bits are zero.
+	  \remarks It is recommended to use the floating point API because of the greater dynamic range and no implied clipping.
+	  \sa \ref libopenmpt_cpp_outputformat
+	  \since 0.5.0
+	*/
+	std::size_t read_interleaved_stereo( std::int32_t samplerate, std::size_t count, std::int32_t * interleaved_stereo );
+	//! Render audio data
+	/*!
+	  \param samplerate Sample rate to render output. Should be in [8000,192000], but this is not enforced.
+	  \param count Number of audio frames to render per channel.
+	  \param interleaved_quad Pointer to a buffer of at least count*4 elements that receives the interleaved quad surround output in the order (L,R,RL,RR).
+	  \return The number of frames actually rendered.
+	  \retval 0 The end of song has been reached.
+	  \remarks The output buffers are only written to up to the returned number of elements.
+	  \remarks You can freely switch between any of the "read*" variants if you see a need to do so. libopenmpt tries to introduce as little switching annoyances as possible. Normally, you would only use a single one of these functions for rendering a particular module.
+	  \remarks Samples are signed 32bit integers, converted directly from the internal mix buffer and dithered according to the "dither" ctl. The internal mix buffer provides 28 bits of resolution, the remaining bits are zero.
+	  \remarks It is recommended to use the floating point API because of the greater dynamic range and no implied clipping.
+	  \sa \ref libopenmpt_cpp_outputformat
+	  \since 0.5.0
+	*/
+	std::size_t read_interleaved_quad( std::int32_t samplerate, std::size_t count, std::int32_t * interleaved_quad );
+	//! Render audio data
+	/*!
+	  \param samplerate Sample rate to render output. Should be in [8000,192000], but this is not enforced.
+	  \param count Number of audio frames to render per channel.
+	  \param mono Pointer to a buffer of at least count*3 bytes that receives the mono/center output.
+	  \return The number of frames actually rendered.
+	  \retval 0 The end of song has been reached.
+	  \remarks The output buffers are only written to up to the returned number of elements.
+	  \remarks You can freely switch between any of the "read*" variants if you see a need to do so. libopenmpt tries to introduce as little switching annoyances as possible. Normally, you would only use a single one of these functions for rendering a particular module.
+	  \remarks Samples are packed signed 24bit integers in native byte order (3 bytes per sample), converted directly from the internal mix buffer and dithered according to the "dither" ctl.
+	  \remarks It is recommended to use the floating point API because of the greater dynamic range and no implied clipping.
+	  \sa \ref libopenmpt_cpp_outputformat
+	  \since 0.5.0
+	*/
+	std::size_t read_int24( std::int32_t samplerate, std::size_t count, std::uint8_t * mono );
+	//! Render audio data
+	/*!
+	  \param samplerate Sample rate to render output. Should be in [8000,192000], but this is not enforced.
+	  \param count Number of audio frames to render per channel.
+	  \param left Pointer to a buffer of at least count*3 bytes that receives the left output.
+	  \param right Pointer to a buffer of at least count*3 bytes that receives the right output.
+	  \return The number of frames actually rendered.
+	  \retval 0 The end of song has been reached.
+	  \remarks The output buffers are only written to up to the returned number of elements.
+	  \remarks You can freely switch between any of the "read*" variants if you see a need to do so. libopenmpt tries to introduce as little switching annoyances as possible. Normally, you would only use a single one of these functions for rendering a particular module.
+	  \remarks Samples are packed signed 24bit integers in native byte order (3 bytes per sample), converted directly from the internal mix buffer and dithered according to the "dither" ctl.
+	  \remarks It is recommended to use the floating point API because of the greater dynamic range and no implied clipping.
+	  \sa \ref libopenmpt_cpp_outputformat
+	  \since 0.5.0
+	*/
+	std::size_t read_int24( std::int32_t samplerate, std::size_t count, std::uint8_t * left, std::uint8_t * right );
+	//! Render audio data
+	/*!
+	  \param samplerate Sample rate to render output. Should be in [8000,192000], but this is not enforced.
+	  \param count Number of audio frames to render per channel.
+	  \param left Pointer to a buffer of at least count*3 bytes that receives the left output.
+	  \param right Pointer to a buffer of at least count*3 bytes that receives the right output.
+	  \param rear_left Pointer to a buffer of at least count*3 bytes that receives the rear left output.
+	  \param rear_right Pointer to a buffer of at least count*3 bytes that receives the rear right output.
+	  \return The number of frames actually rendered.
+	  \retval 0 The end of song has been reached.
+	  \remarks The output buffers are only written to up to the returned number of elements.
+	  \remarks You can freely switch between any of the "read*" variants if you see a need to do so. libopenmpt tries to introduce as little switching annoyances as possible. Normally, you would only use a single one of these functions for rendering a particular module.
+	  \remarks Samples are packed signed 24bit integers in native byte order (3 bytes per sample), converted directly from the internal mix buffer and dithered according to the "dither" ctl.
+	  \remarks It is recommended to use the floating point API because of the greater dynamic range and no implied clipping.
+	  \sa \ref libopenmpt_cpp_outputformat
+	  \since 0.5.0
+	*/
+	std::size_t read_int24( std::int32_t samplerate, std::size_t count, std::uint8_t * left, std::uint8_t * right, std::uint8_t * rear_left, std::uint8_t * rear_right );
+	//! Render audio data
+	/*!
+	  \param samplerate Sample rate to render output. Should be in [8000,192000], but this is not enforced.
+	  \param count Number of audio frames to render per channel.
+	  \param interleaved_stereo Pointer to a buffer of at least count*2*3 bytes that receives the interleaved stereo output in the order (L,R).
+	  \return The number of frames actually rendered.
+	  \retval 0 The end of song has been reached.
+	  \remarks The output buffers are only written to up to the returned number of elements.
+	  \remarks You can freely switch between any of the "read*" variants if you see a need to do so. libopenmpt tries to introduce as little switching annoyances as possible. Normally, you would only use a single one of these functions for rendering a particular module.
+	  \remarks Samples are packed signed 24bit integers in native byte order (3 bytes per sample), converted directly from the internal mix buffer and dithered according to the "dither" ctl.
+	  \remarks It is recommended to use the floating point API because of the greater dynamic range and no implied clipping.
+	  \sa \ref libopenmpt_cpp_outputformat
+	  \since 0.5.0
+	*/
+	std::size_t read_interleaved_int24_stereo( std::int32_t samplerate, std::size_t count, std::uint8_t * interleaved_stereo );
+	//! Render audio data
+	/*!
+	  \param samplerate Sample rate to render output. Should be in [8000,192000], but this is not enforced.
+	  \param count Number of audio frames to render per channel.
+	  \param interleaved_quad Pointer to a buffer of at least count*4*3 bytes that receives the interleaved quad surround output in the order (L,R,RL,RR).
+	  \return The number of frames actually rendered.
+	  \retval 0 The end of song has been reached.
+	  \remarks The output buffers are only written to up to the returned number of elements.
+	  \remarks You can freely switch between any of the "read*" variants if you see a need to do so. libopenmpt tries to introduce as little switching annoyances as possible. Normally, you would only use a single one of these functions for rendering a particular module.
+	  \remarks Samples are packed signed 24bit integers in native byte order (3 bytes per sample), converted directly from the internal mix buffer and dithered according to the "dither" ctl.
+	  \remarks It is recommended to use the floating point API because of the greater dynamic range and no implied clipping.
+	  \sa \ref libopenmpt_cpp_outputformat
+	  \since 0.5.0
+	*/
+	std::size_t read_interleaved_int24_quad( std::int32_t samplerate, std::size_t count, std::uint8_t * interleaved_quad );
 	/*@}*/
 
 	//! Get the list of supported metadata item keys
@@ -966,7 +1210,14 @@ public:
 	           - load.skip_patterns: Set to "1" to avoid loading patterns into memory
 	           - load.skip_plugins: Set to "1" to avoid loading plugins
 	           - load.skip_subsongs_init: Set to "1" to avoid pre-initializing sub-songs. Skipping results in faster module loading but slower seeking.
+	           - load.subsongs_init_threads: Set the number of threads that are used for pre-initializing sub-songs of modules with several sequences. "0" (the default) uses one thread per CPU core, "1" scans all sequences on the calling thread. The result does not depend on this setting. Only one thread is used if the library has been built without thread support.
+	           - load.subsongs_cache: Cached sub-song information, to avoid determining the sub-songs and their durations again when the same file is loaded another time. Pass this ctl as an initial ctl when creating the module: if the value was obtained from an earlier instance that loaded the same file with the same library version and load settings, it is used instead of scanning the module, otherwise it is silently ignored. Pass an empty value if no cached information is available yet. After loading, getting this ctl returns the cached information for the loaded file, which can be stored by the application. The value is empty if the ctl was not passed when loading the file.
+	           - load.share_sample_data: Set to "1" to share sample data with other modules in the same process that were loaded from identical file contents with this ctl enabled. Only identical sample data is shared. This reduces memory usage when the same file is opened many times at once. Sample data is still decoded for every module.
+	           - load.sample_decode_threads: Set the number of threads that are used for decoding compressed samples while loading. "0" (the default) uses one thread per CPU core, "1" decodes all samples on the calling thread. The result does not depend on this setting. Currently only MO3 files are decoded in parallel. Only one thread is used if the library has been built without thread support.
+	           - load.lazy_sample_decoding: Set to "1" to postpone decoding of compressed samples until they are played for the first time, which makes loading faster. Memory for the samples is still allocated while loading. Decoding happens on the thread that renders audio. Affects compressed samples in IT, MPTM and DMF files as well as Ogg Vorbis samples in MO3 files. While samples are pending, a copy of the module data is kept in memory.
+	           - load.progressive: Set to "1" to make the module ready for playback as soon as the pattern data has been loaded, which minimizes the time until the first audio can be rendered. Implies load.lazy_sample_decoding, and postponed samples are decoded on a background thread. Samples that are played before the background thread got to them are decoded on the thread that renders audio. Unless load.skip_subsongs_init is set or a matching load.subsongs_cache is supplied, the sub-songs and their durations are determined on a background thread, and functions that return information about sub-songs or durations wait for it to finish. Results are identical to loading without this option.
 	           - seek.sync_samples: Set to "1" to sync sample playback when using openmpt::module::set_position_seconds or openmpt::module::set_position_order_row.
+	           - seek.index_interval_seconds: Set to a positive floating point value to store a seek checkpoint every this many seconds of song time while the song length is calculated, including the sub-song scan at load time if set as an initial ctl. Subsequent calls to openmpt::module::set_position_seconds or openmpt::module::set_position_order_row resume from the nearest checkpoint instead of the song start. The number of checkpoints per sub-song is limited; the interval grows for very long songs. "0" (the default) disables the seek index. The index is not used if seek.sync_samples is enabled.
 	           - subsong: The current subsong. Setting it has identical semantics as openmpt::module::select_subsong(), getting it returns the currently selected subsong.
 	           - play.at_end: Chooses the behaviour when the end of song is reached:
 	                          - "fadeout": Fades the module out for a short while. Subsequent reads after the fadeout will return 0 rendered frames.
@@ -976,7 +1227,10 @@ public:
 	           - play.pitch_factor: Set a floating point pitch factor. "1.0" is the default pitch.
 	           - render.resampler.emulate_amiga: Set to "1" to enable the Amiga resampler for Amiga modules. This emulates the sound characteristics of the Paula chip and overrides the selected interpolation filter. Non-Amiga module formats are not affected by this setting. 
 	           - render.opl.volume_factor: Set volume factor applied to synthesized OPL sounds, relative to the default OPL volume.
-	           - dither: Set the dither algorithm that is used for the 16 bit versions of openmpt::module::read. Supported values are:
+	           - render.mix_threads: Set the number of threads that are used for mixing the module channels. "0" uses one thread per CPU core, "1" (the default) mixes all channels on the thread that calls openmpt::module::read. The output does not depend on this setting. If the library has been built without thread support, this setting has no effect and reading it always returns "1".
+	           - render.mix_block_size: Set the maximum number of frames that are rendered at once. Larger values reduce the processing overhead when reading large chunks of audio data at once, e.g. when rendering to a file. "0" restores the default (512). The value is rounded up to a multiple of 16 and limited to 16384. While mix plugins are loaded, at most 512 frames are rendered at once. The output does not depend on this setting.
+	           - render.cull_threshold_db: Voices whose level stays below this threshold (in dBFS, negative value, e.g. "-90") are not mixed. Their play position is still advanced exactly as if they had been mixed, so they continue seamlessly once they get louder again. Voices that are ramping their volume or use a resonant filter are always mixed. The level is measured before applying the master gain, DSP effects and plugins. "0" (the default) only skips completely silent voices.
+	           - dither: Set the dither algorithm that is used for the integer versions of openmpt::module::read. Supported values are:
 	                     - 0: No dithering.
 	                     - 1: Default mode. Chosen by OpenMPT code, might change.
 	                     - 2: Rectangular, 0.5 bit depth, no noise shaping (original ModPlug Tracker).
@@ -510,6 +510,99 @@ int openmpt_probe_file_header_from_stream( uint64_t flags, openmpt_stream_callba
 	return OPENMPT_PROBE_FILE_HEADER_RESULT_ERROR;
 }
 
+static openmpt_module_metadata * openmpt_metadata_create( const openmpt::module_metadata & metadata ) {
+	openmpt_module_metadata * result = (openmpt_module_metadata*)std::calloc( 1, sizeof( openmpt_module_metadata ) );
+	if ( !result ) {
+		throw std::bad_alloc();
+	}
+	try {
+		result->duration_seconds = metadata.duration_seconds;
+		result->num_channels = metadata.num_channels;
+		const std::pair< const char * *, const std::string * > strings[] = {
+			{ &result->type, &metadata.type },
+			{ &result->type_long, &metadata.type_long },
+			{ &result->container, &metadata.container },
+			{ &result->tracker, &metadata.tracker },
+			{ &result->artist, &metadata.artist },
+			{ &result->title, &metadata.title },
+			{ &result->message, &metadata.message },
+		};
+		for ( const auto & str : strings ) {
+			*str.first = openmpt::strdup( str.second->c_str() );
+			if ( !*str.first ) {
+				throw std::bad_alloc();
+			}
+		}
+		const std::pair< const char * const * *, const std::vector<std::string> * > names[] = {
+			{ &result->sample_names, &metadata.sample_names },
+			{ &result->instrument_names, &metadata.instrument_names },
+		};
+		for ( const auto & name : names ) {
+			const char * * list = (const char * *)std::calloc( name.second->size() + 1, sizeof( const char * ) );
+			if ( !list ) {
+				throw std::bad_alloc();
+			}
+			*name.first = list;
+			for ( std::size_t i = 0; i < name.second->size(); ++i ) {
+				list[i] = openmpt::strdup( (*name.second)[i].c_str() );
+				if ( !list[i] ) {
+					throw std::bad_alloc();
+				}
+			}
+		}
+		result->num_samples = static_cast<std::int32_t>( metadata.sample_names.size() );
+		result->num_instruments = static_cast<std::int32_t>( metadata.instrument_names.size() );
+	} catch ( ... ) {
+		openmpt_free_metadata( result );
+		throw;
+	}
+	return result;
+}
+
+openmpt_module_metadata * openmpt_read_metadata_from_memory( const void * filedata, size_t filesize, uint64_t flags, openmpt_log_func logfunc, void * loguser, openmpt_error_func errfunc, void * erruser, int * error, const char * * error_message ) {
+	try {
+		return openmpt_metadata_create( openmpt::module_impl::read_metadata( filedata, filesize, flags, openmpt::helper::make_unique<openmpt::logfunc_logger>( logfunc ? logfunc : openmpt_log_func_default, loguser ) ) );
+	} catch ( ... ) {
+		openmpt::report_exception( __FUNCTION__, logfunc, loguser, errfunc, erruser, error, error_message );
+	}
+	return NULL;
+}
+
+openmpt_module_metadata * openmpt_read_metadata_from_stream( openmpt_stream_callbacks stream_callbacks, void * stream, uint64_t flags, openmpt_log_func logfunc, void * loguser, openmpt_error_func errfunc, void * erruser, int * error, const char * * error_message ) {
+	try {
+		openmpt::callback_stream_wrapper istream = { stream, stream_callbacks.read, stream_callbacks.seek, stream_callbacks.tell };
+		return openmpt_metadata_create( openmpt::module_impl::read_metadata( istream, flags, openmpt::helper::make_unique<openmpt::logfunc_logger>( logfunc ? logfunc : openmpt_log_func_default, loguser ) ) );
+	} catch ( ... ) {
+		openmpt::report_exception( __FUNCTION__, logfunc, loguser, errfunc, erruser, error, error_message );
+	}
+	return NULL;
+}
+
+void openmpt_free_metadata( openmpt_module_metadata * metadata ) {
+	try {
+		if ( !metadata ) {
+			return;
+		}
+		const char * const strings[] = { metadata->type, metadata->type_long, metadata->container, metadata->tracker, metadata->artist, metadata->title, metadata->message };
+		for ( const char * str : strings ) {
+			std::free( const_cast< char * >( str ) );
+		}
+		const char * const * const names[] = { metadata->sample_names, metadata->instrument_names };
+		for ( const char * const * list : names ) {
+			if ( list ) {
+				for ( const char * const * it = list; *it; ++it ) {
+					std::free( const_cast< char * >( *it ) );
+				}
+				std::free( const_cast< char * * >( list ) );
+			}
+		}
+		std::free( metadata );
+	} catch ( ... ) {
+		openmpt::report_exception( __FUNCTION__ );
+	}
+	return;
+}
+
 openmpt_module * openmpt_module_create( openmpt_stream_callbacks stream_callbacks, void * stream, openmpt_log_func logfunc, void * user, const openmpt_module_initial_ctl * ctls ) {
 	return openmpt_module_create2( stream_callbacks, stream, logfunc, user, NULL, NULL, NULL, NULL, ctls );
 }
@@ -607,6 +700,95 @@ openmpt_module * openmpt_module_create_from_memory2( const void * filedata, size
 	return NULL;
 }
 
+openmpt_module * openmpt_module_create_from_filename( const char * filename, openmpt_log_func logfunc, void * loguser, openmpt_error_func errfunc, void * erruser, int * error, const char * * error_message, const openmpt_module_initial_ctl * ctls ) {
+	try {
+		openmpt::interface::check_pointer( filename );
+		openmpt_module * mod = (openmpt_module*)std::calloc( 1, sizeof( openmpt_module ) );
+		if ( !mod ) {
+			throw std::bad_alloc();
+		}
+		std::memset( mod, 0, sizeof( openmpt_module ) );
+		mod->logfunc = logfunc ? logfunc : openmpt_log_func_default;
+		mod->loguser = loguser;
+		mod->errfunc = errfunc ? errfunc : NULL;
+		mod->erruser = erruser;
+		mod->error = OPENMPT_ERROR_OK;
+		mod->error_message = NULL;
+		mod->impl = 0;
+		try {
+			std::map< std::string, std::string > ctls_map;
+			if ( ctls ) {
+				for ( const openmpt_module_initial_ctl * it = ctls; it->ctl; ++it ) {
+					if ( it->value ) {
+						ctls_map[ it->ctl ] = it->value;
+					} else {
+						ctls_map.erase( it->ctl );
+					}
+				}
+			}
+			mod->impl = new openmpt::module_impl( std::string( filename ), openmpt::helper::make_unique<openmpt::logfunc_logger>( mod->logfunc, mod->loguser ), ctls_map );
+			return mod;
+		} catch ( ... ) {
+			openmpt::report_exception( __FUNCTION__, mod, error, error_message );
+		}
+		delete mod->impl;
+		mod->impl = 0;
+		if ( mod->error_message ) {
+			openmpt_free_string( mod->error_message );
+			mod->error_message = NULL;
+		}
+		std::free( (void*)mod );
+		mod = NULL;
+	} catch ( ... ) {
+		openmpt::report_exception( __FUNCTION__, 0, error, error_message );
+	}
+	return NULL;
+}
+
+openmpt_module * openmpt_module_create_from_fd( int fd, openmpt_log_func logfunc, void * loguser, openmpt_error_func errfunc, void * erruser, int * error, const char * * error_message, const openmpt_module_initial_ctl * ctls ) {
+	try {
+		openmpt_module * mod = (openmpt_module*)std::calloc( 1, sizeof( openmpt_module ) );
+		if ( !mod ) {
+			throw std::bad_alloc();
+		}
+		std::memset( mod, 0, sizeof( openmpt_module ) );
+		mod->logfunc = logfunc ? logfunc : openmpt_log_func_default;
+		mod->loguser = loguser;
+		mod->errfunc = errfunc ? errfunc : NULL;
+		mod->erruser = erruser;
+		mod->error = OPENMPT_ERROR_OK;
+		mod->error_message = NULL;
+		mod->impl = 0;
+		try {
+			std::map< std::string, std::string > ctls_map;
+			if ( ctls ) {
+				for ( const openmpt_module_initial_ctl * it = ctls; it->ctl; ++it ) {
+					if ( it->value ) {
+						ctls_map[ it->ctl ] = it->value;
+					} else {
+						ctls_map.erase( it->ctl );
+					}
+				}
+			}
+			mod->impl = new openmpt::module_impl( fd, openmpt::helper::make_unique<openmpt::logfunc_logger>( mod->logfunc, mod->loguser ), ctls_map );
+			return mod;
+		} catch ( ... ) {
+			openmpt::report_exception( __FUNCTION__, mod, error, error_message );
+		}
+		delete mod->impl;
+		mod->impl = 0;
+		if ( mod->error_message ) {
+			openmpt_free_string( mod->error_message );
+			mod->error_message = NULL;
+		}
+		std::free( (void*)mod );
+		mod = NULL;
+	} catch ( ... ) {
+		openmpt::report_exception( __FUNCTION__, 0, error, error_message );
+	}
+	return NULL;
+}
+
 void openmpt_module_destroy( openmpt_module * mod ) {
 	try {
 		openmpt::interface::check_soundfile( mod );
@@ -892,6 +1074,96 @@ size_t openmpt_module_read_interleaved_float_quad( openmpt_module * mod, int32_t
 	}
 	return 0;
 }
+size_t openmpt_module_read_int32_mono( openmpt_module * mod, int32_t samplerate, size_t count, int32_t * mono ) {
+	try {
+		openmpt::interface::check_soundfile( mod );
+		return mod->impl->read( samplerate, count, mono );
+	} catch ( ... ) {
+		openmpt::report_exception( __FUNCTION__, mod );
+	}
+	return 0;
+}
+size_t openmpt_module_read_int32_stereo( openmpt_module * mod, int32_t samplerate, size_t count, int32_t * left, int32_t * right ) {
+	try {
+		openmpt::interface::check_soundfile( mod );
+		return mod->impl->read( samplerate, count, left, right );
+	} catch ( ... ) {
+		openmpt::report_exception( __FUNCTION__, mod );
+	}
+	return 0;
+}
+size_t openmpt_module_read_int32_quad( openmpt_module * mod, int32_t samplerate, size_t count, int32_t * left, int32_t * right, int32_t * rear_left, int32_t * rear_right ) {
+	try {
+		openmpt::interface::check_soundfile( mod );
+		return mod->impl->read( samplerate, count, left, right, rear_left, rear_right );
+	} catch ( ... ) {
+		openmpt::report_exception( __FUNCTION__, mod );
+	}
+	return 0;
+}
+size_t openmpt_module_read_interleaved_int32_stereo( openmpt_module * mod, int32_t samplerate, size_t count, int32_t * interleaved_stereo ) {
+	try {
+		openmpt::interface::check_soundfile( mod );
+		return mod->impl->read_interleaved_stereo( samplerate, count, interleaved_stereo );
+	} catch ( ... ) {
+		openmpt::report_exception( __FUNCTION__, mod );
+	}
+	return 0;
+}
+size_t openmpt_module_read_interleaved_int32_quad( openmpt_module * mod, int32_t samplerate, size_t count, int32_t * interleaved_quad ) {
+	try {
+		openmpt::interface::check_soundfile( mod );
+		return mod->impl->read_interleaved_quad( samplerate, count, interleaved_quad );
+	} catch ( ... ) {
+		openmpt::report_exception( __FUNCTION__, mod );
+	}
+	return 0;
+}
+size_t openmpt_module_read_int24_mono( openmpt_module * mod, int32_t samplerate, size_t count, uint8_t * mono ) {
+	try {
+		openmpt::interface::check_soundfile( mod );
+		return mod->impl->read_int24( samplerate, count, mono );
+	} catch ( ... ) {
+		openmpt::report_exception( __FUNCTION__, mod );
+	}
+	return 0;
+}
+size_t openmpt_module_read_int24_stereo( openmpt_module * mod, int32_t samplerate, size_t count, uint8_t * left, uint8_t * right ) {
+	try {
+		openmpt::interface::check_soundfile( mod );
+		return mod->impl->read_int24( samplerate, count, left, right );
+	} catch ( ... ) {
+		openmpt::report_exception( __FUNCTION__, mod );
+	}
+	return 0;
+}
+size_t openmpt_module_read_int24_quad( openmpt_module * mod, int32_t samplerate, size_t count, uint8_t * left, uint8_t * right, uint8_t * rear_left, uint8_t * rear_right ) {
+	try {
+		openmpt::interface::check_soundfile( mod );
+		return mod->impl->read_int24( samplerate, count, left, right, rear_left, rear_right );
+	} catch ( ... ) {
+		openmpt::report_exception( __FUNCTION__, mod );
+	}
+	return 0;
+}
+size_t openmpt_module_read_interleaved_int24_stereo( openmpt_module * mod, int32_t samplerate, size_t count, uint8_t * interleaved_stereo ) {
+	try {
+		openmpt::interface::check_soundfile( mod );
+		return mod->impl->read_interleaved_int24_stereo( samplerate, count, interleaved_stereo );
+	} catch ( ... ) {
+		openmpt::report_exception( __FUNCTION__, mod );
+	}
+	return 0;
+}
+size_t openmpt_module_read_interleaved_int24_quad( openmpt_module * mod, int32_t samplerate, size_t count, uint8_t * interleaved_quad ) {
+	try {
+		openmpt::interface::check_soundfile( mod );
+		return mod->impl->read_interleaved_int24_quad( samplerate, count, interleaved_quad );
+	} catch ( ... ) {
+		openmpt::report_exception( __FUNCTION__, mod );
+	}
+	return 0;
+}
 
 const char * openmpt_module_get_metadata_keys( openmpt_module * mod ) {
 	try {
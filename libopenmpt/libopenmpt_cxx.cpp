@@ -147,6 +147,13 @@ int probe_file_header( std::uint64_t flags, std::istream & stream ) {
 	return openmpt::module_impl::probe_file_header( flags, stream );
 }
 
+module_metadata read_metadata( std::istream & stream, std::uint64_t flags, std::ostream & log ) {
+	return openmpt::module_impl::read_metadata( stream, flags, openmpt::helper::make_unique<std_ostream_log>( log ) );
+}
+module_metadata read_metadata( const void * data, std::size_t size, std::uint64_t flags, std::ostream & log ) {
+	return openmpt::module_impl::read_metadata( data, size, flags, openmpt::helper::make_unique<std_ostream_log>( log ) );
+}
+
 #if defined(_MSC_VER)
 #pragma warning(push)
 #pragma warning(disable:4702) // unreachable code
@@ -205,6 +212,14 @@ module::module( const void * data, std::size_t size, std::ostream & log, const s
 	impl = new module_impl( data, size, openmpt::helper::make_unique<std_ostream_log>( log ), ctls );
 }
 
+module::module( const std::string & filename, std::ostream & log, const std::map< std::string, std::string > & ctls ) : impl(0) {
+	impl = new module_impl( filename, openmpt::helper::make_unique<std_ostream_log>( log ), ctls );
+}
+
+module::module( int fd, std::ostream & log, const std::map< std::string, std::string > & ctls ) : impl(0) {
+	impl = new module_impl( fd, openmpt::helper::make_unique<std_ostream_log>( log ), ctls );
+}
+
 module::~module() {
 	delete impl;
 	impl = 0;
@@ -276,6 +291,36 @@ std::size_t module::read_interleaved_stereo( std::int32_t samplerate, std::size_
 std::size_t module::read_interleaved_quad( std::int32_t samplerate, std::size_t count, float * interleaved_quad ) {
 	return impl->read_interleaved_quad( samplerate, count, interleaved_quad );
 }
+std::size_t module::read( std::int32_t samplerate, std::size_t count, std::int32_t * mono ) {
+	return impl->read( samplerate, count, mono );
+}
+std::size_t module::read( std::int32_t samplerate, std::size_t count, std::int32_t * left, std::int32_t * right ) {
+	return impl->read( samplerate, count, left, right );
+}
+std::size_t module::read( std::int32_t samplerate, std::size_t count, std::int32_t * left, std::int32_t * right, std::int32_t * rear_left, std::int32_t * rear_right ) {
+	return impl->read( samplerate, count, left, right, rear_left, rear_right );
+}
+std::size_t module::read_interleaved_stereo( std::int32_t samplerate, std::size_t count, std::int32_t * interleaved_stereo ) {
+	return impl->read_interleaved_stereo( samplerate, count, interleaved_stereo );
+}
+std::size_t module::read_interleaved_quad( std::int32_t samplerate, std::size_t count, std::int32_t * interleaved_quad ) {
+	return impl->read_interleaved_quad( samplerate, count, interleaved_quad );
+}
+std::size_t module::read_int24( std::int32_t samplerate, std::size_t count, std::uint8_t * mono ) {
+	return impl->read_int24( samplerate, count, mono );
+}
+std::size_t module::read_int24( std::int32_t samplerate, std::size_t count, std::uint8_t * left, std::uint8_t * right ) {
+	return impl->read_int24( samplerate, count, left, right );
+}
+std::size_t module::read_int24( std::int32_t samplerate, std::size_t count, std::uint8_t * left, std::uint8_t * right, std::uint8_t * rear_left, std::uint8_t * rear_right ) {
+	return impl->read_int24( samplerate, count, left, right, rear_left, rear_right );
+}
+std::size_t module::read_interleaved_int24_stereo( std::int32_t samplerate, std::size_t count, std::uint8_t * interleaved_stereo ) {
+	return impl->read_interleaved_int24_stereo( samplerate, count, interleaved_stereo );
+}
+std::size_t module::read_interleaved_int24_quad( std::int32_t samplerate, std::size_t count, std::uint8_t * interleaved_quad ) {
+	return impl->read_interleaved_int24_quad( samplerate, count, interleaved_quad );
+}
 
 std::vector<std::string> module::get_metadata_keys() const {
 	return impl->get_metadata_keys();
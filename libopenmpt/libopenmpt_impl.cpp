@@ -15,25 +15,40 @@
 #include "libopenmpt_impl.hpp"
 
 #include <algorithm>
+#include <fstream>
 #include <iostream>
 #include <istream>
 #include <iterator>
 #include <limits>
 #include <ostream>
+#include <sstream>
 
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
 
+#if defined(MPT_ENABLE_THREAD)
+#include <system_error>
+#include <thread>
+#endif // MPT_ENABLE_THREAD
+
 #include "common/version.h"
 #include "common/misc_util.h"
 #include "common/FileReader.h"
+#include "common/mptCRC.h"
+#include "common/mptIO.h"
 #include "common/Logging.h"
 #include "common/mptMutex.h"
 #include "soundlib/Sndfile.h"
 #include "soundlib/mod_specifications.h"
 #include "soundlib/AudioReadTarget.h"
 
+#if defined(MPT_FILEREADER_MMAP)
+#include "libopenmpt_stream_callbacks_fd.h"
+#include <fcntl.h>
+#include <unistd.h>
+#endif // MPT_FILEREADER_MMAP
+
 OPENMPT_NAMESPACE_BEGIN
 
 #if !defined(MPT_BUILD_SILENCE_LIBOPENMPT_CONFIGURATION_WARNINGS)
@@ -286,6 +301,15 @@ void std_ostream_log::log( const std::string & message ) const {
 	destination.flush();
 }
 
+class silent_log : public log_interface {
+public:
+	void log( const std::string & message ) const override;
+}; // class silent_log
+
+void silent_log::log( const std::string & /* message */ ) const {
+	return;
+}
+
 class log_forwarder : public ILog {
 private:
 	log_interface & destination;
@@ -425,9 +449,9 @@ module_impl::subsongs_type module_impl::get_subsongs() const {
 	if ( m_sndFile->Order.GetNumSequences() == 0 ) {
 		throw openmpt::exception("module contains no songs");
 	}
+	const std::vector< std::vector<GetLengthType> > lengths = m_sndFile->GetLengthOfAllSequences( m_ctl_load_subsongs_init_threads );
 	for ( SEQUENCEINDEX seq = 0; seq < m_sndFile->Order.GetNumSequences(); ++seq ) {
-		const std::vector<GetLengthType> lengths = m_sndFile->GetLength( eNoAdjust, GetLengthTarget( true ).StartPos( seq, 0, 0 ) );
-		for ( const auto & l : lengths ) {
+		for ( const auto & l : lengths[seq] ) {
 			subsongs.push_back( subsong_data( l.duration, l.startRow, l.startOrder, seq ) );
 		}
 	}
@@ -437,8 +461,141 @@ void module_impl::init_subsongs( subsongs_type & subsongs ) const {
 	subsongs = get_subsongs();
 }
 bool module_impl::has_subsongs_inited() const {
+	finish_subsongs_scan();
 	return !m_subsongs.empty();
 }
+struct module_impl::subsongs_scan {
+	std::shared_ptr<const std::vector<mpt::byte>> data;
+	std::map< std::string, std::string > ctls;
+	subsongs_type subsongs;
+	bool succeeded = false;
+#if defined(MPT_ENABLE_THREAD)
+	std::thread thread;
+	~subsongs_scan() {
+		if ( thread.joinable() ) {
+			thread.join();
+		}
+	}
+#endif // MPT_ENABLE_THREAD
+}; // struct module_impl::subsongs_scan
+void module_impl::start_subsongs_scan( std::unique_ptr<subsongs_scan> scan ) {
+#if defined(MPT_ENABLE_THREAD)
+	// The module that is being played cannot be scanned at the same time, as both playback and the scan modify its play state.
+	// Instead, a private instance of the module (without samples and plugins, which do not affect the sub-songs) is scanned.
+	scan->ctls["load.skip_samples"] = "1";
+	scan->ctls["load.skip_patterns"] = mpt::fmt::val( m_ctl_load_skip_patterns );
+	scan->ctls["load.skip_plugins"] = "1";
+	scan->ctls["load.subsongs_init_threads"] = mpt::fmt::val( m_ctl_load_subsongs_init_threads );
+	subsongs_scan & s = *scan;
+	try {
+		s.thread = std::thread( [&s]() {
+			try {
+				module_impl impl( FileReader( mpt::as_span( *s.data ) ), std::make_unique<silent_log>(), s.ctls );
+				s.subsongs = std::move( impl.m_subsongs );
+				s.succeeded = true;
+			} catch ( ... ) {
+				// The sub-songs of the module that is being played are scanned on demand instead.
+			}
+		} );
+	} catch ( const std::system_error & ) {
+		init_subsongs( m_subsongs );
+		return;
+	}
+	m_subsongs_scan = std::move( scan );
+#else // !MPT_ENABLE_THREAD
+	MPT_UNREFERENCED_PARAMETER( scan );
+	init_subsongs( m_subsongs );
+#endif // MPT_ENABLE_THREAD
+}
+void module_impl::finish_subsongs_scan() const {
+	if ( !m_subsongs_scan ) {
+		return;
+	}
+	std::unique_ptr<subsongs_scan> scan = std::move( m_subsongs_scan );
+#if defined(MPT_ENABLE_THREAD)
+	scan->thread.join();
+#endif // MPT_ENABLE_THREAD
+	if ( scan->succeeded ) {
+		m_subsongs = std::move( scan->subsongs );
+	}
+}
+std::string module_impl::get_file_key( const FileReader & file, int load_flags ) {
+	// Identifies the file contents and everything else that affects what is loaded from it.
+	FileReader f = file;
+	f.Rewind();
+	FileReader::PinnedRawDataView view( f );
+	const mpt::const_byte_span data = view.GetSpan();
+	const mpt::checksum::crc64_jones crc( data.begin(), data.end() );
+	std::ostringstream key;
+	mpt::IO::WriteIntLE<std::uint64_t>( key, crc.result() );
+	mpt::IO::WriteIntLE<std::uint64_t>( key, data.size() );
+	mpt::IO::WriteIntLE<std::uint32_t>( key, load_flags );
+	return key.str();
+}
+std::string module_impl::get_subsongs_cache_key( const std::string & file_key ) const {
+	// Everything that the sub-song scan depends on. A cache is only used if its key matches exactly.
+	const std::string version = version::get_library_version_string() + " " + version::get_core_version_string();
+	std::ostringstream key;
+	mpt::IO::WriteRaw( key, "OMSC", 4 );
+	mpt::IO::WriteIntLE<std::uint8_t>( key, 1 ); // cache format version
+	mpt::IO::WriteIntLE<std::uint16_t>( key, mpt::saturate_cast<std::uint16_t>( version.length() ) );
+	mpt::IO::WriteRaw( key, version.data(), std::min( version.length(), static_cast<std::size_t>( std::numeric_limits<std::uint16_t>::max() ) ) );
+	mpt::IO::WriteRaw( key, file_key.data(), file_key.size() );
+	mpt::IO::WriteIntLE<std::uint32_t>( key, m_sndFile->GetSampleRate() );
+	mpt::IO::WriteIntLE<std::uint32_t>( key, m_sndFile->m_nTempoFactor );
+	return key.str();
+}
+std::string module_impl::get_subsongs_cache() const {
+	if ( m_subsongs_cache_key.empty() ) {
+		return std::string();
+	}
+	std::unique_ptr<subsongs_type> subsongs_temp = has_subsongs_inited() ? std::unique_ptr<subsongs_type>() : std::make_unique<subsongs_type>( get_subsongs() );
+	const subsongs_type & subsongs = has_subsongs_inited() ? m_subsongs : *subsongs_temp;
+	std::ostringstream cache;
+	mpt::IO::WriteRaw( cache, m_subsongs_cache_key.data(), m_subsongs_cache_key.size() );
+	mpt::IO::WriteIntLE<std::uint32_t>( cache, static_cast<std::uint32_t>( subsongs.size() ) );
+	for ( const auto & subsong : subsongs ) {
+		mpt::IO::WriteIntLE<std::uint64_t>( cache, IEEE754binary64LE( subsong.duration ).GetInt64() );
+		mpt::IO::WriteIntLE<std::int32_t>( cache, subsong.start_row );
+		mpt::IO::WriteIntLE<std::int32_t>( cache, subsong.start_order );
+		mpt::IO::WriteIntLE<std::int32_t>( cache, subsong.sequence );
+	}
+	const std::string data = cache.str();
+	return mpt::ToCharset( mpt::CharsetUTF8, Util::BinToHex( mpt::byte_cast<mpt::const_byte_span>( mpt::as_span( data ) ) ) );
+}
+bool module_impl::load_subsongs_cache( const std::string & cache, subsongs_type & subsongs ) const {
+	const std::vector<mpt::byte> data = Util::HexToBin( mpt::ToUnicode( mpt::CharsetUTF8, cache ) );
+	// HexToBin stops at the first invalid character and ignores a trailing half byte, so make sure that the whole string was decoded.
+	if ( data.size() * 2 != cache.length() ) {
+		return false;
+	}
+	FileReader file( mpt::as_span( data ) );
+	if ( !file.ReadMagic( m_subsongs_cache_key.data(), m_subsongs_cache_key.size() ) ) {
+		return false;
+	}
+	const std::uint32_t num_subsongs = file.ReadUint32LE();
+	if ( num_subsongs == 0 || file.BytesLeft() != static_cast<FileReader::off_t>( num_subsongs ) * 20 ) {
+		return false;
+	}
+	subsongs_type result;
+	result.reserve( num_subsongs );
+	for ( std::uint32_t i = 0; i < num_subsongs; ++i ) {
+		const double duration = file.ReadDoubleLE();
+		const std::int32_t start_row = file.ReadInt32LE();
+		const std::int32_t start_order = file.ReadInt32LE();
+		const std::int32_t sequence = file.ReadInt32LE();
+		// The key guards against using the cache with a different file, but do not trust it blindly.
+		if ( !std::isfinite( duration ) || duration < 0.0 || start_row < 0 || start_order < 0 || sequence < 0 ) {
+			return false;
+		}
+		if ( sequence >= m_sndFile->Order.GetNumSequences() || start_order >= m_sndFile->Order( static_cast<SEQUENCEINDEX>( sequence ) ).GetLength() ) {
+			return false;
+		}
+		result.push_back( subsong_data( duration, start_row, start_order, sequence ) );
+	}
+	subsongs = std::move( result );
+	return true;
+}
 void module_impl::ctor( const std::map< std::string, std::string > & ctls ) {
 	m_sndFile = std::make_unique<CSoundFile>();
 	m_loaded = false;
@@ -454,6 +611,12 @@ void module_impl::ctor( const std::map< std::string, std::string > & ctls ) {
 	m_ctl_load_skip_patterns = false;
 	m_ctl_load_skip_plugins = false;
 	m_ctl_load_skip_subsongs_init = false;
+	m_ctl_load_subsongs_init_threads = 0;
+	m_ctl_load_subsongs_cache_enabled = false;
+	m_ctl_load_share_sample_data = false;
+	m_ctl_load_sample_decode_threads = 0;
+	m_ctl_load_lazy_sample_decoding = false;
+	m_ctl_load_progressive = false;
 	m_ctl_seek_sync_samples = false;
 	// init member variables that correspond to ctls
 	for ( const auto & ctl : ctls ) {
@@ -474,11 +637,48 @@ void module_impl::load( const FileReader & file, const std::map< std::string, st
 		if ( m_ctl_load_skip_plugins ) {
 			load_flags &= ~(CSoundFile::loadPluginData | CSoundFile::loadPluginInstance);
 		}
-		if ( !m_sndFile->Create( file, static_cast<CSoundFile::ModLoadingFlags>( load_flags ) ) ) {
+		if ( !( load_flags & CSoundFile::loadCompleteModule ) ) {
+			// Without any of the above, the loaders would only verify the file header.
+			load_flags |= CSoundFile::onlyMetadata;
+		}
+		m_sndFile->SetSampleDecodeThreads( m_ctl_load_sample_decode_threads );
+		m_sndFile->SetLazySampleDecoding( m_ctl_load_lazy_sample_decoding || m_ctl_load_progressive );
+		std::shared_ptr<const std::vector<mpt::byte>> file_data;
+		if ( m_ctl_load_progressive ) {
+			// Postponed samples and the sub-song scan both need the module data after loading. Share a single copy of it.
+			FileReader f = file;
+			f.Rewind();
+			FileReader::PinnedRawDataView view( f );
+			file_data = std::make_shared<const std::vector<mpt::byte>>( view.begin(), view.end() );
+			m_sndFile->SetLazySampleFileData( file_data );
+		}
+		// libopenmpt never associates a file name with the module data, so there is no name that would have to outlive loading.
+		if ( !m_sndFile->Create( file_data ? FileReader( mpt::as_span( *file_data ) ) : file, static_cast<CSoundFile::ModLoadingFlags>( load_flags ) ) ) {
 			throw openmpt::exception("error loading file");
 		}
+		std::string file_key;
+		if ( m_ctl_load_subsongs_cache_enabled || m_ctl_load_share_sample_data ) {
+			file_key = get_file_key( file, load_flags );
+		}
+		if ( m_ctl_load_share_sample_data ) {
+			m_sndFile->ShareSampleData( file_key );
+		}
+		if ( m_ctl_load_subsongs_cache_enabled ) {
+			m_subsongs_cache_key = get_subsongs_cache_key( file_key );
+		}
 		if ( !m_ctl_load_skip_subsongs_init ) {
-			init_subsongs( m_subsongs );
+			if ( m_subsongs_cache_key.empty() || !load_subsongs_cache( m_ctl_load_subsongs_cache, m_subsongs ) ) {
+				if ( m_ctl_load_progressive ) {
+					std::unique_ptr<subsongs_scan> scan = std::make_unique<subsongs_scan>();
+					scan->data = file_data;
+					start_subsongs_scan( std::move( scan ) );
+				} else {
+					init_subsongs( m_subsongs );
+				}
+			}
+		}
+		if ( m_ctl_load_progressive ) {
+			m_sndFile->DecodePendingSamplesInBackground();
 		}
 		m_loaded = true;
 	}
@@ -493,61 +693,38 @@ void module_impl::load( const FileReader & file, const std::map< std::string, st
 		ctl_set( ctl.first, ctl.second, false );
 	}
 }
-bool module_impl::is_loaded() const {
-	return m_loaded;
-}
-std::size_t module_impl::read_wrapper( std::size_t count, std::int16_t * left, std::int16_t * right, std::int16_t * rear_left, std::int16_t * rear_right ) {
-	m_sndFile->ResetMixStat();
-	m_sndFile->m_bIsRendering = ( m_ctl_play_at_end != song_end_action::fadeout_song );
-	std::size_t count_read = 0;
-	while ( count > 0 ) {
-		std::int16_t * const buffers[4] = { left + count_read, right + count_read, rear_left + count_read, rear_right + count_read };
-		AudioReadTargetGainBuffer<std::int16_t> target(*m_Dither, 0, buffers, m_Gain);
-		std::size_t count_chunk = m_sndFile->Read(
-			static_cast<CSoundFile::samplecount_t>( std::min<std::uint64_t>( count, std::numeric_limits<CSoundFile::samplecount_t>::max() / 2 / 4 / 4 ) ), // safety margin / samplesize / channels
-			target
-			);
-		if ( count_chunk == 0 ) {
-			break;
-		}
-		count -= count_chunk;
-		count_read += count_chunk;
-	}
-	if ( count_read == 0 && m_ctl_play_at_end == song_end_action::continue_song ) {
-		// This is the song end, but allow the song or loop to restart on the next call
-		m_sndFile->m_SongFlags.reset(SONG_ENDREACHED);
+void module_impl::load_fd( int fd, const std::map< std::string, std::string > & ctls ) {
+#if defined(MPT_FILEREADER_MMAP)
+	std::shared_ptr<FileDataContainerMappedFile> mapping = std::make_shared<FileDataContainerMappedFile>( fd );
+	if ( mapping->IsValid() ) {
+		load( FileReader( mapping ), ctls );
+		return;
 	}
-	return count_read;
+	// pipes, sockets and the like cannot be mapped, so they are read sequentially (the fd stream callbacks cannot seek)
+	const openmpt_stream_callbacks fd_callbacks = openmpt_stream_get_fd_callbacks();
+	CallbackStream fstream;
+	fstream.stream = reinterpret_cast<void *>( static_cast<std::uintptr_t>( fd ) );
+	fstream.read = fd_callbacks.read;
+	fstream.seek = nullptr;
+	fstream.tell = nullptr;
+	load( make_FileReader( fstream ), ctls );
+#else
+	MPT_UNREFERENCED_PARAMETER( fd );
+	MPT_UNREFERENCED_PARAMETER( ctls );
+	throw openmpt::exception("loading from file descriptors is not supported on this platform");
+#endif
 }
-std::size_t module_impl::read_wrapper( std::size_t count, float * left, float * right, float * rear_left, float * rear_right ) {
-	m_sndFile->ResetMixStat();
-	m_sndFile->m_bIsRendering = ( m_ctl_play_at_end != song_end_action::fadeout_song );
-	std::size_t count_read = 0;
-	while ( count > 0 ) {
-		float * const buffers[4] = { left + count_read, right + count_read, rear_left + count_read, rear_right + count_read };
-		AudioReadTargetGainBuffer<float> target(*m_Dither, 0, buffers, m_Gain);
-		std::size_t count_chunk = m_sndFile->Read(
-			static_cast<CSoundFile::samplecount_t>( std::min<std::uint64_t>( count, std::numeric_limits<CSoundFile::samplecount_t>::max() / 2 / 4 / 4 ) ), // safety margin / samplesize / channels
-			target
-			);
-		if ( count_chunk == 0 ) {
-			break;
-		}
-		count -= count_chunk;
-		count_read += count_chunk;
-	}
-	if ( count_read == 0 && m_ctl_play_at_end == song_end_action::continue_song ) {
-		// This is the song end, but allow the song or loop to restart on the next call
-		m_sndFile->m_SongFlags.reset(SONG_ENDREACHED);
-	}
-	return count_read;
+bool module_impl::is_loaded() const {
+	return m_loaded;
 }
-std::size_t module_impl::read_interleaved_wrapper( std::size_t count, std::size_t channels, std::int16_t * interleaved ) {
+template < typename Tsample >
+std::size_t module_impl::read_wrapper( std::size_t count, Tsample * left, Tsample * right, Tsample * rear_left, Tsample * rear_right ) {
 	m_sndFile->ResetMixStat();
 	m_sndFile->m_bIsRendering = ( m_ctl_play_at_end != song_end_action::fadeout_song );
 	std::size_t count_read = 0;
 	while ( count > 0 ) {
-		AudioReadTargetGainBuffer<std::int16_t> target(*m_Dither, interleaved + count_read * channels, 0, m_Gain);
+		Tsample * const buffers[4] = { left + count_read, right + count_read, rear_left + count_read, rear_right + count_read };
+		AudioReadTargetGainBuffer<Tsample> target(*m_Dither, 0, buffers, m_Gain);
 		std::size_t count_chunk = m_sndFile->Read(
 			static_cast<CSoundFile::samplecount_t>( std::min<std::uint64_t>( count, std::numeric_limits<CSoundFile::samplecount_t>::max() / 2 / 4 / 4 ) ), // safety margin / samplesize / channels
 			target
@@ -564,12 +741,13 @@ std::size_t module_impl::read_interleaved_wrapper( std::size_t count, std::size_
 	}
 	return count_read;
 }
-std::size_t module_impl::read_interleaved_wrapper( std::size_t count, std::size_t channels, float * interleaved ) {
+template < typename Tsample >
+std::size_t module_impl::read_interleaved_wrapper( std::size_t count, std::size_t channels, Tsample * interleaved ) {
 	m_sndFile->ResetMixStat();
 	m_sndFile->m_bIsRendering = ( m_ctl_play_at_end != song_end_action::fadeout_song );
 	std::size_t count_read = 0;
 	while ( count > 0 ) {
-		AudioReadTargetGainBuffer<float> target(*m_Dither, interleaved + count_read * channels, 0, m_Gain);
+		AudioReadTargetGainBuffer<Tsample> target(*m_Dither, interleaved + count_read * channels, 0, m_Gain);
 		std::size_t count_chunk = m_sndFile->Read(
 			static_cast<CSoundFile::samplecount_t>( std::min<std::uint64_t>( count, std::numeric_limits<CSoundFile::samplecount_t>::max() / 2 / 4 / 4 ) ), // safety margin / samplesize / channels
 			target
@@ -823,6 +1001,50 @@ int module_impl::probe_file_header( std::uint64_t flags, callback_stream_wrapper
 	}
 	return result;
 }
+module_metadata module_impl::read_metadata( const OpenMPT::FileReader & file, std::uint64_t flags, std::unique_ptr<log_interface> log ) {
+	// Load as little as possible: no sample data, no plugins, and pattern data only if it is needed for the duration.
+	std::map< std::string, std::string > ctls;
+	ctls["load.skip_samples"] = "1";
+	ctls["load.skip_patterns"] = ( flags & read_metadata_flags_duration ) ? "0" : "1";
+	ctls["load.skip_plugins"] = "1";
+	ctls["load.skip_subsongs_init"] = "1";
+	module_impl impl( file, std::move(log), ctls );
+	module_metadata metadata;
+	metadata.type = impl.get_metadata( "type" );
+	metadata.type_long = impl.get_metadata( "type_long" );
+	metadata.container = impl.get_metadata( "container" );
+	metadata.tracker = impl.get_metadata( "tracker" );
+	metadata.artist = impl.get_metadata( "artist" );
+	metadata.title = impl.get_metadata( "title" );
+	metadata.message = impl.get_metadata( "message_raw" );
+	metadata.num_channels = impl.get_num_channels();
+	metadata.sample_names = impl.get_sample_names();
+	metadata.instrument_names = impl.get_instrument_names();
+	if ( flags & read_metadata_flags_duration ) {
+		// Only the first sub-song, which is what openmpt::module::get_duration_seconds() returns by default.
+		metadata.duration_seconds = impl.m_sndFile->GetLength( eNoAdjust, GetLengthTarget().StartPos( 0, 0, 0 ) ).back().duration;
+	}
+	return metadata;
+}
+module_metadata module_impl::read_metadata( callback_stream_wrapper stream, std::uint64_t flags, std::unique_ptr<log_interface> log ) {
+	CallbackStream fstream;
+	fstream.stream = stream.stream;
+	fstream.read = stream.read;
+	fstream.seek = stream.seek;
+	fstream.tell = stream.tell;
+	return read_metadata( make_FileReader( fstream ), flags, std::move(log) );
+}
+module_metadata module_impl::read_metadata( std::istream & stream, std::uint64_t flags, std::unique_ptr<log_interface> log ) {
+	return read_metadata( make_FileReader( &stream ), flags, std::move(log) );
+}
+module_metadata module_impl::read_metadata( const void * data, std::size_t size, std::uint64_t flags, std::unique_ptr<log_interface> log ) {
+	return read_metadata( make_FileReader( mpt::as_span( mpt::void_cast< const mpt::byte * >( data ), size ) ), flags, std::move(log) );
+}
+module_impl::module_impl( const OpenMPT::FileReader & file, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls ) : m_Log(std::move(log)) {
+	ctor( ctls );
+	load( file, ctls );
+	apply_libopenmpt_defaults();
+}
 module_impl::module_impl( callback_stream_wrapper stream, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls ) : m_Log(std::move(log)) {
 	ctor( ctls );
 	CallbackStream fstream;
@@ -863,6 +1085,34 @@ module_impl::module_impl( const void * data, std::size_t size, std::unique_ptr<l
 	load( make_FileReader( mpt::as_span( mpt::void_cast< const mpt::byte * >( data ), size ) ), ctls );
 	apply_libopenmpt_defaults();
 }
+module_impl::module_impl( int fd, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls ) : m_Log(std::move(log)) {
+	ctor( ctls );
+	load_fd( fd, ctls );
+	apply_libopenmpt_defaults();
+}
+module_impl::module_impl( const std::string & filename, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls ) : m_Log(std::move(log)) {
+	ctor( ctls );
+#if defined(MPT_FILEREADER_MMAP)
+	int fd = ::open( filename.c_str(), O_RDONLY | O_CLOEXEC );
+	if ( fd < 0 ) {
+		throw openmpt::exception("cannot open file");
+	}
+	try {
+		load_fd( fd, ctls );
+	} catch ( ... ) {
+		::close( fd );
+		throw;
+	}
+	::close( fd );
+#else
+	std::ifstream stream( filename, std::ios::binary );
+	if ( !stream ) {
+		throw openmpt::exception("cannot open file");
+	}
+	load( make_FileReader( &stream ), ctls );
+#endif
+	apply_libopenmpt_defaults();
+}
 module_impl::~module_impl() {
 	m_sndFile->Destroy();
 }
@@ -924,7 +1174,7 @@ std::size_t module_impl::read( std::int32_t samplerate, std::size_t count, std::
 		throw openmpt::exception("null pointer");
 	}
 	apply_mixer_settings( samplerate, 1 );
-	count = read_wrapper( count, mono, 0, 0, 0 );
+	count = read_wrapper<std::int16_t>( count, mono, 0, 0, 0 );
 	m_currentPositionSeconds += static_cast<double>( count ) / static_cast<double>( samplerate );
 	return count;
 }
@@ -933,7 +1183,7 @@ std::size_t module_impl::read( std::int32_t samplerate, std::size_t count, std::
 		throw openmpt::exception("null pointer");
 	}
 	apply_mixer_settings( samplerate, 2 );
-	count = read_wrapper( count, left, right, 0, 0 );
+	count = read_wrapper<std::int16_t>( count, left, right, 0, 0 );
 	m_currentPositionSeconds += static_cast<double>( count ) / static_cast<double>( samplerate );
 	return count;
 }
@@ -951,7 +1201,7 @@ std::size_t module_impl::read( std::int32_t samplerate, std::size_t count, float
 		throw openmpt::exception("null pointer");
 	}
 	apply_mixer_settings( samplerate, 1 );
-	count = read_wrapper( count, mono, 0, 0, 0 );
+	count = read_wrapper<float>( count, mono, 0, 0, 0 );
 	m_currentPositionSeconds += static_cast<double>( count ) / static_cast<double>( samplerate );
 	return count;
 }
@@ -960,7 +1210,7 @@ std::size_t module_impl::read( std::int32_t samplerate, std::size_t count, float
 		throw openmpt::exception("null pointer");
 	}
 	apply_mixer_settings( samplerate, 2 );
-	count = read_wrapper( count, left, right, 0, 0 );
+	count = read_wrapper<float>( count, left, right, 0, 0 );
 	m_currentPositionSeconds += static_cast<double>( count ) / static_cast<double>( samplerate );
 	return count;
 }
@@ -1010,6 +1260,96 @@ std::size_t module_impl::read_interleaved_quad( std::int32_t samplerate, std::si
 	return count;
 }
 
+std::size_t module_impl::read( std::int32_t samplerate, std::size_t count, std::int32_t * mono ) {
+	if ( !mono ) {
+		throw openmpt::exception("null pointer");
+	}
+	apply_mixer_settings( samplerate, 1 );
+	count = read_wrapper<std::int32_t>( count, mono, 0, 0, 0 );
+	m_currentPositionSeconds += static_cast<double>( count ) / static_cast<double>( samplerate );
+	return count;
+}
+std::size_t module_impl::read( std::int32_t samplerate, std::size_t count, std::int32_t * left, std::int32_t * right ) {
+	if ( !left || !right ) {
+		throw openmpt::exception("null pointer");
+	}
+	apply_mixer_settings( samplerate, 2 );
+	count = read_wrapper<std::int32_t>( count, left, right, 0, 0 );
+	m_currentPositionSeconds += static_cast<double>( count ) / static_cast<double>( samplerate );
+	return count;
+}
+std::size_t module_impl::read( std::int32_t samplerate, std::size_t count, std::int32_t * left, std::int32_t * right, std::int32_t * rear_left, std::int32_t * rear_right ) {
+	if ( !left || !right || !rear_left || !rear_right ) {
+		throw openmpt::exception("null pointer");
+	}
+	apply_mixer_settings( samplerate, 4 );
+	count = read_wrapper( count, left, right, rear_left, rear_right );
+	m_currentPositionSeconds += static_cast<double>( count ) / static_cast<double>( samplerate );
+	return count;
+}
+std::size_t module_impl::read_interleaved_stereo( std::int32_t samplerate, std::size_t count, std::int32_t * interleaved_stereo ) {
+	if ( !interleaved_stereo ) {
+		throw openmpt::exception("null pointer");
+	}
+	apply_mixer_settings( samplerate, 2 );
+	count = read_interleaved_wrapper( count, 2, interleaved_stereo );
+	m_currentPositionSeconds += static_cast<double>( count ) / static_cast<double>( samplerate );
+	return count;
+}
+std::size_t module_impl::read_interleaved_quad( std::int32_t samplerate, std::size_t count, std::int32_t * interleaved_quad ) {
+	if ( !interleaved_quad ) {
+		throw openmpt::exception("null pointer");
+	}
+	apply_mixer_settings( samplerate, 4 );
+	count = read_interleaved_wrapper( count, 4, interleaved_quad );
+	m_currentPositionSeconds += static_cast<double>( count ) / static_cast<double>( samplerate );
+	return count;
+}
+std::size_t module_impl::read_int24( std::int32_t samplerate, std::size_t count, std::uint8_t * mono ) {
+	if ( !mono ) {
+		throw openmpt::exception("null pointer");
+	}
+	apply_mixer_settings( samplerate, 1 );
+	count = read_wrapper<int24>( count, reinterpret_cast<int24 *>( mono ), 0, 0, 0 );
+	m_currentPositionSeconds += static_cast<double>( count ) / static_cast<double>( samplerate );
+	return count;
+}
+std::size_t module_impl::read_int24( std::int32_t samplerate, std::size_t count, std::uint8_t * left, std::uint8_t * right ) {
+	if ( !left || !right ) {
+		throw openmpt::exception("null pointer");
+	}
+	apply_mixer_settings( samplerate, 2 );
+	count = read_wrapper<int24>( count, reinterpret_cast<int24 *>( left ), reinterpret_cast<int24 *>( right ), 0, 0 );
+	m_currentPositionSeconds += static_cast<double>( count ) / static_cast<double>( samplerate );
+	return count;
+}
+std::size_t module_impl::read_int24( std::int32_t samplerate, std::size_t count, std::uint8_t * left, std::uint8_t * right, std::uint8_t * rear_left, std::uint8_t * rear_right ) {
+	if ( !left || !right || !rear_left || !rear_right ) {
+		throw openmpt::exception("null pointer");
+	}
+	apply_mixer_settings( samplerate, 4 );
+	count = read_wrapper( count, reinterpret_cast<int24 *>( left ), reinterpret_cast<int24 *>( right ), reinterpret_cast<int24 *>( rear_left ), reinterpret_cast<int24 *>( rear_right ) );
+	m_currentPositionSeconds += static_cast<double>( count ) / static_cast<double>( samplerate );
+	return count;
+}
+std::size_t module_impl::read_interleaved_int24_stereo( std::int32_t samplerate, std::size_t count, std::uint8_t * interleaved_stereo ) {
+	if ( !interleaved_stereo ) {
+		throw openmpt::exception("null pointer");
+	}
+	apply_mixer_settings( samplerate, 2 );
+	count = read_interleaved_wrapper( count, 2, reinterpret_cast<int24 *>( interleaved_stereo ) );
+	m_currentPositionSeconds += static_cast<double>( count ) / static_cast<double>( samplerate );
+	return count;
+}
+std::size_t module_impl::read_interleaved_int24_quad( std::int32_t samplerate, std::size_t count, std::uint8_t * interleaved_quad ) {
+	if ( !interleaved_quad ) {
+		throw openmpt::exception("null pointer");
+	}
+	apply_mixer_settings( samplerate, 4 );
+	count = read_interleaved_wrapper( count, 4, reinterpret_cast<int24 *>( interleaved_quad ) );
+	m_currentPositionSeconds += static_cast<double>( count ) / static_cast<double>( samplerate );
+	return count;
+}
 
 double module_impl::get_duration_seconds() const {
 	std::unique_ptr<subsongs_type> subsongs_temp = has_subsongs_inited() ?  std::unique_ptr<subsongs_type>() : std::make_unique<subsongs_type>( get_subsongs() );
@@ -1517,13 +1857,23 @@ std::vector<std::string> module_impl::get_ctls() const {
 		"load.skip_patterns",
 		"load.skip_plugins",
 		"load.skip_subsongs_init",
+		"load.subsongs_init_threads",
+		"load.subsongs_cache",
+		"load.share_sample_data",
+		"load.sample_decode_threads",
+		"load.lazy_sample_decoding",
+		"load.progressive",
 		"seek.sync_samples",
+		"seek.index_interval_seconds",
 		"subsong",
 		"play.tempo_factor",
 		"play.pitch_factor",
 		"play.at_end",
 		"render.resampler.emulate_amiga",
 		"render.opl.volume_factor",
+		"render.mix_threads",
+		"render.mix_block_size",
+		"render.cull_threshold_db",
 		"dither",
 	};
 }
@@ -1551,8 +1901,22 @@ std::string module_impl::ctl_get( std::string ctl, bool throw_if_unknown ) const
 		return mpt::fmt::val( m_ctl_load_skip_plugins );
 	} else if ( ctl == "load.skip_subsongs_init" ) {
 		return mpt::fmt::val( m_ctl_load_skip_subsongs_init );
+	} else if ( ctl == "load.subsongs_init_threads" ) {
+		return mpt::fmt::val( m_ctl_load_subsongs_init_threads );
+	} else if ( ctl == "load.subsongs_cache" ) {
+		return get_subsongs_cache();
+	} else if ( ctl == "load.share_sample_data" ) {
+		return mpt::fmt::val( m_ctl_load_share_sample_data );
+	} else if ( ctl == "load.sample_decode_threads" ) {
+		return mpt::fmt::val( m_ctl_load_sample_decode_threads );
+	} else if ( ctl == "load.lazy_sample_decoding" ) {
+		return mpt::fmt::val( m_ctl_load_lazy_sample_decoding );
+	} else if ( ctl == "load.progressive" ) {
+		return mpt::fmt::val( m_ctl_load_progressive );
 	} else if ( ctl == "seek.sync_samples" ) {
 		return mpt::fmt::val( m_ctl_seek_sync_samples );
+	} else if ( ctl == "seek.index_interval_seconds" ) {
+		return mpt::fmt::val( m_sndFile->GetSeekIndexInterval() );
 	} else if ( ctl == "subsong" ) {
 		return mpt::fmt::val( get_selected_subsong() );
 	} else if ( ctl == "play.at_end" ) {
@@ -1581,6 +1945,12 @@ std::string module_impl::ctl_get( std::string ctl, bool throw_if_unknown ) const
 		return mpt::fmt::val( m_sndFile->m_Resampler.m_Settings.emulateAmiga );
 	} else if ( ctl == "render.opl.volume_factor" ) {
 		return mpt::fmt::val( static_cast<double>( m_sndFile->m_OPLVolumeFactor ) / static_cast<double>( m_sndFile->m_OPLVolumeFactorScale ) );
+	} else if ( ctl == "render.mix_threads" ) {
+		return mpt::fmt::val( m_sndFile->GetMixThreads() );
+	} else if ( ctl == "render.mix_block_size" ) {
+		return mpt::fmt::val( m_sndFile->GetMixBlockSize() );
+	} else if ( ctl == "render.cull_threshold_db" ) {
+		return mpt::fmt::val( m_sndFile->GetVoiceCullThreshold() );
 	} else if ( ctl == "dither" ) {
 		return mpt::fmt::val( static_cast<int>( m_Dither->GetMode() ) );
 	} else {
@@ -1615,8 +1985,35 @@ void module_impl::ctl_set( std::string ctl, const std::string & value, bool thro
 		m_ctl_load_skip_plugins = ConvertStrTo<bool>( value );
 	} else if ( ctl == "load.skip_subsongs_init" ) {
 		m_ctl_load_skip_subsongs_init = ConvertStrTo<bool>( value );
+	} else if ( ctl == "load.subsongs_init_threads" ) {
+		int32 threads = ConvertStrTo<int32>( value );
+		if ( threads < 0 ) {
+			throw openmpt::exception("invalid number of threads");
+		}
+		m_ctl_load_subsongs_init_threads = threads;
+	} else if ( ctl == "load.subsongs_cache" ) {
+		m_ctl_load_subsongs_cache_enabled = true;
+		m_ctl_load_subsongs_cache = value;
+	} else if ( ctl == "load.share_sample_data" ) {
+		m_ctl_load_share_sample_data = ConvertStrTo<bool>( value );
+	} else if ( ctl == "load.sample_decode_threads" ) {
+		int32 threads = ConvertStrTo<int32>( value );
+		if ( threads < 0 ) {
+			throw openmpt::exception("invalid number of threads");
+		}
+		m_ctl_load_sample_decode_threads = threads;
+	} else if ( ctl == "load.lazy_sample_decoding" ) {
+		m_ctl_load_lazy_sample_decoding = ConvertStrTo<bool>( value );
+	} else if ( ctl == "load.progressive" ) {
+		m_ctl_load_progressive = ConvertStrTo<bool>( value );
 	} else if ( ctl == "seek.sync_samples" ) {
 		m_ctl_seek_sync_samples = ConvertStrTo<bool>( value );
+	} else if ( ctl == "seek.index_interval_seconds" ) {
+		double interval = ConvertStrTo<double>( value );
+		if ( interval < 0.0 ) {
+			throw openmpt::exception("invalid seek index interval");
+		}
+		m_sndFile->SetSeekIndexInterval( interval );
 	} else if ( ctl == "subsong" ) {
 		select_subsong( ConvertStrTo<int32>( value ) );
 	} else if ( ctl == "play.at_end" ) {
@@ -1657,6 +2054,12 @@ void module_impl::ctl_set( std::string ctl, const std::string & value, bool thro
 		}
 	} else if ( ctl == "render.opl.volume_factor" ) {
 		m_sndFile->m_OPLVolumeFactor = mpt::saturate_round<int32>( ConvertStrTo<double>( value ) * static_cast<double>( m_sndFile->m_OPLVolumeFactorScale ) );
+	} else if ( ctl == "render.mix_threads" ) {
+		m_sndFile->SetMixThreads( ConvertStrTo<uint32>( value ) );
+	} else if ( ctl == "render.mix_block_size" ) {
+		m_sndFile->SetMixBlockSize( ConvertStrTo<uint32>( value ) );
+	} else if ( ctl == "render.cull_threshold_db" ) {
+		m_sndFile->SetVoiceCullThreshold( ConvertStrTo<double>( value ) );
 	} else if ( ctl == "dither" ) {
 		int dither = ConvertStrTo<int>( value );
 		if ( dither < 0 || dither >= NumDitherModes ) {
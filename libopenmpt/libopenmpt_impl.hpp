@@ -82,6 +82,8 @@ protected:
 
 	typedef std::vector<subsong_data> subsongs_type;
 
+	struct subsongs_scan;
+
 	enum class song_end_action {
 		fadeout_song,
 		continue_song,
@@ -98,13 +100,23 @@ protected:
 	bool m_loaded;
 	bool m_mixer_initialized;
 	std::unique_ptr<OpenMPT::Dither> m_Dither;
-	subsongs_type m_subsongs;
+	// Filled in later if the sub-songs are scanned in the background, see load.progressive.
+	mutable subsongs_type m_subsongs;
+	mutable std::unique_ptr<subsongs_scan> m_subsongs_scan;
 	float m_Gain;
 	song_end_action m_ctl_play_at_end;
 	bool m_ctl_load_skip_samples;
 	bool m_ctl_load_skip_patterns;
 	bool m_ctl_load_skip_plugins;
 	bool m_ctl_load_skip_subsongs_init;
+	std::int32_t m_ctl_load_subsongs_init_threads;
+	bool m_ctl_load_subsongs_cache_enabled;
+	std::string m_ctl_load_subsongs_cache;
+	std::string m_subsongs_cache_key;
+	bool m_ctl_load_share_sample_data;
+	std::int32_t m_ctl_load_sample_decode_threads;
+	bool m_ctl_load_lazy_sample_decoding;
+	bool m_ctl_load_progressive;
 	bool m_ctl_seek_sync_samples;
 	std::vector<std::string> m_loaderMessages;
 public:
@@ -117,16 +129,25 @@ protected:
 	subsongs_type get_subsongs() const;
 	void init_subsongs( subsongs_type & subsongs ) const;
 	bool has_subsongs_inited() const;
+	void start_subsongs_scan( std::unique_ptr<subsongs_scan> scan );
+	void finish_subsongs_scan() const;
+	static std::string get_file_key( const OpenMPT::FileReader & file, int load_flags );
+	std::string get_subsongs_cache_key( const std::string & file_key ) const;
+	std::string get_subsongs_cache() const;
+	bool load_subsongs_cache( const std::string & cache, subsongs_type & subsongs ) const;
 	void ctor( const std::map< std::string, std::string > & ctls );
 	void load( const OpenMPT::FileReader & file, const std::map< std::string, std::string > & ctls );
+	void load_fd( int fd, const std::map< std::string, std::string > & ctls );
 	bool is_loaded() const;
-	std::size_t read_wrapper( std::size_t count, std::int16_t * left, std::int16_t * right, std::int16_t * rear_left, std::int16_t * rear_right );
-	std::size_t read_wrapper( std::size_t count, float * left, float * right, float * rear_left, float * rear_right );
-	std::size_t read_interleaved_wrapper( std::size_t count, std::size_t channels, std::int16_t * interleaved );
-	std::size_t read_interleaved_wrapper( std::size_t count, std::size_t channels, float * interleaved );
+	template < typename Tsample >
+	std::size_t read_wrapper( std::size_t count, Tsample * left, Tsample * right, Tsample * rear_left, Tsample * rear_right );
+	template < typename Tsample >
+	std::size_t read_interleaved_wrapper( std::size_t count, std::size_t channels, Tsample * interleaved );
 	std::pair< std::string, std::string > format_and_highlight_pattern_row_channel_command( std::int32_t p, std::int32_t r, std::int32_t c, int command ) const;
 	std::pair< std::string, std::string > format_and_highlight_pattern_row_channel( std::int32_t p, std::int32_t r, std::int32_t c, std::size_t width, bool pad ) const;
 	static double could_open_probability( const OpenMPT::FileReader & file, double effort, std::unique_ptr<log_interface> log );
+	static module_metadata read_metadata( const OpenMPT::FileReader & file, std::uint64_t flags, std::unique_ptr<log_interface> log );
+	module_impl( const OpenMPT::FileReader & file, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls );
 public:
 	static std::vector<std::string> get_supported_extensions();
 	static bool is_extension_supported( const char * extension );
@@ -140,6 +161,9 @@ public:
 	static int probe_file_header( std::uint64_t flags, const void * data, std::size_t size );
 	static int probe_file_header( std::uint64_t flags, std::istream & stream );
 	static int probe_file_header( std::uint64_t flags, callback_stream_wrapper stream );
+	static module_metadata read_metadata( callback_stream_wrapper stream, std::uint64_t flags, std::unique_ptr<log_interface> log );
+	static module_metadata read_metadata( std::istream & stream, std::uint64_t flags, std::unique_ptr<log_interface> log );
+	static module_metadata read_metadata( const void * data, std::size_t size, std::uint64_t flags, std::unique_ptr<log_interface> log );
 	module_impl( callback_stream_wrapper stream, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls );
 	module_impl( std::istream & stream, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls );
 	module_impl( const std::vector<std::uint8_t> & data, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls );
@@ -147,6 +171,8 @@ public:
 	module_impl( const std::uint8_t * data, std::size_t size, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls );
 	module_impl( const char * data, std::size_t size, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls );
 	module_impl( const void * data, std::size_t size, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls );
+	module_impl( int fd, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls );
+	module_impl( const std::string & filename, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls );
 	~module_impl();
 public:
 	void select_subsong( std::int32_t subsong );
@@ -169,6 +195,16 @@ public:
 	std::size_t read_interleaved_quad( std::int32_t samplerate, std::size_t count, std::int16_t * interleaved_quad );
 	std::size_t read_interleaved_stereo( std::int32_t samplerate, std::size_t count, float * interleaved_stereo );
 	std::size_t read_interleaved_quad( std::int32_t samplerate, std::size_t count, float * interleaved_quad );
+	std::size_t read( std::int32_t samplerate, std::size_t count, std::int32_t * mono );
+	std::size_t read( std::int32_t samplerate, std::size_t count, std::int32_t * left, std::int32_t * right );
+	std::size_t read( std::int32_t samplerate, std::size_t count, std::int32_t * left, std::int32_t * right, std::int32_t * rear_left, std::int32_t * rear_right );
+	std::size_t read_interleaved_stereo( std::int32_t samplerate, std::size_t count, std::int32_t * interleaved_stereo );
+	std::size_t read_interleaved_quad( std::int32_t samplerate, std::size_t count, std::int32_t * interleaved_quad );
+	std::size_t read_int24( std::int32_t samplerate, std::size_t count, std::uint8_t * mono );
+	std::size_t read_int24( std::int32_t samplerate, std::size_t count, std::uint8_t * left, std::uint8_t * right );
+	std::size_t read_int24( std::int32_t samplerate, std::size_t count, std::uint8_t * left, std::uint8_t * right, std::uint8_t * rear_left, std::uint8_t * rear_right );
+	std::size_t read_interleaved_int24_stereo( std::int32_t samplerate, std::size_t count, std::uint8_t * interleaved_stereo );
+	std::size_t read_interleaved_int24_quad( std::int32_t samplerate, std::size_t count, std::uint8_t * interleaved_quad );
 	std::vector<std::string> get_metadata_keys() const;
 	std::string get_metadata( const std::string & key ) const;
 	std::int32_t get_current_speed() const;
@@ -1988,7 +1988,7 @@ void CCtrlSamples::ApplyResample(uint32_t newRate, ResamplingMode mode)
 				SmpLength procCount = std::min<SmpLength>(MIXBUFFERSIZE, writeCount);
 				mixsample_t buffer[MIXBUFFERSIZE * 2];
 				MemsetZero(buffer);
-				MixFuncTable::Functions[functionNdx](chn, m_sndFile.m_Resampler, buffer, procCount);
+				MixFuncTable::Functions[MixFuncTable::GetInstructionSetIndex()][functionNdx](chn, m_sndFile.m_Resampler, buffer, procCount);
 
 				for(uint8 c = 0; c < numChannels; c++)
 				{
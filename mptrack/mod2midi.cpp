@@ -110,6 +110,7 @@ namespace MidiExport
 			if(tempoTrack == nullptr) return;
 
 			m_pMixStruct->pMixPlugin = this;
+			m_sndFile.InvalidatePluginGraph();
 		}
 
 		void WritePitchWheelDepth(MidiChannel midiChOverride = MidiNoChannel)
@@ -418,6 +419,7 @@ namespace MidiExport
 				MidiTrack &midiInstr = *(new MidiTrack(m_plugFactory, m_sndFile, &mixPlugin, &tempoTrack, m_wasInstrumentMode ? std::string(oldInstr->name) : m_sndFile.GetSampleName(i), oldInstr, overlappingInstruments));
 				ModInstrument &instr = midiInstr;
 				mixPlugin.pMixPlugin = &midiInstr;
+				m_sndFile.InvalidatePluginGraph();
 				
 				m_sndFile.Instruments[i] = &instr;
 				m_tracks.push_back(&midiInstr);
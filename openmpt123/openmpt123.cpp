@@ -58,6 +58,26 @@ static const char * const license =
 #include <cstring>
 #include <ctime>
 
+#if !defined(__DJGPP__)
+#if (defined(__MINGW32__) || defined(__MINGW64__)) && !defined(_GLIBCXX_HAS_GTHREADS) && defined(MPT_WITH_MINGWSTDTHREADS)
+#define OPENMPT123_WITH_THREADS
+#include <atomic>
+#include <chrono>
+#include <mingw.condition_variable.h>
+#include <mingw.mutex.h>
+#include <mingw.thread.h>
+#include <system_error>
+#elif !((defined(__MINGW32__) || defined(__MINGW64__)) && !defined(_GLIBCXX_HAS_GTHREADS))
+#define OPENMPT123_WITH_THREADS
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#endif
+#endif
+
 #if defined(__DJGPP__)
 #include <conio.h>
 #include <fcntl.h>
@@ -282,6 +302,7 @@ static std::ostream & operator << ( std::ostream & s, const commandlineflags & f
 	s << "Standard output: " << flags.use_stdout << std::endl;
 	s << "Output filename: " << flags.output_filename << std::endl;
 	s << "Force overwrite output file: " << flags.force_overwrite << std::endl;
+	s << "Render jobs: " << flags.jobs << std::endl;
 	s << "Ctls: " << ctls_to_string( flags.ctls ) << std::endl;
 	s << std::endl;
 	s << "Files: " << std::endl;
@@ -657,6 +678,7 @@ static void show_help( textout & log, bool with_info = true, bool longhelp = fal
 		log << "     --output-type t        Use output format t when writing to a individual PCM files (only applies to --render mode) [default: " << commandlineflags().output_extension << "]" << std::endl;
 		log << " -o, --output f             Write PCM output to file f instead of streaming to audio device (only applies to --ui and --batch modes) [default: " << commandlineflags().output_filename << "]" << std::endl;
 		log << "     --force                Force overwriting of output file [default: " << commandlineflags().force_overwrite << "]" << std::endl;
+		log << "     --jobs n               Render n files in parallel, 0 means one per CPU core (only applies to --render mode) [default: " << commandlineflags().jobs << "]" << std::endl;
 		log << std::endl;
 		log << "     --                     Interpret further arguments as filenames" << std::endl;
 		log << std::endl;
@@ -1686,12 +1708,14 @@ static void probe_file( commandlineflags & flags, const std::string & filename,
 
 }
 
-static void render_file( commandlineflags & flags, const std::string & filename, textout & log, write_buffers_interface & audio_stream ) {
+static bool render_file( commandlineflags & flags, const std::string & filename, textout & log, write_buffers_interface & audio_stream ) {
 
 	log.writeout();
 
 	std::ostringstream silentlog;
 
+	bool success = false;
+
 	try {
 
 #if defined(WIN32) && defined(UNICODE) && !defined(_MSC_VER)
@@ -1743,6 +1767,8 @@ static void render_file( commandlineflags & flags, const std::string & filename,
 			render_mod_file( flags, filename, filesize, mod, log, audio_stream );
 		}
 
+		success = true;
+
 	} catch ( prev_file & ) {
 		throw;
 	} catch ( next_file & ) {
@@ -1769,6 +1795,8 @@ static void render_file( commandlineflags & flags, const std::string & filename,
 
 	log.writeout();
 
+	return success;
+
 }
 
 
@@ -1848,6 +1876,184 @@ static void render_files( commandlineflags & flags, textout & log, write_buffers
 }
 
 
+#if defined(OPENMPT123_WITH_THREADS)
+
+class counting_audio_stream : public write_buffers_interface {
+private:
+	write_buffers_interface & impl;
+	std::uint64_t frames;
+public:
+	counting_audio_stream( write_buffers_interface & impl_ )
+		: impl(impl_)
+		, frames(0)
+	{
+		return;
+	}
+	virtual ~counting_audio_stream() {
+		return;
+	}
+public:
+	std::uint64_t get_frames() const {
+		return frames;
+	}
+	void write_metadata( std::map<std::string,std::string> metadata ) override {
+		impl.write_metadata( metadata );
+	}
+	void write_updated_metadata( std::map<std::string,std::string> metadata ) override {
+		impl.write_updated_metadata( metadata );
+	}
+	void write( const std::vector<float*> buffers, std::size_t frames_ ) override {
+		impl.write( buffers, frames_ );
+		frames += frames_;
+	}
+	void write( const std::vector<std::int16_t*> buffers, std::size_t frames_ ) override {
+		impl.write( buffers, frames_ );
+		frames += frames_;
+	}
+};
+
+struct render_job_result {
+	std::string log;
+	bool success;
+	std::uint64_t frames;
+	double seconds;
+	render_job_result()
+		: success(false)
+		, frames(0)
+		, seconds(0.0)
+	{
+		return;
+	}
+};
+
+static std::string realtime_factor_to_string( double audio_seconds, double wall_seconds ) {
+	std::ostringstream str;
+	str << std::fixed << std::setprecision(2);
+	if ( wall_seconds > 0.0 ) {
+		str << audio_seconds / wall_seconds << "x";
+	} else {
+		str << "-";
+	}
+	return str.str();
+}
+
+// Each file is rendered by one of flags.jobs worker threads with its own module instance and output file.
+// The console output of each file is collected separately and printed in playlist order
+// as soon as all preceding files have been rendered, so that it never interleaves.
+static void render_files_parallel( commandlineflags & flags, textout & log ) {
+
+	log.writeout();
+
+	const std::size_t num_files = flags.filenames.size();
+	const std::size_t num_jobs = std::min( static_cast<std::size_t>( flags.jobs ), num_files );
+
+	std::vector<render_job_result> results( num_files );
+	std::vector<bool> done( num_files );
+	std::mutex done_mutex;
+	std::condition_variable done_cond;
+	std::atomic<std::size_t> next_file( 0 );
+
+	const auto render_job = [&]( std::size_t index ) {
+		const std::string & filename = flags.filenames[index];
+		commandlineflags job_flags = flags;
+		job_flags.playlist_index = index;
+		job_flags.show_progress = false;
+		textout_buffer job_log;
+		render_job_result result;
+		const auto start = std::chrono::steady_clock::now();
+		try {
+			file_audio_stream_raii file_audio_stream( job_flags, filename + std::string(".") + job_flags.output_extension, job_log );
+			counting_audio_stream audio_stream( file_audio_stream );
+			result.success = render_file( job_flags, filename, job_log, audio_stream );
+			result.frames = audio_stream.get_frames();
+		} catch ( std::exception & e ) {
+			job_log << "error rendering '" << filename << "': " << e.what() << std::endl;
+			job_log << std::endl;
+		} catch ( ... ) {
+			job_log << "unknown error rendering '" << filename << "'" << std::endl;
+			job_log << std::endl;
+		}
+		result.seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+		result.log = job_log.get();
+		{
+			std::lock_guard<std::mutex> lock( done_mutex );
+			results[index] = std::move( result );
+			done[index] = true;
+		}
+		done_cond.notify_one();
+	};
+
+	const auto worker = [&]() {
+		while ( true ) {
+			const std::size_t index = next_file++;
+			if ( index >= num_files ) {
+				return;
+			}
+			render_job( index );
+		}
+	};
+
+	const auto start = std::chrono::steady_clock::now();
+
+	std::vector<std::thread> threads;
+	try {
+		for ( std::size_t job = 0; job < num_jobs; ++job ) {
+			threads.emplace_back( worker );
+		}
+	} catch ( std::system_error & ) {
+		// continue with fewer jobs
+	}
+	if ( threads.empty() ) {
+		worker();
+	}
+
+	for ( std::size_t index = 0; index < num_files; ++index ) {
+		std::string text;
+		{
+			std::unique_lock<std::mutex> lock( done_mutex );
+			done_cond.wait( lock, [&]() { return static_cast<bool>( done[index] ); } );
+			text = std::move( results[index].log );
+		}
+		log << text;
+		log.writeout();
+	}
+
+	for ( auto & thread : threads ) {
+		thread.join();
+	}
+
+	const double wall_seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+	double total_audio_seconds = 0.0;
+	std::size_t failed = 0;
+	log << "Rendered " << num_files << " files using " << std::max( threads.size(), static_cast<std::size_t>( 1 ) ) << " jobs:" << std::endl;
+	for ( std::size_t index = 0; index < num_files; ++index ) {
+		const render_job_result & result = results[index];
+		const double audio_seconds = static_cast<double>( result.frames ) / static_cast<double>( flags.samplerate );
+		total_audio_seconds += audio_seconds;
+		log << " " << get_filename( flags.filenames[index] ) << ": ";
+		if ( result.success ) {
+			log << seconds_to_string( audio_seconds ) << " in " << seconds_to_string( result.seconds ) << " (" << realtime_factor_to_string( audio_seconds, result.seconds ) << " realtime)";
+		} else {
+			log << "failed";
+			failed++;
+		}
+		log << std::endl;
+	}
+	log << "Total: " << seconds_to_string( total_audio_seconds ) << " in " << seconds_to_string( wall_seconds ) << " (" << realtime_factor_to_string( total_audio_seconds, wall_seconds ) << " realtime)";
+	if ( failed > 0 ) {
+		log << ", " << failed << " failed";
+	}
+	log << std::endl;
+	log << std::endl;
+
+	log.writeout();
+
+}
+
+#endif // OPENMPT123_WITH_THREADS
+
+
 static bool parse_playlist( commandlineflags & flags, std::string filename, std::ostream & log ) {
 	log.flush();
 	bool is_playlist = false;
@@ -2139,6 +2345,10 @@ static commandlineflags parse_openmpt123( const std::vector<std::string> & args,
 				++i;
 			} else if ( arg == "--force" ) {
 				flags.force_overwrite = true;
+			} else if ( arg == "--jobs" && nextarg != "" ) {
+				std::istringstream istr( nextarg );
+				istr >> flags.jobs;
+				++i;
 			} else if ( arg == "--output-type" && nextarg != "" ) {
 				flags.output_extension = nextarg;
 				++i;
@@ -2483,6 +2693,16 @@ static int main( int argc, char * argv [] ) {
 				}
 			} break;
 			case ModeRender: {
+#if defined(OPENMPT123_WITH_THREADS)
+				if ( flags.jobs == 0 ) {
+					flags.jobs = std::max( static_cast<std::int32_t>( std::thread::hardware_concurrency() ), static_cast<std::int32_t>( 1 ) );
+				}
+				if ( flags.jobs > 1 && flags.filenames.size() > 1 ) {
+					flags.apply_default_buffer_sizes();
+					render_files_parallel( flags, log );
+					break;
+				}
+#endif
 				for ( const auto & filename : flags.filenames ) {
 					flags.apply_default_buffer_sizes();
 					file_audio_stream_raii file_audio_stream( flags, filename + std::string(".") + flags.output_extension, log );
@@ -150,6 +150,26 @@ public:
 	}
 };
 
+class textout_buffer : public textout {
+private:
+	std::string buf;
+public:
+	textout_buffer() {
+		return;
+	}
+	virtual ~textout_buffer() {
+		return;
+	}
+public:
+	void write( const std::string & text ) override {
+		buf += text;
+	}
+	std::string get() {
+		writeout();
+		return buf;
+	}
+};
+
 class textout_ostream : public textout {
 private:
 	std::ostream & s;
@@ -302,6 +322,7 @@ struct commandlineflags {
 	std::string output_filename;
 	std::string output_extension;
 	bool force_overwrite;
+	std::int32_t jobs;
 	bool paused;
 	std::string warnings;
 	void apply_default_buffer_sizes() {
@@ -417,6 +438,7 @@ struct commandlineflags {
 		playlist_index = 0;
 		output_extension = "auto";
 		force_overwrite = false;
+		jobs = 1;
 		paused = false;
 	}
 	void check_and_sanitize() {
@@ -511,6 +533,12 @@ struct commandlineflags {
 		if ( output_extension.empty() ) {
 			output_extension = "wav";
 		}
+		if ( jobs < 0 ) {
+			jobs = commandlineflags().jobs;
+		}
+		if ( mode != ModeRender && jobs != 1 ) {
+			throw args_error_exception();
+		}
 	}
 };
 
@@ -15,6 +15,7 @@
 
 #include "../common/Endianness.h"
 #include "SampleFormatConverters.h"
+#include "SampleFormatCopySIMD.h"
 
 
 OPENMPT_NAMESPACE_BEGIN
@@ -78,12 +79,49 @@ void CopyInterleavedSampleStreams(typename SampleConversion::output_t * MPT_REST
 
 
 
+// Vectorized conversion of the beginning of a fixed point buffer, for output sample formats that have a block converter.
+// Returns the number of samples (Interleaved) or frames (Stereo) that have been converted.
+template<int fractionalBits, bool clipOutput, typename Tsample>
+struct ConvertFixedPointBlock
+{
+	static MPT_FORCEINLINE std::size_t Interleaved(Tsample *, const int32 *, std::size_t) { return 0; }
+	static MPT_FORCEINLINE std::size_t Stereo(Tsample *, Tsample *, const int32 *, std::size_t) { return 0; }
+};
+
+template<int fractionalBits, bool clipOutput>
+struct ConvertFixedPointBlock<fractionalBits, clipOutput, int16>
+{
+	static const int shiftBits = SC::ConvertFixedPoint<int16, int32, fractionalBits, clipOutput>::shiftBits;
+	static MPT_FORCEINLINE std::size_t Interleaved(int16 *p, const int32 *mixbuffer, std::size_t count)
+	{
+		return SC::ConvertFixedPointToInt16Block(p, mixbuffer, count, shiftBits);
+	}
+	static MPT_FORCEINLINE std::size_t Stereo(int16 *left, int16 *right, const int32 *mixbuffer, std::size_t count)
+	{
+		return SC::ConvertFixedPointToInt16StereoBlock(left, right, mixbuffer, count, shiftBits);
+	}
+};
+
+template<int fractionalBits, bool clipOutput>
+struct ConvertFixedPointBlock<fractionalBits, clipOutput, float32>
+{
+	static MPT_FORCEINLINE std::size_t Interleaved(float32 *p, const int32 *mixbuffer, std::size_t count)
+	{
+		return SC::ConvertFixedPointToFloat32Block(p, mixbuffer, count, 1.0f / static_cast<float>(1 << fractionalBits), clipOutput);
+	}
+	static MPT_FORCEINLINE std::size_t Stereo(float32 *left, float32 *right, const int32 *mixbuffer, std::size_t count)
+	{
+		return SC::ConvertFixedPointToFloat32StereoBlock(left, right, mixbuffer, count, 1.0f / static_cast<float>(1 << fractionalBits), clipOutput);
+	}
+};
+
+
 template<int fractionalBits, bool clipOutput, typename Tsample, typename Tfixed>
 void ConvertInterleavedFixedPointToInterleaved(Tsample * MPT_RESTRICT p, const Tfixed * MPT_RESTRICT mixbuffer, std::size_t channels, std::size_t count)
 {
 	SC::ConvertFixedPoint<Tsample, int32, fractionalBits, clipOutput> conv;
 	count *= channels;
-	for(std::size_t i = 0; i < count; ++i)
+	for(std::size_t i = ConvertFixedPointBlock<fractionalBits, clipOutput, Tsample>::Interleaved(p, mixbuffer, count); i < count; ++i)
 	{
 		p[i] = conv(mixbuffer[i]);
 	}
@@ -93,7 +131,13 @@ template<int fractionalBits, bool clipOutput, typename Tsample, typename Tfixed>
 void ConvertInterleavedFixedPointToNonInterleaved(Tsample * const * const MPT_RESTRICT buffers, const Tfixed * MPT_RESTRICT mixbuffer, std::size_t channels, std::size_t count)
 {
 	SC::ConvertFixedPoint<Tsample, int32, fractionalBits, clipOutput> conv;
-	for(std::size_t i = 0; i < count; ++i)
+	std::size_t i = 0;
+	if(channels == 2)
+	{
+		i = ConvertFixedPointBlock<fractionalBits, clipOutput, Tsample>::Stereo(buffers[0], buffers[1], mixbuffer, count);
+		mixbuffer += i * 2;
+	}
+	for(; i < count; ++i)
 	{
 		for(std::size_t channel = 0; channel < channels; ++channel)
 		{
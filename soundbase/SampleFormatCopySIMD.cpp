@@ -0,0 +1,346 @@
+/*
+ * SampleFormatCopySIMD.cpp
+ * ------------------------
+ * Purpose: Vectorized block versions of frequently used sample conversions.
+ * Notes  : This file contains performance-critical loops with variants
+ *          optimized for various instruction sets.
+ *          Integer arithmetic wraps around and rounds exactly like the scalar functors in SampleFormatConverters.h,
+ *          int32 to float conversion uses the same rounding mode, and the factors applied are powers of two,
+ *          so all variants produce bit-identical results.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+#include "SampleFormatCopySIMD.h"
+#ifdef ENABLE_SSE2_INTRINSICS
+#include <emmintrin.h>
+#endif
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+namespace SC { // SC = _S_ample_C_onversion
+
+
+///////////////////////////////////////////////////////////////////////////////////////
+// SSE2 Optimizations
+
+#ifdef ENABLE_SSE2_INTRINSICS
+
+static MPT_FORCEINLINE __m128i SSE2_RoundShift(__m128i val, __m128i round, __m128i shift)
+{
+	return _mm_sra_epi32(_mm_add_epi32(val, round), shift);
+}
+
+
+static MPT_FORCEINLINE __m128 SSE2_ToFloat(__m128i val, __m128 factor, bool clip, __m128 clipMin, __m128 clipMax)
+{
+	__m128 f = _mm_mul_ps(_mm_cvtepi32_ps(val), factor);
+	if(clip)
+	{
+		f = _mm_min_ps(_mm_max_ps(f, clipMin), clipMax);
+	}
+	return f;
+}
+
+
+static std::size_t SSE2_ConvertFixedPointToInt16(int16 *dst, const int32 *src, std::size_t count, int shiftBits)
+{
+	const __m128i round = _mm_set1_epi32(1 << (shiftBits - 1));
+	const __m128i shift = _mm_cvtsi32_si128(shiftBits);
+	const std::size_t countVector = count & ~std::size_t(7);
+	for(std::size_t i = 0; i < countVector; i += 8)
+	{
+		__m128i a = SSE2_RoundShift(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)), round, shift);
+		__m128i b = SSE2_RoundShift(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 4)), round, shift);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packs_epi32(a, b));	// Saturate to int16
+	}
+	return countVector;
+}
+
+
+static std::size_t SSE2_ConvertFixedPointToInt16Stereo(int16 *dstL, int16 *dstR, const int32 *src, std::size_t countFrames, int shiftBits)
+{
+	const __m128i round = _mm_set1_epi32(1 << (shiftBits - 1));
+	const __m128i shift = _mm_cvtsi32_si128(shiftBits);
+	const std::size_t countVector = countFrames & ~std::size_t(7);
+	for(std::size_t i = 0; i < countVector; i += 8)
+	{
+		const __m128i *in = reinterpret_cast<const __m128i *>(src + i * 2);
+		__m128 i1 = _mm_castsi128_ps(_mm_loadu_si128(in + 0));	// LRLR
+		__m128 i2 = _mm_castsi128_ps(_mm_loadu_si128(in + 1));	// LRLR
+		__m128 i3 = _mm_castsi128_ps(_mm_loadu_si128(in + 2));	// LRLR
+		__m128 i4 = _mm_castsi128_ps(_mm_loadu_si128(in + 3));	// LRLR
+		__m128i l1 = SSE2_RoundShift(_mm_castps_si128(_mm_shuffle_ps(i1, i2, _MM_SHUFFLE(2, 0, 2, 0))), round, shift);	// LLLL
+		__m128i r1 = SSE2_RoundShift(_mm_castps_si128(_mm_shuffle_ps(i1, i2, _MM_SHUFFLE(3, 1, 3, 1))), round, shift);	// RRRR
+		__m128i l2 = SSE2_RoundShift(_mm_castps_si128(_mm_shuffle_ps(i3, i4, _MM_SHUFFLE(2, 0, 2, 0))), round, shift);	// LLLL
+		__m128i r2 = SSE2_RoundShift(_mm_castps_si128(_mm_shuffle_ps(i3, i4, _MM_SHUFFLE(3, 1, 3, 1))), round, shift);	// RRRR
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dstL + i), _mm_packs_epi32(l1, l2));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dstR + i), _mm_packs_epi32(r1, r2));
+	}
+	return countVector;
+}
+
+
+static std::size_t SSE2_ConvertFixedPointToFloat32(float32 *dst, const int32 *src, std::size_t count, float32 factor, bool clip)
+{
+	const __m128 f = _mm_set1_ps(factor);
+	const __m128 clipMin = _mm_set1_ps(-1.0f);
+	const __m128 clipMax = _mm_set1_ps(1.0f);
+	const std::size_t countVector = count & ~std::size_t(7);
+	for(std::size_t i = 0; i < countVector; i += 8)
+	{
+		__m128 a = SSE2_ToFloat(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)), f, clip, clipMin, clipMax);
+		__m128 b = SSE2_ToFloat(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 4)), f, clip, clipMin, clipMax);
+		_mm_storeu_ps(dst + i, a);
+		_mm_storeu_ps(dst + i + 4, b);
+	}
+	return countVector;
+}
+
+
+static std::size_t SSE2_ConvertFixedPointToFloat32Stereo(float32 *dstL, float32 *dstR, const int32 *src, std::size_t countFrames, float32 factor, bool clip)
+{
+	const __m128 f = _mm_set1_ps(factor);
+	const __m128 clipMin = _mm_set1_ps(-1.0f);
+	const __m128 clipMax = _mm_set1_ps(1.0f);
+	const std::size_t countVector = countFrames & ~std::size_t(3);
+	for(std::size_t i = 0; i < countVector; i += 4)
+	{
+		const __m128i *in = reinterpret_cast<const __m128i *>(src + i * 2);
+		__m128 f1 = SSE2_ToFloat(_mm_loadu_si128(in + 0), f, clip, clipMin, clipMax);	// LRLR
+		__m128 f2 = SSE2_ToFloat(_mm_loadu_si128(in + 1), f, clip, clipMin, clipMax);	// LRLR
+		_mm_storeu_ps(dstL + i, _mm_shuffle_ps(f1, f2, _MM_SHUFFLE(2, 0, 2, 0)));	// LRLR+LRLR => LLLL
+		_mm_storeu_ps(dstR + i, _mm_shuffle_ps(f1, f2, _MM_SHUFFLE(3, 1, 3, 1)));	// LRLR+LRLR => RRRR
+	}
+	return countVector;
+}
+
+
+static std::size_t SSE2_DecodeInt8(int8 *dst, const mpt::byte *src, std::size_t count, uint8 signMask)
+{
+	const __m128i mask = _mm_set1_epi8(static_cast<char>(signMask));
+	const std::size_t countVector = count & ~std::size_t(15);
+	for(std::size_t i = 0; i < countVector; i += 16)
+	{
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_xor_si128(v, mask));
+	}
+	return countVector;
+}
+
+
+static std::size_t SSE2_DecodeInt8Delta(int8 *dst, const mpt::byte *src, std::size_t count, uint8 &delta)
+{
+	__m128i carry = _mm_set1_epi8(static_cast<char>(delta));
+	const std::size_t countVector = count & ~std::size_t(15);
+	for(std::size_t i = 0; i < countVector; i += 16)
+	{
+		// Prefix sum of 16 bytes in four steps
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+		v = _mm_add_epi8(v, _mm_slli_si128(v, 1));
+		v = _mm_add_epi8(v, _mm_slli_si128(v, 2));
+		v = _mm_add_epi8(v, _mm_slli_si128(v, 4));
+		v = _mm_add_epi8(v, _mm_slli_si128(v, 8));
+		v = _mm_add_epi8(v, carry);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), v);
+		// Broadcast the last byte
+		carry = _mm_unpackhi_epi8(v, v);
+		carry = _mm_shufflehi_epi16(carry, _MM_SHUFFLE(3, 3, 3, 3));
+		carry = _mm_unpackhi_epi64(carry, carry);
+	}
+	delta = static_cast<uint8>(_mm_cvtsi128_si32(carry));
+	return countVector;
+}
+
+
+static MPT_FORCEINLINE __m128i SSE2_LoadInt16(const mpt::byte *src, bool swapBytes)
+{
+	__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+	if(swapBytes)
+	{
+		v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+	}
+	return v;
+}
+
+
+static std::size_t SSE2_DecodeInt16(int16 *dst, const mpt::byte *src, std::size_t count, bool swapBytes, uint16 signMask)
+{
+	const __m128i mask = _mm_set1_epi16(static_cast<int16>(signMask));
+	const std::size_t countVector = count & ~std::size_t(7);
+	for(std::size_t i = 0; i < countVector; i += 8)
+	{
+		__m128i v = SSE2_LoadInt16(src + i * 2, swapBytes);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_xor_si128(v, mask));
+	}
+	return countVector;
+}
+
+
+static std::size_t SSE2_DecodeInt16Delta(int16 *dst, const mpt::byte *src, std::size_t count, bool swapBytes, uint16 &delta)
+{
+	__m128i carry = _mm_set1_epi16(static_cast<int16>(delta));
+	const std::size_t countVector = count & ~std::size_t(7);
+	for(std::size_t i = 0; i < countVector; i += 8)
+	{
+		// Prefix sum of 8 words in three steps
+		__m128i v = SSE2_LoadInt16(src + i * 2, swapBytes);
+		v = _mm_add_epi16(v, _mm_slli_si128(v, 2));
+		v = _mm_add_epi16(v, _mm_slli_si128(v, 4));
+		v = _mm_add_epi16(v, _mm_slli_si128(v, 8));
+		v = _mm_add_epi16(v, carry);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), v);
+		// Broadcast the last word
+		carry = _mm_shufflehi_epi16(v, _MM_SHUFFLE(3, 3, 3, 3));
+		carry = _mm_unpackhi_epi64(carry, carry);
+	}
+	delta = static_cast<uint16>(_mm_cvtsi128_si32(carry));
+	return countVector;
+}
+
+#endif // ENABLE_SSE2_INTRINSICS
+
+
+
+std::size_t ConvertFixedPointToInt16Block(int16 * MPT_RESTRICT dst, const int32 * MPT_RESTRICT src, std::size_t count, int shiftBits)
+{
+	#ifdef ENABLE_SSE2_INTRINSICS
+	if(CanUseSSE2())
+	{
+		return SSE2_ConvertFixedPointToInt16(dst, src, count, shiftBits);
+	}
+	#endif // ENABLE_SSE2_INTRINSICS
+	MPT_UNREFERENCED_PARAMETER(dst);
+	MPT_UNREFERENCED_PARAMETER(src);
+	MPT_UNREFERENCED_PARAMETER(count);
+	MPT_UNREFERENCED_PARAMETER(shiftBits);
+	return 0;
+}
+
+
+std::size_t ConvertFixedPointToInt16StereoBlock(int16 * MPT_RESTRICT dstL, int16 * MPT_RESTRICT dstR, const int32 * MPT_RESTRICT src, std::size_t countFrames, int shiftBits)
+{
+	#ifdef ENABLE_SSE2_INTRINSICS
+	if(CanUseSSE2())
+	{
+		return SSE2_ConvertFixedPointToInt16Stereo(dstL, dstR, src, countFrames, shiftBits);
+	}
+	#endif // ENABLE_SSE2_INTRINSICS
+	MPT_UNREFERENCED_PARAMETER(dstL);
+	MPT_UNREFERENCED_PARAMETER(dstR);
+	MPT_UNREFERENCED_PARAMETER(src);
+	MPT_UNREFERENCED_PARAMETER(countFrames);
+	MPT_UNREFERENCED_PARAMETER(shiftBits);
+	return 0;
+}
+
+
+std::size_t ConvertFixedPointToFloat32Block(float32 * MPT_RESTRICT dst, const int32 * MPT_RESTRICT src, std::size_t count, float32 factor, bool clip)
+{
+	#ifdef ENABLE_SSE2_INTRINSICS
+	if(CanUseSSE2())
+	{
+		return SSE2_ConvertFixedPointToFloat32(dst, src, count, factor, clip);
+	}
+	#endif // ENABLE_SSE2_INTRINSICS
+	MPT_UNREFERENCED_PARAMETER(dst);
+	MPT_UNREFERENCED_PARAMETER(src);
+	MPT_UNREFERENCED_PARAMETER(count);
+	MPT_UNREFERENCED_PARAMETER(factor);
+	MPT_UNREFERENCED_PARAMETER(clip);
+	return 0;
+}
+
+
+std::size_t ConvertFixedPointToFloat32StereoBlock(float32 * MPT_RESTRICT dstL, float32 * MPT_RESTRICT dstR, const int32 * MPT_RESTRICT src, std::size_t countFrames, float32 factor, bool clip)
+{
+	#ifdef ENABLE_SSE2_INTRINSICS
+	if(CanUseSSE2())
+	{
+		return SSE2_ConvertFixedPointToFloat32Stereo(dstL, dstR, src, countFrames, factor, clip);
+	}
+	#endif // ENABLE_SSE2_INTRINSICS
+	MPT_UNREFERENCED_PARAMETER(dstL);
+	MPT_UNREFERENCED_PARAMETER(dstR);
+	MPT_UNREFERENCED_PARAMETER(src);
+	MPT_UNREFERENCED_PARAMETER(countFrames);
+	MPT_UNREFERENCED_PARAMETER(factor);
+	MPT_UNREFERENCED_PARAMETER(clip);
+	return 0;
+}
+
+
+std::size_t DecodeInt8Block(int8 * MPT_RESTRICT dst, const mpt::byte * MPT_RESTRICT src, std::size_t count, uint8 signMask)
+{
+	#ifdef ENABLE_SSE2_INTRINSICS
+	if(CanUseSSE2())
+	{
+		return SSE2_DecodeInt8(dst, src, count, signMask);
+	}
+	#endif // ENABLE_SSE2_INTRINSICS
+	MPT_UNREFERENCED_PARAMETER(dst);
+	MPT_UNREFERENCED_PARAMETER(src);
+	MPT_UNREFERENCED_PARAMETER(count);
+	MPT_UNREFERENCED_PARAMETER(signMask);
+	return 0;
+}
+
+
+std::size_t DecodeInt8DeltaBlock(int8 * MPT_RESTRICT dst, const mpt::byte * MPT_RESTRICT src, std::size_t count, uint8 &delta)
+{
+	#ifdef ENABLE_SSE2_INTRINSICS
+	if(CanUseSSE2())
+	{
+		return SSE2_DecodeInt8Delta(dst, src, count, delta);
+	}
+	#endif // ENABLE_SSE2_INTRINSICS
+	MPT_UNREFERENCED_PARAMETER(dst);
+	MPT_UNREFERENCED_PARAMETER(src);
+	MPT_UNREFERENCED_PARAMETER(count);
+	MPT_UNREFERENCED_PARAMETER(delta);
+	return 0;
+}
+
+
+std::size_t DecodeInt16Block(int16 * MPT_RESTRICT dst, const mpt::byte * MPT_RESTRICT src, std::size_t count, bool swapBytes, uint16 signMask)
+{
+	#ifdef ENABLE_SSE2_INTRINSICS
+	if(CanUseSSE2())
+	{
+		return SSE2_DecodeInt16(dst, src, count, swapBytes, signMask);
+	}
+	#endif // ENABLE_SSE2_INTRINSICS
+	MPT_UNREFERENCED_PARAMETER(dst);
+	MPT_UNREFERENCED_PARAMETER(src);
+	MPT_UNREFERENCED_PARAMETER(count);
+	MPT_UNREFERENCED_PARAMETER(swapBytes);
+	MPT_UNREFERENCED_PARAMETER(signMask);
+	return 0;
+}
+
+
+std::size_t DecodeInt16DeltaBlock(int16 * MPT_RESTRICT dst, const mpt::byte * MPT_RESTRICT src, std::size_t count, bool swapBytes, uint16 &delta)
+{
+	#ifdef ENABLE_SSE2_INTRINSICS
+	if(CanUseSSE2())
+	{
+		return SSE2_DecodeInt16Delta(dst, src, count, swapBytes, delta);
+	}
+	#endif // ENABLE_SSE2_INTRINSICS
+	MPT_UNREFERENCED_PARAMETER(dst);
+	MPT_UNREFERENCED_PARAMETER(src);
+	MPT_UNREFERENCED_PARAMETER(count);
+	MPT_UNREFERENCED_PARAMETER(swapBytes);
+	MPT_UNREFERENCED_PARAMETER(delta);
+	return 0;
+}
+
+
+} // namespace SC
+
+
+OPENMPT_NAMESPACE_END
@@ -0,0 +1,44 @@
+/*
+ * SampleFormatCopySIMD.h
+ * ----------------------
+ * Purpose: Vectorized block versions of frequently used sample conversions.
+ * Notes  : Every function converts as many samples as it can handle with the instruction sets that are available
+ *          and returns that number. This may be less than the requested amount of samples (or even 0 if no suitable
+ *          instruction set is available), so the caller has to convert the remaining samples using the scalar
+ *          functors from SampleFormatConverters.h. The results are bit-identical to those of the scalar functors.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+#include "BuildSettings.h"
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+namespace SC { // SC = _S_ample_C_onversion
+
+
+// Fixed point mix buffer to output sample format (see ConvertFixedPoint).
+// The Stereo variants additionally split an interleaved stereo buffer into two separate channel buffers.
+std::size_t ConvertFixedPointToInt16Block(int16 * MPT_RESTRICT dst, const int32 * MPT_RESTRICT src, std::size_t count, int shiftBits);
+std::size_t ConvertFixedPointToInt16StereoBlock(int16 * MPT_RESTRICT dstL, int16 * MPT_RESTRICT dstR, const int32 * MPT_RESTRICT src, std::size_t countFrames, int shiftBits);
+std::size_t ConvertFixedPointToFloat32Block(float32 * MPT_RESTRICT dst, const int32 * MPT_RESTRICT src, std::size_t count, float32 factor, bool clip);
+std::size_t ConvertFixedPointToFloat32StereoBlock(float32 * MPT_RESTRICT dstL, float32 * MPT_RESTRICT dstR, const int32 * MPT_RESTRICT src, std::size_t countFrames, float32 factor, bool clip);
+
+// Raw sample data to internal sample format (see DecodeUint8, DecodeInt8Delta, DecodeInt16 and DecodeInt16Delta).
+// Samples are XORed with signMask after their bytes have optionally been swapped, i.e. signMask is 0x80 / 0x8000 for unsigned samples.
+// The delta decoders update delta the same way as the scalar functors do.
+std::size_t DecodeInt8Block(int8 * MPT_RESTRICT dst, const mpt::byte * MPT_RESTRICT src, std::size_t count, uint8 signMask);
+std::size_t DecodeInt8DeltaBlock(int8 * MPT_RESTRICT dst, const mpt::byte * MPT_RESTRICT src, std::size_t count, uint8 &delta);
+std::size_t DecodeInt16Block(int16 * MPT_RESTRICT dst, const mpt::byte * MPT_RESTRICT src, std::size_t count, bool swapBytes, uint16 signMask);
+std::size_t DecodeInt16DeltaBlock(int16 * MPT_RESTRICT dst, const mpt::byte * MPT_RESTRICT src, std::size_t count, bool swapBytes, uint16 &delta);
+
+
+} // namespace SC
+
+
+OPENMPT_NAMESPACE_END
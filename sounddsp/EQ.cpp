@@ -449,16 +449,24 @@ void CQuadEQ::SetEQGains(const UINT *pGains, UINT nGains, const UINT *pFreqs, bo
 
 void CQuadEQ::Process(int *frontBuffer, int *rearBuffer, UINT nCount, UINT nChannels)
 {
-	if(nChannels == 1)
+	// The temporary buffer only holds MIXBUFFERSIZE frames
+	while(nCount > 0)
 	{
-		front.ProcessMono(frontBuffer, EQTempFloatBuffer, nCount);
-	} else if(nChannels == 2)
-	{
-		front.ProcessStereo(frontBuffer, EQTempFloatBuffer, nCount);
-	} else if(nChannels == 4)
-	{
-		front.ProcessStereo(frontBuffer, EQTempFloatBuffer, nCount);
-		rear.ProcessStereo(rearBuffer, EQTempFloatBuffer, nCount);
+		const UINT count = std::min(nCount, static_cast<UINT>(MIXBUFFERSIZE));
+		if(nChannels == 1)
+		{
+			front.ProcessMono(frontBuffer, EQTempFloatBuffer, count);
+		} else if(nChannels == 2)
+		{
+			front.ProcessStereo(frontBuffer, EQTempFloatBuffer, count);
+		} else if(nChannels == 4)
+		{
+			front.ProcessStereo(frontBuffer, EQTempFloatBuffer, count);
+			rear.ProcessStereo(rearBuffer, EQTempFloatBuffer, count);
+		}
+		frontBuffer += count * std::min(nChannels, 2u);
+		rearBuffer += count * 2;
+		nCount -= count;
 	}
 }
 
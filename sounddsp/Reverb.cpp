@@ -58,9 +58,6 @@ static MPT_FORCEINLINE void Store64SSE(LR16 *dst, __m128i src) { return _mm_stor
 
 CReverb::CReverb()
 {
-	// Shared reverb state
-	InitMixBuffer(MixReverbBuffer, static_cast<uint32>(mpt::size(MixReverbBuffer)));
-
 	// Reverb mix buffers
 	MemsetZero(g_RefDelay);
 	MemsetZero(g_LateReverb);
@@ -410,15 +407,37 @@ mixsample_t *CReverb::GetReverbSendBuffer(uint32 nSamples)
 {
 	if(!gnReverbSend)
 	{ // and we did not clear the buffer yet, do it now because we will get new data
-		StereoFill(MixReverbBuffer, nSamples, gnRvbROfsVol, gnRvbLOfsVol);
+		StereoFill(MixReverbBuffer.data(), nSamples, gnRvbROfsVol, gnRvbLOfsVol);
 	}
 	gnReverbSend = 1; // we will have to process reverb
-	return MixReverbBuffer;
+	return MixReverbBuffer.data();
+}
+
+
+void CReverb::SetBlockSize(uint32 nSamples)
+{
+	MixReverbBuffer.destructive_resize(nSamples * 2);
 }
 
 
 // Reverb
 void CReverb::Process(mixsample_t *MixSoundBuffer, uint32 nSamples)
+{
+	// The delay lines only allow for processing MIXBUFFERSIZE samples at once
+	mixsample_t *pReverb = MixReverbBuffer.data();
+	while(nSamples > 0)
+	{
+		const uint32 n = std::min(nSamples, static_cast<uint32>(MIXBUFFERSIZE));
+		ProcessBlock(MixSoundBuffer, pReverb, n);
+		MixSoundBuffer += n * 2;
+		pReverb += n * 2;
+		nSamples -= n;
+	}
+	gnReverbSend = 0; // no input data in MixReverbBuffer
+}
+
+
+void CReverb::ProcessBlock(mixsample_t *MixSoundBuffer, mixsample_t *pReverb, uint32 nSamples)
 {
 	if((!gnReverbSend) && (!gnReverbSamples))
 	{ // no data is sent to reverb and reverb decayed completely
@@ -426,7 +445,7 @@ void CReverb::Process(mixsample_t *MixSoundBuffer, uint32 nSamples)
 	}
 	if(!gnReverbSend)
 	{ // no input data in MixReverbBuffer, so the buffer got not cleared in GetReverbSendBuffer(), do it now for decay
-		StereoFill(MixReverbBuffer, nSamples, gnRvbROfsVol, gnRvbLOfsVol);
+		StereoFill(pReverb, nSamples, gnRvbROfsVol, gnRvbLOfsVol);
 	}
 
 	uint32 nIn, nOut;
@@ -449,15 +468,15 @@ void CReverb::Process(mixsample_t *MixSoundBuffer, uint32 nSamples)
 	if (lDryVol < 8) lDryVol = 8;
 	if (lDryVol > 16) lDryVol = 16;
 	lDryVol = 16 - (((16-lDryVol) * lMaxRvbGain) >> 15);
-	ReverbDryMix(MixSoundBuffer, MixReverbBuffer, lDryVol, nSamples);
+	ReverbDryMix(MixSoundBuffer, pReverb, lDryVol, nSamples);
 	// Downsample 2x + 1st stage of lowpass filter
-	nIn = ReverbProcessPreFiltering1x(MixReverbBuffer, nSamples);
+	nIn = ReverbProcessPreFiltering1x(pReverb, nSamples);
 	nOut = nIn;
 	// Main reverb processing: split into small chunks (needed for short reverb delays)
 	// Reverb Input + Low-Pass stage #2 + Pre-diffusion
-	if (nIn > 0) ProcessPreDelay(&g_RefDelay, MixReverbBuffer, nIn);
+	if (nIn > 0) ProcessPreDelay(&g_RefDelay, pReverb, nIn);
 	// Process Reverb Reflections and Late Reverberation
-	int32 *pRvbOut = MixReverbBuffer;
+	int32 *pRvbOut = pReverb;
 	uint32 nRvbSamples = nOut, nCount = 0;
 	while (nRvbSamples > 0)
 	{
@@ -483,7 +502,7 @@ void CReverb::Process(mixsample_t *MixSoundBuffer, uint32 nSamples)
 	// Adjust nDelayPos, in case nIn != nOut
 	g_RefDelay.nDelayPos = (g_RefDelay.nDelayPos - nOut + nIn) & SNDMIX_REFLECTIONS_DELAY_MASK;
 	// Upsample 2x
-	ReverbProcessPostFiltering1x(MixReverbBuffer, MixSoundBuffer, nSamples);
+	ReverbProcessPostFiltering1x(pReverb, MixSoundBuffer, nSamples);
 	// Automatically shut down if needed
 	if(gnReverbSend) gnReverbSamples = gnReverbDecaySamples; // reset decay counter
 	else if(gnReverbSamples > nSamples) gnReverbSamples -= nSamples; // decay
@@ -492,7 +511,6 @@ void CReverb::Process(mixsample_t *MixSoundBuffer, uint32 nSamples)
 		Shutdown();
 		gnReverbSamples = 0;
 	}
-	gnReverbSend = 0; // no input data in MixReverbBuffer
 }
 
 
@@ -142,7 +142,7 @@ public:
 
 	// Shared reverb state
 private:
-	mixsample_t MixReverbBuffer[MIXBUFFERSIZE * 2];
+	mpt::aligned_buffer<mixsample_t, 16> MixReverbBuffer{MIXBUFFERSIZE * 2};
 public:
 	mixsample_t gnRvbROfsVol = 0, gnRvbLOfsVol = 0;
 
@@ -178,10 +178,14 @@ public:
 	// can be called multiple times or never (if no data is sent to reverb)
 	mixsample_t *GetReverbSendBuffer(uint32 nSamples);
 
+	// Maximum number of samples that are sent to reverb at once
+	void SetBlockSize(uint32 nSamples);
+
 	// call once after all data has been sent.
 	void Process(mixsample_t *MixSoundBuffer, uint32 nSamples);
 
 private:
+	void ProcessBlock(mixsample_t *MixSoundBuffer, mixsample_t *pReverb, uint32 nSamples);
 	void Shutdown();
 	// Pre/Post resampling and filtering
 	uint32 ReverbProcessPreFiltering1x(int32 *pWet, uint32 nSamples);
@@ -234,7 +234,7 @@ void ApplyGainBeforeConversionIfAppropriate(int32 *MixSoundBuffer, std::size_t c
 	ApplyGain(MixSoundBuffer, channels, countChunk, mpt::saturate_round<int32>(gainFactor * (1<<16)));
 }
 template<>
-void ApplyGainBeforeConversionIfAppropriate<float>(int32 * /*MixSoundBuffer*/, std::size_t /*channels*/, std::size_t /*countChunk*/, float /*gainFactor*/)
+inline void ApplyGainBeforeConversionIfAppropriate<float>(int32 * /*MixSoundBuffer*/, std::size_t /*channels*/, std::size_t /*countChunk*/, float /*gainFactor*/)
 {
 	// nothing
 }
@@ -245,7 +245,7 @@ void ApplyGainAfterConversionIfAppropriate(Tsample * /*buffer*/, Tsample * const
 	// nothing
 }
 template<>
-void ApplyGainAfterConversionIfAppropriate<float>(float *buffer, float * const *buffers, std::size_t countRendered, std::size_t channels, std::size_t countChunk, float gainFactor)
+inline void ApplyGainAfterConversionIfAppropriate<float>(float *buffer, float * const *buffers, std::size_t countRendered, std::size_t channels, std::size_t countChunk, float gainFactor)
 {
 	// Apply final output gain for floating point output after conversion so we do not suffer underflow or clipping
 	ApplyGain(buffer, buffers, countRendered, channels, countChunk, gainFactor);
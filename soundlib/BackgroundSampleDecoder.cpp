@@ -0,0 +1,168 @@
+/*
+ * BackgroundSampleDecoder.cpp
+ * ---------------------------
+ * Purpose: Worker thread for decoding samples whose decoding has been postponed while loading.
+ * Notes  : The worker thread only ever writes to its own copies of the samples. The decoded samples are put in place
+ *          by the thread that renders the module (see CSoundFile::FinishBackgroundDecodedSamples), so that sample
+ *          memory is never modified while it is being mixed.
+ *          If a sample is needed before the worker thread got to it, the rendering thread decodes it on its own
+ *          instead of waiting for all the samples in front of it in the queue.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+#include "BackgroundSampleDecoder.h"
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+#if defined(MPT_ENABLE_THREAD)
+
+BackgroundSampleDecoder::Job::Job(SAMPLEINDEX smp, const ModSample &sample, const PendingSampleDecoder &decoder)
+	: decoder(decoder)
+	, sample(sample)
+	, smp(smp)
+{
+	this->sample.pData.pSample = nullptr;
+}
+
+
+BackgroundSampleDecoder::BackgroundSampleDecoder(std::vector<Job> &&jobs)
+	: m_jobs(std::move(jobs))
+	, m_jobsRemaining(m_jobs.size())
+{
+	try
+	{
+		m_worker = std::thread(&BackgroundSampleDecoder::WorkerThread, this);
+	} catch(const std::system_error &)
+	{
+		// All samples will be decoded on demand
+	}
+}
+
+
+BackgroundSampleDecoder::~BackgroundSampleDecoder()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_shutdown = true;
+	}
+	if(m_worker.joinable())
+	{
+		m_worker.join();
+	}
+	for(auto &job : m_jobs)
+	{
+		job.sample.FreeSample();
+	}
+}
+
+
+bool BackgroundSampleDecoder::Take(SAMPLEINDEX smp, ModSample &sample, std::vector<std::pair<LogLevel, mpt::ustring>> &messages, bool &success)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	Job *job = FindJob(smp);
+	if(job == nullptr || job->state == Job::Taken)
+	{
+		return false;
+	}
+	if(job->state == Job::Queued)
+	{
+		job->state = Job::Taken;
+		m_jobsRemaining--;
+		return false;
+	}
+	m_jobFinished.wait(lock, [job] { return job->state == Job::Finished; });
+	TakeJob(*job, sample, messages, success);
+	return true;
+}
+
+
+bool BackgroundSampleDecoder::TakeFinished(SAMPLEINDEX &smp, ModSample &sample, std::vector<std::pair<LogLevel, mpt::ustring>> &messages, bool &success)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	// Jobs are finished in order, so only the jobs before the next queued job need to be looked at.
+	for(std::size_t i = 0; i < m_nextJob; i++)
+	{
+		if(m_jobs[i].state == Job::Finished)
+		{
+			smp = m_jobs[i].smp;
+			TakeJob(m_jobs[i], sample, messages, success);
+			return true;
+		}
+	}
+	return false;
+}
+
+
+bool BackgroundSampleDecoder::IsDone() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_jobsRemaining == 0;
+}
+
+
+BackgroundSampleDecoder::Job *BackgroundSampleDecoder::FindJob(SAMPLEINDEX smp)
+{
+	for(auto &job : m_jobs)
+	{
+		if(job.smp == smp)
+		{
+			return &job;
+		}
+	}
+	return nullptr;
+}
+
+
+void BackgroundSampleDecoder::TakeJob(Job &job, ModSample &sample, std::vector<std::pair<LogLevel, mpt::ustring>> &messages, bool &success)
+{
+	MPT_ASSERT(job.state == Job::Finished);
+	sample = job.sample;
+	job.sample.pData.pSample = nullptr;
+	messages = std::move(job.messages);
+	success = job.success;
+	job.state = Job::Taken;
+	job.decoder = nullptr;
+	m_jobsRemaining--;
+}
+
+
+void BackgroundSampleDecoder::WorkerThread()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while(!m_shutdown)
+	{
+		while(m_nextJob < m_jobs.size() && m_jobs[m_nextJob].state != Job::Queued)
+		{
+			m_nextJob++;
+		}
+		if(m_nextJob >= m_jobs.size())
+		{
+			return;
+		}
+		// The job is not touched by any other thread until it is finished, and m_jobs is never resized.
+		Job &job = m_jobs[m_nextJob++];
+		job.state = Job::Decoding;
+		lock.unlock();
+		bool success = false;
+		try
+		{
+			success = job.decoder(job.sample, job.messages);
+		} catch(...)
+		{
+			job.sample.FreeSample();
+		}
+		lock.lock();
+		job.success = success;
+		job.state = Job::Finished;
+		m_jobFinished.notify_all();
+	}
+}
+
+#endif // MPT_ENABLE_THREAD
+
+
+OPENMPT_NAMESPACE_END
@@ -0,0 +1,84 @@
+/*
+ * BackgroundSampleDecoder.h
+ * -------------------------
+ * Purpose: Worker thread for decoding samples whose decoding has been postponed while loading.
+ * Notes  : See implementation file.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+#include "BuildSettings.h"
+
+#include "Sndfile.h"
+
+#if defined(MPT_ENABLE_THREAD)
+#include <condition_variable>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+#endif // MPT_ENABLE_THREAD
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+#if defined(MPT_ENABLE_THREAD)
+
+class BackgroundSampleDecoder
+{
+public:
+	struct Job
+	{
+		enum State
+		{
+			Queued,
+			Decoding,
+			Finished,
+			Taken,
+		};
+
+		PendingSampleDecoder decoder;
+		ModSample sample;  // Sample properties without sample memory; receives the decoded sample.
+		std::vector<std::pair<LogLevel, mpt::ustring>> messages;
+		SAMPLEINDEX smp;
+		State state = Queued;
+		bool success = false;
+
+		Job(SAMPLEINDEX smp, const ModSample &sample, const PendingSampleDecoder &decoder);
+	};
+
+	// Jobs are processed in the given order.
+	explicit BackgroundSampleDecoder(std::vector<Job> &&jobs);
+	~BackgroundSampleDecoder();
+
+	// Retrieve the decoded sample, waiting for the worker thread if it is currently decoding it.
+	// If the worker thread has not started decoding the sample yet, it is removed from the queue and false is returned,
+	// in which case the caller has to decode the sample itself. Ownership of the decoded sample memory is transferred to the caller.
+	bool Take(SAMPLEINDEX smp, ModSample &sample, std::vector<std::pair<LogLevel, mpt::ustring>> &messages, bool &success);
+	// Retrieve any sample that has been decoded already without waiting. Returns false if there is none.
+	bool TakeFinished(SAMPLEINDEX &smp, ModSample &sample, std::vector<std::pair<LogLevel, mpt::ustring>> &messages, bool &success);
+	// Returns true if all samples have been retrieved or removed from the queue.
+	bool IsDone() const;
+
+protected:
+	void WorkerThread();
+	Job *FindJob(SAMPLEINDEX smp);
+	void TakeJob(Job &job, ModSample &sample, std::vector<std::pair<LogLevel, mpt::ustring>> &messages, bool &success);
+
+	std::vector<Job> m_jobs;
+	std::thread m_worker;
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_jobFinished;
+	std::size_t m_nextJob = 0;
+	std::size_t m_jobsRemaining;
+	bool m_shutdown = false;
+};
+
+#endif // MPT_ENABLE_THREAD
+
+
+OPENMPT_NAMESPACE_END
@@ -22,7 +22,9 @@
 #include "MixFuncTable.h"
 #include <cfloat>	// For FLT_EPSILON
 #include "plugins/PlugInterface.h"
+#include "MixThreadPool.h"
 #include <algorithm>
+#include <array>
 
 
 OPENMPT_NAMESPACE_BEGIN
@@ -84,17 +86,96 @@ struct MixLoopState
 		return static_cast<uint32>((to - from - SamplePosition(1)) / inc) + 1;
 	}
 
-	// Check how many samples can be rendered without encountering loop or sample end, and also update loop position / direction
-	MPT_FORCEINLINE uint32 GetSampleCount(ModChannel &chn, uint32 nSamples, bool ITPingPongMode) const
+	// For voices that are not being mixed: Skip all iterations of a forward loop that are completed within the next numSamples samples in one step,
+	// instead of calling GetSampleCount several times for every loop iteration. Afterwards, the voice is in exactly the same state as it would be
+	// right before the start of the last loop iteration (i.e. the play position has not been wrapped around yet). Returns the number of skipped samples.
+	static uint32 SkipLoopIterations(ModChannel &chn, uint32 numSamples, bool ITPingPongMode)
 	{
-		int32 nLoopStart = chn.dwFlags[CHN_LOOP] ? chn.nLoopStart : 0;
-		SamplePosition nInc = chn.increment;
+		if(chn.dwFlags[CHN_LOOP] && chn.dwFlags[CHN_PINGPONGLOOP])
+		{
+			return SkipPingPongLoopIterations(chn, numSamples, ITPingPongMode);
+		}
+		const SamplePosition inc = chn.increment;
+		if((chn.dwFlags & (CHN_LOOP | CHN_PINGPONGLOOP)) != CHN_LOOP || chn.nLoopEnd != chn.nLength || chn.nLoopStart >= chn.nLength
+			|| !inc.IsPositive() || inc.GetUInt() >= (1u << 16) || chn.position.IsNegative() || numSamples < 2)
+		{
+			return 0;
+		}
+		const SamplePosition loopEnd(chn.nLength, 0);
+		const SamplePosition loopLength = loopEnd - SamplePosition(chn.nLoopStart, 0);
+		// GetSampleCount only wraps around the play position by one loop length at a time
+		if(inc >= loopLength || chn.position >= loopEnd + loopLength)
+		{
+			return 0;
+		}
 
-		if ((nSamples <= 0) || nInc.IsZero() || (!chn.nLength)) return 0;
+		// Unwrapped position of the last sample that is going to be rendered
+		const SamplePosition lastPos = chn.position + inc * static_cast<int32>(numSamples - 1);
+		if(lastPos < loopEnd)
+		{
+			return 0;
+		}
+		// Unwrapped position where the last loop iteration starts
+		const SamplePosition::value_t numWraps = (lastPos - loopEnd).GetRaw() / loopLength.GetRaw();
+		const SamplePosition lastWrap = loopEnd + loopLength * numWraps;
+		if(chn.position >= lastWrap)
+		{
+			return 0;
+		}
+		const uint32 skipSamples = DistanceToBufferLength(chn.position, lastWrap, inc);
+		chn.position += inc * static_cast<int32>(skipSamples);
+		chn.position -= loopLength * numWraps;
+		return skipSamples;
+	}
 
-		// Part 1: Making sure the play position is valid, and if necessary, invert the play direction in case we reached a loop boundary of a ping-pong loop.
-		chn.pCurrentSample = samplePointer;
+	// Same as SkipLoopIterations, but for ping-pong loops. These cannot be skipped in one step, as the position after turning around at the loop end
+	// depends on how far the loop end was overshot (and on the IT ping-pong mode), so they are skipped one change of direction at a time instead.
+	static uint32 SkipPingPongLoopIterations(ModChannel &chn, uint32 numSamples, bool ITPingPongMode)
+	{
+		if(chn.nLoopEnd != chn.nLength || chn.nLoopStart >= chn.nLength || chn.increment.IsZero() || chn.position.IsNegative())
+		{
+			return 0;
+		}
+		const SamplePosition loopStart(chn.nLoopStart, 0), loopEnd(chn.nLength, 0);
+		uint32 skipSamples = 0;
+		while(skipSamples < numSamples)
+		{
+			// Turn around exactly like GetSampleCount would at the start of the next chunk
+			SamplePosition inc = chn.increment;
+			if(!UpdateLoopPosition(chn, inc, static_cast<int32>(chn.nLoopStart), ITPingPongMode) || chn.position >= loopEnd)
+			{
+				break;
+			}
+			uint32 distance;
+			if(inc.IsNegative())
+			{
+				if(chn.position < loopStart)
+				{
+					break;
+				}
+				// Number of samples until the play position falls below the loop start
+				SamplePosition inv = inc;
+				inv.Negate();
+				distance = DistanceToBufferLength(loopStart - SamplePosition(1), chn.position, inv);
+			} else
+			{
+				distance = DistanceToBufferLength(chn.position, loopEnd, inc);
+			}
+			// Leave the last change of direction to the regular mixing loop
+			if(distance >= numSamples - skipSamples)
+			{
+				break;
+			}
+			chn.position += inc * static_cast<int32>(distance);
+			skipSamples += distance;
+		}
+		return skipSamples;
+	}
 
+	// Part 1 of GetSampleCount (see below), also used for skipping ping-pong loop iterations.
+	// Returns false if the end of the sample has been reached and the voice has to be stopped.
+	static MPT_FORCEINLINE bool UpdateLoopPosition(ModChannel &chn, SamplePosition &nInc, int32 nLoopStart, bool ITPingPongMode)
+	{
 		// Under zero ?
 		if (chn.position.GetInt() < nLoopStart)
 		{
@@ -120,7 +201,7 @@ struct MixLoopState
 				if(!chn.dwFlags[CHN_LOOP] || chn.position.GetUInt() >= chn.nLength)
 				{
 					chn.position.Set(chn.nLength);
-					return 0;
+					return false;
 				}
 			} else
 			{
@@ -130,7 +211,7 @@ struct MixLoopState
 		} else if (chn.position.GetUInt() >= chn.nLength)
 		{
 			// Past the end
-			if(!chn.dwFlags[CHN_LOOP]) return 0; // not looping -> stop this channel
+			if(!chn.dwFlags[CHN_LOOP]) return false; // not looping -> stop this channel
 			if(chn.dwFlags[CHN_PINGPONGLOOP])
 			{
 				// Invert loop
@@ -163,6 +244,21 @@ struct MixLoopState
 				chn.dwFlags.set(CHN_WRAPPED_LOOP);
 			}
 		}
+		return true;
+	}
+
+	// Check how many samples can be rendered without encountering loop or sample end, and also update loop position / direction
+	MPT_FORCEINLINE uint32 GetSampleCount(ModChannel &chn, uint32 nSamples, bool ITPingPongMode) const
+	{
+		int32 nLoopStart = chn.dwFlags[CHN_LOOP] ? chn.nLoopStart : 0;
+		SamplePosition nInc = chn.increment;
+
+		if ((nSamples <= 0) || nInc.IsZero() || (!chn.nLength)) return 0;
+
+		// Part 1: Making sure the play position is valid, and if necessary, invert the play direction in case we reached a loop boundary of a ping-pong loop.
+		chn.pCurrentSample = samplePointer;
+
+		if(!UpdateLoopPosition(chn, nInc, nLoopStart, ITPingPongMode)) return 0;
 
 		// Part 2: Compute how many samples we can render until we reach the end of sample / loop boundary / etc.
 
@@ -271,205 +367,629 @@ struct MixLoopState
 };
 
 
-// Render count * number of channels samples
-void CSoundFile::CreateStereoMix(int count)
+// Check if a channel that is not ramping contributes to the mix. Quiet channels below cullVolume are not considered to be audible,
+// unless their resonant filter might amplify them.
+static MPT_FORCEINLINE bool IsVoiceAudible(const ModChannel &chn, int32 cullVolume)
 {
-	mixsample_t *pOfsL, *pOfsR;
+	if(!(chn.leftVol | chn.rightVol))
+		return false;
+	if(cullVolume == 0 || chn.dwFlags[CHN_FILTER])
+		return true;
+	return std::abs(chn.leftVol) >= cullVolume || std::abs(chn.rightVol) >= cullVolume;
+}
 
-	if (!count) return;
 
-	// Resetting sound buffer
-	StereoFill(MixSoundBuffer, count, gnDryROfsVol, gnDryLOfsVol);
-	if(m_MixerSettings.gnChannels > 2) InitMixBuffer(MixRearBuffer, count*2);
+// Index into the mix function table for the channel's current settings, without ramping
+static uint32 GetMixFunctionIndex(const ModChannel &chn)
+{
+	uint32 functionNdx = MixFuncTable::ResamplingModeToMixFlags(static_cast<ResamplingMode>(chn.resamplingMode));
+	if(chn.dwFlags[CHN_16BIT]) functionNdx |= MixFuncTable::ndx16Bit;
+	if(chn.dwFlags[CHN_STEREO]) functionNdx |= MixFuncTable::ndxStereo;
+#ifndef NO_FILTER
+	if(chn.dwFlags[CHN_FILTER]) functionNdx |= MixFuncTable::ndxFilter;
+#endif
+	return functionNdx;
+}
 
-	CHANNELINDEX nchmixed = 0;
 
-	const bool ITPingPongMode = m_playBehaviour[kITPingPongMode];
+#ifdef MPT_INTMIXER
 
-	for(uint32 nChn = 0; nChn < m_nMixChannels; nChn++)
+// Check if an audible channel can be mixed using MultiVoiceSampleLoop: It must neither be ramping nor filtered, and all count samples
+// must be rendered in one go without reaching any loop or sample boundaries.
+// If this is the case, the channel is ready to be mixed. Otherwise, it can still be mixed through MixChannel.
+static bool PrepareMultiVoiceMix(ModChannel &chn, uint32 count, bool ITPingPongMode, int32 cullVolume)
+{
+	if(chn.nRampLength || !IsVoiceAudible(chn, cullVolume))
+		return false;
+#ifndef NO_FILTER
+	if(chn.dwFlags[CHN_FILTER])
+		return false;
+#endif
+
+	MixLoopState mixLoopState(chn);
+	if(mixLoopState.GetSampleCount(chn, count, ITPingPongMode) == count && chn.pCurrentSample == mixLoopState.samplePointer)
 	{
-		ModChannel &chn = m_PlayState.Chn[m_PlayState.ChnMix[nChn]];
+		// If the loop end is reached, MixChannel has to deal with ProTracker sample swapping and one-shot loops
+		const SamplePosition endPos = chn.position + chn.increment * static_cast<int32>(count);
+		if(!chn.dwFlags[CHN_LOOP] || endPos.GetUInt() < chn.nLoopEnd)
+			return true;
+	}
+	// The play position has been normalized, which MixChannel would have done as well, but the sample pointer may have
+	// been redirected to the loop wrap-around buffer. MixChannel expects the actual sample pointer.
+	chn.pCurrentSample = mixLoopState.samplePointer;
+	return false;
+}
 
-		if(!chn.pCurrentSample) continue;
-		pOfsR = &gnDryROfsVol;
-		pOfsL = &gnDryLOfsVol;
 
-		uint32 functionNdx = MixFuncTable::ResamplingModeToMixFlags(static_cast<ResamplingMode>(chn.resamplingMode));
-		if(chn.dwFlags[CHN_16BIT]) functionNdx |= MixFuncTable::ndx16Bit;
-		if(chn.dwFlags[CHN_STEREO]) functionNdx |= MixFuncTable::ndxStereo;
-#ifndef NO_FILTER
-		if(chn.dwFlags[CHN_FILTER]) functionNdx |= MixFuncTable::ndxFilter;
-#endif
+// Collects voices that use the same mix function and mix target, so that they can be mixed together using MultiVoiceSampleLoop
+class MultiVoiceMixer
+{
+	struct Group
+	{
+		mixsample_t *buffer;
+		uint32 count;
+		uint32 functionNdx;
+		int numVoices;
+		ModChannel *chn[MixFuncTable::numMultiVoices];
+	};
+
+	std::array<Group, 8> m_groups;
+	std::size_t m_numGroups = 0;
+	const MixFuncInterface *m_mixFunctions;
+	const CResampler &m_resampler;
+
+public:
+	MultiVoiceMixer(const MixFuncInterface *mixFunctions, const CResampler &resampler)
+		: m_mixFunctions(mixFunctions)
+		, m_resampler(resampler)
+	{ }
+
+	// Check if there is a multi-voice mix function for the channel's sample format and resampling mode
+	static bool IsSupported(const ModChannel &chn)
+	{
+		return MixFuncTable::MultiVoiceFunctions[MixFuncTable::ToMultiVoiceIndex(GetMixFunctionIndex(chn))] != nullptr;
+	}
 
-		mixsample_t *pbuffer = MixSoundBuffer;
-#ifndef NO_REVERB
-		if(((m_MixerSettings.DSPMask & SNDDSP_REVERB) && !chn.dwFlags[CHN_NOREVERB]) || chn.dwFlags[CHN_REVERB])
+	// Mix all voices that are still waiting for a partner individually
+	void Flush()
+	{
+		for(std::size_t i = 0; i < m_numGroups; i++)
+		{
+			const Group &group = m_groups[i];
+			for(int v = 0; v < group.numVoices; v++)
+			{
+				MixSingleVoice(*group.chn[v], group.functionNdx, group.buffer, group.count);
+			}
+		}
+		m_numGroups = 0;
+	}
+
+	// Add a supported channel that has been prepared using PrepareMultiVoiceMix
+	void Add(ModChannel &chn, mixsample_t *buffer, uint32 count)
+	{
+		const uint32 functionNdx = GetMixFunctionIndex(chn);
+		for(std::size_t i = 0; i < m_numGroups; i++)
+		{
+			Group &group = m_groups[i];
+			if(group.buffer != buffer || group.count != count || group.functionNdx != functionNdx)
+				continue;
+			group.chn[group.numVoices++] = &chn;
+			if(group.numVoices == MixFuncTable::numMultiVoices)
+			{
+				MixFuncTable::MultiVoiceFunctions[MixFuncTable::ToMultiVoiceIndex(functionNdx)](group.chn, m_resampler, buffer, count);
+				group.numVoices = 0;
+			}
+			return;
+		}
+		if(m_numGroups < m_groups.size())
 		{
-			pbuffer = m_Reverb.GetReverbSendBuffer(count);
-			pOfsR = &m_Reverb.gnRvbROfsVol;
-			pOfsL = &m_Reverb.gnRvbLOfsVol;
+			Group &group = m_groups[m_numGroups++];
+			group.buffer = buffer;
+			group.count = count;
+			group.functionNdx = functionNdx;
+			group.chn[0] = &chn;
+			group.numVoices = 1;
+		} else
+		{
+			MixSingleVoice(chn, functionNdx, buffer, count);
 		}
+	}
+
+private:
+	void MixSingleVoice(ModChannel &chn, uint32 functionNdx, mixsample_t *buffer, uint32 count) const
+	{
+		mixsample_t *pbufmax = buffer + count * 2;
+		chn.nROfs = -*(pbufmax - 2);
+		chn.nLOfs = -*(pbufmax - 1);
+		m_mixFunctions[functionNdx](chn, m_resampler, buffer, count);
+		chn.nROfs += *(pbufmax - 2);
+		chn.nLOfs += *(pbufmax - 1);
+	}
+};
+
+#endif // MPT_INTMIXER
+
+
+// Find out where the output of a channel should be mixed to. If necessary, the target buffer is initialized.
+CSoundFile::MixTarget CSoundFile::GetChannelMixTarget(CHANNELINDEX channel, int count)
+{
+	const ModChannel &chn = m_PlayState.Chn[channel];
+	MixTarget target;
+	target.buffer = MixSoundBuffer.data();
+	target.ofsR = &gnDryROfsVol;
+	target.ofsL = &gnDryLOfsVol;
+	target.plugin = 0;
+	target.pluginBuffer = false;
+
+#ifndef NO_REVERB
+	if(((m_MixerSettings.DSPMask & SNDDSP_REVERB) && !chn.dwFlags[CHN_NOREVERB]) || chn.dwFlags[CHN_REVERB])
+	{
+		target.buffer = m_Reverb.GetReverbSendBuffer(count);
+		target.ofsR = &m_Reverb.gnRvbROfsVol;
+		target.ofsL = &m_Reverb.gnRvbLOfsVol;
+	}
 #endif
-		if(chn.dwFlags[CHN_SURROUND] && m_MixerSettings.gnChannels > 2)
-			pbuffer = MixRearBuffer;
+	if(chn.dwFlags[CHN_SURROUND] && m_MixerSettings.gnChannels > 2)
+		target.buffer = MixRearBuffer.data();
 
-		//Look for plugins associated with this implicit tracker channel.
+	//Look for plugins associated with this implicit tracker channel.
 #ifndef NO_PLUGINS
-		PLUGINDEX nMixPlugin = GetBestPlugin(m_PlayState.ChnMix[nChn], PrioritiseInstrument, RespectMutes);
+	// Finding the plugin requires looking at the channel's master channel and instrument, which is wasted effort
+	// (and cache space) for every mixed voice if there are no plugins at all.
+	if(m_pluginGraphValid && m_pluginGraph.empty())
+		return target;
+
+	PLUGINDEX nMixPlugin = GetBestPlugin(channel, PrioritiseInstrument, RespectMutes);
 
-		if ((nMixPlugin > 0) && (nMixPlugin <= MAX_MIXPLUGINS) && m_MixPlugins[nMixPlugin - 1].pMixPlugin != nullptr)
+	if ((nMixPlugin > 0) && (nMixPlugin <= MAX_MIXPLUGINS) && m_MixPlugins[nMixPlugin - 1].pMixPlugin != nullptr)
+	{
+		target.plugin = nMixPlugin;
+		// Render into plugin buffer instead of global buffer
+		SNDMIXPLUGINSTATE &mixState = m_MixPlugins[nMixPlugin - 1].pMixPlugin->m_MixState;
+		if (mixState.pMixBuffer)
 		{
-			// Render into plugin buffer instead of global buffer
-			SNDMIXPLUGINSTATE &mixState = m_MixPlugins[nMixPlugin - 1].pMixPlugin->m_MixState;
-			if (mixState.pMixBuffer)
+			target.buffer = mixState.pMixBuffer;
+			target.ofsR = &mixState.nVolDecayR;
+			target.ofsL = &mixState.nVolDecayL;
+			target.pluginBuffer = true;
+			if (!(mixState.dwFlags & SNDMIXPLUGINSTATE::psfMixReady))
 			{
-				pbuffer = mixState.pMixBuffer;
-				pOfsR = &mixState.nVolDecayR;
-				pOfsL = &mixState.nVolDecayL;
-				if (!(mixState.dwFlags & SNDMIXPLUGINSTATE::psfMixReady))
-				{
-					StereoFill(pbuffer, count, *pOfsR, *pOfsL);
-					mixState.dwFlags |= SNDMIXPLUGINSTATE::psfMixReady;
-				}
+				StereoFill(target.buffer, count, *target.ofsR, *target.ofsL);
+				mixState.dwFlags |= SNDMIXPLUGINSTATE::psfMixReady;
 			}
 		}
+	}
+#else
+	MPT_UNREFERENCED_PARAMETER(count);
 #endif // NO_PLUGINS
+	return target;
+}
+
+
+// Mix count samples of a single channel into pbuffer. Returns true if the channel was audible.
+bool CSoundFile::MixChannel(ModChannel &chn, const MixFuncInterface *mixFunctions, mixsample_t *pbuffer, mixsample_t &ofsR, mixsample_t &ofsL, int count, bool tooManyChannels) const
+{
+	const bool ITPingPongMode = m_playBehaviour[kITPingPongMode];
+
+	const uint32 functionNdx = GetMixFunctionIndex(chn);
 
-		MixLoopState mixLoopState(chn);
+	MixLoopState mixLoopState(chn);
 
-		////////////////////////////////////////////////////
-		CHANNELINDEX naddmix = 0;
-		int nsamples = count;
-		// Keep mixing this sample until the buffer is filled.
-		do
+	////////////////////////////////////////////////////
+	CHANNELINDEX naddmix = 0;
+	int nsamples = count;
+	// Voices that are not going to be mixed do not need to go through every single loop iteration.
+	// ProTracker sample swapping and one-shot loops need to look at every loop iteration, though.
+	// Voices that were still mixed in the previous chunk have to fade out their last output first, see below.
+	if(!chn.nRampLength && !chn.nROfs && !chn.nLOfs && (tooManyChannels || !IsVoiceAudible(chn, m_voiceCullVolume))
+		&& !m_playBehaviour[kMODSampleSwap] && !m_playBehaviour[kMODOneShotLoops])
+	{
+		const uint32 skipSamples = MixLoopState::SkipLoopIterations(chn, nsamples, ITPingPongMode);
+		nsamples -= skipSamples;
+		pbuffer += skipSamples * 2;
+	}
+	// Keep mixing this sample until the buffer is filled.
+	do
+	{
+		uint32 nrampsamples = nsamples;
+		int32 nSmpCount;
+		if(chn.nRampLength > 0)
 		{
-			uint32 nrampsamples = nsamples;
-			int32 nSmpCount;
-			if(chn.nRampLength > 0)
-			{
-				if (nrampsamples > chn.nRampLength) nrampsamples = chn.nRampLength;
-			}
+			if (nrampsamples > chn.nRampLength) nrampsamples = chn.nRampLength;
+		}
 
-			if((nSmpCount = mixLoopState.GetSampleCount(chn, nrampsamples, ITPingPongMode)) <= 0)
-			{
-				// Stopping the channel
-				chn.pCurrentSample = nullptr;
-				chn.nLength = 0;
-				chn.position.Set(0);
-				chn.nRampLength = 0;
-				EndChannelOfs(chn, pbuffer, nsamples);
-				*pOfsR += chn.nROfs;
-				*pOfsL += chn.nLOfs;
-				chn.nROfs = chn.nLOfs = 0;
-				chn.dwFlags.reset(CHN_PINGPONGFLAG);
-				break;
-			}
+		if((nSmpCount = mixLoopState.GetSampleCount(chn, nrampsamples, ITPingPongMode)) <= 0)
+		{
+			// Stopping the channel
+			chn.pCurrentSample = nullptr;
+			chn.nLength = 0;
+			chn.position.Set(0);
+			chn.nRampLength = 0;
+			EndChannelOfs(chn, pbuffer, nsamples);
+			ofsR += chn.nROfs;
+			ofsL += chn.nLOfs;
+			chn.nROfs = chn.nLOfs = 0;
+			chn.dwFlags.reset(CHN_PINGPONGFLAG);
+			break;
+		}
 
-			// Should we mix this channel ?
-			if((nchmixed >= m_MixerSettings.m_nMaxMixChannels)				// Too many channels
-				|| (!chn.nRampLength && !(chn.leftVol | chn.rightVol)))		// Channel is completely silent
+		// Should we mix this channel ?
+		if(tooManyChannels									// Too many channels
+			|| (!chn.nRampLength && !IsVoiceAudible(chn, m_voiceCullVolume)))		// Channel is silent or too quiet to be heard
+		{
+			if(chn.nROfs || chn.nLOfs)
 			{
-				chn.position += chn.increment * nSmpCount;
+				// The voice was mixed until now, and its last output may be well above zero if it is only too quiet to be heard.
+				// Fade it out like when stopping the voice to avoid a click.
+				EndChannelOfs(chn, pbuffer, nsamples);
+				ofsR += chn.nROfs;
+				ofsL += chn.nLOfs;
 				chn.nROfs = chn.nLOfs = 0;
-				pbuffer += nSmpCount * 2;
-				naddmix = 0;
 			}
+			chn.position += chn.increment * nSmpCount;
+			pbuffer += nSmpCount * 2;
+			naddmix = 0;
+		}
 #ifdef MODPLUG_TRACKER
-			else if(m_SamplePlayLengths != nullptr)
+		else if(m_SamplePlayLengths != nullptr)
+		{
+			// Detecting the longest play time for each sample for optimization
+			chn.position += chn.increment * nSmpCount;
+			size_t smp = Samples.index_of(chn.pModSample);
+			if(smp < m_SamplePlayLengths->size())
 			{
-				// Detecting the longest play time for each sample for optimization
-				chn.position += chn.increment * nSmpCount;
-				size_t smp = std::distance<const ModSample *>(Samples, chn.pModSample);
-				if(smp < m_SamplePlayLengths->size())
-				{
-					m_SamplePlayLengths->at(smp) = std::max(m_SamplePlayLengths->at(smp), chn.position.GetUInt());
-				}
+				m_SamplePlayLengths->at(smp) = std::max(m_SamplePlayLengths->at(smp), chn.position.GetUInt());
 			}
+		}
 #endif
-			else
-			{
-				// Do mixing
-				mixsample_t *pbufmax = pbuffer + (nSmpCount * 2);
-				chn.nROfs = -*(pbufmax - 2);
-				chn.nLOfs = -*(pbufmax - 1);
+		else
+		{
+			// Do mixing
+			mixsample_t *pbufmax = pbuffer + (nSmpCount * 2);
+			chn.nROfs = -*(pbufmax - 2);
+			chn.nLOfs = -*(pbufmax - 1);
 
 #ifdef MPT_BUILD_DEBUG
-				SamplePosition targetpos = chn.position + chn.increment * nSmpCount;
+			SamplePosition targetpos = chn.position + chn.increment * nSmpCount;
 #endif
-				MixFuncTable::Functions[functionNdx | (chn.nRampLength ? MixFuncTable::ndxRamp : 0)](chn, m_Resampler, pbuffer, nSmpCount);
+			mixFunctions[functionNdx | (chn.nRampLength ? MixFuncTable::ndxRamp : 0)](chn, m_Resampler, pbuffer, nSmpCount);
 #ifdef MPT_BUILD_DEBUG
-				MPT_ASSERT(chn.position.GetUInt() == targetpos.GetUInt());
+			MPT_ASSERT(chn.position.GetUInt() == targetpos.GetUInt());
 #endif
 
-				chn.nROfs += *(pbufmax - 2);
-				chn.nLOfs += *(pbufmax - 1);
-				pbuffer = pbufmax;
-				naddmix = 1;
-			}
+			chn.nROfs += *(pbufmax - 2);
+			chn.nLOfs += *(pbufmax - 1);
+			pbuffer = pbufmax;
+			naddmix = 1;
+		}
 
-			nsamples -= nSmpCount;
-			if (chn.nRampLength)
+		nsamples -= nSmpCount;
+		if (chn.nRampLength)
+		{
+			if (chn.nRampLength <= static_cast<uint32>(nSmpCount))
 			{
-				if (chn.nRampLength <= static_cast<uint32>(nSmpCount))
-				{
-					// Ramping is done
-					chn.nRampLength = 0;
-					chn.leftVol = chn.newLeftVol;
-					chn.rightVol = chn.newRightVol;
-					chn.rightRamp = chn.leftRamp = 0;
-					if(chn.dwFlags[CHN_NOTEFADE] && !chn.nFadeOutVol)
-					{
-						chn.nLength = 0;
-						chn.pCurrentSample = nullptr;
-					}
-				} else
+				// Ramping is done
+				chn.nRampLength = 0;
+				chn.leftVol = chn.newLeftVol;
+				chn.rightVol = chn.newRightVol;
+				chn.rightRamp = chn.leftRamp = 0;
+				if(chn.dwFlags[CHN_NOTEFADE] && !chn.nFadeOutVol)
 				{
-					chn.nRampLength -= nSmpCount;
+					chn.nLength = 0;
+					chn.pCurrentSample = nullptr;
 				}
+			} else
+			{
+				chn.nRampLength -= nSmpCount;
 			}
+		}
 
-			if(chn.position.GetUInt() >= chn.nLoopEnd && chn.dwFlags[CHN_LOOP])
+		if(chn.position.GetUInt() >= chn.nLoopEnd && chn.dwFlags[CHN_LOOP])
+		{
+			if(m_playBehaviour[kMODSampleSwap] && chn.nNewIns && chn.nNewIns <= GetNumSamples() && chn.pModSample != &Samples[chn.nNewIns])
 			{
-				if(m_playBehaviour[kMODSampleSwap] && chn.nNewIns && chn.nNewIns <= GetNumSamples() && chn.pModSample != &Samples[chn.nNewIns])
+				// ProTracker compatibility: Instrument changes without a note do not happen instantly, but rather when the sample loop has finished playing.
+				// Test case: PTInstrSwap.mod
+				const ModSample &smp = Samples[chn.nNewIns];
+				chn.pModSample = &smp;
+				chn.pCurrentSample = smp.samplev();
+				chn.dwFlags = (chn.dwFlags & CHN_CHANNELFLAGS) | smp.uFlags;
+				chn.nLength = smp.uFlags[CHN_LOOP] ? smp.nLoopEnd : smp.nLength;
+				chn.nLoopStart = smp.nLoopStart;
+				chn.nLoopEnd = smp.nLoopEnd;
+				chn.position.SetInt(chn.nLoopStart);
+				mixLoopState.UpdateLookaheadPointers(chn);
+				if(!chn.pCurrentSample)
 				{
-					// ProTracker compatibility: Instrument changes without a note do not happen instantly, but rather when the sample loop has finished playing.
-					// Test case: PTInstrSwap.mod
-					const ModSample &smp = Samples[chn.nNewIns];
-					chn.pModSample = &smp;
-					chn.pCurrentSample = smp.samplev();
-					chn.dwFlags = (chn.dwFlags & CHN_CHANNELFLAGS) | smp.uFlags;
-					chn.nLength = smp.uFlags[CHN_LOOP] ? smp.nLoopEnd : smp.nLength;
-					chn.nLoopStart = smp.nLoopStart;
-					chn.nLoopEnd = smp.nLoopEnd;
-					chn.position.SetInt(chn.nLoopStart);
-					mixLoopState.UpdateLookaheadPointers(chn);
-					if(!chn.pCurrentSample)
-					{
-						break;
-					}
-				} else if(m_playBehaviour[kMODOneShotLoops] && chn.nLoopStart == 0)
-				{
-					// ProTracker "oneshot" loops (if loop start is 0, play the whole sample once and then repeat until loop end)
-					chn.position.SetInt(0);
-					chn.nLoopEnd = chn.nLength = chn.pModSample->nLoopEnd;
+					break;
 				}
+			} else if(m_playBehaviour[kMODOneShotLoops] && chn.nLoopStart == 0)
+			{
+				// ProTracker "oneshot" loops (if loop start is 0, play the whole sample once and then repeat until loop end)
+				chn.position.SetInt(0);
+				chn.nLoopEnd = chn.nLength = chn.pModSample->nLoopEnd;
 			}
-		} while(nsamples > 0);
+		}
+	} while(nsamples > 0);
+
+	// Restore sample pointer in case it got changed through loop wrap-around
+	chn.pCurrentSample = mixLoopState.samplePointer;
+	return naddmix != 0;
+}
+
+
+// Render count * number of channels samples
+void CSoundFile::CreateStereoMix(int count)
+{
+	if (!count) return;
+
+	// Resetting sound buffer
+	StereoFill(MixSoundBuffer.data(), count, gnDryROfsVol, gnDryLOfsVol);
+	if(m_MixerSettings.gnChannels > 2) InitMixBuffer(MixRearBuffer.data(), count*2);
+
+	const MixFuncInterface *mixFunctions = MixFuncTable::Functions[MixFuncTable::GetInstructionSetIndex()];
+
+#if defined(MPT_ENABLE_THREAD) && defined(MPT_INTMIXER)
+	// The channel limit depends on the order in which channels are mixed, so we can only mix in parallel if it cannot be reached.
+	if(m_mixThreadPool != nullptr && m_nMixChannels <= m_MixerSettings.m_nMaxMixChannels
+#ifdef MODPLUG_TRACKER
+		&& m_SamplePlayLengths == nullptr
+#endif // MODPLUG_TRACKER
+		)
+	{
+		CreateStereoMixParallel(count, mixFunctions);
+		return;
+	}
+#endif // MPT_ENABLE_THREAD && MPT_INTMIXER
+
+	CHANNELINDEX nchmixed = 0;
+
+#ifdef MPT_INTMIXER
+	// Voices that are not ramping, filtered or wrapping around are mixed in groups that share the same mix function and target.
+	// As the integer mixer is exact, the order in which the voices are summed up does not matter.
+	const bool ITPingPongMode = m_playBehaviour[kITPingPongMode];
+	bool multiVoice = m_multiVoiceMixing;
+#ifdef MODPLUG_TRACKER
+	multiVoice = multiVoice && (m_SamplePlayLengths == nullptr);
+#endif // MODPLUG_TRACKER
+	MultiVoiceMixer multiVoiceMixer(mixFunctions, m_Resampler);
+#endif // MPT_INTMIXER
+
+	for(uint32 nChn = 0; nChn < m_nMixChannels; nChn++)
+	{
+		ModChannel &chn = m_PlayState.Chn[m_PlayState.ChnMix[nChn]];
 
-		// Restore sample pointer in case it got changed through loop wrap-around
-		chn.pCurrentSample = mixLoopState.samplePointer;
-		nchmixed += naddmix;
-	
+		if(!chn.pCurrentSample) continue;
+
+		const MixTarget target = GetChannelMixTarget(m_PlayState.ChnMix[nChn], count);
+		const bool tooManyChannels = nchmixed >= m_MixerSettings.m_nMaxMixChannels;
+		bool mixed;
+#ifdef MPT_INTMIXER
+		if(multiVoice && !tooManyChannels && MultiVoiceMixer::IsSupported(chn) && PrepareMultiVoiceMix(chn, count, ITPingPongMode, m_voiceCullVolume))
+		{
+			multiVoiceMixer.Add(chn, target.buffer, count);
+			mixed = true;
+		} else
+#endif // MPT_INTMIXER
+		{
+			mixed = MixChannel(chn, mixFunctions, target.buffer, *target.ofsR, *target.ofsL, count, tooManyChannels);
+		}
+		if(mixed)
+		{
+			nchmixed++;
 #ifndef NO_PLUGINS
-		if(naddmix && nMixPlugin > 0 && nMixPlugin <= MAX_MIXPLUGINS && m_MixPlugins[nMixPlugin - 1].pMixPlugin)
+			if(target.plugin)
+			{
+				m_MixPlugins[target.plugin - 1].pMixPlugin->ResetSilence();
+			}
+#endif // NO_PLUGINS
+		}
+	}
+#ifdef MPT_INTMIXER
+	multiVoiceMixer.Flush();
+#endif // MPT_INTMIXER
+	m_nMixStat = std::max<CHANNELINDEX>(m_nMixStat, nchmixed);
+}
+
+
+#if defined(MPT_ENABLE_THREAD) && defined(MPT_INTMIXER)
+
+// Same as the serial mixing loop in CreateStereoMix, but the channels are distributed over several threads.
+// Each worker thread mixes into its own buffers, which are then summed up in a fixed order.
+// As integer addition is associative, the result is identical to mixing all channels on a single thread.
+// Channels that are routed into plugins are always mixed on the calling thread.
+void CSoundFile::CreateStereoMixParallel(int count, const MixFuncInterface *mixFunctions)
+{
+	// Don't bother waking up threads for just a few channels
+	static constexpr uint32 MinChannelsPerThread = 4;
+
+	std::array<MixTarget, MAX_CHANNELS> targets;
+	std::array<bool, MAX_CHANNELS> channelMixed;
+	std::array<CHANNELINDEX, MAX_CHANNELS> parallelChannels, serialChannels;
+	uint32 numParallel = 0, numSerial = 0;
+	mixsample_t *reverbBuffer = nullptr;
+
+	for(uint32 nChn = 0; nChn < m_nMixChannels; nChn++)
+	{
+		channelMixed[nChn] = false;
+		if(!m_PlayState.Chn[m_PlayState.ChnMix[nChn]].pCurrentSample) continue;
+
+		targets[nChn] = GetChannelMixTarget(m_PlayState.ChnMix[nChn], count);
+		if(targets[nChn].pluginBuffer)
+		{
+			serialChannels[numSerial++] = static_cast<CHANNELINDEX>(nChn);
+		} else
 		{
-			m_MixPlugins[nMixPlugin - 1].pMixPlugin->ResetSilence();
+			parallelChannels[numParallel++] = static_cast<CHANNELINDEX>(nChn);
+			if(targets[nChn].buffer != MixSoundBuffer.data() && targets[nChn].buffer != MixRearBuffer.data())
+				reverbBuffer = targets[nChn].buffer;
 		}
+	}
+
+	const uint32 numThreads = Clamp(numParallel / MinChannelsPerThread, uint32(1), m_mixThreadPool->GetNumThreads());
+
+	m_mixThreadPool->Run(numThreads, [&](uint32 thread)
+	{
+		const uint32 first = numParallel * thread / numThreads, last = numParallel * (thread + 1) / numThreads;
+		if(thread == 0)
+		{
+			for(uint32 i = 0; i < numSerial; i++)
+			{
+				const MixTarget &target = targets[serialChannels[i]];
+				channelMixed[serialChannels[i]] = MixChannel(m_PlayState.Chn[m_PlayState.ChnMix[serialChannels[i]]], mixFunctions, target.buffer, *target.ofsR, *target.ofsL, count, false);
+			}
+			for(uint32 i = first; i < last; i++)
+			{
+				const MixTarget &target = targets[parallelChannels[i]];
+				channelMixed[parallelChannels[i]] = MixChannel(m_PlayState.Chn[m_PlayState.ChnMix[parallelChannels[i]]], mixFunctions, target.buffer, *target.ofsR, *target.ofsL, count, false);
+			}
+			return;
+		}
+
+		MixThreadBuffers &buffers = m_mixThreadPool->GetBuffers(thread);
+		buffers.dryOfsR = buffers.dryOfsL = buffers.reverbOfsR = buffers.reverbOfsL = 0;
+		buffers.dryUsed = buffers.rearUsed = buffers.reverbUsed = false;
+		for(uint32 i = first; i < last; i++)
+		{
+			const MixTarget &target = targets[parallelChannels[i]];
+			mixsample_t *buffer;
+			bool *used;
+			if(target.buffer == MixSoundBuffer.data())
+			{
+				buffer = buffers.dry.data();
+				used = &buffers.dryUsed;
+			} else if(target.buffer == MixRearBuffer.data())
+			{
+				buffer = buffers.rear.data();
+				used = &buffers.rearUsed;
+			} else
+			{
+				buffer = buffers.reverb.data();
+				used = &buffers.reverbUsed;
+			}
+			if(!*used)
+			{
+				InitMixBuffer(buffer, count * 2);
+				*used = true;
+			}
+			const bool dryOfs = (target.ofsR == &gnDryROfsVol);
+			channelMixed[parallelChannels[i]] = MixChannel(m_PlayState.Chn[m_PlayState.ChnMix[parallelChannels[i]]], mixFunctions, buffer,
+				dryOfs ? buffers.dryOfsR : buffers.reverbOfsR, dryOfs ? buffers.dryOfsL : buffers.reverbOfsL, count, false);
+		}
+	});
+
+	// Sum up the worker buffers in a fixed order
+	for(uint32 thread = 1; thread < numThreads; thread++)
+	{
+		const MixThreadBuffers &buffers = m_mixThreadPool->GetBuffers(thread);
+		if(buffers.dryUsed)
+			AddMixBuffer(MixSoundBuffer.data(), buffers.dry.data(), count * 2);
+		if(buffers.rearUsed)
+			AddMixBuffer(MixRearBuffer.data(), buffers.rear.data(), count * 2);
+		if(buffers.reverbUsed)
+			AddMixBuffer(reverbBuffer, buffers.reverb.data(), count * 2);
+		gnDryROfsVol += buffers.dryOfsR;
+		gnDryLOfsVol += buffers.dryOfsL;
+#ifndef NO_REVERB
+		m_Reverb.gnRvbROfsVol += buffers.reverbOfsR;
+		m_Reverb.gnRvbLOfsVol += buffers.reverbOfsL;
+#endif // NO_REVERB
+	}
+
+	CHANNELINDEX nchmixed = 0;
+	for(uint32 nChn = 0; nChn < m_nMixChannels; nChn++)
+	{
+		if(channelMixed[nChn])
+		{
+			nchmixed++;
+#ifndef NO_PLUGINS
+			if(targets[nChn].plugin)
+			{
+				m_MixPlugins[targets[nChn].plugin - 1].pMixPlugin->ResetSilence();
+			}
 #endif // NO_PLUGINS
+		}
 	}
 	m_nMixStat = std::max<CHANNELINDEX>(m_nMixStat, nchmixed);
 }
 
+#endif // MPT_ENABLE_THREAD && MPT_INTMIXER
+
+
+void CSoundFile::SetMixThreads(uint32 numThreads)
+{
+#if defined(MPT_ENABLE_THREAD) && defined(MPT_INTMIXER)
+	if(numThreads == 0)
+		numThreads = std::thread::hardware_concurrency();
+	LimitMax(numThreads, MaxMixThreads);
+	if(numThreads == GetMixThreads())
+		return;
+	m_mixThreadPool.reset();
+	if(numThreads > 1)
+	{
+		m_mixThreadPool = std::make_unique<MixThreadPool>(numThreads, m_mixBlockSize);
+		if(m_mixThreadPool->GetNumThreads() < 2)
+			m_mixThreadPool.reset();
+	}
+#else
+	MPT_UNREFERENCED_PARAMETER(numThreads);
+#endif // MPT_ENABLE_THREAD && MPT_INTMIXER
+}
+
+
+uint32 CSoundFile::GetMixThreads() const
+{
+#if defined(MPT_ENABLE_THREAD) && defined(MPT_INTMIXER)
+	if(m_mixThreadPool != nullptr)
+		return m_mixThreadPool->GetNumThreads();
+#endif // MPT_ENABLE_THREAD && MPT_INTMIXER
+	return 1;
+}
+
+
+// Rebuild the list of active plugins if plugins have been added, removed or re-routed since it was last built.
+// Checking the list only costs as much as there are active plugins.
+void CSoundFile::UpdatePluginGraph()
+{
+#ifndef NO_PLUGINS
+	if(m_pluginGraphValid)
+	{
+		for(const auto &node : m_pluginGraph)
+		{
+			const SNDMIXPLUGIN &plugin = m_MixPlugins[node.slot];
+			if(plugin.pMixPlugin != node.plugin || plugin.Info.dwOutputRouting != node.outputRouting)
+			{
+				m_pluginGraphValid = false;
+				break;
+			}
+		}
+		if(m_pluginGraphValid)
+			return;
+	}
+
+	m_pluginGraph.clear();
+	PLUGINDEX nodeIndex[MAX_MIXPLUGINS];
+	for(PLUGINDEX plug = 0; plug < MAX_MIXPLUGINS; plug++)
+	{
+		const SNDMIXPLUGIN &plugin = m_MixPlugins[plug];
+		nodeIndex[plug] = PLUGINDEX_INVALID;
+		if(plugin.pMixPlugin == nullptr)
+			continue;
+		nodeIndex[plug] = static_cast<PLUGINDEX>(m_pluginGraph.size());
+		m_pluginGraph.push_back({ plugin.pMixPlugin, plugin.Info.dwOutputRouting, plug, false });
+	}
+	for(const auto &node : m_pluginGraph)
+	{
+		const PLUGINDEX output = m_MixPlugins[node.slot].GetOutputPlugin();
+		if(output > node.slot && output < MAX_MIXPLUGINS && nodeIndex[output] != PLUGINDEX_INVALID)
+		{
+			m_pluginGraph[nodeIndex[output]].hasPluginInput = true;
+		}
+	}
+	m_pluginGraphValid = true;
+#endif // NO_PLUGINS
+}
+
 
 void CSoundFile::ProcessPlugins(uint32 nCount)
 {
@@ -483,9 +1003,9 @@ void CSoundFile::ProcessPlugins(uint32 nCount)
 #endif // MPT_INTMIXER
 
 	// Setup float inputs from samples
-	for(PLUGINDEX plug = 0; plug < MAX_MIXPLUGINS; plug++)
+	for(const auto &node : m_pluginGraph)
 	{
-		SNDMIXPLUGIN &plugin = m_MixPlugins[plug];
+		SNDMIXPLUGIN &plugin = m_MixPlugins[node.slot];
 		if(plugin.pMixPlugin != nullptr
 			&& plugin.pMixPlugin->m_MixState.pMixBuffer != nullptr
 			&& plugin.pMixPlugin->m_mixBuffer.Ok())
@@ -536,9 +1056,9 @@ void CSoundFile::ProcessPlugins(uint32 nCount)
 	}
 	// Convert mix buffer
 #ifdef MPT_INTMIXER
-	StereoMixToFloat(MixSoundBuffer, MixFloatBuffer[0], MixFloatBuffer[1], nCount, IntToFloat);
+	StereoMixToFloat(MixSoundBuffer.data(), MixFloatBuffer[0], MixFloatBuffer[1], nCount, IntToFloat);
 #else
-	DeinterleaveStereo(MixSoundBuffer, MixFloatBuffer[0], MixFloatBuffer[1], nCount);
+	DeinterleaveStereo(MixSoundBuffer.data(), MixFloatBuffer[0], MixFloatBuffer[1], nCount);
 #endif // MPT_INTMIXER
 	float *pMixL = MixFloatBuffer[0];
 	float *pMixR = MixFloatBuffer[1];
@@ -546,31 +1066,20 @@ void CSoundFile::ProcessPlugins(uint32 nCount)
 	const bool positionChanged = HasPositionChanged();
 
 	// Process Plugins
-	for(PLUGINDEX plug = 0; plug < MAX_MIXPLUGINS; plug++)
+	for(const auto &node : m_pluginGraph)
 	{
+		const PLUGINDEX plug = node.slot;
 		SNDMIXPLUGIN &plugin = m_MixPlugins[plug];
 		if (plugin.pMixPlugin != nullptr
 			&& plugin.pMixPlugin->m_MixState.pMixBuffer != nullptr
 			&& plugin.pMixPlugin->m_mixBuffer.Ok())
 		{
 			IMixPlugin *pObject = plugin.pMixPlugin;
-			if(!plugin.IsMasterEffect() && !plugin.pMixPlugin->ShouldProcessSilence() && !(plugin.pMixPlugin->m_MixState.dwFlags & SNDMIXPLUGINSTATE::psfHasInput))
+			if(!plugin.IsMasterEffect() && !plugin.pMixPlugin->ShouldProcessSilence() && !(plugin.pMixPlugin->m_MixState.dwFlags & SNDMIXPLUGINSTATE::psfHasInput) && !node.hasPluginInput)
 			{
 				// If plugin has no inputs and isn't a master plugin, we shouldn't let it process silence if possible.
 				// I have yet to encounter a VST plugin which actually sets this flag.
-				bool hasInput = false;
-				for(PLUGINDEX inPlug = 0; inPlug < plug; inPlug++)
-				{
-					if(m_MixPlugins[inPlug].GetOutputPlugin() == plug)
-					{
-						hasInput = true;
-						break;
-					}
-				}
-				if(!hasInput)
-				{
-					continue;
-				}
+				continue;
 			}
 
 			bool isMasterMix = false;
@@ -693,9 +1202,9 @@ void CSoundFile::ProcessPlugins(uint32 nCount)
 		}
 	}
 #ifdef MPT_INTMIXER
-	FloatToStereoMix(pMixL, pMixR, MixSoundBuffer, nCount, FloatToInt);
+	FloatToStereoMix(pMixL, pMixR, MixSoundBuffer.data(), nCount, FloatToInt);
 #else
-	InterleaveStereo(pMixL, pMixR, MixSoundBuffer, nCount);
+	InterleaveStereo(pMixL, pMixR, MixSoundBuffer.data(), nCount);
 #endif // MPT_INTMIXER
 
 #else
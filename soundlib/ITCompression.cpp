@@ -91,9 +91,8 @@ ITCompression::ITCompression(const ModSample &sample, bool it215, std::ostream *
 		{
 			// Initialise output buffer and bit writer positions
 			packedLength = 2;
-			bitPos = 0;
-			remBits = 8;
-			byteVal = 0;
+			bitBuf = 0;
+			bitCount = 0;
 
 			if(mptSample.GetElementarySampleSize() > 1)
 				Compress<IT16BitParams>(sample.sample16() + chn, offset, remain);
@@ -153,6 +152,8 @@ void ITCompression::Compress(const void *data, SmpLength offset, SmpLength actua
 		Deltafy<typename Properties::sample_t>();
 	}
 
+	CalculateMinWidth<Properties>();
+
 	// Initialise bit width table with initial values
 	bwt.assign(baseLength, Properties::defWidth);
 
@@ -190,12 +191,46 @@ void ITCompression::Compress(const void *data, SmpLength offset, SmpLength actua
 	}
 
 	// Write last byte and update block length
-	WriteByte(byteVal);
+	if(bitCount > 0)
+		WriteByte(static_cast<uint8>(bitBuf));
 	packedData[0] = static_cast<uint8>((packedLength - 2) & 0xFF);
 	packedData[1] = static_cast<uint8>((packedLength - 2) >> 8);
 }
 
 
+// Find the smallest bit width at which each sampling point can be stored,
+// so that SquishRecurse only needs a single comparison per sampling point and recursion level.
+template<typename Properties>
+void ITCompression::CalculateMinWidth()
+{
+	typedef typename Properties::sample_t sample_t;
+	typedef typename std::make_unsigned<sample_t>::type usample_t;
+
+	// Lookup table for all possible sample values
+	static const std::vector<int8> minWidthTable = []()
+	{
+		std::vector<int8> table(size_t(1) << (8 * sizeof(sample_t)));
+		for(size_t v = 0; v < table.size(); v++)
+		{
+			// The last table entry covers the full sample range, so this always terminates.
+			const sample_t val = static_cast<sample_t>(static_cast<usample_t>(v));
+			int8 width = 0;
+			while(val < Properties::lowerTab[width] || val > Properties::upperTab[width])
+				width++;
+			table[v] = width;
+		}
+		return table;
+	}();
+
+	const sample_t *p = static_cast<sample_t *>(sampleData);
+	minWidth.resize(baseLength);
+	for(SmpLength i = 0; i < baseLength; i++)
+	{
+		minWidth[i] = minWidthTable[static_cast<usample_t>(p[i])];
+	}
+}
+
+
 int8 ITCompression::GetWidthChangeSize(int8 w, bool is16)
 {
 	MPT_ASSERT(w > 0 && static_cast<unsigned int>(w) <= CountOf(ITWidthChangeSize));
@@ -220,15 +255,14 @@ void ITCompression::SquishRecurse(int8 sWidth, int8 lWidth, int8 rWidth, int8 wi
 
 	SmpLength i = offset;
 	SmpLength end = offset + length;
-	const typename Properties::sample_t *p = static_cast<typename Properties::sample_t *>(sampleData);
 
 	while(i < end)
 	{
-		if(p[i] >= Properties::lowerTab[width] && p[i] <= Properties::upperTab[width])
+		if(minWidth[i] <= width)
 		{
 			SmpLength start = i;
 			// Check for how long we can keep this bit width
-			while(i < end && p[i] >= Properties::lowerTab[width] && p[i] <= Properties::upperTab[width])
+			while(i < end && minWidth[i] <= width)
 			{
 				i++;
 			}
@@ -287,22 +321,14 @@ int8 ITCompression::ConvertWidth(int8 curWidth, int8 newWidth)
 
 void ITCompression::WriteBits(int8 width, int v)
 {
-	while(width > remBits)
+	// At most 7 bits are left over from the previous call, so 17 more bits always fit.
+	bitBuf |= (static_cast<uint32>(v) & ((1u << width) - 1u)) << bitCount;
+	bitCount += width;
+	while(bitCount >= 8)
 	{
-		byteVal |= (v << bitPos);
-		width -= remBits;
-		v >>= remBits;
-		bitPos = 0;
-		remBits = 8;
-		WriteByte(byteVal);
-		byteVal = 0;
-	}
-
-	if(width > 0)
-	{
-		byteVal |= (v & ((1 << width) - 1)) << bitPos;
-		remBits -= width;
-		bitPos += width;
+		WriteByte(static_cast<uint8>(bitBuf));
+		bitBuf >>= 8;
+		bitCount -= 8;
 	}
 }
 
@@ -324,101 +350,192 @@ void ITCompression::WriteByte(uint8 v)
 // IT 2.14 decompression
 
 
-ITDecompression::ITDecompression(FileReader &file, ModSample &sample, bool it215)
-	: mptSample(sample)
-	, is215(it215)
+// Lookup tables for the decoder, indexed by the current bit width
+struct ITDecompressionTables
 {
-	for(uint8 chn = 0; chn < mptSample.GetNumChannels(); chn++)
+	enum : int { maxWidth = 17 };
+	// Read values v with (v - changeLow[width]) <= changeRange[width] (unsigned) indicate a width change
+	uint32 changeLow[maxWidth + 1];
+	uint32 changeRange[maxWidth + 1];
+	// New bit width after a mode A or mode B width change, indexed by the current width and the read value
+	uint8 newWidth[maxWidth + 1][16];
+
+	template<typename Properties>
+	static const ITDecompressionTables &Get()
 	{
-		writtenSamples = writePos = 0;
-		while(writtenSamples < sample.nLength && file.CanRead(sizeof(uint16)))
-		{
-			uint16 compressedSize = file.ReadUint16LE();
-			if(!compressedSize)
-				continue;	// Malformed sample?
-			bitFile = file.ReadChunk(compressedSize);
-
-			// Initialise bit reader
-			mem1 = mem2 = 0;
+		static const ITDecompressionTables tables{Properties()};
+		return tables;
+	}
 
-			try
+	template<typename Properties>
+	explicit ITDecompressionTables(Properties)
+	{
+		MemsetZero(changeLow);
+		MemsetZero(changeRange);
+		MemsetZero(newWidth);
+		for(int width = 1; width <= Properties::defWidth; width++)
+		{
+			const uint32 topBit = 1u << (width - 1);
+			if(width <= 6)
 			{
-				if(mptSample.GetElementarySampleSize() > 1)
-					Uncompress<IT16BitParams>(mptSample.sample16() + chn);
-				else
-					Uncompress<IT8BitParams>(mptSample.sample8() + chn);
-			} catch(const BitReader::eof &)
+				// Mode A: 1 to 6 bits
+				changeLow[width] = topBit;
+				changeRange[width] = 0;
+			} else if(width < Properties::defWidth)
 			{
-				// Data is not sufficient to decode the block
-				//AddToLog(LogWarning, "Truncated IT sample block");
+				// Mode B: 7 to 8 / 16 bits
+				changeLow[width] = topBit + Properties::lowerB;
+				changeRange[width] = Properties::upperB - Properties::lowerB;
+			} else
+			{
+				// Mode C: 9 / 17 bits
+				changeLow[width] = topBit;
+				changeRange[width] = topBit - 1;
+			}
+			for(int v = 0; v < 16; v++)
+			{
+				newWidth[width][v] = static_cast<uint8>((v + 1 >= width) ? (v + 2) : (v + 1));
 			}
 		}
 	}
+};
+
+
+ITDecompression::ITDecompression(FileReader &file, ModSample &sample, bool it215)
+	: compressedData(0xFFFF + paddingSize)
+	, mptSample(sample)
+	, is215(it215)
+{
+	for(uint8 chn = 0; chn < mptSample.GetNumChannels(); chn++)
+	{
+		if(mptSample.GetElementarySampleSize() > 1)
+			Uncompress<IT16BitParams>(file, mptSample.sample16() + chn);
+		else
+			Uncompress<IT8BitParams>(file, mptSample.sample8() + chn);
+	}
 }
 
 
 template<typename Properties>
-void ITDecompression::Uncompress(typename Properties::sample_t *target)
+void ITDecompression::Uncompress(FileReader &file, typename Properties::sample_t *target)
 {
-	curLength = std::min(mptSample.nLength - writtenSamples, SmpLength(ITCompression::blockSize / sizeof(typename Properties::sample_t)));
+	typedef typename Properties::sample_t sample_t;
+	const SmpLength numChannels = mptSample.GetNumChannels();
+	std::vector<sample_t> deltas(ITCompression::blockSize / sizeof(sample_t));
+
+	SmpLength writtenSamples = 0;	// Number of samples so far written on this channel
+	while(writtenSamples < mptSample.nLength && file.CanRead(sizeof(uint16)))
+	{
+		uint16 compressedSize = file.ReadUint16LE();
+		if(!compressedSize)
+			continue;	// Malformed sample?
+		const size_t size = file.ReadRaw(compressedData.data(), compressedSize);
+		std::fill(compressedData.begin() + size, compressedData.begin() + size + paddingSize, uint8(0));
+
+		// If the data is not sufficient to decode the whole block, only the samples that could be decoded are written.
+		const SmpLength length = UncompressBlock<Properties>(size, deltas.data(), std::min(mptSample.nLength - writtenSamples, SmpLength(deltas.size())));
+		Integrate(target + writtenSamples * numChannels, deltas.data(), length, numChannels, is215);
+		writtenSamples += length;
+	}
+}
+
+
+// Decode the bit stream of a block into delta values. Returns the number of decoded values.
+template<typename Properties>
+SmpLength ITDecompression::UncompressBlock(size_t compressedSize, typename Properties::sample_t *deltas, SmpLength maxLength) const
+{
+	const ITDecompressionTables &tables = ITDecompressionTables::Get<Properties>();
+	const uint8 *data = compressedData.data();
+
+	uint64 bitBuf = 0;			// Bits that have been fetched but not consumed yet
+	int bitNum = 0;				// Number of bits in bitBuf
+	size_t bytePos = 0;			// Next byte to fetch
+	uint64 bitsLeft = static_cast<uint64>(compressedSize) * 8u;	// Number of real (non-padding) bits that have not been consumed yet
+
+	// Fetch as many whole bytes as fit into the bit buffer (at least 57 bits).
+	// Bits beyond the compressed data are zero padding, which is never consumed because of the bitsLeft checks.
+	const auto Refill = [&]()
+	{
+		uint64le next;
+		std::memcpy(&next, data + bytePos, sizeof(next));
+		bitBuf |= static_cast<uint64>(next) << bitNum;
+		bytePos += (63 - bitNum) >> 3;
+		bitNum |= 56;
+	};
 
 	int width = Properties::defWidth;
-	while(curLength > 0)
+	SmpLength length = 0;
+	while(length < maxLength)
 	{
-		if(width > Properties::defWidth)
+		if(static_cast<uint64>(width) > bitsLeft)
+			break;
+		if(bitNum < width)
+			Refill();
+		const uint32 v = static_cast<uint32>(bitBuf) & ((1u << width) - 1u);
+		bitBuf >>= width;
+		bitNum -= width;
+		bitsLeft -= width;
+
+		const uint32 change = v - tables.changeLow[width];
+		if(change > tables.changeRange[width])
 		{
-			// Error!
-			return;
-		}
-
-		int v = bitFile.ReadBits(width);
-		const int topBit = (1 << (width - 1));
-		if(width <= 6)
+			// Sign-extend and store the delta. In mode C, v is always positive here.
+			const uint32 topBit = 1u << (width - 1);
+			deltas[length++] = static_cast<typename Properties::sample_t>(static_cast<int>(v) - static_cast<int>((v & topBit) << 1));
+		} else if(width <= 6)
 		{
 			// Mode A: 1 to 6 bits
-			if(v == topBit)
-				ChangeWidth(width, bitFile.ReadBits(Properties::fetchA));
-			else
-				Write<Properties>(v, topBit, target);
+			if(static_cast<uint64>(Properties::fetchA) > bitsLeft)
+				break;
+			if(bitNum < Properties::fetchA)
+				Refill();
+			const uint32 newWidth = static_cast<uint32>(bitBuf) & ((1u << Properties::fetchA) - 1u);
+			bitBuf >>= Properties::fetchA;
+			bitNum -= Properties::fetchA;
+			bitsLeft -= Properties::fetchA;
+			width = tables.newWidth[width][newWidth];
 		} else if(width < Properties::defWidth)
 		{
 			// Mode B: 7 to 8 / 16 bits
-			if(v >= topBit + Properties::lowerB && v <= topBit + Properties::upperB)
-				ChangeWidth(width, v - (topBit + Properties::lowerB));
-			else
-				Write<Properties>(v, topBit, target);
+			width = tables.newWidth[width][change];
 		} else
 		{
 			// Mode C: 9 / 17 bits
-			if(v & topBit)
-				width = (v & ~topBit) + 1;
-			else
-				Write<Properties>((v & ~topBit), 0, target);
+			width = static_cast<int>(change) + 1;
+			if(width > Properties::defWidth)
+			{
+				// Error!
+				break;
+			}
 		}
 	}
+	return length;
 }
 
 
-void ITDecompression::ChangeWidth(int &curWidth, int width)
-{
-	width++;
-	if(width >= curWidth)
-		width++;
-	curWidth = width;
-}
-
-
-template<typename Properties>
-void ITDecompression::Write(int v, int topBit, typename Properties::sample_t *target)
+// Sum up the (double) deltas and write the result to the sample.
+// As the result is truncated to the sample size anyway, the integrators can operate at the sample size, too.
+template<typename T>
+void ITDecompression::Integrate(T *target, const T *deltas, SmpLength length, SmpLength stride, bool it215)
 {
-	if(v & topBit)
-		v -= (topBit << 1);
-	mem1 += v;
-	mem2 += mem1;
-	target[writePos] = static_cast<typename Properties::sample_t>(static_cast<int>(is215 ? mem2 : mem1));
-	writtenSamples++;
-	writePos += mptSample.GetNumChannels();
-	curLength--;
+	typedef typename std::make_unsigned<T>::type uT;
+	uT mem1 = 0, mem2 = 0;
+	if(it215)
+	{
+		for(SmpLength i = 0; i < length; i++, target += stride)
+		{
+			mem1 += static_cast<uT>(deltas[i]);
+			mem2 += mem1;
+			*target = static_cast<T>(mem2);
+		}
+	} else
+	{
+		for(SmpLength i = 0; i < length; i++, target += stride)
+		{
+			mem1 += static_cast<uT>(deltas[i]);
+			*target = static_cast<T>(mem1);
+		}
+	}
 }
 
 
@@ -15,7 +15,7 @@
 #include <vector>
 #include <iosfwd>
 #include "Snd_defs.h"
-#include "BitReader.h"
+#include "../common/FileReader.h"
 
 
 OPENMPT_NAMESPACE_BEGIN
@@ -33,6 +33,7 @@ public:
 
 protected:
 	std::vector<int8> bwt;			// Bit width table for each sampling point
+	std::vector<int8> minWidth;		// Smallest possible bit width for each sampling point
 	uint8 *packedData;				// Compressed data for current sample block
 	std::ostream *file;				// File to which compressed data will be written (can be nullptr if you only want to find out the sample size)
 	void *sampleData;				// Pre-processed sample data for currently compressed sample block
@@ -42,9 +43,8 @@ protected:
 	SmpLength baseLength;			// Length of the currently compressed sample block (in samples)
 
 	// Bit writer
-	int8 bitPos;	// Current bit position in this byte
-	int8 remBits;	// Remaining bits in this byte
-	uint8 byteVal;	// Current byte value to be written
+	uint32 bitBuf;	// Bits that have not been written yet
+	int8 bitCount;	// Number of bits in bitBuf
 
 	bool is215;		// Use IT2.15 compression (double deltas)
 
@@ -54,6 +54,9 @@ protected:
 	template<typename T>
 	void Deltafy();
 
+	template<typename Properties>
+	void CalculateMinWidth();
+
 	template<typename Properties>
 	void Compress(const void *data, SmpLength offset, SmpLength actualLength);
 
@@ -74,22 +77,21 @@ class ITDecompression
 public:
 	ITDecompression(FileReader &file, ModSample &sample, bool it215);
 
+	enum : size_t { paddingSize = 16 };	// Zero padding after compressed data, so that the bit reader can always read whole 64-bit words
+
 protected:
-	BitReader bitFile;
+	std::vector<uint8> compressedData;	// Compressed data of the current block, followed by paddingSize zero bytes
 	ModSample &mptSample;		// Sample that is being processed
-
-	SmpLength writtenSamples;	// Number of samples so far written on this channel
-	SmpLength writePos;			// Absolut write position in sample (for stereo samples)
-	SmpLength curLength;		// Length of currently processed block
-	unsigned int mem1, mem2;	// Integrator memory
 	bool is215;					// Use IT2.15 compression (double deltas)
 
 	template<typename Properties>
-	void Uncompress(typename Properties::sample_t *target);
-	static void ChangeWidth(int &curWidth, int width);
+	void Uncompress(FileReader &file, typename Properties::sample_t *target);
 
 	template<typename Properties>
-	void Write(int v, int topbit, typename Properties::sample_t *target);
+	SmpLength UncompressBlock(size_t compressedSize, typename Properties::sample_t *deltas, SmpLength maxLength) const;
+
+	template<typename T>
+	static void Integrate(T *target, const T *deltas, SmpLength length, SmpLength stride, bool it215);
 };
 
 
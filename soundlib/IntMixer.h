@@ -16,6 +16,15 @@
 #include "Resampler.h"
 #include "MixerInterface.h"
 #include "Paula.h"
+#ifdef ENABLE_SSE2_INTRINSICS
+#include <emmintrin.h>
+#endif
+#ifdef ENABLE_SSE4
+#include <smmintrin.h>
+#endif
+#ifdef ENABLE_AVX2
+#include <immintrin.h>
+#endif
 
 OPENMPT_NAMESPACE_BEGIN
 
@@ -222,6 +231,260 @@ struct FIRFilterInterpolation
 };
 
 
+#ifdef ENABLE_SSE2_INTRINSICS
+
+//////////////////////////////////////////////////////////////////////////
+// SIMD interpolation templates
+// The tap dot products of the FastSinc, Polyphase and FIR interpolators are computed with pmaddwd.
+// Both the sample points (widened to 16 bits exactly like IntToIntTraits::Convert does) and the
+// LUT entries fit into int16, and the 32-bit sums wrap around exactly like the scalar code does,
+// so the results are bit-identical to the scalar templates above. The final scaling is done in scalar code.
+
+namespace SIMDMixer
+{
+
+struct SSE2
+{
+	// Load 4 sampling points of a mono sample, widened to int16
+	static MPT_FORCEINLINE __m128i LoadMono4(const int8 *p)
+	{
+		int32 v;
+		std::memcpy(&v, p, 4);
+		return _mm_unpacklo_epi8(_mm_setzero_si128(), _mm_cvtsi32_si128(v));
+	}
+	static MPT_FORCEINLINE __m128i LoadMono4(const int16 *p)
+	{
+		return _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p));
+	}
+
+	// Load 8 sampling points of a mono sample, widened to int16
+	static MPT_FORCEINLINE __m128i LoadMono8(const int8 *p)
+	{
+		return _mm_unpacklo_epi8(_mm_setzero_si128(), _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)));
+	}
+	static MPT_FORCEINLINE __m128i LoadMono8(const int16 *p)
+	{
+		return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+	}
+
+	// LRLRLRLR => LLLLRRRR
+	static MPT_FORCEINLINE __m128i Deinterleave(__m128i v)
+	{
+		v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(3, 1, 2, 0));
+		v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(3, 1, 2, 0));
+		return _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 1, 2, 0));
+	}
+
+	// Load 4 sampling points of a stereo sample, widened to int16 and deinterleaved to LLLLRRRR
+	static MPT_FORCEINLINE __m128i LoadStereo4(const int8 *p)
+	{
+		return Deinterleave(LoadMono8(p));
+	}
+	static MPT_FORCEINLINE __m128i LoadStereo4(const int16 *p)
+	{
+		return Deinterleave(LoadMono8(p));
+	}
+};
+
+
+#ifdef ENABLE_SSE4
+
+struct SSE4_1 : public SSE2
+{
+	// Deinterleaving and widening can be done with a single pshufb
+	static MPT_FORCEINLINE __m128i LoadStereo4(const int8 *p)
+	{
+		const __m128i mask = _mm_setr_epi8(-128, 0, -128, 2, -128, 4, -128, 6, -128, 1, -128, 3, -128, 5, -128, 7);
+		return _mm_shuffle_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)), mask);
+	}
+	static MPT_FORCEINLINE __m128i LoadStereo4(const int16 *p)
+	{
+		const __m128i mask = _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
+		return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)), mask);
+	}
+};
+
+#endif // ENABLE_SSE4
+
+
+// Multiply 8 sampling points of a stereo sample with 8 taps.
+// Result: {L taps 0+1, L taps 2+3, R taps 0+1, R taps 2+3} in lo and the same for taps 4-7 in hi.
+template<class ISA, typename Tsample>
+static MPT_FORCEINLINE void MulStereo8(ISA, __m128i &lo, __m128i &hi, const Tsample *p, const int16 *lut)
+{
+	const __m128i taps = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lut));
+	lo = _mm_madd_epi16(ISA::LoadStereo4(p), _mm_unpacklo_epi64(taps, taps));
+	hi = _mm_madd_epi16(ISA::LoadStereo4(p + 8), _mm_unpackhi_epi64(taps, taps));
+}
+
+
+#if defined(ENABLE_SSE4) && defined(ENABLE_AVX2)
+
+// Sampling point loads are the same as with SSE4.1, only the stereo 8-tap products differ (see below)
+struct AVX2 : public SSE4_1
+{
+};
+
+// Taps 0-3 are processed in the lower lane, taps 4-7 in the upper lane
+static MPT_FORCEINLINE void MulStereo8(AVX2, __m128i &lo, __m128i &hi, const int8 *p, const int16 *lut)
+{
+	const __m256i mask = _mm256_setr_epi8(
+		-128, 0, -128, 2, -128, 4, -128, 6, -128, 1, -128, 3, -128, 5, -128, 7,
+		-128, 8, -128, 10, -128, 12, -128, 14, -128, 9, -128, 11, -128, 13, -128, 15);
+	const __m256i taps = _mm256_permute4x64_epi64(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(lut))), _MM_SHUFFLE(1, 1, 0, 0));
+	const __m256i smp = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))), mask);
+	const __m256i result = _mm256_madd_epi16(smp, taps);
+	lo = _mm256_castsi256_si128(result);
+	hi = _mm256_extracti128_si256(result, 1);
+}
+
+static MPT_FORCEINLINE void MulStereo8(AVX2, __m128i &lo, __m128i &hi, const int16 *p, const int16 *lut)
+{
+	const __m256i mask = _mm256_setr_epi8(
+		0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15,
+		0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
+	const __m256i taps = _mm256_permute4x64_epi64(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(lut))), _MM_SHUFFLE(1, 1, 0, 0));
+	const __m256i smp = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)), mask);
+	const __m256i result = _mm256_madd_epi16(smp, taps);
+	lo = _mm256_castsi256_si128(result);
+	hi = _mm256_extracti128_si256(result, 1);
+}
+
+#endif // ENABLE_SSE4 && ENABLE_AVX2
+
+
+// Sums of products of sampling points and interpolation taps, per channel
+template<class ISA, int channels>
+struct Taps;
+
+template<class ISA>
+struct Taps<ISA, 1>
+{
+	// 4 taps, sampling points -1 to 2
+	template<typename Tsample>
+	static MPT_FORCEINLINE void Sum4(int32 (&sum)[1], const Tsample *p, const int16 *lut)
+	{
+		__m128i v = _mm_madd_epi16(ISA::LoadMono4(p - 1), _mm_loadl_epi64(reinterpret_cast<const __m128i *>(lut)));
+		v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+		sum[0] = _mm_cvtsi128_si32(v);
+	}
+
+	// 8 taps, sampling points -3 to 4, with separate sums for taps 0-3 and 4-7
+	template<typename Tsample>
+	static MPT_FORCEINLINE void Sum8(int32 (&sum)[1][2], const Tsample *p, const int16 *lut)
+	{
+		__m128i v = _mm_madd_epi16(ISA::LoadMono8(p - 3), _mm_loadu_si128(reinterpret_cast<const __m128i *>(lut)));
+		v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+		sum[0][0] = _mm_cvtsi128_si32(v);
+		sum[0][1] = _mm_cvtsi128_si32(_mm_unpackhi_epi64(v, v));
+	}
+};
+
+template<class ISA>
+struct Taps<ISA, 2>
+{
+	template<typename Tsample>
+	static MPT_FORCEINLINE void Sum4(int32 (&sum)[2], const Tsample *p, const int16 *lut)
+	{
+		const __m128i taps = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(lut));
+		__m128i v = _mm_madd_epi16(ISA::LoadStereo4(p - 2), _mm_unpacklo_epi64(taps, taps));
+		v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+		sum[0] = _mm_cvtsi128_si32(v);
+		sum[1] = _mm_cvtsi128_si32(_mm_unpackhi_epi64(v, v));
+	}
+
+	template<typename Tsample>
+	static MPT_FORCEINLINE void Sum8(int32 (&sum)[2][2], const Tsample *p, const int16 *lut)
+	{
+		__m128i lo, hi;
+		MulStereo8(ISA(), lo, hi, p - 6, lut);
+		lo = _mm_add_epi32(lo, _mm_shuffle_epi32(lo, _MM_SHUFFLE(2, 3, 0, 1)));
+		hi = _mm_add_epi32(hi, _mm_shuffle_epi32(hi, _MM_SHUFFLE(2, 3, 0, 1)));
+		// {L taps 0-3, L taps 4-7, R taps 0-3, R taps 4-7}
+		const __m128i v = _mm_unpacklo_epi32(_mm_shuffle_epi32(lo, _MM_SHUFFLE(3, 1, 2, 0)), _mm_shuffle_epi32(hi, _MM_SHUFFLE(3, 1, 2, 0)));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(&sum[0][0]), v);
+	}
+};
+
+} // namespace SIMDMixer
+
+
+template<class Traits, class ISA>
+struct FastSincInterpolationSIMD
+{
+	MPT_FORCEINLINE void Start(const ModChannel &, const CResampler &) { }
+	MPT_FORCEINLINE void End(const ModChannel &) { }
+
+	MPT_FORCEINLINE void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const MPT_RESTRICT inBuffer, const uint32 posLo)
+	{
+		static_assert(static_cast<int>(Traits::numChannelsIn) <= static_cast<int>(Traits::numChannelsOut), "Too many input channels");
+		const int16 *lut = CResampler::FastSincTable + ((posLo >> 22) & 0x3FC);
+
+		int32 sum[Traits::numChannelsIn];
+		SIMDMixer::Taps<ISA, Traits::numChannelsIn>::Sum4(sum, inBuffer, lut);
+		for(int i = 0; i < Traits::numChannelsIn; i++)
+		{
+			outSample[i] = sum[i] / 16384;
+		}
+	}
+};
+
+
+template<class Traits, class ISA>
+struct PolyphaseInterpolationSIMD : public PolyphaseInterpolation<Traits>
+{
+	MPT_FORCEINLINE void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const MPT_RESTRICT inBuffer, const uint32 posLo)
+	{
+		static_assert(static_cast<int>(Traits::numChannelsIn) <= static_cast<int>(Traits::numChannelsOut), "Too many input channels");
+		const SINC_TYPE *lut = this->sinc + ((posLo >> (32 - SINC_PHASES_BITS)) & SINC_MASK) * SINC_WIDTH;
+
+		int32 sum[Traits::numChannelsIn][2];
+		SIMDMixer::Taps<ISA, Traits::numChannelsIn>::Sum8(sum, inBuffer, lut);
+		for(int i = 0; i < Traits::numChannelsIn; i++)
+		{
+			outSample[i] = static_cast<int32>(static_cast<uint32>(sum[i][0]) + static_cast<uint32>(sum[i][1])) / (1 << SINC_QUANTSHIFT);
+		}
+	}
+};
+
+
+template<class Traits, class ISA>
+struct FIRFilterInterpolationSIMD : public FIRFilterInterpolation<Traits>
+{
+	MPT_FORCEINLINE void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const MPT_RESTRICT inBuffer, const uint32 posLo)
+	{
+		static_assert(static_cast<int>(Traits::numChannelsIn) <= static_cast<int>(Traits::numChannelsOut), "Too many input channels");
+		const int16 * const lut = this->WFIRlut + ((((posLo >> 16) + WFIR_FRACHALVE) >> WFIR_FRACSHIFT) & WFIR_FRACMASK);
+
+		int32 sum[Traits::numChannelsIn][2];
+		SIMDMixer::Taps<ISA, Traits::numChannelsIn>::Sum8(sum, inBuffer, lut);
+		for(int i = 0; i < Traits::numChannelsIn; i++)
+		{
+			outSample[i] = ((sum[i][0] / 2) + (sum[i][1] / 2)) / (1 << (WFIR_16BITSHIFT - 1));
+		}
+	}
+};
+
+
+template<class Traits> using FastSincInterpolationSSE2 = FastSincInterpolationSIMD<Traits, SIMDMixer::SSE2>;
+template<class Traits> using PolyphaseInterpolationSSE2 = PolyphaseInterpolationSIMD<Traits, SIMDMixer::SSE2>;
+template<class Traits> using FIRFilterInterpolationSSE2 = FIRFilterInterpolationSIMD<Traits, SIMDMixer::SSE2>;
+
+#ifdef ENABLE_SSE4
+template<class Traits> using FastSincInterpolationSSE4_1 = FastSincInterpolationSIMD<Traits, SIMDMixer::SSE4_1>;
+template<class Traits> using PolyphaseInterpolationSSE4_1 = PolyphaseInterpolationSIMD<Traits, SIMDMixer::SSE4_1>;
+template<class Traits> using FIRFilterInterpolationSSE4_1 = FIRFilterInterpolationSIMD<Traits, SIMDMixer::SSE4_1>;
+#endif // ENABLE_SSE4
+
+#if defined(ENABLE_SSE4) && defined(ENABLE_AVX2)
+// 4-tap and mono 8-tap kernels fit into 128 bits, so only the stereo 8-tap kernels benefit from AVX2
+template<class Traits> using PolyphaseInterpolationAVX2 = PolyphaseInterpolationSIMD<Traits, SIMDMixer::AVX2>;
+template<class Traits> using FIRFilterInterpolationAVX2 = FIRFilterInterpolationSIMD<Traits, SIMDMixer::AVX2>;
+#endif // ENABLE_SSE4 && ENABLE_AVX2
+
+#endif // ENABLE_SSE2_INTRINSICS
+
+
 //////////////////////////////////////////////////////////////////////////
 // Mixing templates (add sample to stereo mix)
 
@@ -1016,12 +1016,12 @@ bool CSoundFile::ReadDMF(FileReader &file, ModLoadingFlags loadFlags)
 		FileReader sampleData = sampleDataChunk.ReadChunk(sampleDataChunk.ReadUint32LE());
 		if(sampleData.IsValid() && (loadFlags & loadSampleData))
 		{
-			SampleIO(
+			SampleIO sampleIO(
 				sample.uFlags[CHN_16BIT] ? SampleIO::_16bit : SampleIO::_8bit,
 				SampleIO::mono,
 				SampleIO::littleEndian,
-				(sampleHeader.flags & DMFSampleHeader::smpCompMask) == DMFSampleHeader::smpComp1 ? SampleIO::DMF : SampleIO::signedPCM)
-				.ReadSample(sample, sampleData);
+				(sampleHeader.flags & DMFSampleHeader::smpCompMask) == DMFSampleHeader::smpComp1 ? SampleIO::DMF : SampleIO::signedPCM);
+			ReadOrDeferSample(smp, sampleIO, sampleData);
 		}
 	}
 
@@ -793,7 +793,8 @@ bool CSoundFile::ReadIT(FileReader &file, ModLoadingFlags loadFlags)
 				SampleIO sampleIO = sampleHeader.GetSampleFormat(fileHeader.cwtv);
 				if(loadFlags & loadSampleData)
 				{
-					sampleIO.ReadSample(sample, file);
+					if(!ReadOrDeferSample(i + 1, sampleIO, file))
+						lastSampleCompressed = true;
 				} else
 				{
 					if(sampleIO.IsVariableLengthEncoded())
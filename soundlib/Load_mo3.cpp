@@ -56,6 +56,13 @@
 #include "../soundbase/SampleFormatCopy.h"
 #endif // MPT_WITH_STBVORBIS
 
+#if defined(MPT_ENABLE_THREAD)
+#include <atomic>
+#include <exception>
+#include <system_error>
+#include <thread>
+#endif // MPT_ENABLE_THREAD
+
 
 OPENMPT_NAMESPACE_BEGIN
 
@@ -348,6 +355,29 @@ struct MO3SampleChunk
 };
 
 
+// Private copy of all Ogg sample chunks, for samples that are only decoded when they are played for the first time.
+struct MO3OggSampleData
+{
+	std::vector<mpt::byte> data;
+	std::vector<MO3SampleChunk> chunks;	// Point into data
+};
+
+
+// A compressed sample that is decoded after all sample headers have been read.
+struct MO3SampleDecodeJob
+{
+	FileReader data;
+	std::vector<std::pair<LogLevel, mpt::ustring>> messages;	// Log messages that are added once all samples have been decoded
+	SmpLength length;		// Sample length according to sample header (MPEG)
+	SAMPLEINDEX smp;
+	uint16 compression;		// See MO3Sample::MO3SampleFlags
+	uint16 encoderDelay;	// Bytes to skip at the start of the decoded output (MPEG)
+	bool decoded = false;
+	MO3SampleDecodeJob(SAMPLEINDEX smp_, uint32 compression_, const FileReader &data_, SmpLength length_ = 0, uint16 encoderDelay_ = 0)
+		: data(data_), length(length_), smp(smp_), compression(static_cast<uint16>(compression_)), encoderDelay(encoderDelay_) { }
+};
+
+
 // Unpack macros
 
 // shift control bits until it is empty:
@@ -710,6 +740,340 @@ static long VorbisfileFilereaderTell(void *datasource)
 #endif // MPT_WITH_VORBIS && MPT_WITH_VORBISFILE
 
 
+// Decode an Ogg Vorbis sample. Shared Vorbis headers can be taken from any other sample, so all sample chunks are needed.
+// Only the given sample is modified, so that several samples can be decoded at the same time. For the same reason, log messages
+// are not added to the module directly. If the sample already has sample data, it is decoded into the existing buffer.
+// Returns false if the sample uses an unsupported codec.
+static bool DecodeMO3OggSample(ModSample &sample, SAMPLEINDEX smp, const std::vector<MO3SampleChunk> &sampleChunks, std::vector<std::pair<LogLevel, mpt::ustring>> &messages)
+{
+	MO3SampleChunk sampleChunk = sampleChunks[smp - 1];
+	sampleChunk.chunk.Rewind();
+	const SAMPLEINDEX numSamples = static_cast<SAMPLEINDEX>(sampleChunks.size());
+	SAMPLEINDEX sharedOggHeader = smp + sampleChunk.sharedHeader;
+	// Which chunk are we going to read the header from?
+	// Note: Every Ogg stream has a unique serial number.
+	// stb_vorbis (currently) ignores this serial number so we can just stitch
+	// together our sample without adjusting the shared header's serial number.
+	const bool sharedHeader = sharedOggHeader != smp && sharedOggHeader > 0 && sharedOggHeader <= numSamples;
+	FileReader sharedChunkData = sharedHeader ? sampleChunks[sharedOggHeader - 1].chunk : FileReader();
+
+#if defined(MPT_WITH_VORBIS) && defined(MPT_WITH_VORBISFILE)
+
+	std::vector<char> mergedData;
+	if(sharedHeader)
+	{
+		// Prepend the shared header to the actual sample data and adjust bitstream serial numbers.
+		// We do not handle multiple muxed logical streams as they do not exist in practice in mo3.
+		// We assume sequence numbers are consecutive at the end of the headers.
+		// Corrupted pages get dropped as required by Ogg spec. We cannot do any further sane parsing on them anyway.
+		// We do not match up multiple muxed stream properly as this would need parsing of actual packet data to determine or guess the codec.
+		// Ogg Vorbis files may contain at least an additional Ogg Skeleton stream. It is not clear whether these actually exist in MO3.
+		// We do not validate packet structure or logical bitstream structure (i.e. sequence numbers and granule positions).
+
+		// TODO: At least handle Skeleton streams here, as they violate our stream ordering assumptions here.
+
+#if 0
+		// This block may still turn out to be useful as it does a more thourough validation of the stream than the optimized version below.
+
+		// We copy the whole data into a single consecutive buffer in order to keep things simple when interfacing libvorbisfile.
+		// We could in theory only adjust the header and pass 2 chunks to libvorbisfile.
+		// Another option would be to demux both chunks on our own (or using libogg) and pass the raw packet data to libvorbis directly.
+
+		mpt::ostringstream mergedStream(std::ios::binary);
+		mergedStream.imbue(std::locale::classic());
+
+		sharedChunkData.Rewind();
+		FileReader sharedChunk = sharedChunkData.ReadChunk(sampleChunk.headerSize);
+		sharedChunk.Rewind();
+
+		std::vector<uint32> streamSerials;
+		Ogg::PageInfo oggPageInfo;
+		std::vector<uint8> oggPageData;
+
+		streamSerials.clear();
+		while(Ogg::ReadPageAndSkipJunk(sharedChunk, oggPageInfo, oggPageData))
+		{
+			auto it = std::find(streamSerials.begin(), streamSerials.end(), oggPageInfo.header.bitstream_serial_number);
+			if(it == streamSerials.end())
+			{
+				streamSerials.push_back(oggPageInfo.header.bitstream_serial_number);
+				it = streamSerials.begin() + (streamSerials.size() - 1);
+			}
+			uint32 newSerial = it - streamSerials.begin() + 1;
+			oggPageInfo.header.bitstream_serial_number = newSerial;
+			Ogg::UpdatePageCRC(oggPageInfo, oggPageData);
+			Ogg::WritePage(mergedStream, oggPageInfo, oggPageData);
+		}
+
+		streamSerials.clear();
+		while(Ogg::ReadPageAndSkipJunk(sampleChunk.chunk, oggPageInfo, oggPageData))
+		{
+			auto it = std::find(streamSerials.begin(), streamSerials.end(), oggPageInfo.header.bitstream_serial_number);
+			if(it == streamSerials.end())
+			{
+				streamSerials.push_back(oggPageInfo.header.bitstream_serial_number);
+				it = streamSerials.begin() + (streamSerials.size() - 1);
+			}
+			uint32 newSerial = it - streamSerials.begin() + 1;
+			oggPageInfo.header.bitstream_serial_number = newSerial;
+			Ogg::UpdatePageCRC(oggPageInfo, oggPageData);
+			Ogg::WritePage(mergedStream, oggPageInfo, oggPageData);
+		}
+
+		std::string mergedStreamData = mergedStream.str();
+		mergedData.insert(mergedData.end(), mergedStreamData.begin(), mergedStreamData.end());
+
+#else
+
+		// We assume same ordering of streams in both header and data if
+		// multiple streams are present.
+
+		mpt::ostringstream mergedStream(std::ios::binary);
+		mergedStream.imbue(std::locale::classic());
+
+		sharedChunkData.Rewind();
+		FileReader sharedChunk = sharedChunkData.ReadChunk(sampleChunk.headerSize);
+		sharedChunk.Rewind();
+
+		std::vector<uint32> dataStreamSerials;
+		std::vector<uint32> headStreamSerials;
+		Ogg::PageInfo oggPageInfo;
+		std::vector<uint8> oggPageData;
+
+		// Gather bitstream serial numbers form sample data chunk
+		dataStreamSerials.clear();
+		while(Ogg::ReadPageAndSkipJunk(sampleChunk.chunk, oggPageInfo, oggPageData))
+		{
+			auto it = std::find(dataStreamSerials.begin(), dataStreamSerials.end(), oggPageInfo.header.bitstream_serial_number);
+			if(it == dataStreamSerials.end())
+			{
+				dataStreamSerials.push_back(oggPageInfo.header.bitstream_serial_number);
+			}
+		}
+
+		// Apply the data bitstream serial numbers to the header
+		headStreamSerials.clear();
+		while(Ogg::ReadPageAndSkipJunk(sharedChunk, oggPageInfo, oggPageData))
+		{
+			auto it = std::find(headStreamSerials.begin(), headStreamSerials.end(), oggPageInfo.header.bitstream_serial_number);
+			if(it == headStreamSerials.end())
+			{
+				headStreamSerials.push_back(oggPageInfo.header.bitstream_serial_number);
+				it = headStreamSerials.begin() + (headStreamSerials.size() - 1);
+			}
+			uint32 newSerial = 0;
+			if(dataStreamSerials.size() >= static_cast<std::size_t>(it - headStreamSerials.begin()))
+			{
+				// Found corresponding stream in data chunk.
+				newSerial = dataStreamSerials[it - headStreamSerials.begin()];
+			} else
+			{
+				// No corresponding stream in data chunk. Find a free serialno.
+				std::size_t extraIndex = (it - headStreamSerials.begin()) - dataStreamSerials.size();
+				for(newSerial = 1; newSerial < 0xffffffffu; ++newSerial)
+				{
+					auto dss = std::find(dataStreamSerials.begin(), dataStreamSerials.end(), newSerial);
+					if(dss == dataStreamSerials.end())
+					{
+						extraIndex -= 1;
+					}
+					if(extraIndex == 0)
+					{
+						break;
+					}
+				}
+			}
+			oggPageInfo.header.bitstream_serial_number = newSerial;
+			Ogg::UpdatePageCRC(oggPageInfo, oggPageData);
+			Ogg::WritePage(mergedStream, oggPageInfo, oggPageData);
+		}
+
+		if(headStreamSerials.size() > 1)
+		{
+			messages.emplace_back(LogWarning, mpt::format(U_("Sample %1: Ogg Vorbis data with shared header and multiple logical bitstreams in header chunk found. This may be handled incorrectly."))(smp));
+		} else if(dataStreamSerials.size() > 1)
+		{
+			messages.emplace_back(LogWarning, mpt::format(U_("Sample %1: Ogg Vorbis sample with shared header and multiple logical bitstreams found. This may be handled incorrectly."))(smp));
+		} else if((dataStreamSerials.size() == 1) && (headStreamSerials.size() == 1) && (dataStreamSerials[0] != headStreamSerials[0]))
+		{
+			messages.emplace_back(LogInformation, mpt::format(U_("Sample %1: Ogg Vorbis data with shared header and different logical bitstream serials found."))(smp));
+		}
+
+		std::string mergedStreamData = mergedStream.str();
+		mergedData.insert(mergedData.end(), mergedStreamData.begin(), mergedStreamData.end());
+
+		sampleChunk.chunk.Rewind();
+		FileReader::PinnedRawDataView sampleChunkView = sampleChunk.chunk.GetPinnedRawDataView();
+		mergedData.insert(mergedData.end(), mpt::byte_cast<const char*>(sampleChunkView.begin()), mpt::byte_cast<const char*>(sampleChunkView.end()));
+
+#endif
+
+	}
+	FileReader mergedDataChunk(mpt::byte_cast<mpt::const_byte_span>(mpt::as_span(mergedData)));
+
+	FileReader &sampleData = sharedHeader ? mergedDataChunk : sampleChunk.chunk;
+	FileReader &headerChunk = sampleData;
+
+#else // !(MPT_WITH_VORBIS && MPT_WITH_VORBISFILE)
+
+	FileReader &sampleData = sampleChunk.chunk;
+	FileReader &headerChunk = sharedHeader ? sharedChunkData : sampleData;
+#if defined(MPT_WITH_STBVORBIS)
+	std::size_t initialRead = sharedHeader ? sampleChunk.headerSize : headerChunk.GetLength();
+#endif // MPT_WITH_STBVORBIS
+
+#endif // MPT_WITH_VORBIS && MPT_WITH_VORBISFILE
+
+	headerChunk.Rewind();
+	if(sharedHeader && !headerChunk.CanRead(sampleChunk.headerSize))
+		return true;
+
+#if defined(MPT_WITH_VORBIS) && defined(MPT_WITH_VORBISFILE)
+
+	ov_callbacks callbacks = {
+		&VorbisfileFilereaderRead,
+		&VorbisfileFilereaderSeek,
+		NULL,
+		&VorbisfileFilereaderTell
+	};
+	OggVorbis_File vf;
+	MemsetZero(vf);
+	bool supported = true;
+	if(ov_open_callbacks(&sampleData, &vf, nullptr, 0, callbacks) == 0)
+	{
+		if(ov_streams(&vf) == 1)
+		{ // we do not support chained vorbis samples
+			vorbis_info *vi = ov_info(&vf, -1);
+			if(vi && vi->rate > 0 && vi->channels > 0)
+			{
+				if(!sample.HasSampleData())
+					sample.AllocateSample();
+				SmpLength offset = 0;
+				int channels = vi->channels;
+				int current_section = 0;
+				long decodedSamples = 0;
+				bool eof = false;
+				while(!eof && offset < sample.nLength && sample.HasSampleData())
+				{
+					float **output = nullptr;
+					long ret = ov_read_float(&vf, &output, 1024, &current_section);
+					if(ret == 0)
+					{
+						eof = true;
+					} else if(ret < 0)
+					{
+						// stream error, just try to continue
+					} else
+					{
+						decodedSamples = ret;
+						LimitMax(decodedSamples, mpt::saturate_cast<long>(sample.nLength - offset));
+						if(decodedSamples > 0 && channels == sample.GetNumChannels())
+						{
+							for(int chn = 0; chn < channels; chn++)
+							{
+								if(sample.uFlags[CHN_16BIT])
+								{
+									CopyChannelToInterleaved<SC::Convert<int16, float> >(sample.sample16() + offset * sample.GetNumChannels(), output[chn], channels, decodedSamples, chn);
+								} else
+								{
+									CopyChannelToInterleaved<SC::Convert<int8, float> >(sample.sample8() + offset * sample.GetNumChannels(), output[chn], channels, decodedSamples, chn);
+								}
+							}
+						}
+						offset += decodedSamples;
+					}
+				}
+			} else
+			{
+				supported = false;
+			}
+		} else
+		{
+			messages.emplace_back(LogWarning, mpt::format(U_("Sample %1: Unsupported Ogg Vorbis chained stream found."))(smp));
+			supported = false;
+		}
+		ov_clear(&vf);
+	} else
+	{
+		supported = false;
+	}
+	return supported;
+
+#elif defined(MPT_WITH_STBVORBIS)
+
+	// NOTE/TODO: stb_vorbis does not handle inferred negative PCM sample
+	// position at stream start. (See
+	// <https://www.xiph.org/vorbis/doc/Vorbis_I_spec.html#x1-132000A.2>).
+	// This means that, for remuxed and re-aligned/cutted (at stream start)
+	// Vorbis files, stb_vorbis will include superfluous samples at the
+	// beginning. MO3 files with this property are yet to be spotted in the
+	// wild, thus, this behaviour is currently not problematic.
+
+	MPT_UNREFERENCED_PARAMETER(messages);
+	int consumed = 0, error = 0;
+	stb_vorbis *vorb = nullptr;
+	if(sharedHeader)
+	{
+		FileReader::PinnedRawDataView headChunkView = headerChunk.GetPinnedRawDataView(initialRead);
+		vorb = stb_vorbis_open_pushdata(mpt::byte_cast<const unsigned char*>(headChunkView.data()), mpt::saturate_cast<int>(headChunkView.size()), &consumed, &error, nullptr);
+		headerChunk.Skip(consumed);
+	}
+	FileReader::PinnedRawDataView sampleDataView = sampleData.GetPinnedRawDataView();
+	const mpt::byte* data = sampleDataView.data();
+	std::size_t dataLeft = sampleDataView.size();
+	if(!sharedHeader)
+	{
+		vorb = stb_vorbis_open_pushdata(mpt::byte_cast<const unsigned char*>(data), mpt::saturate_cast<int>(dataLeft), &consumed, &error, nullptr);
+		sampleData.Skip(consumed);
+		data += consumed;
+		dataLeft -= consumed;
+	}
+	if(vorb)
+	{
+		// Header has been read, proceed to reading the sample data
+		if(!sample.HasSampleData())
+			sample.AllocateSample();
+		SmpLength offset = 0;
+		while((error == VORBIS__no_error || (error == VORBIS_need_more_data && dataLeft > 0))
+			&& offset < sample.nLength && sample.HasSampleData())
+		{
+			int channels = 0, decodedSamples = 0;
+			float **output;
+			consumed = stb_vorbis_decode_frame_pushdata(vorb, mpt::byte_cast<const unsigned char*>(data), mpt::saturate_cast<int>(dataLeft), &channels, &output, &decodedSamples);
+			sampleData.Skip(consumed);
+			data += consumed;
+			dataLeft -= consumed;
+			LimitMax(decodedSamples, mpt::saturate_cast<int>(sample.nLength - offset));
+			if(decodedSamples > 0 && channels == sample.GetNumChannels())
+			{
+				for(int chn = 0; chn < channels; chn++)
+				{
+					if(sample.uFlags[CHN_16BIT])
+						CopyChannelToInterleaved<SC::Convert<int16, float> >(sample.sample16() + offset * sample.GetNumChannels(), output[chn], channels, decodedSamples, chn);
+					else
+						CopyChannelToInterleaved<SC::Convert<int8, float> >(sample.sample8() + offset * sample.GetNumChannels(), output[chn], channels, decodedSamples, chn);
+				}
+			}
+			offset += decodedSamples;
+			error = stb_vorbis_get_error(vorb);
+		}
+		stb_vorbis_close(vorb);
+		return true;
+	} else
+	{
+		return false;
+	}
+
+#else // !VORBIS
+
+	MPT_UNREFERENCED_PARAMETER(sample);
+	MPT_UNREFERENCED_PARAMETER(messages);
+	return false;
+
+#endif // VORBIS
+}
+
+
 struct MO3ContainerHeader
 {
 	char     magic[3];   // MO3
@@ -1298,6 +1662,13 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 		m_nInstruments = 0;
 
 	std::vector<MO3SampleChunk> sampleChunks(m_nSamples);
+	// Compressed samples are only decoded once all sample headers have been read, as they can be decoded independently
+	// (and thus in parallel). For this to be safe, they are decoded from memory rather than from the file itself.
+	std::vector<FileReader::PinnedRawDataView> pinnedSampleData;
+	std::vector<MO3SampleDecodeJob> decodeJobs;
+	std::vector<std::pair<SAMPLEINDEX, SAMPLEINDEX>> duplicateSamples;
+	if(loadFlags & loadSampleData)
+		pinnedSampleData.reserve(m_nSamples);
 
 	const bool frequencyIsHertz = (version >= 5 || !(fileHeader.flags & MO3FileHeader::linearSlides));
 	bool unsupportedSamples = false;
@@ -1339,21 +1710,15 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 				.ReadSample(Samples[smp], file);
 		} else if(smpHeader.compressedSize < 0 && (smp + smpHeader.compressedSize) > 0)
 		{
-			// Duplicate sample
-			const ModSample &smpFrom = Samples[smp + smpHeader.compressedSize];
-			LimitMax(sample.nLength, smpFrom.nLength);
-			sample.uFlags.set(CHN_16BIT, smpFrom.uFlags[CHN_16BIT]);
-			sample.uFlags.set(CHN_STEREO, smpFrom.uFlags[CHN_STEREO]);
-			if(smpFrom.HasSampleData() && sample.AllocateSample())
-			{
-				memcpy(sample.sampleb(), smpFrom.sampleb(), sample.GetSampleSizeInBytes());
-			}
+			// Duplicate sample, which is copied once the original sample has been decoded
+			duplicateSamples.push_back(std::make_pair(smp, static_cast<SAMPLEINDEX>(smp + smpHeader.compressedSize)));
 		} else if(smpHeader.compressedSize > 0)
 		{
 			if(smpHeader.flags & MO3Sample::smp16Bit) sample.uFlags.set(CHN_16BIT);
 			if(smpHeader.flags & MO3Sample::smpStereo) sample.uFlags.set(CHN_STEREO);
 
-			FileReader sampleData = file.ReadChunk(smpHeader.compressedSize);
+			pinnedSampleData.emplace_back(file, static_cast<std::size_t>(smpHeader.compressedSize), true);
+			FileReader sampleData(pinnedSampleData.back().GetSpan());
 			const uint8 numChannels = sample.GetNumChannels();
 
 			if(compression == MO3Sample::smpDeltaCompression || compression == MO3Sample::smpDeltaPrediction)
@@ -1367,30 +1732,12 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 				else
 					maxLength = Util::MaxValueOfType(maxLength);
 				LimitMax(sample.nLength, mpt::saturate_cast<SmpLength>(maxLength));
-			}
-
-			if(compression == MO3Sample::smpDeltaCompression)
-			{
-				if(sample.AllocateSample())
-				{
-					if(smpHeader.flags & MO3Sample::smp16Bit)
-						UnpackMO3DeltaSample<MO3Delta16BitParams>(sampleData, sample.sample16(), sample.nLength, numChannels);
-					else
-						UnpackMO3DeltaSample<MO3Delta8BitParams>(sampleData, sample.sample8(), sample.nLength, numChannels);
-				}
-			} else if(compression == MO3Sample::smpDeltaPrediction)
-			{
-				if(sample.AllocateSample())
-				{
-					if(smpHeader.flags & MO3Sample::smp16Bit)
-						UnpackMO3DeltaPredictionSample<MO3Delta16BitParams>(sampleData, sample.sample16(), sample.nLength, numChannels);
-					else
-						UnpackMO3DeltaPredictionSample<MO3Delta8BitParams>(sampleData, sample.sample8(), sample.nLength, numChannels);
-				}
+				decodeJobs.emplace_back(smp, compression, sampleData);
 			} else if(compression == MO3Sample::smpCompressionOgg || compression == MO3Sample::smpSharedOgg)
 			{
-				// Since shared Ogg headers can stem from a sample that has not been read yet, postpone Ogg import.
+				// Since shared Ogg headers can stem from a sample that has not been read yet, the sample chunks are kept around until decoding.
 				sampleChunks[smp - 1] = MO3SampleChunk(sampleData, smpHeader.encoderDelay, sharedOggHeader);
+				decodeJobs.emplace_back(smp, compression, sampleData);
 			} else if(compression == MO3Sample::smpCompressionMPEG)
 			{
 				// Old MO3 encoders didn't remove LAME info frames. This is unfortunate since the encoder delay
@@ -1409,20 +1756,7 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 					sampleData.Seek(frame.frameSize);
 					mpegData = sampleData.ReadChunk(sampleData.BytesLeft());
 				}
-				
-				if(ReadMP3Sample(smp, mpegData, true, true) || ReadMediaFoundationSample(smp, mpegData, true))
-				{
-					if(smpHeader.encoderDelay > 0 && smpHeader.encoderDelay < sample.GetSampleSizeInBytes())
-					{
-						SmpLength delay = smpHeader.encoderDelay / sample.GetBytesPerSample();
-						memmove(sample.sampleb(), sample.sampleb() + smpHeader.encoderDelay, sample.GetSampleSizeInBytes() - smpHeader.encoderDelay);
-						sample.nLength -= delay;
-					}
-					LimitMax(sample.nLength, smpHeader.length);
-				} else
-				{
-					unsupportedSamples = true;
-				}
+				decodeJobs.emplace_back(smp, compression, mpegData, smpHeader.length, smpHeader.encoderDelay);
 			} else
 			{
 				unsupportedSamples = true;
@@ -1430,332 +1764,196 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 		}
 	}
 
-	// Now we can load Ogg samples with shared headers.
-	if(loadFlags & loadSampleData)
+	// Duplicates of Ogg samples (and duplicates of those) never receive any sample data, as the Ogg samples have not been decoded yet
+	// at the point where the original sample is copied in the MO3 sample order.
+	std::vector<bool> oggSampleOrDuplicate(m_nSamples + 1, false);
+	for(const auto &job : decodeJobs)
 	{
-		for(SAMPLEINDEX smp = 1; smp <= m_nSamples; smp++)
-		{
-			MO3SampleChunk &sampleChunk = sampleChunks[smp - 1];
-			// Is this an Ogg sample?
-			if(!sampleChunk.chunk.IsValid())
-				continue;
-
-			SAMPLEINDEX sharedOggHeader = smp + sampleChunk.sharedHeader;
-			// Which chunk are we going to read the header from?
-			// Note: Every Ogg stream has a unique serial number.
-			// stb_vorbis (currently) ignores this serial number so we can just stitch
-			// together our sample without adjusting the shared header's serial number.
-			const bool sharedHeader = sharedOggHeader != smp && sharedOggHeader > 0 && sharedOggHeader <= m_nSamples;
+		if(job.compression == MO3Sample::smpCompressionOgg || job.compression == MO3Sample::smpSharedOgg)
+			oggSampleOrDuplicate[job.smp] = true;
+	}
 
-#if defined(MPT_WITH_VORBIS) && defined(MPT_WITH_VORBISFILE)
+#if (defined(MPT_WITH_VORBIS) && defined(MPT_WITH_VORBISFILE)) || defined(MPT_WITH_STBVORBIS)
+	if(m_lazySampleDecoding && std::find_if(decodeJobs.begin(), decodeJobs.end(), [](const MO3SampleDecodeJob &job) { return job.compression == MO3Sample::smpCompressionOgg || job.compression == MO3Sample::smpSharedOgg; }) != decodeJobs.end())
+	{
+		// Postpone decoding of Ogg samples until they are played for the first time. As the file data is not available anymore
+		// at that point, a private copy of the compressed data is kept until all of these samples have been decoded.
+		auto oggSamples = std::make_shared<MO3OggSampleData>();
+		std::size_t dataSize = 0;
+		for(const auto &chunk : sampleChunks)
+		{
+			dataSize += static_cast<std::size_t>(chunk.chunk.GetLength());
+		}
+		oggSamples->data.reserve(dataSize);
+		for(const auto &chunk : sampleChunks)
+		{
+			FileReader::PinnedRawDataView view = chunk.chunk.GetPinnedRawDataView();
+			oggSamples->data.insert(oggSamples->data.end(), view.begin(), view.end());
+		}
+		FileReader oggData(mpt::as_span(oggSamples->data));
+		oggSamples->chunks.reserve(sampleChunks.size());
+		for(const auto &chunk : sampleChunks)
+		{
+			FileReader chunkData = chunk.chunk.IsValid() ? oggData.ReadChunk(chunk.chunk.GetLength()) : FileReader();
+			oggSamples->chunks.push_back(MO3SampleChunk(chunkData, chunk.headerSize, chunk.sharedHeader));
+		}
 
-			std::vector<char> mergedData;
-			if(sharedHeader)
+		m_pendingSampleDecoders.resize(m_nSamples + 1);
+		for(const auto &job : decodeJobs)
+		{
+			if(job.compression != MO3Sample::smpCompressionOgg && job.compression != MO3Sample::smpSharedOgg)
+				continue;
+			// Memory for the sample is already allocated now, so that the sample is considered to be present until it is decoded.
+			if(!Samples[job.smp].AllocateSample())
+				continue;
+			const SAMPLEINDEX smp = job.smp;
+			m_pendingSampleDecoders[smp] = [smp, oggSamples](ModSample &sample, std::vector<std::pair<LogLevel, mpt::ustring>> &messages)
 			{
-				// Prepend the shared header to the actual sample data and adjust bitstream serial numbers.
-				// We do not handle multiple muxed logical streams as they do not exist in practice in mo3.
-				// We assume sequence numbers are consecutive at the end of the headers.
-				// Corrupted pages get dropped as required by Ogg spec. We cannot do any further sane parsing on them anyway.
-				// We do not match up multiple muxed stream properly as this would need parsing of actual packet data to determine or guess the codec.
-				// Ogg Vorbis files may contain at least an additional Ogg Skeleton stream. It is not clear whether these actually exist in MO3.
-				// We do not validate packet structure or logical bitstream structure (i.e. sequence numbers and granule positions).
-
-				// TODO: At least handle Skeleton streams here, as they violate our stream ordering assumptions here.
-
-#if 0
-				// This block may still turn out to be useful as it does a more thourough validation of the stream than the optimized version below.
-
-				// We copy the whole data into a single consecutive buffer in order to keep things simple when interfacing libvorbisfile.
-				// We could in theory only adjust the header and pass 2 chunks to libvorbisfile.
-				// Another option would be to demux both chunks on our own (or using libogg) and pass the raw packet data to libvorbis directly.
-
-				mpt::ostringstream mergedStream(std::ios::binary);
-				mergedStream.imbue(std::locale::classic());
-
-				sampleChunks[sharedOggHeader - 1].chunk.Rewind();
-				FileReader sharedChunk = sampleChunks[sharedOggHeader - 1].chunk.ReadChunk(sampleChunk.headerSize);
-				sharedChunk.Rewind();
-
-				std::vector<uint32> streamSerials;
-				Ogg::PageInfo oggPageInfo;
-				std::vector<uint8> oggPageData;
-
-				streamSerials.clear();
-				while(Ogg::ReadPageAndSkipJunk(sharedChunk, oggPageInfo, oggPageData))
-				{
-					auto it = std::find(streamSerials.begin(), streamSerials.end(), oggPageInfo.header.bitstream_serial_number);
-					if(it == streamSerials.end())
-					{
-						streamSerials.push_back(oggPageInfo.header.bitstream_serial_number);
-						it = streamSerials.begin() + (streamSerials.size() - 1);
-					}
-					uint32 newSerial = it - streamSerials.begin() + 1;
-					oggPageInfo.header.bitstream_serial_number = newSerial;
-					Ogg::UpdatePageCRC(oggPageInfo, oggPageData);
-					Ogg::WritePage(mergedStream, oggPageInfo, oggPageData);
-				}
-
-				streamSerials.clear();
-				while(Ogg::ReadPageAndSkipJunk(sampleChunk.chunk, oggPageInfo, oggPageData))
-				{
-					auto it = std::find(streamSerials.begin(), streamSerials.end(), oggPageInfo.header.bitstream_serial_number);
-					if(it == streamSerials.end())
-					{
-						streamSerials.push_back(oggPageInfo.header.bitstream_serial_number);
-						it = streamSerials.begin() + (streamSerials.size() - 1);
-					}
-					uint32 newSerial = it - streamSerials.begin() + 1;
-					oggPageInfo.header.bitstream_serial_number = newSerial;
-					Ogg::UpdatePageCRC(oggPageInfo, oggPageData);
-					Ogg::WritePage(mergedStream, oggPageInfo, oggPageData);
-				}
-
-				std::string mergedStreamData = mergedStream.str();
-				mergedData.insert(mergedData.end(), mergedStreamData.begin(), mergedStreamData.end());
-
-#else
-
-				// We assume same ordering of streams in both header and data if
-				// multiple streams are present.
-
-				mpt::ostringstream mergedStream(std::ios::binary);
-				mergedStream.imbue(std::locale::classic());
-
-				sampleChunks[sharedOggHeader - 1].chunk.Rewind();
-				FileReader sharedChunk = sampleChunks[sharedOggHeader - 1].chunk.ReadChunk(sampleChunk.headerSize);
-				sharedChunk.Rewind();
-
-				std::vector<uint32> dataStreamSerials;
-				std::vector<uint32> headStreamSerials;
-				Ogg::PageInfo oggPageInfo;
-				std::vector<uint8> oggPageData;
-
-				// Gather bitstream serial numbers form sample data chunk
-				dataStreamSerials.clear();
-				while(Ogg::ReadPageAndSkipJunk(sampleChunk.chunk, oggPageInfo, oggPageData))
-				{
-					auto it = std::find(dataStreamSerials.begin(), dataStreamSerials.end(), oggPageInfo.header.bitstream_serial_number);
-					if(it == dataStreamSerials.end())
-					{
-						dataStreamSerials.push_back(oggPageInfo.header.bitstream_serial_number);
-					}
-				}
-
-				// Apply the data bitstream serial numbers to the header
-				headStreamSerials.clear();
-				while(Ogg::ReadPageAndSkipJunk(sharedChunk, oggPageInfo, oggPageData))
-				{
-					auto it = std::find(headStreamSerials.begin(), headStreamSerials.end(), oggPageInfo.header.bitstream_serial_number);
-					if(it == headStreamSerials.end())
-					{
-						headStreamSerials.push_back(oggPageInfo.header.bitstream_serial_number);
-						it = headStreamSerials.begin() + (headStreamSerials.size() - 1);
-					}
-					uint32 newSerial = 0;
-					if(dataStreamSerials.size() >= static_cast<std::size_t>(it - headStreamSerials.begin()))
-					{
-						// Found corresponding stream in data chunk.
-						newSerial = dataStreamSerials[it - headStreamSerials.begin()];
-					} else
-					{
-						// No corresponding stream in data chunk. Find a free serialno.
-						std::size_t extraIndex = (it - headStreamSerials.begin()) - dataStreamSerials.size();
-						for(newSerial = 1; newSerial < 0xffffffffu; ++newSerial)
-						{
-							auto dss = std::find(dataStreamSerials.begin(), dataStreamSerials.end(), newSerial);
-							if(dss == dataStreamSerials.end())
-							{
-								extraIndex -= 1;
-							}
-							if(extraIndex == 0)
-							{
-								break;
-							}
-						}
-					}
-					oggPageInfo.header.bitstream_serial_number = newSerial;
-					Ogg::UpdatePageCRC(oggPageInfo, oggPageData);
-					Ogg::WritePage(mergedStream, oggPageInfo, oggPageData);
-				}
-
-				if(headStreamSerials.size() > 1)
-				{
-					AddToLog(LogWarning, mpt::format(U_("Sample %1: Ogg Vorbis data with shared header and multiple logical bitstreams in header chunk found. This may be handled incorrectly."))(smp));
-				} else if(dataStreamSerials.size() > 1)
-				{
-					AddToLog(LogWarning, mpt::format(U_("Sample %1: Ogg Vorbis sample with shared header and multiple logical bitstreams found. This may be handled incorrectly."))(smp));
-				} else if((dataStreamSerials.size() == 1) && (headStreamSerials.size() == 1) && (dataStreamSerials[0] != headStreamSerials[0]))
-				{
-					AddToLog(LogInformation, mpt::format(U_("Sample %1: Ogg Vorbis data with shared header and different logical bitstream serials found."))(smp));
-				}
-
-				std::string mergedStreamData = mergedStream.str();
-				mergedData.insert(mergedData.end(), mergedStreamData.begin(), mergedStreamData.end());
-
-				sampleChunk.chunk.Rewind();
-				FileReader::PinnedRawDataView sampleChunkView = sampleChunk.chunk.GetPinnedRawDataView();
-				mergedData.insert(mergedData.end(), mpt::byte_cast<const char*>(sampleChunkView.begin()), mpt::byte_cast<const char*>(sampleChunkView.end()));
-
+				return DecodeMO3OggSample(sample, smp, oggSamples->chunks, messages);
+			};
+		}
+		decodeJobs.erase(std::remove_if(decodeJobs.begin(), decodeJobs.end(), [](const MO3SampleDecodeJob &job) { return job.compression == MO3Sample::smpCompressionOgg || job.compression == MO3Sample::smpSharedOgg; }), decodeJobs.end());
+	}
 #endif
 
+	auto decodeSample = [this, &sampleChunks](MO3SampleDecodeJob &job)
+	{
+		ModSample &sample = Samples[job.smp];
+		const uint8 numChannels = sample.GetNumChannels();
+		switch(job.compression)
+		{
+		case MO3Sample::smpDeltaCompression:
+			if(sample.AllocateSample())
+			{
+				if(sample.uFlags[CHN_16BIT])
+					UnpackMO3DeltaSample<MO3Delta16BitParams>(job.data, sample.sample16(), sample.nLength, numChannels);
+				else
+					UnpackMO3DeltaSample<MO3Delta8BitParams>(job.data, sample.sample8(), sample.nLength, numChannels);
 			}
-			FileReader mergedDataChunk(mpt::byte_cast<mpt::const_byte_span>(mpt::as_span(mergedData)));
-
-			FileReader &sampleData = sharedHeader ? mergedDataChunk : sampleChunk.chunk;
-			FileReader &headerChunk = sampleData;
-
-#else // !(MPT_WITH_VORBIS && MPT_WITH_VORBISFILE)
-
-			FileReader &sampleData = sampleChunk.chunk;
-			FileReader &headerChunk = sharedHeader ? sampleChunks[sharedOggHeader - 1].chunk : sampleData;
-#if defined(MPT_WITH_STBVORBIS)
-			std::size_t initialRead = sharedHeader ? sampleChunk.headerSize : headerChunk.GetLength();
-#endif // MPT_WITH_STBVORBIS
-
-#endif // MPT_WITH_VORBIS && MPT_WITH_VORBISFILE
-
-			headerChunk.Rewind();
-			if(sharedHeader && !headerChunk.CanRead(sampleChunk.headerSize))
-				continue;
-
-#if defined(MPT_WITH_VORBIS) && defined(MPT_WITH_VORBISFILE)
+			job.decoded = true;
+			break;
+		case MO3Sample::smpDeltaPrediction:
+			if(sample.AllocateSample())
+			{
+				if(sample.uFlags[CHN_16BIT])
+					UnpackMO3DeltaPredictionSample<MO3Delta16BitParams>(job.data, sample.sample16(), sample.nLength, numChannels);
+				else
+					UnpackMO3DeltaPredictionSample<MO3Delta8BitParams>(job.data, sample.sample8(), sample.nLength, numChannels);
+			}
+			job.decoded = true;
+			break;
+		case MO3Sample::smpCompressionOgg:
+		case MO3Sample::smpSharedOgg:
+			job.decoded = DecodeMO3OggSample(sample, job.smp, sampleChunks, job.messages);
+			break;
+		case MO3Sample::smpCompressionMPEG:
+			// Media Foundation is only tried afterwards on the loading thread.
+			job.decoded = ReadMP3Sample(job.smp, job.data, true, true);
+			break;
+		}
+	};
 
-			ov_callbacks callbacks = {
-				&VorbisfileFilereaderRead,
-				&VorbisfileFilereaderSeek,
-				NULL,
-				&VorbisfileFilereaderTell
-			};
-			OggVorbis_File vf;
-			MemsetZero(vf);
-			if(ov_open_callbacks(&sampleData, &vf, nullptr, 0, callbacks) == 0)
+	uint32 numThreads = 1;
+#if defined(MPT_ENABLE_THREAD)
+	numThreads = m_sampleDecodeThreads;
+	if(numThreads == 0)
+		numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	numThreads = std::min(numThreads, static_cast<uint32>(decodeJobs.size()));
+	if(numThreads > 1)
+	{
+		// Every job only writes to its own sample, so the result does not depend on the order in which the jobs are run.
+		std::atomic<uint32> nextJob(0);
+		std::vector<std::exception_ptr> exceptions(numThreads);
+		const uint32 numJobs = static_cast<uint32>(decodeJobs.size());
+		auto decodeSamples = [&](uint32 thread)
+		{
+			try
 			{
-				if(ov_streams(&vf) == 1)
-				{ // we do not support chained vorbis samples
-					vorbis_info *vi = ov_info(&vf, -1);
-					if(vi && vi->rate > 0 && vi->channels > 0)
-					{
-						ModSample &sample = Samples[smp];
-						sample.AllocateSample();
-						SmpLength offset = 0;
-						int channels = vi->channels;
-						int current_section = 0;
-						long decodedSamples = 0;
-						bool eof = false;
-						while(!eof && offset < sample.nLength && sample.HasSampleData())
-						{
-							float **output = nullptr;
-							long ret = ov_read_float(&vf, &output, 1024, &current_section);
-							if(ret == 0)
-							{
-								eof = true;
-							} else if(ret < 0)
-							{
-								// stream error, just try to continue
-							} else
-							{
-								decodedSamples = ret;
-								LimitMax(decodedSamples, mpt::saturate_cast<long>(sample.nLength - offset));
-								if(decodedSamples > 0 && channels == sample.GetNumChannels())
-								{
-									for(int chn = 0; chn < channels; chn++)
-									{
-										if(sample.uFlags[CHN_16BIT])
-										{
-											CopyChannelToInterleaved<SC::Convert<int16, float> >(sample.sample16() + offset * sample.GetNumChannels(), output[chn], channels, decodedSamples, chn);
-										} else
-										{
-											CopyChannelToInterleaved<SC::Convert<int8, float> >(sample.sample8() + offset * sample.GetNumChannels(), output[chn], channels, decodedSamples, chn);
-										}
-									}
-								}
-								offset += decodedSamples;
-							}
-						}
-					} else
-					{
-						unsupportedSamples = true;
-					}
-				} else
+				for(uint32 job = nextJob++; job < numJobs; job = nextJob++)
 				{
-					AddToLog(LogWarning, mpt::format(U_("Sample %1: Unsupported Ogg Vorbis chained stream found."))(smp));
-					unsupportedSamples = true;
+					decodeSample(decodeJobs[job]);
 				}
-				ov_clear(&vf);
-			} else
+			} catch(...)
 			{
-				unsupportedSamples = true;
+				exceptions[thread] = std::current_exception();
+				// Make the other threads stop early
+				nextJob = numJobs;
 			}
+		};
 
-#elif defined(MPT_WITH_STBVORBIS)
-
-			// NOTE/TODO: stb_vorbis does not handle inferred negative PCM sample
-			// position at stream start. (See
-			// <https://www.xiph.org/vorbis/doc/Vorbis_I_spec.html#x1-132000A.2>).
-			// This means that, for remuxed and re-aligned/cutted (at stream start)
-			// Vorbis files, stb_vorbis will include superfluous samples at the
-			// beginning. MO3 files with this property are yet to be spotted in the
-			// wild, thus, this behaviour is currently not problematic.
-
-			int consumed = 0, error = 0;
-			stb_vorbis *vorb = nullptr;
-			if(sharedHeader)
-			{
-				FileReader::PinnedRawDataView headChunkView = headerChunk.GetPinnedRawDataView(initialRead);
-				vorb = stb_vorbis_open_pushdata(mpt::byte_cast<const unsigned char*>(headChunkView.data()), mpt::saturate_cast<int>(headChunkView.size()), &consumed, &error, nullptr);
-				headerChunk.Skip(consumed);
-			}
-			FileReader::PinnedRawDataView sampleDataView = sampleData.GetPinnedRawDataView();
-			const mpt::byte* data = sampleDataView.data();
-			std::size_t dataLeft = sampleDataView.size();
-			if(!sharedHeader)
+		std::vector<std::thread> workers;
+		workers.reserve(numThreads - 1);
+		try
+		{
+			for(uint32 thread = 1; thread < numThreads; thread++)
 			{
-				vorb = stb_vorbis_open_pushdata(mpt::byte_cast<const unsigned char*>(data), mpt::saturate_cast<int>(dataLeft), &consumed, &error, nullptr);
-				sampleData.Skip(consumed);
-				data += consumed;
-				dataLeft -= consumed;
+				workers.emplace_back(decodeSamples, thread);
 			}
-			if(vorb)
+		} MPT_EXCEPTION_CATCH_OUT_OF_MEMORY(e)
+		{
+			MPT_EXCEPTION_DELETE_OUT_OF_MEMORY(e);
+		} catch(const std::system_error &)
+		{
+			// Continue with fewer threads
+		}
+		decodeSamples(0);
+		for(auto &worker : workers)
+		{
+			worker.join();
+		}
+		for(const auto &e : exceptions)
+		{
+			if(e)
+				std::rethrow_exception(e);
+		}
+	}
+#endif // MPT_ENABLE_THREAD
+	if(numThreads <= 1)
+	{
+		for(auto &job : decodeJobs)
+		{
+			decodeSample(job);
+		}
+	}
+
+	// Finish decoding in sample order, so that the log messages do not depend on the number of threads.
+	for(auto &job : decodeJobs)
+	{
+		if(job.compression == MO3Sample::smpCompressionMPEG)
+		{
+			ModSample &sample = Samples[job.smp];
+			if(!job.decoded)
+				job.decoded = ReadMediaFoundationSample(job.smp, job.data, true);
+			if(job.decoded)
 			{
-				// Header has been read, proceed to reading the sample data
-				ModSample &sample = Samples[smp];
-				sample.AllocateSample();
-				SmpLength offset = 0;
-				while((error == VORBIS__no_error || (error == VORBIS_need_more_data && dataLeft > 0))
-					&& offset < sample.nLength && sample.HasSampleData())
+				if(job.encoderDelay > 0 && job.encoderDelay < sample.GetSampleSizeInBytes())
 				{
-					int channels = 0, decodedSamples = 0;
-					float **output;
-					consumed = stb_vorbis_decode_frame_pushdata(vorb, mpt::byte_cast<const unsigned char*>(data), mpt::saturate_cast<int>(dataLeft), &channels, &output, &decodedSamples);
-					sampleData.Skip(consumed);
-					data += consumed;
-					dataLeft -= consumed;
-					LimitMax(decodedSamples, mpt::saturate_cast<int>(sample.nLength - offset));
-					if(decodedSamples > 0 && channels == sample.GetNumChannels())
-					{
-						for(int chn = 0; chn < channels; chn++)
-						{
-							if(sample.uFlags[CHN_16BIT])
-								CopyChannelToInterleaved<SC::Convert<int16, float> >(sample.sample16() + offset * sample.GetNumChannels(), output[chn], channels, decodedSamples, chn);
-							else
-								CopyChannelToInterleaved<SC::Convert<int8, float> >(sample.sample8() + offset * sample.GetNumChannels(), output[chn], channels, decodedSamples, chn);
-						}
-					}
-					offset += decodedSamples;
-					error = stb_vorbis_get_error(vorb);
+					SmpLength delay = job.encoderDelay / sample.GetBytesPerSample();
+					memmove(sample.sampleb(), sample.sampleb() + job.encoderDelay, sample.GetSampleSizeInBytes() - job.encoderDelay);
+					sample.nLength -= delay;
 				}
-				stb_vorbis_close(vorb);
-			} else
-			{
-				unsupportedSamples = true;
+				LimitMax(sample.nLength, job.length);
 			}
-
-#else // !VORBIS
-
+		}
+		for(const auto &message : job.messages)
+		{
+			AddToLog(message.first, message.second);
+		}
+		if(!job.decoded)
 			unsupportedSamples = true;
+	}
 
-#endif // VORBIS
-		}
+	for(const auto &duplicate : duplicateSamples)
+	{
+		ModSample &sample = Samples[duplicate.first];
+		const ModSample &smpFrom = Samples[duplicate.second];
+		LimitMax(sample.nLength, smpFrom.nLength);
+		sample.uFlags.set(CHN_16BIT, smpFrom.uFlags[CHN_16BIT]);
+		sample.uFlags.set(CHN_STEREO, smpFrom.uFlags[CHN_STEREO]);
+		if(oggSampleOrDuplicate[duplicate.second])
+			oggSampleOrDuplicate[duplicate.first] = true;
+		else if(smpFrom.HasSampleData() && sample.AllocateSample())
+			memcpy(sample.sampleb(), smpFrom.sampleb(), sample.GetSampleSizeInBytes());
 	}
 
 	if(m_nType == MOD_TYPE_XM)
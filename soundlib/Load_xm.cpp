@@ -234,10 +234,14 @@ static std::vector<SAMPLEINDEX> AllocateXMSamples(CSoundFile &sndFile, SAMPLEIND
 
 
 // Read .XM patterns
-static void ReadXMPatterns(FileReader &file, const XMFileHeader &fileHeader, CSoundFile &sndFile)
+// If loadData is false, the patterns are only skipped.
+static void ReadXMPatterns(FileReader &file, const XMFileHeader &fileHeader, CSoundFile &sndFile, bool loadData)
 {
 	// Reading patterns
-	sndFile.Patterns.ResizeArray(fileHeader.patterns);
+	if(loadData)
+	{
+		sndFile.Patterns.ResizeArray(fileHeader.patterns);
+	}
 	for(PATTERNINDEX pat = 0; pat < fileHeader.patterns; pat++)
 	{
 		FileReader::off_t curPos = file.GetPosition();
@@ -265,7 +269,7 @@ static void ReadXMPatterns(FileReader &file, const XMFileHeader &fileHeader, CSo
 		file.Seek(curPos + headerSize);
 		FileReader patternChunk = file.ReadChunk(packedSize);
 
-		if(!sndFile.Patterns.Insert(pat, numRows) || packedSize == 0)
+		if(!loadData || !sndFile.Patterns.Insert(pat, numRows) || packedSize == 0)
 		{
 			continue;
 		}
@@ -688,7 +692,8 @@ bool CSoundFile::ReadXM(FileReader &file, ModLoadingFlags loadFlags)
 
 	if(fileHeader.version >= 0x0104)
 	{
-		ReadXMPatterns(file, fileHeader, *this);
+		// Patterns are stored before the instruments, so they always have to be skipped at least
+		ReadXMPatterns(file, fileHeader, *this, (loadFlags & loadPatternData) != 0);
 	}
 
 	bool isOXM = false;
@@ -857,7 +862,7 @@ bool CSoundFile::ReadXM(FileReader &file, ModLoadingFlags loadFlags)
 		// Load Patterns and Samples (Version 1.02 and 1.03)
 		if(loadFlags & (loadPatternData | loadSampleData))
 		{
-			ReadXMPatterns(file, fileHeader, *this);
+			ReadXMPatterns(file, fileHeader, *this, (loadFlags & loadPatternData) != 0);
 		}
 
 		if(loadFlags & loadSampleData)
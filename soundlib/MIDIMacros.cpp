@@ -136,7 +136,8 @@ void MIDIMacroConfig::CreateFixedMacro(Macro (&fixedMacros)[128], FixedMacro mac
 			continue;
 		}
 
-		mpt::String::WriteAutoBuf(fixedMacros[i]) = mpt::format(str)(mpt::fmt::HEX0<2>(param));
+		// Formatting is comparatively expensive, and this is done for every newly created module
+		mpt::String::WriteAutoBuf(fixedMacros[i]) = (*str != '\0') ? mpt::format(str)(mpt::fmt::HEX0<2>(param)) : std::string();
 	}
 }
 
@@ -57,20 +57,75 @@ namespace MixFuncTable
 	BuildMixFuncTableFilter(resampling, NoFilter), \
 	BuildMixFuncTableFilter(resampling, ResonantFilter)
 
-const MixFuncInterface Functions[6 * 16] =
+// Build mix function tables for all resampling modes, with specific implementations of the multi-tap interpolators
+#define BuildMixFuncTableSet(fastSinc, polyphase, firFilter) \
+	{ \
+		BuildMixFuncTable(NoInterpolation),			/* No SRC */ \
+		BuildMixFuncTable(LinearInterpolation),		/* Linear SRC */ \
+		BuildMixFuncTable(fastSinc),				/* Fast Sinc (Cubic Spline) SRC */ \
+		BuildMixFuncTable(polyphase),				/* Kaiser SRC */ \
+		BuildMixFuncTable(firFilter),				/* FIR SRC */ \
+		BuildMixFuncTable(AmigaBlepInterpolation),	/* Amiga emulation */ \
+	}
+
+#define BuildMixFuncTableGeneric() \
+	BuildMixFuncTableSet(FastSincInterpolation, PolyphaseInterpolation, FIRFilterInterpolation)
+
+const MixFuncInterface Functions[numInstructionSets][6 * 16] =
+{
+	BuildMixFuncTableGeneric(),
+#if defined(MPT_INTMIXER) && defined(ENABLE_SSE2_INTRINSICS)
+	BuildMixFuncTableSet(FastSincInterpolationSSE2, PolyphaseInterpolationSSE2, FIRFilterInterpolationSSE2),
+#else
+	BuildMixFuncTableGeneric(),
+#endif
+#if defined(MPT_INTMIXER) && defined(ENABLE_SSE2_INTRINSICS) && defined(ENABLE_SSE4)
+	BuildMixFuncTableSet(FastSincInterpolationSSE4_1, PolyphaseInterpolationSSE4_1, FIRFilterInterpolationSSE4_1),
+#else
+	BuildMixFuncTableGeneric(),
+#endif
+#if defined(MPT_INTMIXER) && defined(ENABLE_SSE2_INTRINSICS) && defined(ENABLE_SSE4) && defined(ENABLE_AVX2)
+	BuildMixFuncTableSet(FastSincInterpolationSSE4_1, PolyphaseInterpolationAVX2, FIRFilterInterpolationAVX2),
+#else
+	BuildMixFuncTableGeneric(),
+#endif
+};
+
+
+
+#ifdef MPT_INTMIXER
+
+// Build multi-voice mix function table for given resampling settings: One function each for 8-Bit / 16-Bit Mono / Stereo
+#define BuildMultiVoiceFuncTable(resampling) \
+	MultiVoiceSampleLoop<I8M, resampling<I8M>, MixMonoNoRamp<I8M>, numMultiVoices>, \
+	MultiVoiceSampleLoop<I16M, resampling<I16M>, MixMonoNoRamp<I16M>, numMultiVoices>, \
+	MultiVoiceSampleLoop<I8S, resampling<I8S>, MixStereoNoRamp<I8S>, numMultiVoices>, \
+	MultiVoiceSampleLoop<I16S, resampling<I16S>, MixStereoNoRamp<I16S>, numMultiVoices>
+
+#define NoMultiVoiceFuncTable() \
+	nullptr, nullptr, nullptr, nullptr
+
+const MixMultiVoiceFuncInterface MultiVoiceFunctions[6 * 4] =
 {
-	BuildMixFuncTable(NoInterpolation),			// No SRC
-	BuildMixFuncTable(LinearInterpolation),		// Linear SRC
-	BuildMixFuncTable(FastSincInterpolation),	// Fast Sinc (Cubic Spline) SRC
-	BuildMixFuncTable(PolyphaseInterpolation),	// Kaiser SRC
-	BuildMixFuncTable(FIRFilterInterpolation),	// FIR SRC
-	BuildMixFuncTable(AmigaBlepInterpolation),	// Amiga emulation
+	BuildMultiVoiceFuncTable(NoInterpolation),		/* No SRC */
+	BuildMultiVoiceFuncTable(LinearInterpolation),	/* Linear SRC */
+	NoMultiVoiceFuncTable(),						/* Fast Sinc (Cubic Spline) SRC */
+	NoMultiVoiceFuncTable(),						/* Kaiser SRC */
+	NoMultiVoiceFuncTable(),						/* FIR SRC */
+	NoMultiVoiceFuncTable(),						/* Amiga emulation */
 };
 
+#undef BuildMultiVoiceFuncTable
+#undef NoMultiVoiceFuncTable
+
+#endif // MPT_INTMIXER
+
 
 #undef BuildMixFuncTableRamp
 #undef BuildMixFuncTableFilter
 #undef BuildMixFuncTable
+#undef BuildMixFuncTableSet
+#undef BuildMixFuncTableGeneric
 
 
 ResamplingIndex ResamplingModeToMixFlags(ResamplingMode resamplingMode)
@@ -88,6 +143,24 @@ ResamplingIndex ResamplingModeToMixFlags(ResamplingMode resamplingMode)
 	return ndxNoInterpolation;
 }
 
+
+InstructionSetIndex GetInstructionSetIndex()
+{
+#if defined(MPT_INTMIXER) && defined(ENABLE_SSE2_INTRINSICS)
+#if defined(ENABLE_SSE4) && defined(ENABLE_AVX2)
+	if((GetProcSupport() & (PROCSUPPORT_SSE4_1 | PROCSUPPORT_AVX2)) == (PROCSUPPORT_SSE4_1 | PROCSUPPORT_AVX2))
+		return isAVX2;
+#endif // ENABLE_SSE4 && ENABLE_AVX2
+#if defined(ENABLE_SSE4)
+	if(GetProcSupport() & PROCSUPPORT_SSE4_1)
+		return isSSE4_1;
+#endif // ENABLE_SSE4
+	if(CanUseSSE2())
+		return isSSE2;
+#endif // MPT_INTMIXER && ENABLE_SSE2_INTRINSICS
+	return isGeneric;
+}
+
 } // namespace MixFuncTable
 
 OPENMPT_NAMESPACE_END
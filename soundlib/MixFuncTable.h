@@ -19,6 +19,7 @@ OPENMPT_NAMESPACE_BEGIN
 namespace MixFuncTable
 {
 	// Table index:
+	//	first dimension: instruction set (see InstructionSetIndex)
 	//	[b1-b0]	format (8-bit-mono, 16-bit-mono, 8-bit-stereo, 16-bit-stereo)
 	//	[b2]	ramp
 	//	[b3]	filter
@@ -44,9 +45,38 @@ namespace MixFuncTable
 		ndxAmigaBlep		= 0x50,
 	};
 
-	extern const MixFuncInterface Functions[6 * 16];
+	// Instruction set index (first table dimension)
+	enum InstructionSetIndex
+	{
+		isGeneric = 0,
+		isSSE2,
+		isSSE4_1,
+		isAVX2,
+		numInstructionSets
+	};
+
+	extern const MixFuncInterface Functions[numInstructionSets][6 * 16];
+
+#ifdef MPT_INTMIXER
+	// Number of voices that are mixed together by the functions in MultiVoiceFunctions
+	enum : int { numMultiVoices = 2 };
+
+	// Table index:
+	//	[b1-b0]	format (8-bit-mono, 16-bit-mono, 8-bit-stereo, 16-bit-stereo)
+	//	[b4-b2]	src type
+	// There are no ramping or filter variants, see MultiVoiceSampleLoop.
+	// Entries are nullptr for resampling modes that are limited by the interpolation itself rather than by accessing the mix buffer,
+	// as mixing several voices at once is not faster for them. For the same reason, there are no instruction set specific variants.
+	extern const MixMultiVoiceFuncInterface MultiVoiceFunctions[6 * 4];
+
+	// Convert an index into Functions (without ramp or filter flags) into an index into MultiVoiceFunctions
+	inline uint32 ToMultiVoiceIndex(uint32 functionNdx) { return ((functionNdx & 0x70) >> 2) | (functionNdx & (ndx16Bit | ndxStereo)); }
+#endif // MPT_INTMIXER
 
 	ResamplingIndex ResamplingModeToMixFlags(ResamplingMode resamplingMode);
+
+	// Returns the best mix function set supported by the current CPU
+	InstructionSetIndex GetInstructionSetIndex();
 }
 
 OPENMPT_NAMESPACE_END
@@ -0,0 +1,128 @@
+/*
+ * MixThreadPool.cpp
+ * -----------------
+ * Purpose: Persistent worker threads for mixing the channels of a single chunk in parallel.
+ * Notes  : The threads are created once and then wait for work, as the mixer only renders small chunks at a time
+ *          and creating threads for each of them would be far too expensive.
+ *          Each worker thread mixes into its own set of buffers. The caller is responsible for summing up the
+ *          buffers in a fixed order afterwards, so that the output does not depend on thread scheduling.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+#include "MixThreadPool.h"
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+#if defined(MPT_ENABLE_THREAD)
+
+MixThreadPool::MixThreadPool(uint32 numThreads, uint32 blockSize)
+{
+	MPT_ASSERT(numThreads > 1);
+	m_buffers.resize(numThreads - 1);
+	m_workers.reserve(numThreads - 1);
+	try
+	{
+		for(uint32 thread = 1; thread < numThreads; thread++)
+		{
+			m_workers.emplace_back(&MixThreadPool::WorkerThread, this, thread);
+		}
+	} MPT_EXCEPTION_CATCH_OUT_OF_MEMORY(e)
+	{
+		MPT_EXCEPTION_DELETE_OUT_OF_MEMORY(e);
+	} catch(const std::system_error &)
+	{
+		// Continue with fewer threads
+	}
+	m_buffers.resize(m_workers.size());
+	SetBlockSize(blockSize);
+}
+
+
+void MixThreadPool::SetBlockSize(uint32 blockSize)
+{
+	for(auto &buffers : m_buffers)
+	{
+		buffers.dry.resize(blockSize * 2);
+		buffers.rear.resize(blockSize * 2);
+		buffers.reverb.resize(blockSize * 2);
+	}
+}
+
+
+MixThreadPool::~MixThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_shutdown = true;
+	}
+	m_jobsAvailable.notify_all();
+	for(auto &worker : m_workers)
+	{
+		worker.join();
+	}
+}
+
+
+void MixThreadPool::Run(uint32 numJobs, const std::function<void(uint32)> &job)
+{
+	MPT_ASSERT(numJobs <= GetNumThreads());
+	if(numJobs > 1)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_job = &job;
+			m_numJobs = numJobs;
+			m_jobsPending = numJobs - 1;
+			m_generation++;
+		}
+		m_jobsAvailable.notify_all();
+	}
+
+	if(numJobs > 0)
+	{
+		job(0);
+	}
+
+	if(numJobs > 1)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_jobsDone.wait(lock, [this] { return m_jobsPending == 0; });
+		m_job = nullptr;
+	}
+}
+
+
+void MixThreadPool::WorkerThread(uint32 thread)
+{
+	uint64 generation = 0;
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for(;;)
+	{
+		m_jobsAvailable.wait(lock, [this, generation] { return m_shutdown || m_generation != generation; });
+		if(m_shutdown)
+		{
+			return;
+		}
+		generation = m_generation;
+		if(thread < m_numJobs)
+		{
+			const auto &job = *m_job;
+			lock.unlock();
+			job(thread);
+			lock.lock();
+			if(--m_jobsPending == 0)
+			{
+				m_jobsDone.notify_one();
+			}
+		}
+	}
+}
+
+#endif // MPT_ENABLE_THREAD
+
+
+OPENMPT_NAMESPACE_END
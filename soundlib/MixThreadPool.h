@@ -0,0 +1,79 @@
+/*
+ * MixThreadPool.h
+ * ---------------
+ * Purpose: Persistent worker threads for mixing the channels of a single chunk in parallel.
+ * Notes  : See implementation file.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+#include "BuildSettings.h"
+
+#include "Mixer.h"
+
+#if defined(MPT_ENABLE_THREAD)
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+#endif // MPT_ENABLE_THREAD
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+#if defined(MPT_ENABLE_THREAD)
+
+// Private mix buffers of a worker thread, which are summed into the real mix buffers once all threads are done.
+struct MixThreadBuffers
+{
+	std::vector<mixsample_t> dry, rear, reverb;
+	mixsample_t dryOfsR, dryOfsL;
+	mixsample_t reverbOfsR, reverbOfsL;
+	bool dryUsed, rearUsed, reverbUsed;
+};
+
+
+class MixThreadPool
+{
+public:
+	// numThreads includes the calling thread, i.e. numThreads - 1 worker threads are created.
+	// blockSize is the maximum number of frames mixed at once.
+	MixThreadPool(uint32 numThreads, uint32 blockSize);
+	~MixThreadPool();
+
+	uint32 GetNumThreads() const { return static_cast<uint32>(m_workers.size()) + 1; }
+
+	// Resize the worker mix buffers. Must not be called while jobs are running.
+	void SetBlockSize(uint32 blockSize);
+
+	// Mix buffers of the given worker thread (1...GetNumThreads() - 1). Thread 0 (the calling thread) mixes into the real buffers.
+	MixThreadBuffers &GetBuffers(uint32 thread) { return m_buffers[thread - 1]; }
+
+	// Calls job(i) for all i in [0, numJobs), with numJobs <= GetNumThreads().
+	// Job 0 is executed on the calling thread. Returns once all jobs have finished.
+	void Run(uint32 numJobs, const std::function<void(uint32)> &job);
+
+protected:
+	void WorkerThread(uint32 thread);
+
+	std::vector<std::thread> m_workers;
+	std::vector<MixThreadBuffers> m_buffers;
+
+	std::mutex m_mutex;
+	std::condition_variable m_jobsAvailable, m_jobsDone;
+	const std::function<void(uint32)> *m_job = nullptr;
+	uint64 m_generation = 0;
+	uint32 m_numJobs = 0;
+	uint32 m_jobsPending = 0;
+	bool m_shutdown = false;
+};
+
+#endif // MPT_ENABLE_THREAD
+
+
+OPENMPT_NAMESPACE_END
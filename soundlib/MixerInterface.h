@@ -106,4 +106,74 @@ static void SampleLoop(ModChannel &chn, const CResampler &resampler, typename Tr
 // Type of the SampleLoop function above
 typedef void (*MixFuncInterface)(ModChannel &, const CResampler &, mixsample_t *, unsigned int);
 
+
+// Render loop for mixing several voices that use the same sample format and interpolation at once.
+// The voices are summed up before being added to the output buffer, so that every sampling point in the output buffer
+// is only read and written once instead of once per voice.
+// Ramping and filters are not supported, and all voices must be able to render numSamples samples without reaching
+// a loop or sample boundary (see MixLoopState::GetSampleCount).
+// As the output buffer is modified in one go, the contribution of each voice to the last sampling point is stored
+// in its nROfs / nLOfs members for click removal, like CSoundFile::MixChannel does.
+template<class Traits, class InterpolationFunc, class MixFunc, int numVoices>
+static void MultiVoiceSampleLoop(ModChannel * const *chn, const CResampler &resampler, typename Traits::output_t * MPT_RESTRICT outBuffer, unsigned int numSamples)
+{
+	static_assert(static_cast<int>(Traits::numChannelsOut) == 2, "Click removal expects stereo output");
+	MPT_ASSERT(numSamples > 0);
+
+	const typename Traits::input_t *inSample[numVoices];
+	InterpolationFunc interpolate[numVoices];
+	MixFunc mix[numVoices];
+	SamplePosition smpPos[numVoices];
+	SamplePosition increment[numVoices];
+
+	for(int v = 0; v < numVoices; v++)
+	{
+		ModChannel &c = *chn[v];
+		inSample[v] = static_cast<const typename Traits::input_t *>(c.pCurrentSample);
+		interpolate[v].Start(c, resampler);
+		mix[v].Start(c);
+		smpPos[v] = c.position;
+		increment[v] = c.increment;
+	}
+
+	for(unsigned int samples = numSamples - 1; samples > 0; samples--)
+	{
+		typename Traits::output_t mixed[Traits::numChannelsOut] = { 0 };
+		for(int v = 0; v < numVoices; v++)
+		{
+			typename Traits::outbuf_t outSample;
+			interpolate[v](outSample, inSample[v] + smpPos[v].GetInt() * Traits::numChannelsIn, smpPos[v].GetFract());
+			mix[v](outSample, *chn[v], mixed);
+			smpPos[v] += increment[v];
+		}
+		for(int i = 0; i < Traits::numChannelsOut; i++)
+		{
+			outBuffer[i] += mixed[i];
+		}
+		outBuffer += Traits::numChannelsOut;
+	}
+
+	// Last sampling point: Keep track of the individual contributions
+	for(int v = 0; v < numVoices; v++)
+	{
+		ModChannel &c = *chn[v];
+		typename Traits::outbuf_t outSample;
+		typename Traits::output_t mixed[Traits::numChannelsOut] = { 0 };
+		interpolate[v](outSample, inSample[v] + smpPos[v].GetInt() * Traits::numChannelsIn, smpPos[v].GetFract());
+		mix[v](outSample, c, mixed);
+		smpPos[v] += increment[v];
+		outBuffer[0] += mixed[0];
+		outBuffer[1] += mixed[1];
+		c.nROfs = mixed[0];
+		c.nLOfs = mixed[1];
+
+		mix[v].End(c);
+		interpolate[v].End(c);
+		c.position = smpPos[v];
+	}
+}
+
+// Type of the MultiVoiceSampleLoop function above
+typedef void (*MixMultiVoiceFuncInterface)(ModChannel * const *, const CResampler &, mixsample_t *, unsigned int);
+
 OPENMPT_NAMESPACE_END
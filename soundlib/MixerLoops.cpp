@@ -256,6 +256,15 @@ void InitMixBuffer(mixsample_t *pBuffer, uint32 nSamples)
 	memset(pBuffer, 0, nSamples * sizeof(mixsample_t));
 }
 
+
+void AddMixBuffer(mixsample_t * MPT_RESTRICT pDest, const mixsample_t * MPT_RESTRICT pSrc, uint32 nSamples)
+{
+	for(uint32 i = 0; i < nSamples; i++)
+	{
+		pDest[i] += pSrc[i];
+	}
+}
+
 #if MPT_COMPILER_MSVC
 #pragma warning(disable:4731) // ebp modified
 #endif
@@ -29,6 +29,7 @@ void ApplyGain(float *outputBuffer, float * const *outputBuffers, std::size_t of
 #endif // !MODPLUG_TRACKER
 
 void InitMixBuffer(mixsample_t *pBuffer, uint32 nSamples);
+void AddMixBuffer(mixsample_t *pDest, const mixsample_t *pSrc, uint32 nSamples);
 void InterleaveFrontRear(mixsample_t *pFrontBuf, mixsample_t *pRearBuf, uint32 nFrames);
 void MonoFromStereo(mixsample_t *pMixBuf, uint32 nSamples);
 
@@ -39,9 +39,13 @@ struct ModChannel
 	};
 
 	// Information used in the mixer (should be kept tight for better caching)
+	// Everything that is accessed for every mixed chunk of a playing voice is placed in the first 128 bytes,
+	// so that mixing many NNA voices only touches a few cache lines per voice. ModChannel is not aligned to cache lines,
+	// so depending on where a voice is located in memory, these 128 bytes may still be spread over three cache lines.
 	SamplePosition position;	// Current play position (fixed point)
 	SamplePosition increment;	// Sample speed relative to mixing frequency (fixed point)
 	const void *pCurrentSample;	// Currently playing sample (nullptr if no sample is playing)
+	const ModSample *pModSample;	// Currently assigned sample slot (may already be stopped)
 	int32 leftVol;			// 0...4096 (12 bits, since 16 bits + 12 bits = 28 bits = 0dB in integer mixer, see MIXING_ATTENUATION)
 	int32 rightVol;			// Ditto
 	int32 leftRamp;			// Ramping delta, 20.12 fixed point (see VOLUMERAMPPRECISION)
@@ -58,8 +62,9 @@ struct ModChannel
 	FlagSet<ChannelFlags> dwFlags;
 	mixsample_t nROfs, nLOfs;
 	uint32 nRampLength;
+	int32 newLeftVol, newRightVol;	// Target volume of current ramp
+	ResamplingMode resamplingMode;
 
-	const ModSample *pModSample;			// Currently assigned sample slot (may already be stopped)
 	Paula::State paulaState;
 
 	// Information not used in the mixer
@@ -67,7 +72,6 @@ struct ModChannel
 	SmpLength prevNoteOffset;				// Offset for instrument-less notes for ProTracker/ScreamTracker
 	SmpLength oldOffset;
 	FlagSet<ChannelFlags> dwOldFlags;		// Flags from previous tick
-	int32 newLeftVol, newRightVol;
 	int32 nRealVolume, nRealPan;
 	int32 nVolume, nPan, nFadeOutVol;
 	int32 nPeriod, nC5Speed, nPortamentoDest;
@@ -87,7 +91,6 @@ struct ModChannel
 	CHANNELINDEX nMasterChn;
 	ModCommand rowCommand;
 	// 8-bit members
-	ResamplingMode resamplingMode;
 	uint8 nRestoreResonanceOnNewNote;	// See nRestorePanOnNewNote
 	uint8 nRestoreCutoffOnNewNote;		// ditto
 	uint8 nNote;
@@ -191,6 +194,17 @@ struct ModChannel
 	void UpdateInstrumentVolume(const ModSample *smp, const ModInstrument *ins);
 };
 
+// The mixer state must not grow past the first 128 bytes (see above).
+// ModChannel is not standard-layout, but it has no virtual functions or bases, so offsetof works with all supported compilers.
+#if MPT_COMPILER_GCC || MPT_COMPILER_CLANG
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winvalid-offsetof"
+#endif
+MPT_STATIC_ASSERT(offsetof(ModChannel, resamplingMode) + sizeof(ModChannel::resamplingMode) <= 128);
+#if MPT_COMPILER_GCC || MPT_COMPILER_CLANG
+#pragma GCC diagnostic pop
+#endif
+
 
 // Default pattern channel settings
 struct ModChannelSettings
@@ -14,6 +14,7 @@
 #include "modsmp_ctrl.h"
 
 #include <cmath>
+#include <cstdlib>
 
 
 OPENMPT_NAMESPACE_BEGIN
@@ -189,10 +190,11 @@ void *ModSample::AllocateSample(SmpLength numFrames, size_t bytesPerSample)
 
 	if(allocSize != 0)
 	{
-		char *p = new (std::nothrow) char[allocSize];
+		// calloc can hand out memory that is known to be zero already (e.g. fresh pages from the OS for large buffers),
+		// so large samples do not have to be silenced in an extra pass before their sample data is copied over.
+		char *p = static_cast<char *>(calloc(allocSize, 1));
 		if(p != nullptr)
 		{
-			memset(p, 0, allocSize);
 			return p + (InterpolationMaxLookahead * MaxSamplingPointSize);
 		}
 	}
@@ -239,7 +241,7 @@ void ModSample::FreeSample(void *samplePtr)
 {
 	if(samplePtr)
 	{
-		delete[] (((char *)samplePtr) - (InterpolationMaxLookahead * MaxSamplingPointSize));
+		free(((char *)samplePtr) - (InterpolationMaxLookahead * MaxSamplingPointSize));
 	}
 }
 
@@ -13,7 +13,12 @@
 #include "BuildSettings.h"
 
 
+#include "../common/Endianness.h"
 #include "../soundbase/SampleFormatCopy.h"
+#include "../soundbase/SampleFormatCopySIMD.h"
+
+#include <cstring>
+#include <type_traits>
 
 
 OPENMPT_NAMESPACE_BEGIN
@@ -21,6 +26,64 @@ OPENMPT_NAMESPACE_BEGIN
 
 struct ModSample;
 
+
+// Sample conversions whose output is identical to their input, i.e. the source data is already in the internal sample format.
+// Such sample data is copied as a whole instead of converting it sampling point by sampling point.
+template <typename SampleConversion>
+struct IsIdentitySampleConversion : std::false_type { };
+template <>
+struct IsIdentitySampleConversion<SC::DecodeInt8> : std::true_type { };
+#if defined(MPT_PLATFORM_LITTLE_ENDIAN)
+template <>
+struct IsIdentitySampleConversion<SC::DecodeInt16<0, littleEndian16> > : std::true_type { };
+#elif defined(MPT_PLATFORM_BIG_ENDIAN)
+template <>
+struct IsIdentitySampleConversion<SC::DecodeInt16<0, bigEndian16> > : std::true_type { };
+#endif
+
+
+// Sample conversions that have a vectorized block converter (see SampleFormatCopySIMD.h).
+// Convert() returns the number of samples that have been converted, the remaining samples have to be converted by the caller.
+// Conversions that are not stateless must not be used for converting interleaved channels in one go.
+template <typename SampleConversion>
+struct BlockSampleConversion
+{
+	static const bool stateless = true;
+	static MPT_FORCEINLINE size_t Convert(typename SampleConversion::output_t *, const mpt::byte *, size_t, SampleConversion &) { return 0; }
+};
+template <>
+struct BlockSampleConversion<SC::DecodeUint8>
+{
+	static const bool stateless = true;
+	static MPT_FORCEINLINE size_t Convert(int8 *outBuf, const mpt::byte *inBuf, size_t count, SC::DecodeUint8 &) { return SC::DecodeInt8Block(outBuf, inBuf, count, 0x80); }
+};
+template <>
+struct BlockSampleConversion<SC::DecodeInt8Delta>
+{
+	static const bool stateless = false;
+	static MPT_FORCEINLINE size_t Convert(int8 *outBuf, const mpt::byte *inBuf, size_t count, SC::DecodeInt8Delta &conv) { return SC::DecodeInt8DeltaBlock(outBuf, inBuf, count, conv.delta); }
+};
+template <uint16 offset, size_t loByteIndex, size_t hiByteIndex>
+struct BlockSampleConversion<SC::DecodeInt16<offset, loByteIndex, hiByteIndex> >
+{
+	static const bool stateless = true;
+	static MPT_FORCEINLINE size_t Convert(int16 *outBuf, const mpt::byte *inBuf, size_t count, SC::DecodeInt16<offset, loByteIndex, hiByteIndex> &)
+	{
+		MPT_CONSTANT_IF(offset != 0 && offset != 0x8000u)
+		{
+			return 0;
+		}
+		return SC::DecodeInt16Block(outBuf, inBuf, count, (loByteIndex != 0) != (mpt::endian_is_big()), offset);
+	}
+};
+template <size_t loByteIndex, size_t hiByteIndex>
+struct BlockSampleConversion<SC::DecodeInt16Delta<loByteIndex, hiByteIndex> >
+{
+	static const bool stateless = false;
+	static MPT_FORCEINLINE size_t Convert(int16 *outBuf, const mpt::byte *inBuf, size_t count, SC::DecodeInt16Delta<loByteIndex, hiByteIndex> &conv) { return SC::DecodeInt16DeltaBlock(outBuf, inBuf, count, (loByteIndex != 0) != (mpt::endian_is_big()), conv.delta); }
+};
+
+
 // Copy a mono sample data buffer.
 template <typename SampleConversion, typename Tbyte>
 size_t CopyMonoSample(ModSample &sample, const Tbyte *sourceBuffer, size_t sourceSize, SampleConversion conv = SampleConversion())
@@ -30,10 +93,19 @@ size_t CopyMonoSample(ModSample &sample, const Tbyte *sourceBuffer, size_t sourc
 
 	const size_t frameSize =  SampleConversion::input_inc;
 	const size_t countFrames = std::min<size_t>(sourceSize / frameSize, sample.nLength);
+	MPT_CONSTANT_IF(IsIdentitySampleConversion<SampleConversion>::value)
+	{
+		std::memcpy(sample.samplev(), sourceBuffer, frameSize * countFrames);
+		return frameSize * countFrames;
+	}
 	size_t numFrames = countFrames;
 	SampleConversion sampleConv(conv);
 	const mpt::byte * MPT_RESTRICT inBuf = mpt::byte_cast<const mpt::byte*>(sourceBuffer);
 	typename SampleConversion::output_t * MPT_RESTRICT outBuf = static_cast<typename SampleConversion::output_t *>(sample.samplev());
+	const size_t blockFrames = BlockSampleConversion<SampleConversion>::Convert(outBuf, inBuf, numFrames, sampleConv);
+	inBuf += blockFrames * SampleConversion::input_inc;
+	outBuf += blockFrames;
+	numFrames -= blockFrames;
 	while(numFrames--)
 	{
 		*outBuf = sampleConv(inBuf);
@@ -53,11 +125,24 @@ size_t CopyStereoInterleavedSample(ModSample &sample, const Tbyte *sourceBuffer,
 
 	const size_t frameSize = 2 * SampleConversion::input_inc;
 	const size_t countFrames = std::min<size_t>(sourceSize / frameSize, sample.nLength);
+	MPT_CONSTANT_IF(IsIdentitySampleConversion<SampleConversion>::value)
+	{
+		std::memcpy(sample.samplev(), sourceBuffer, frameSize * countFrames);
+		return frameSize * countFrames;
+	}
 	size_t numFrames = countFrames;
 	SampleConversion sampleConvLeft(conv);
 	SampleConversion sampleConvRight(conv);
 	const mpt::byte * MPT_RESTRICT inBuf = mpt::byte_cast<const mpt::byte*>(sourceBuffer);
 	typename SampleConversion::output_t * MPT_RESTRICT outBuf = static_cast<typename SampleConversion::output_t *>(sample.samplev());
+	MPT_CONSTANT_IF(BlockSampleConversion<SampleConversion>::stateless)
+	{
+		// Both channels can be converted in one go
+		const size_t blockFrames = BlockSampleConversion<SampleConversion>::Convert(outBuf, inBuf, numFrames * 2, sampleConvLeft) / 2;
+		inBuf += blockFrames * 2 * SampleConversion::input_inc;
+		outBuf += blockFrames * 2;
+		numFrames -= blockFrames;
+	}
 	while(numFrames--)
 	{
 		*outBuf = sampleConvLeft(inBuf);
@@ -17,7 +17,7 @@ namespace Paula
 {
 
 // Tables are: A500 (filter off), A500 (filter on)
-static constexpr int32 WinSincIntegral[2][2048] =
+static constexpr int32 WinSincIntegral[2][BLEP_SIZE] =
 {
 	{
 	131072,131072,131072,131072,131072,131072,131072,131072,131072,131072,131072,
@@ -270,6 +270,9 @@ static constexpr int32 WinSincIntegral[2][2048] =
 };
 
 
+static_assert((MAX_BLEPS & (MAX_BLEPS - 1)) == 0, "blepState ring buffer size must be a power of 2");
+
+
 // we do not initialize blepState here
 // cppcheck-suppress uninitMemberVar
 State::State(uint32 sampleRate)
@@ -277,9 +280,7 @@ State::State(uint32 sampleRate)
 	double amigaClocksPerSample = static_cast<double>(PAULA_HZ) / sampleRate;
 	numSteps = static_cast<int>(amigaClocksPerSample / MINIMUM_INTERVAL);
 	stepRemainder = SamplePosition::FromDouble(amigaClocksPerSample - numSteps * MINIMUM_INTERVAL);
-	remainder = SamplePosition(0);
-	activeBleps = 0;
-	globalOutputLevel = 0;
+	Reset();
 }
 
 
@@ -288,56 +289,33 @@ void State::Reset()
 	remainder = SamplePosition(0);
 	activeBleps = 0;
 	globalOutputLevel = 0;
-}
-
-
-void State::InputSample(int16 sample)
-{
-	if(sample != globalOutputLevel)
-	{
-		LimitMax(activeBleps, static_cast<uint16>(mpt::size(blepState) - 1));
-
-		// Make room for new blep in the sorted list
-		std::move_backward(blepState, blepState + activeBleps, blepState + activeBleps + 1);
-
-		// Start a new blep: level is the difference, age (or phase) is 0 clocks.
-		activeBleps++;
-		blepState[0].age = 0;
-		blepState[0].level = sample - globalOutputLevel;
-		globalOutputLevel = sample;
-	}
+	clockCount = 0;
+	newestBlep = 0;
 }
 
 
 // Return output simulated as series of bleps
 int State::OutputSample(bool filter)
 {
+	const int32 *table = WinSincIntegral[filter];
 	int output = globalOutputLevel * (1 << Paula::BLEP_SCALE);
-	for(uint16 i = 0; i < activeBleps; i++)
+	// Walk from the newest to the oldest blep, in two contiguous parts of the ring buffer
+	const uint32 firstPart = std::min(static_cast<uint32>(activeBleps), static_cast<uint32>(MAX_BLEPS - newestBlep));
+	const Blep *blep = blepState + newestBlep;
+	for(uint32 i = 0; i < firstPart; i++, blep++)
 	{
-		const auto &blep = blepState[i];
-		output -= WinSincIntegral[filter][blep.age] * blep.level;
+		output -= table[static_cast<uint16>(clockCount - blep->startTime)] * blep->level;
+	}
+	blep = blepState;
+	for(uint32 i = firstPart; i < activeBleps; i++, blep++)
+	{
+		output -= table[static_cast<uint16>(clockCount - blep->startTime)] * blep->level;
 	}
 	output /= (1 << (Paula::BLEP_SCALE - 2));	// - 2 to compensate for the fact that we reduced the input sample bit depth
 
 	return output;
 }
 
-
-// Advance the simulation by given number of clock ticks
-void State::Clock(int cycles)
-{
-	for(uint16 i = 0; i < activeBleps; i++)
-	{
-		blepState[i].age += static_cast<uint16>(cycles);
-		if(blepState[i].age >= mpt::size(WinSincIntegral[0]))
-		{
-			activeBleps = i;
-			return;
-		}
-	}
-}
-
 }
 
 OPENMPT_NAMESPACE_END
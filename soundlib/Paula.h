@@ -30,7 +30,7 @@ class State
 	struct Blep
 	{
 		int16 level;
-		uint16 age;
+		uint16 startTime;		// Value of clockCount when this blep was started; its age is clockCount - startTime
 	};
 
 public:
@@ -39,15 +39,46 @@ public:
 private:
 	uint16 activeBleps;			// Count of simultaneous bleps to keep track of
 	int16 globalOutputLevel;	// The instantenous value of Paula output
+	uint16 clockCount;			// Running clock, wraps around
+	uint16 newestBlep;			// Position of the most recent blep in the blepState ring buffer; older bleps follow it
 	Blep blepState[MAX_BLEPS];
 
 public:
 	State(uint32 sampleRate = 48000);
 
 	void Reset();
-	void InputSample(int16 sample);
 	int OutputSample(bool filter);
-	void Clock(int cycles);
+
+	// Called for every Amiga clock interval, so keep these inline
+	MPT_FORCEINLINE void InputSample(int16 sample)
+	{
+		if(sample != globalOutputLevel)
+		{
+			// If the ring buffer is full, the new blep replaces the oldest one
+			LimitMax(activeBleps, static_cast<uint16>(MAX_BLEPS - 1));
+
+			// Start a new blep: level is the difference, age (or phase) is 0 clocks.
+			activeBleps++;
+			newestBlep = (newestBlep - 1u) & (MAX_BLEPS - 1);
+			blepState[newestBlep].startTime = clockCount;
+			blepState[newestBlep].level = sample - globalOutputLevel;
+			globalOutputLevel = sample;
+		}
+	}
+
+	// Advance the simulation by given number of clock ticks
+	MPT_FORCEINLINE void Clock(int cycles)
+	{
+		clockCount += static_cast<uint16>(cycles);
+		// Bleps are sorted by age, so expired bleps can only be found at the old end of the list
+		while(activeBleps)
+		{
+			const Blep &oldest = blepState[(newestBlep + activeBleps - 1u) & (MAX_BLEPS - 1)];
+			if(static_cast<uint16>(clockCount - oldest.startTime) < BLEP_SIZE)
+				break;
+			activeBleps--;
+		}
+	}
 };
 
 }
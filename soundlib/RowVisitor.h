@@ -34,6 +34,8 @@ protected:
 
 public:
 	RowVisitor(const CSoundFile &sf, SEQUENCEINDEX sequence = SEQUENCEINDEX_INVALID);
+	RowVisitor(const RowVisitor &) = default;
+	RowVisitor(RowVisitor &&) = default;
 	RowVisitor& operator=(RowVisitor &&other);
 
 	// Resize / Clear the row vector.
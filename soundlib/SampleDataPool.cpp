@@ -0,0 +1,130 @@
+/*
+ * SampleDataPool.cpp
+ * ------------------
+ * Purpose: Sharing of identical sample data between several modules that were loaded from the same file.
+ * Notes  : When the same module is opened many times at once (e.g. by a streaming server), every instance would normally
+ *          keep its own copy of all sample data, although it never changes during playback. Instead, instances that were
+ *          loaded with the same key can use a single, reference-counted copy of the sample data.
+ *          As the key is only a hint (e.g. a hash of the file contents), sample data is only shared if it is byte-identical
+ *          to the pooled data, including the precomputed loop wrap-around buffers.
+ *          Shared sample data must never be modified. The only effect that modifies sample data during playback (MOD
+ *          Invert Loop) calls Unshare() first to obtain a private copy.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+#include "SampleDataPool.h"
+#include "Sndfile.h"
+#include "../common/mptMutex.h"
+
+#include <map>
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+// The real start of a sample buffer, as allocated by ModSample::AllocateSample()
+static const mpt::byte *GetBufferStart(const void *sampleData)
+{
+	return static_cast<const mpt::byte *>(sampleData) - (InterpolationMaxLookahead * MaxSamplingPointSize);
+}
+
+
+static size_t GetBufferSize(const ModSample &sample)
+{
+	return ModSample::GetRealSampleBufferSize(sample.nLength, sample.GetBytesPerSample());
+}
+
+
+SharedSampleData::~SharedSampleData()
+{
+	for(auto &buffer : m_buffers)
+	{
+		ModSample::FreeSample(buffer.data);
+	}
+}
+
+
+std::shared_ptr<SharedSampleData> SharedSampleData::Share(CSoundFile &sndFile, const std::string &key)
+{
+	static mpt::mutex poolMutex;
+	static std::map<std::string, std::weak_ptr<SharedSampleData>> pool;
+
+	MPT_LOCK_GUARD<mpt::mutex> lock(poolMutex);
+	for(auto it = pool.begin(); it != pool.end();)
+	{
+		if(it->second.expired())
+			it = pool.erase(it);
+		else
+			++it;
+	}
+
+	std::shared_ptr<SharedSampleData> shared = pool[key].lock();
+	if(shared == nullptr)
+	{
+		// First module with this key: Its sample data becomes the shared data.
+		shared = std::make_shared<SharedSampleData>();
+		shared->m_buffers.resize(sndFile.GetNumSamples() + 1);
+		for(SAMPLEINDEX smp = 1; smp <= sndFile.GetNumSamples(); smp++)
+		{
+			const ModSample &sample = sndFile.GetSample(smp);
+			if(sample.HasSampleData())
+			{
+				shared->m_buffers[smp].data = sample.pData.pSample;
+				shared->m_buffers[smp].size = GetBufferSize(sample);
+			}
+		}
+		pool[key] = shared;
+		return shared;
+	}
+
+	const SAMPLEINDEX numSamples = static_cast<SAMPLEINDEX>(std::min(static_cast<size_t>(sndFile.GetNumSamples()), shared->m_buffers.size() - 1));
+	for(SAMPLEINDEX smp = 1; smp <= numSamples; smp++)
+	{
+		ModSample &sample = sndFile.GetSample(smp);
+		const Buffer &buffer = shared->m_buffers[smp];
+		if(buffer.data == nullptr || !sample.HasSampleData() || buffer.size != GetBufferSize(sample))
+			continue;
+		if(!memcmp(GetBufferStart(buffer.data), GetBufferStart(sample.pData.pSample), buffer.size))
+		{
+			sample.FreeSample();
+			sample.pData.pSample = buffer.data;
+		}
+	}
+	return shared;
+}
+
+
+bool SharedSampleData::IsShared(SAMPLEINDEX smp, const ModSample &sample) const
+{
+	return smp < m_buffers.size() && sample.pData.pSample != nullptr && sample.pData.pSample == m_buffers[smp].data;
+}
+
+
+bool SharedSampleData::Unshare(SAMPLEINDEX smp, ModSample &sample) const
+{
+	if(!IsShared(smp, sample))
+		return true;
+	void *data = ModSample::AllocateSample(sample.nLength, sample.GetBytesPerSample());
+	if(data == nullptr)
+		return false;
+	memcpy(const_cast<mpt::byte *>(GetBufferStart(data)), GetBufferStart(sample.pData.pSample), m_buffers[smp].size);
+	sample.pData.pSample = data;
+	return true;
+}
+
+
+void SharedSampleData::Detach(CSoundFile &sndFile) const
+{
+	// The number of samples may have changed since the data was shared
+	for(SAMPLEINDEX smp = 1; smp < m_buffers.size() && smp < MAX_SAMPLES; smp++)
+	{
+		ModSample &sample = sndFile.Samples[smp];
+		if(IsShared(smp, sample))
+			sample.pData.pSample = nullptr;
+	}
+}
+
+
+OPENMPT_NAMESPACE_END
@@ -0,0 +1,57 @@
+/*
+ * SampleDataPool.h
+ * ----------------
+ * Purpose: Sharing of identical sample data between several modules that were loaded from the same file.
+ * Notes  : See implementation file.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+#include "BuildSettings.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "Snd_defs.h"
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+class CSoundFile;
+struct ModSample;
+
+
+class SharedSampleData
+{
+protected:
+	struct Buffer
+	{
+		void *data = nullptr;
+		size_t size = 0;	// Including the lookahead area around the sample
+	};
+	std::vector<Buffer> m_buffers;	// Indexed by sample number
+
+public:
+	SharedSampleData() = default;
+	SharedSampleData(const SharedSampleData &) = delete;
+	SharedSampleData &operator=(const SharedSampleData &) = delete;
+	~SharedSampleData();
+
+	// Replace the sample data of sndFile by identical sample data of other modules that were loaded with the same key (e.g. a hash of the file contents).
+	// If no other module with this key exists, the sample data of sndFile is added to the pool.
+	// The returned object owns the shared sample data and must be kept alive as long as sndFile uses it.
+	static std::shared_ptr<SharedSampleData> Share(CSoundFile &sndFile, const std::string &key);
+
+	// Returns true if the sample currently uses shared sample data.
+	bool IsShared(SAMPLEINDEX smp, const ModSample &sample) const;
+	// Give the sample its own copy of the sample data, so that it can be modified. Returns false if there is not enough memory.
+	bool Unshare(SAMPLEINDEX smp, ModSample &sample) const;
+	// Remove all references to the shared sample data from sndFile, so that it is not freed along with the module.
+	void Detach(CSoundFile &sndFile) const;
+};
+
+
+OPENMPT_NAMESPACE_END
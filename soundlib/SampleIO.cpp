@@ -31,36 +31,11 @@ void AMSUnpack(const int8 * const source, size_t sourceSize, void * const dest,
 uintptr_t DMFUnpack(FileReader &file, uint8 *psample, uint32 maxlen);
 
 
-// Read a sample from memory
-size_t SampleIO::ReadSample(ModSample &sample, FileReader &file) const
+// Limit the sample length to what can be decoded from fileSize bytes and allocate silent sample memory
+size_t SampleIO::PrepareSample(ModSample &sample, std::size_t fileSize) const
 {
-	if(!file.IsValid())
-	{
-		return 0;
-	}
-
 	LimitMax(sample.nLength, MAX_SAMPLE_LENGTH);
 
-	FileReader::off_t bytesRead = 0;	// Amount of memory that has been read from file
-
-	FileReader::off_t filePosition = file.GetPosition();
-	const mpt::byte * sourceBuf = nullptr;
-	FileReader::PinnedRawDataView restrictedSampleDataView;
-	FileReader::off_t fileSize = 0;
-	if(UsesFileReaderForDecoding())
-	{
-		sourceBuf = nullptr;
-		fileSize = file.BytesLeft();
-	} else if(!IsVariableLengthEncoded())
-	{
-		restrictedSampleDataView = file.GetPinnedRawDataView(CalculateEncodedSize(sample.nLength));
-		sourceBuf = restrictedSampleDataView.data();
-		fileSize = restrictedSampleDataView.size();
-	} else
-	{
-		MPT_ASSERT_NOTREACHED();
-	}
-
 	if(!IsVariableLengthEncoded() && sample.nLength > 0x40000)
 	{
 		// Limit sample length to available bytes in file to avoid excessive memory allocation.
@@ -109,11 +84,48 @@ size_t SampleIO::ReadSample(ModSample &sample, FileReader &file) const
 
 	sample.uFlags.set(CHN_16BIT, GetBitDepth() >= 16);
 	sample.uFlags.set(CHN_STEREO, GetChannelFormat() != mono);
-	size_t sampleSize = sample.AllocateSample();	// Target sample size in bytes
-
+	size_t sampleSize = sample.AllocateSample();
 	if(sampleSize == 0)
 	{
 		sample.nLength = 0;
+	}
+	return sampleSize;
+}
+
+
+// Read a sample from memory
+size_t SampleIO::ReadSample(ModSample &sample, FileReader &file) const
+{
+	if(!file.IsValid())
+	{
+		return 0;
+	}
+
+	LimitMax(sample.nLength, MAX_SAMPLE_LENGTH);
+
+	FileReader::off_t bytesRead = 0;	// Amount of memory that has been read from file
+
+	FileReader::off_t filePosition = file.GetPosition();
+	const mpt::byte * sourceBuf = nullptr;
+	FileReader::PinnedRawDataView restrictedSampleDataView;
+	FileReader::off_t fileSize = 0;
+	if(UsesFileReaderForDecoding())
+	{
+		sourceBuf = nullptr;
+		fileSize = file.BytesLeft();
+	} else if(!IsVariableLengthEncoded())
+	{
+		restrictedSampleDataView = file.GetPinnedRawDataView(CalculateEncodedSize(sample.nLength));
+		sourceBuf = restrictedSampleDataView.data();
+		fileSize = restrictedSampleDataView.size();
+	} else
+	{
+		MPT_ASSERT_NOTREACHED();
+	}
+
+	size_t sampleSize = PrepareSample(sample, fileSize);	// Target sample size in bytes
+	if(sampleSize == 0)
+	{
 		return 0;
 	}
 
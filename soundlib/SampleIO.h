@@ -246,6 +246,10 @@ public:
 		return GetEncodedHeaderSize() + (length * (bps / 8) * GetNumChannels());
 	}
 
+	// Limit the sample length to what can be decoded from fileSize bytes of encoded data, set the sample format and allocate silent sample memory.
+	// Returns the sample size in bytes, or 0 if there is nothing to read.
+	size_t PrepareSample(ModSample &sample, std::size_t fileSize) const;
+
 	// Read a sample from memory
 	size_t ReadSample(ModSample &sample, FileReader &file) const;
 
@@ -0,0 +1,123 @@
+/*
+ * SeekIndex.cpp
+ * -------------
+ * Purpose: Playback state checkpoints for speeding up CSoundFile::GetLength() when seeking.
+ * Notes  : Seeking is done by simulating playback from the start of the song up to the seek target, which can take a long time
+ *          for long songs. While simulating, GetLength() stores a snapshot of its state every few seconds. The next time the
+ *          same part of the song is simulated, GetLength() can restore the latest snapshot before the target and only
+ *          simulate the rest of the way. As the simulation is deterministic, the result is identical.
+ *
+ *          Only the first part of a simulation (i.e. until the first sub song has ended) is indexed, and sample position
+ *          syncing (eAdjustSamplePositions) is never indexed, as that state depends on the seek target.
+ *          As GetLength() evaluates all effects while the index is used, the checkpoints taken while calculating the
+ *          song length at load time are also used by the first seek.
+ *          The index is only valid as long as the module is not modified.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+#include "SeekIndex.h"
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+const SeekIndex::Checkpoint *SeekIndex::Timeline::FindCheckpoint(const GetLengthTarget &target) const
+{
+	size_t numUsable = checkpoints.size();
+	if(target.mode == GetLengthTarget::SeekPosition)
+	{
+		// Orders that have not been reached yet by any simulation can only be reached after the last checkpoint.
+		if(target.pos.order < orderFirstReached.size())
+			numUsable = std::min(numUsable, static_cast<size_t>(orderFirstReached[target.pos.order]));
+	} else if(target.mode == GetLengthTarget::SeekSeconds)
+	{
+		while(numUsable > 0 && checkpoints[numUsable - 1].elapsedTime >= target.time)
+			numUsable--;
+	}
+	return numUsable > 0 ? &checkpoints[numUsable - 1] : nullptr;
+}
+
+
+bool SeekIndex::Timeline::WantCheckpoint(double elapsedTime) const
+{
+	const double lastTime = checkpoints.empty() ? 0.0 : checkpoints.back().elapsedTime;
+	return elapsedTime >= lastTime + interval;
+}
+
+
+void SeekIndex::Timeline::AddCheckpoint(Checkpoint &&checkpoint)
+{
+	if(checkpoints.size() >= MaxCheckpoints)
+	{
+		// Keep every other checkpoint
+		std::vector<Checkpoint> thinned;
+		thinned.reserve(MaxCheckpoints);
+		for(size_t i = 0; i < checkpoints.size(); i += 2)
+		{
+			thinned.push_back(std::move(checkpoints[i]));
+		}
+		checkpoints.swap(thinned);
+		for(auto &numCheckpoints : orderFirstReached)
+		{
+			if(numCheckpoints != uint32_max)
+				numCheckpoints = (numCheckpoints + 1) / 2;
+		}
+		interval *= 2.0;
+		if(!WantCheckpoint(checkpoint.elapsedTime))
+			return;
+	}
+	checkpoints.push_back(std::move(checkpoint));
+}
+
+
+void SeekIndex::Timeline::OrderReached(ORDERINDEX ord)
+{
+	if(ord >= orderFirstReached.size())
+	{
+		if(ord == ORDERINDEX_INVALID)
+			return;
+		orderFirstReached.resize(ord + 1, uint32_max);
+	}
+	if(orderFirstReached[ord] == uint32_max)
+		orderFirstReached[ord] = static_cast<uint32>(checkpoints.size());
+}
+
+
+SeekIndex::Timeline *SeekIndex::GetTimeline(const CSoundFile &sndFile, SEQUENCEINDEX sequence, ORDERINDEX startOrder, ROWINDEX startRow)
+{
+	if(m_interval <= 0.0)
+		return nullptr;
+
+	MPT_LOCK_GUARD<mpt::mutex> lock(m_mutex);
+
+	std::vector<bool> mutedChannels(sndFile.GetNumChannels());
+	for(CHANNELINDEX chn = 0; chn < sndFile.GetNumChannels(); chn++)
+	{
+		mutedChannels[chn] = sndFile.ChnSettings[chn].dwFlags[CHN_MUTE];
+	}
+	const uint32 mixingFreq = sndFile.GetSampleRate();
+	if(mixingFreq != m_mixingFreq || sndFile.m_nTempoFactor != m_tempoFactor || mutedChannels != m_mutedChannels)
+	{
+		m_timelines.clear();
+		m_mixingFreq = mixingFreq;
+		m_tempoFactor = sndFile.m_nTempoFactor;
+		m_mutedChannels = std::move(mutedChannels);
+	}
+
+	auto &timeline = m_timelines[std::make_tuple(sequence, startOrder, startRow)];
+	if(timeline.interval <= 0.0)
+		timeline.interval = m_interval;
+	return &timeline;
+}
+
+
+void SeekIndex::Clear()
+{
+	MPT_LOCK_GUARD<mpt::mutex> lock(m_mutex);
+	m_timelines.clear();
+}
+
+
+OPENMPT_NAMESPACE_END
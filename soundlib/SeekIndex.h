@@ -0,0 +1,107 @@
+/*
+ * SeekIndex.h
+ * -----------
+ * Purpose: Playback state checkpoints for speeding up CSoundFile::GetLength() when seeking.
+ * Notes  : See implementation file.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+#include "BuildSettings.h"
+
+#include <map>
+#include <tuple>
+#include <vector>
+#include "Sndfile.h"
+#include "../common/mptMutex.h"
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+// Per-channel state of the GetLength() simulation
+struct GetLengthChnSettings
+{
+	double patLoop = 0.0;
+	CSoundFile::samplecount_t patLoopSmp = 0;
+	ROWINDEX patLoopStart = 0;
+	uint32 ticksToRender = 0;	// When using sample sync, we still need to render this many ticks
+	bool incChanged = false;	// When using sample sync, note frequency has changed
+	uint8 vol = 0xFF;
+};
+
+#ifndef NO_PLUGINS
+typedef std::map<std::pair<ModCommand::INSTR, uint16>, uint16> GetLengthPlugParamMap;
+#endif // NO_PLUGINS
+
+
+class SeekIndex
+{
+public:
+	// Maximum number of checkpoints kept per timeline. If there are more, every other checkpoint is dropped and the interval is doubled.
+	static constexpr size_t MaxCheckpoints = 128;
+
+	// Snapshot of the GetLength() state at the start of a row
+	struct Checkpoint
+	{
+		CSoundFile::PlayStateGlobals globals;
+		std::vector<ModChannel> chn;
+		std::vector<GetLengthChnSettings> chnSettings;
+#ifndef NO_PLUGINS
+		GetLengthPlugParamMap plugParams;
+#endif // NO_PLUGINS
+		RowVisitor visitedRows;
+		double elapsedTime;
+		ORDERINDEX endOrder;
+		ROWINDEX endRow;
+	};
+
+	// All checkpoints of a simulation that starts at a given position
+	struct Timeline
+	{
+		std::vector<Checkpoint> checkpoints;
+		// For each order, the number of checkpoints that were taken before the order was reached for the first time.
+		std::vector<uint32> orderFirstReached;
+		double interval = 0.0;
+
+		// Find the latest checkpoint that lies before the given target.
+		const Checkpoint *FindCheckpoint(const GetLengthTarget &target) const;
+
+		// Returns true if a new checkpoint should be taken at the given time.
+		bool WantCheckpoint(double elapsedTime) const;
+		void AddCheckpoint(Checkpoint &&checkpoint);
+
+		void OrderReached(ORDERINDEX ord);
+	};
+
+protected:
+	// Sequence, start order, start row
+	typedef std::tuple<SEQUENCEINDEX, ORDERINDEX, ROWINDEX> TimelineKey;
+
+	// Sequences may be scanned in parallel. Each timeline is only used by one scan at a time, but the container is shared.
+	mpt::mutex m_mutex;
+	std::map<TimelineKey, Timeline> m_timelines;
+	double m_interval = 0.0;
+
+	// Settings that the checkpoints depend on
+	uint32 m_mixingFreq = 0, m_tempoFactor = 0;
+	std::vector<bool> m_mutedChannels;
+
+public:
+	SeekIndex(double interval) : m_interval(interval) { }
+
+	double GetInterval() const { return m_interval; }
+
+	// Returns the timeline for the given start position, or nullptr if the index is not usable for this simulation.
+	// If the settings that affect the simulation have changed since the index was built, the index is cleared.
+	// The timeline is shared by song length calculations and seeks, as GetLength() evaluates all effects if the index is used.
+	Timeline *GetTimeline(const CSoundFile &sndFile, SEQUENCEINDEX sequence, ORDERINDEX startOrder, ROWINDEX startRow);
+
+	// Remove all checkpoints, e.g. because the module has changed.
+	void Clear();
+};
+
+
+OPENMPT_NAMESPACE_END
@@ -15,6 +15,8 @@
 #include "Sndfile.h"
 #include "Tables.h"
 #include "../common/misc_util.h"
+#include <algorithm>
+#include <array>
 
 
 OPENMPT_NAMESPACE_BEGIN
@@ -37,27 +39,100 @@ uint8 CSoundFile::FrequencyToCutOff(double frequency) const
 }
 
 
-uint32 CSoundFile::CutOffToFrequency(uint32 nCutOff, int envModifier) const
+// computedCutoff = cutoff * (envModifier + 256), i.e. 0...127*512
+// Not inlined, so that the cache is filled using the scalar pow() rather than a vectorized version that might round differently.
+static MPT_NOINLINE uint32 ComputedCutOffToFrequency(uint32 computedCutoff, MODTYPE type, bool extendedRange, uint32 mixingFreq)
 {
-	MPT_ASSERT(nCutOff < 128);
-	float computedCutoff = static_cast<float>(nCutOff * (envModifier + 256));	// 0...127*512
+	const float cutoff = static_cast<float>(computedCutoff);
 	float Fc;
-	if(GetType() != MOD_TYPE_IMF)
+	if(type != MOD_TYPE_IMF)
 	{
-		Fc = 110.0f * std::pow(2.0f, 0.25f + computedCutoff / (m_SongFlags[SONG_EXFILTERRANGE] ? 20.0f * 512.0f : 24.0f * 512.0f));
+		Fc = 110.0f * std::pow(2.0f, 0.25f + cutoff / (extendedRange ? 20.0f * 512.0f : 24.0f * 512.0f));
 	} else
 	{
 		// EMU8000: Documentation says the cutoff is in quarter semitones, with 0x00 being 125 Hz and 0xFF being 8 kHz
 		// The first half of the sentence contradicts the second, though.
-		Fc = 125.0f * std::pow(2.0f, computedCutoff * 6.0f / (127.0f * 512.0f));
+		Fc = 125.0f * std::pow(2.0f, cutoff * 6.0f / (127.0f * 512.0f));
 	}
 	int freq = mpt::saturate_round<int>(Fc);
 	Limit(freq, 120, 20000);
-	if(freq * 2 > (int)m_MixerSettings.gdwMixingFreq) freq = m_MixerSettings.gdwMixingFreq / 2;
+	if(freq * 2 > (int)mixingFreq) freq = mixingFreq / 2;
 	return static_cast<uint32>(freq);
 }
 
 
+uint32 CSoundFile::CutOffToFrequency(uint32 nCutOff, int envModifier) const
+{
+	MPT_ASSERT(nCutOff < 128);
+	return ComputedCutOffToFrequency(nCutOff * (envModifier + 256), GetType(), m_SongFlags[SONG_EXFILTERRANGE], m_MixerSettings.gdwMixingFreq);
+}
+
+
+uint32 CSoundFile::CutOffToFrequencyCached(uint32 nCutOff, int envModifier) const
+{
+	MPT_ASSERT(nCutOff < 128);
+	const int computedCutoff = static_cast<int>(nCutOff) * (envModifier + 256);
+	if(computedCutoff < 0 || computedCutoff > 127 * 512)
+	{
+		return CutOffToFrequency(nCutOff, envModifier);
+	}
+	// Normally already built by InitPlayer(), but filters may also be introduced or the filter range changed after that
+	UpdateCutoffFrequencyCache();
+	return m_cutoffFrequencyCache[computedCutoff];
+}
+
+
+void CSoundFile::UpdateCutoffFrequencyCache() const
+{
+	const uint8 range = (m_SongFlags[SONG_EXFILTERRANGE] ? 1 : 0) | (GetType() == MOD_TYPE_IMF ? 2 : 0);
+	if(!m_cutoffFrequencyCache.empty() && m_cutoffFrequencyCacheMixingFreq == m_MixerSettings.gdwMixingFreq && m_cutoffFrequencyCacheRange == range)
+	{
+		return;
+	}
+	m_cutoffFrequencyCache.resize(127 * 512 + 1);
+	for(uint32 i = 0; i < m_cutoffFrequencyCache.size(); i++)
+	{
+		m_cutoffFrequencyCache[i] = static_cast<uint16>(ComputedCutOffToFrequency(i, GetType(), m_SongFlags[SONG_EXFILTERRANGE], m_MixerSettings.gdwMixingFreq));
+	}
+	m_cutoffFrequencyCacheMixingFreq = m_MixerSettings.gdwMixingFreq;
+	m_cutoffFrequencyCacheRange = range;
+}
+
+
+bool CSoundFile::UsesResonantFilter() const
+{
+	for(INSTRUMENTINDEX ins = 1; ins <= GetNumInstruments(); ins++)
+	{
+		const ModInstrument *pIns = Instruments[ins];
+		if(pIns != nullptr && (pIns->IsCutoffEnabled() || pIns->IsResonanceEnabled() || pIns->PitchEnv.dwFlags[ENV_FILTER]))
+		{
+			return true;
+		}
+	}
+	// Filters can also be set up by MIDI macros
+	for(PATTERNINDEX pat = 0; pat < Patterns.Size(); pat++)
+	{
+		if(!Patterns.IsValidPat(pat))
+		{
+			continue;
+		}
+		const CPattern &pattern = Patterns[pat];
+		if(std::any_of(pattern.begin(), pattern.end(), [](const ModCommand &m) { return m.command == CMD_MIDI || m.command == CMD_SMOOTHMIDI; }))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
+// 2 * damping factor for resonance 0...127. Not inlined for the same reason as ComputedCutOffToFrequency.
+static MPT_NOINLINE float ResonanceToDampingFactor(int resonance)
+{
+	return std::pow(10.0f, -resonance * ((24.0f / 128.0f) / 20.0f));
+}
+
+
 // Simple 2-poles resonant filter. Returns computed cutoff in range [0, 254] or -1 if filter is not applied.
 int CSoundFile::SetupChannelFilter(ModChannel &chn, bool bReset, int envModifier) const
 {
@@ -93,8 +168,17 @@ int CSoundFile::SetupChannelFilter(ModChannel &chn, bool bReset, int envModifier
 	chn.dwFlags.set(CHN_FILTER);
 
 	// 2 * damping factor
-	const float dmpfac = std::pow(10.0f, -resonance * ((24.0f / 128.0f) / 20.0f));
-	const float fc = CutOffToFrequency(cutoff, envModifier) * (2.0f * (float)M_PI);
+	static const std::array<float, 128> DampingFactors = []()
+	{
+		std::array<float, 128> factors;
+		for(int i = 0; i < 128; i++)
+		{
+			factors[i] = ResonanceToDampingFactor(i);
+		}
+		return factors;
+	}();
+	const float dmpfac = DampingFactors[resonance];
+	const float fc = CutOffToFrequencyCached(cutoff, envModifier) * (2.0f * (float)M_PI);
 	float d, e;
 	if(m_playBehaviour[kITFilterBehaviour] && !m_SongFlags[SONG_EXFILTERRANGE])
 	{
@@ -25,6 +25,14 @@
 #include "modsmp_ctrl.h"	// For updating the loop wraparound data with the invert loop effect
 #include "plugins/PlugInterface.h"
 #include "OPL.h"
+#include "SeekIndex.h"
+#include "SampleDataPool.h"
+#if defined(MPT_ENABLE_THREAD)
+#include <atomic>
+#include <exception>
+#include <system_error>
+#include <thread>
+#endif // MPT_ENABLE_THREAD
 
 OPENMPT_NAMESPACE_BEGIN
 
@@ -56,18 +64,10 @@ protected:
 
 public:
 	std::unique_ptr<CSoundFile::PlayState> state;
-	struct ChnSettings
-	{
-		double patLoop = 0.0;
-		CSoundFile::samplecount_t patLoopSmp = 0;
-		ROWINDEX patLoopStart = 0;
-		uint32 ticksToRender = 0;	// When using sample sync, we still need to render this many ticks
-		bool incChanged = false;	// When using sample sync, note frequency has changed
-		uint8 vol = 0xFF;
-	};
+	typedef GetLengthChnSettings ChnSettings;
 
 #ifndef NO_PLUGINS
-	typedef std::map<std::pair<ModCommand::INSTR, uint16>, uint16> PlugParamMap;
+	typedef GetLengthPlugParamMap PlugParamMap;
 	PlugParamMap plugParams;
 #endif
 	std::vector<ChnSettings> chnSettings;
@@ -99,6 +99,31 @@ public:
 		}
 	}
 
+	// Take a snapshot of the current state for the seek index
+	SeekIndex::Checkpoint CreateCheckpoint(const RowVisitor &visitedRows, const GetLengthType &retval) const
+	{
+		SeekIndex::Checkpoint checkpoint{ *state, { state->Chn, state->Chn + sndFile.GetNumChannels() }, chnSettings,
+#ifndef NO_PLUGINS
+			plugParams,
+#endif // NO_PLUGINS
+			visitedRows, elapsedTime, retval.endOrder, retval.endRow };
+		return checkpoint;
+	}
+
+	// Continue from a seek index snapshot. The visited rows have to be restored by the caller.
+	void RestoreCheckpoint(const SeekIndex::Checkpoint &checkpoint, GetLengthType &retval)
+	{
+		state->RestoreSimulatedState(checkpoint.globals);
+		std::copy(checkpoint.chn.begin(), checkpoint.chn.end(), std::begin(state->Chn));
+		chnSettings = checkpoint.chnSettings;
+#ifndef NO_PLUGINS
+		plugParams = checkpoint.plugParams;
+#endif // NO_PLUGINS
+		elapsedTime = checkpoint.elapsedTime;
+		retval.endOrder = checkpoint.endOrder;
+		retval.endRow = checkpoint.endRow;
+	}
+
 	// Increment playback position of sample and envelopes on a channel
 	void RenderChannel(CHANNELINDEX channel, uint32 tickDuration, uint32 portaStart = uint32_max)
 	{
@@ -245,11 +270,30 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 
 	GetLengthMemory memory(*this);
 	CSoundFile::PlayState &playState = *memory.state;
+
+	// Sample positions depend on the seek target, so they cannot be indexed.
+	SeekIndex::Timeline *seekTimeline = nullptr;
+	const SeekIndex::Checkpoint *checkpoint = nullptr;
+	const bool useSeekIndex = m_seekIndex != nullptr && !adjustSamplePos;
+	// Effects that only matter for the play state after seeking are evaluated in all modes if the seek index is used,
+	// so that the checkpoints of a song length calculation can also be used for seeking.
+	const bool evaluateEffects = (adjustMode & eAdjust) || useSeekIndex;
+	if(useSeekIndex)
+	{
+		seekTimeline = m_seekIndex->GetTimeline(*this, sequence, target.startOrder, target.startRow);
+		if(seekTimeline != nullptr)
+			checkpoint = seekTimeline->FindCheckpoint(target);
+	}
+
 	// Temporary visited rows vector (so that GetLength() won't interfere with the player code if the module is playing at the same time)
-	RowVisitor visitedRows(*this, sequence);
+	RowVisitor visitedRows = (checkpoint != nullptr) ? checkpoint->visitedRows : RowVisitor(*this, sequence);
 
 	playState.m_nNextRow = playState.m_nRow = target.startRow;
 	playState.m_nNextOrder = playState.m_nCurrentOrder = target.startOrder;
+	if(checkpoint != nullptr)
+	{
+		memory.RestoreCheckpoint(*checkpoint, retval);
+	}
 
 	// Fast LUTs for commands that are too weird / complicated / whatever to emulate in sample position adjust mode.
 	std::bitset<MAX_EFFECTS> forbiddenCommands;
@@ -292,6 +336,16 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 
 	for (;;)
 	{
+		// Only the first sub song is indexed, as the state is reset when continuing with the next one.
+		if(seekTimeline != nullptr && !results.empty())
+		{
+			seekTimeline = nullptr;
+		}
+		if(seekTimeline != nullptr && seekTimeline->WantCheckpoint(memory.elapsedTime))
+		{
+			seekTimeline->AddCheckpoint(memory.CreateCheckpoint(visitedRows, retval));
+		}
+
 		// Time target reached.
 		if(target.mode == GetLengthTarget::SeekSeconds && memory.elapsedTime >= target.time)
 		{
@@ -316,6 +370,7 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 
 		// Check if pattern is valid
 		playState.m_nPattern = playState.m_nCurrentOrder < orderList.size() ? orderList[playState.m_nCurrentOrder] : orderList.GetInvalidPatIndex();
+		if(seekTimeline != nullptr && results.empty()) seekTimeline->OrderReached(playState.m_nCurrentOrder);
 		bool positionJumpOnThisRow = false;
 		bool patternBreakOnThisRow = false;
 		bool patternLoopEndedOnThisRow = false, patternLoopStartedOnThisRow = false;
@@ -400,6 +455,7 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 			playState.m_nRow = 0;
 
 		// Check whether target was reached.
+		if(seekTimeline != nullptr && results.empty()) seekTimeline->OrderReached(playState.m_nCurrentOrder);
 		if(target.mode == GetLengthTarget::SeekPosition && playState.m_nCurrentOrder == target.pos.order && playState.m_nRow == target.pos.row)
 		{
 			retval.targetReached = true;
@@ -456,7 +512,7 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 			if(p->IsPcNote())
 			{
 #ifndef NO_PLUGINS
-				if((adjustMode & eAdjust) && p->instr > 0 && p->instr <= MAX_MIXPLUGINS)
+				if(evaluateEffects && p->instr > 0 && p->instr <= MAX_MIXPLUGINS)
 				{
 					memory.plugParams[std::make_pair(p->instr, p->GetValueVolCol())] = p->GetValueEffectCol();
 				}
@@ -582,7 +638,7 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 				if(!patternBreakOnThisRow || (GetType() & (MOD_TYPE_MOD | MOD_TYPE_XM)))
 					playState.m_nNextRow = 0;
 
-				if (adjustMode & eAdjust)
+				if(evaluateEffects)
 				{
 					chn.nPatternLoopCount = 0;
 					chn.nPatternLoop = 0;
@@ -601,7 +657,7 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 						{
 							playState.m_nNextOrder = playState.m_nCurrentOrder + 1;
 						}
-						if(adjustMode & eAdjust)
+						if(evaluateEffects)
 						{
 							chn.nPatternLoopCount = 0;
 							chn.nPatternLoop = 0;
@@ -614,7 +670,7 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 				if(!m_playBehaviour[kMODVBlankTiming])
 				{
 					TEMPO tempo(CalculateXParam(playState.m_nPattern, playState.m_nRow, nChn), 0);
-					if ((adjustMode & eAdjust) && (GetType() & (MOD_TYPE_S3M | MOD_TYPE_IT | MOD_TYPE_MPT)))
+					if (evaluateEffects && (GetType() & (MOD_TYPE_S3M | MOD_TYPE_IT | MOD_TYPE_MPT)))
 					{
 						if (tempo.GetInt()) chn.nOldTempo = static_cast<uint8>(tempo.GetInt()); else tempo.Set(chn.nOldTempo);
 					}
@@ -735,7 +791,7 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 			}
 
 			// The following calculations are not interesting if we just want to get the song length.
-			if (!(adjustMode & eAdjust)) continue;
+			if(!evaluateEffects) continue;
 			switch(command)
 			{
 			// Portamento Up/Down
@@ -903,7 +959,7 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 			case CMD_VIBRATO:
 			case CMD_FINEVIBRATO:
 			case CMD_VIBRATOVOL:
-				if(adjustMode & eAdjust)
+				if(evaluateEffects)
 				{
 					uint32 vibTicks = ((GetType() & (MOD_TYPE_IT | MOD_TYPE_MPT)) && !m_SongFlags[SONG_ITOLDEFFECTS]) ? numTicks : nonRowTicks;
 					uint32 inc = chn.nVibratoSpeed * vibTicks;
@@ -914,7 +970,7 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 				break;
 
 			case CMD_TREMOLO:
-				if(adjustMode & eAdjust)
+				if(evaluateEffects)
 				{
 					uint32 tremTicks = ((GetType() & (MOD_TYPE_IT | MOD_TYPE_MPT)) && !m_SongFlags[SONG_ITOLDEFFECTS]) ? numTicks : nonRowTicks;
 					uint32 inc = chn.nTremoloSpeed * tremTicks;
@@ -925,7 +981,7 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 				break;
 
 			case CMD_PANBRELLO:
-				if(adjustMode & eAdjust)
+				if(evaluateEffects)
 				{
 					// Panbrello effect is permanent in compatible mode, so actually apply panbrello for the last tick of this row
 					chn.nPanbrelloPos += static_cast<uint8>(chn.nPanbrelloSpeed * (numTicks - 1));
@@ -1331,6 +1387,92 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 }
 
 
+void CSoundFile::SetSeekIndexInterval(double seconds)
+{
+	if(seconds <= 0.0)
+		m_seekIndex.reset();
+	else if(m_seekIndex == nullptr || m_seekIndex->GetInterval() != seconds)
+		m_seekIndex = std::make_unique<SeekIndex>(seconds);
+}
+
+
+double CSoundFile::GetSeekIndexInterval() const
+{
+	return m_seekIndex != nullptr ? m_seekIndex->GetInterval() : 0.0;
+}
+
+
+std::vector<std::vector<GetLengthType>> CSoundFile::GetLengthOfAllSequences(uint32 numThreads)
+{
+	const SEQUENCEINDEX numSequences = Order.GetNumSequences();
+	std::vector<std::vector<GetLengthType>> lengths(numSequences);
+
+#if defined(MPT_ENABLE_THREAD)
+	// With eNoAdjust, GetLength() keeps all of its state in local variables and only reads from the module,
+	// so sequences can be scanned concurrently. The only exception is the seek index, which has one timeline per sequence.
+	// Sub songs of the same sequence cannot be scanned independently, as they are only found one after another.
+	if(numThreads == 0)
+		numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	numThreads = std::min(numThreads, static_cast<uint32>(numSequences));
+	if(numThreads > 1)
+	{
+		std::atomic<uint32> nextSequence(0);
+		std::vector<std::exception_ptr> exceptions(numThreads);
+		auto scanSequences = [&](uint32 thread)
+		{
+			try
+			{
+				for(uint32 seq = nextSequence++; seq < numSequences; seq = nextSequence++)
+				{
+					lengths[seq] = GetLength(eNoAdjust, GetLengthTarget(true).StartPos(static_cast<SEQUENCEINDEX>(seq), 0, 0));
+				}
+			} catch(...)
+			{
+				exceptions[thread] = std::current_exception();
+				// Make the other threads stop early
+				nextSequence = numSequences;
+			}
+		};
+
+		std::vector<std::thread> workers;
+		workers.reserve(numThreads - 1);
+		try
+		{
+			for(uint32 thread = 1; thread < numThreads; thread++)
+			{
+				workers.emplace_back(scanSequences, thread);
+			}
+		} MPT_EXCEPTION_CATCH_OUT_OF_MEMORY(e)
+		{
+			MPT_EXCEPTION_DELETE_OUT_OF_MEMORY(e);
+		} catch(const std::system_error &)
+		{
+			// Continue with fewer threads
+		}
+		scanSequences(0);
+		for(auto &worker : workers)
+		{
+			worker.join();
+		}
+		for(const auto &e : exceptions)
+		{
+			if(e)
+				std::rethrow_exception(e);
+		}
+		return lengths;
+	}
+#else
+	MPT_UNREFERENCED_PARAMETER(numThreads);
+#endif // MPT_ENABLE_THREAD
+
+	for(SEQUENCEINDEX seq = 0; seq < numSequences; seq++)
+	{
+		lengths[seq] = GetLength(eNoAdjust, GetLengthTarget(true).StartPos(seq, 0, 0));
+	}
+	return lengths;
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////////////
 // Effects
 
@@ -4821,6 +4963,10 @@ void CSoundFile::InvertLoop(ModChannel &chn)
 	if (++chn.nEFxOffset >= pModSample->nLoopEnd - pModSample->nLoopStart)
 		chn.nEFxOffset = 0;
 
+	// Other modules may be using the same sample data
+	if(m_sharedSamples != nullptr && !m_sharedSamples->Unshare(static_cast<SAMPLEINDEX>(Samples.index_of(pModSample)), *pModSample))
+		return;
+
 	// TRASH IT!!! (Yes, the sample!)
 	uint8 &sample = mpt::byte_cast<uint8 *>(pModSample->sampleb())[pModSample->nLoopStart + chn.nEFxOffset];
 	sample = ~sample;
@@ -34,6 +34,11 @@
 #include "../common/FileReader.h"
 #include "Container.h"
 #include "OPL.h"
+#include "SeekIndex.h"
+#include "SampleDataPool.h"
+#include "MixThreadPool.h"
+#include "BackgroundSampleDecoder.h"
+#include "SampleIO.h"
 
 #ifndef NO_ARCHIVE_SUPPORT
 #include "../unarchiver/unarchiver.h"
@@ -80,8 +85,6 @@ CSoundFile::CSoundFile() :
 	m_PRNG(mpt::make_prng<mpt::fast_prng>(mpt::global_prng())),
 	visitedSongRows(*this)
 {
-	MemsetZero(MixSoundBuffer);
-	MemsetZero(MixRearBuffer);
 	MemsetZero(MixFloatBuffer);
 
 #ifdef MODPLUG_TRACKER
@@ -188,72 +191,159 @@ void CSoundFile::InitializeChannels()
 }
 
 
+// Magic bytes that a format loader requires at a fixed file offset.
+// Formats without such magic bytes (or with too many variants of them) have length 0 and are always tried.
+struct FileFormatSignature
+{
+	uint16 offset;     // File offset of the magic bytes
+	uint16 probeSize;  // Amount of data that the prober needs before it looks at the magic bytes at all
+	uint8 length;      // Length of the magic bytes
+	const char *magic[2];  // Magic bytes (up to two alternatives of the same length)
+};
+
 struct FileFormatLoader
 {
 	decltype(CSoundFile::ProbeFileHeaderXM) *prober;
 	decltype(&CSoundFile::ReadXM) loader;
+	FileFormatSignature signature;
 };
 
 #ifdef MODPLUG_TRACKER
-#define MPT_DECLARE_FORMAT(format) { nullptr, &CSoundFile::Read ## format }
+#define MPT_DECLARE_FORMAT_PROBER(format) nullptr
 #else
-#define MPT_DECLARE_FORMAT(format) { CSoundFile::ProbeFileHeader ## format, &CSoundFile::Read ## format }
+#define MPT_DECLARE_FORMAT_PROBER(format) CSoundFile::ProbeFileHeader ## format
 #endif
 
+#define MPT_DECLARE_FORMAT(format) { MPT_DECLARE_FORMAT_PROBER(format), &CSoundFile::Read ## format, { 0, 0, 0, { nullptr, nullptr } } }
+#define MPT_DECLARE_FORMAT_MAGIC(format, offset, probeSize, magic) { MPT_DECLARE_FORMAT_PROBER(format), &CSoundFile::Read ## format, { offset, probeSize, sizeof(magic) - 1, { magic, magic } } }
+#define MPT_DECLARE_FORMAT_MAGIC2(format, offset, probeSize, magic1, magic2) { MPT_DECLARE_FORMAT_PROBER(format), &CSoundFile::Read ## format, { offset, probeSize, sizeof(magic1) - 1, { magic1, magic2 } } }
+
 // All module format loaders, in the order they should be executed.
 // This order matters, depending on the format, due to some unfortunate
 // clashes or lack of magic bytes that can lead to mis-detection of some formats.
 // Apart from that, more common formats with sane magic bytes are also found
 // at the top of the list to match the most common cases more quickly.
+// The magic bytes listed here must be a necessary condition for both the prober and the loader to succeed,
+// the probe size is the size of the header struct that the prober reads first.
 static constexpr FileFormatLoader ModuleFormatLoaders[] =
 {
-	MPT_DECLARE_FORMAT(XM),
-	MPT_DECLARE_FORMAT(IT),
-	MPT_DECLARE_FORMAT(S3M),
+	MPT_DECLARE_FORMAT_MAGIC(XM, 0, 80, "Extended Module: "),
+	MPT_DECLARE_FORMAT_MAGIC2(IT, 0, 192, "IMPM", "tpm."),
+	MPT_DECLARE_FORMAT_MAGIC(S3M, 44, 96, "SCRM"),
 	MPT_DECLARE_FORMAT(STM),
-	MPT_DECLARE_FORMAT(MED),
-	MPT_DECLARE_FORMAT(MTM),
-	MPT_DECLARE_FORMAT(MDL),
-	MPT_DECLARE_FORMAT(DBM),
-	MPT_DECLARE_FORMAT(FAR),
-	MPT_DECLARE_FORMAT(AMS),
-	MPT_DECLARE_FORMAT(AMS2),
-	MPT_DECLARE_FORMAT(OKT),
-	MPT_DECLARE_FORMAT(PTM),
-	MPT_DECLARE_FORMAT(ULT),
-	MPT_DECLARE_FORMAT(DMF),
-	MPT_DECLARE_FORMAT(DSM),
-	MPT_DECLARE_FORMAT(AMF_Asylum),
-	MPT_DECLARE_FORMAT(AMF_DSMI),
-	MPT_DECLARE_FORMAT(PSM),
-	MPT_DECLARE_FORMAT(PSM16),
-	MPT_DECLARE_FORMAT(MT2),
-	MPT_DECLARE_FORMAT(ITP),
+	MPT_DECLARE_FORMAT_MAGIC(MED, 0, 52, "MMD"),
+	MPT_DECLARE_FORMAT_MAGIC(MTM, 0, 66, "MTM"),
+	MPT_DECLARE_FORMAT_MAGIC(MDL, 0, 5, "DMDL"),
+	MPT_DECLARE_FORMAT_MAGIC(DBM, 0, 8, "DBM0"),
+	MPT_DECLARE_FORMAT_MAGIC(FAR, 0, 98, "FAR\xFE"),
+	MPT_DECLARE_FORMAT_MAGIC(AMS, 0, 7, "Extreme"),
+	MPT_DECLARE_FORMAT_MAGIC(AMS2, 0, 7, "AMShdr\x1A"),
+	MPT_DECLARE_FORMAT_MAGIC(OKT, 0, 8, "OKTASONG"),
+	MPT_DECLARE_FORMAT_MAGIC(PTM, 44, 608, "PTMF"),
+	MPT_DECLARE_FORMAT_MAGIC(ULT, 0, 48, "MAS_UTrack_V00"),
+	MPT_DECLARE_FORMAT_MAGIC(DMF, 0, 66, "DDMF"),
+	MPT_DECLARE_FORMAT_MAGIC2(DSM, 0, 12, "RIFF", "DSMF"),
+	MPT_DECLARE_FORMAT_MAGIC(AMF_Asylum, 0, 38, "ASYLUM Music Format V1.0\0"),
+	MPT_DECLARE_FORMAT_MAGIC(AMF_DSMI, 0, 41, "AMF"),
+	MPT_DECLARE_FORMAT_MAGIC2(PSM, 0, 12, "PSM ", "QUP$"),
+	MPT_DECLARE_FORMAT_MAGIC(PSM16, 0, 146, "PSM\xFE"),
+	MPT_DECLARE_FORMAT_MAGIC(MT2, 0, 126, "MT20"),
+	MPT_DECLARE_FORMAT_MAGIC(ITP, 0, 8, "pti."),
 #if defined(MODPLUG_TRACKER) || defined(MPT_FUZZ_TRACKER)
 	// These make little sense for a module player library
 	MPT_DECLARE_FORMAT(UAX),
 	MPT_DECLARE_FORMAT(WAV),
 	MPT_DECLARE_FORMAT(MID),
 #endif // MODPLUG_TRACKER || MPT_FUZZ_TRACKER
-	MPT_DECLARE_FORMAT(GDM),
-	MPT_DECLARE_FORMAT(IMF),
-	MPT_DECLARE_FORMAT(DIGI),
-	MPT_DECLARE_FORMAT(DTM),
-	MPT_DECLARE_FORMAT(PLM),
-	MPT_DECLARE_FORMAT(AM),
-	MPT_DECLARE_FORMAT(J2B),
-	MPT_DECLARE_FORMAT(PT36),
+	MPT_DECLARE_FORMAT_MAGIC(GDM, 0, 157, "GDM\xFE"),
+	MPT_DECLARE_FORMAT_MAGIC(IMF, 60, 576, "IM10"),
+	MPT_DECLARE_FORMAT_MAGIC(DIGI, 0, 610, "DIGI Booster module\0"),
+	MPT_DECLARE_FORMAT_MAGIC(DTM, 0, 22, "D.T."),
+	MPT_DECLARE_FORMAT_MAGIC(PLM, 0, 96, "PLM\x1A"),
+	MPT_DECLARE_FORMAT_MAGIC(AM, 0, 8, "RIFF"),
+	MPT_DECLARE_FORMAT_MAGIC(J2B, 0, 24, "MUSE"),
+	MPT_DECLARE_FORMAT_MAGIC(PT36, 0, 12, "FORM"),
 	MPT_DECLARE_FORMAT(SFX),
-	MPT_DECLARE_FORMAT(STP),
+	MPT_DECLARE_FORMAT_MAGIC(STP, 0, 204, "STP3"),
 	MPT_DECLARE_FORMAT(MOD),
-	MPT_DECLARE_FORMAT(ICE),
-	MPT_DECLARE_FORMAT(669),
+	MPT_DECLARE_FORMAT_MAGIC2(ICE, 1464, 1464 + 4, "MTN\0", "IT10"),
+	MPT_DECLARE_FORMAT_MAGIC2(669, 0, 497, "if", "JN"),
 	MPT_DECLARE_FORMAT(C67),
-	MPT_DECLARE_FORMAT(MO3),
+	MPT_DECLARE_FORMAT_MAGIC(MO3, 0, 8, "MO3"),
 	MPT_DECLARE_FORMAT(M15),
 };
 
+#undef MPT_DECLARE_FORMAT_MAGIC2
+#undef MPT_DECLARE_FORMAT_MAGIC
 #undef MPT_DECLARE_FORMAT
+#undef MPT_DECLARE_FORMAT_PROBER
+
+MPT_STATIC_ASSERT(CountOf(ModuleFormatLoaders) <= 64);
+
+
+// Index for quickly ruling out module formats based on their magic bytes.
+// As the formats are still tried in the same order as before, this gives the same results as trying all formats.
+struct ModuleFormatIndex
+{
+	// For each possible first byte of a file, the formats with magic bytes at offset 0 that cannot start with this byte.
+	uint64 rejectByFirstByte[256];
+	// Number of bytes needed to check all magic bytes.
+	std::size_t signatureSize = 0;
+
+	ModuleFormatIndex()
+	{
+		MemsetZero(rejectByFirstByte);
+		for(std::size_t f = 0; f < CountOf(ModuleFormatLoaders); f++)
+		{
+			const FileFormatSignature &signature = ModuleFormatLoaders[f].signature;
+			if(!signature.length)
+				continue;
+			signatureSize = std::max(signatureSize, static_cast<std::size_t>(signature.offset + signature.length));
+			if(signature.offset != 0)
+				continue;
+			for(std::size_t b = 0; b < 256; b++)
+			{
+				if(static_cast<uint8>(signature.magic[0][0]) != b && static_cast<uint8>(signature.magic[1][0]) != b)
+					rejectByFirstByte[b] |= uint64(1) << f;
+			}
+		}
+		MPT_ASSERT(signatureSize <= PROBE_RECOMMENDED_SIZE);
+	}
+
+	static const ModuleFormatIndex &Get()
+	{
+		static const ModuleFormatIndex index;
+		return index;
+	}
+
+	// Returns a bit mask of all formats in ModuleFormatLoaders that may accept a file starting with the given data.
+	// If shortDataFails is true, formats whose magic bytes are not fully contained in the data are ruled out, too.
+	// This is the case if the data is the complete file, or when loading (the loaders fail if they cannot read their header).
+	// Otherwise, a format is only ruled out if the data also contains the complete header that the prober needs.
+	uint64 GetCandidates(mpt::span<const mpt::byte> data, bool shortDataFails) const
+	{
+		uint64 candidates = ~uint64(0);
+		const uint64 firstByteRejects = data.size() ? rejectByFirstByte[mpt::byte_cast<uint8>(data[0])] : 0;
+		for(std::size_t f = 0; f < CountOf(ModuleFormatLoaders); f++)
+		{
+			const FileFormatSignature &signature = ModuleFormatLoaders[f].signature;
+			if(!signature.length)
+				continue;
+			const std::size_t signatureEnd = signature.offset + signature.length;
+			const std::size_t requiredSize = shortDataFails ? signatureEnd : std::max<std::size_t>(signatureEnd, signature.probeSize);
+			if(data.size() >= requiredSize)
+			{
+				if(data.size() < signatureEnd
+					|| (firstByteRejects & (uint64(1) << f))
+					|| (std::memcmp(data.data() + signature.offset, signature.magic[0], signature.length) && std::memcmp(data.data() + signature.offset, signature.magic[1], signature.length)))
+				{
+					candidates &= ~(uint64(1) << f);
+				}
+			}
+		}
+		return candidates;
+	}
+};
 
 
 CSoundFile::ProbeResult CSoundFile::ProbeAdditionalSize(MemoryFileReader &file, const uint64 *pfilesize, uint64 minimumAdditionalSize)
@@ -299,7 +389,7 @@ const std::size_t CSoundFile::ProbeRecommendedSize = PROBE_RECOMMENDED_SIZE;
 /**/
 
 
-CSoundFile::ProbeResult CSoundFile::Probe(ProbeFlags flags, mpt::span<const mpt::byte> data, const uint64 *pfilesize)
+CSoundFile::ProbeResult CSoundFile::Probe(ProbeFlags flags, mpt::span<const mpt::byte> data, const uint64 *pfilesize, bool useFormatIndex)
 {
 	ProbeResult result = ProbeFailure;
 	if(pfilesize && (*pfilesize < data.size()))
@@ -320,11 +410,13 @@ CSoundFile::ProbeResult CSoundFile::Probe(ProbeFlags flags, mpt::span<const mpt:
 	}
 	if(flags & ProbeModules)
 	{
-		for(const auto &format : ModuleFormatLoaders)
+		const bool dataIsComplete = pfilesize && (*pfilesize <= data.size());
+		const uint64 candidates = useFormatIndex ? ModuleFormatIndex::Get().GetCandidates(data, dataIsComplete) : ~uint64(0);
+		for(std::size_t f = 0; f < CountOf(ModuleFormatLoaders); f++)
 		{
-			if(format.prober != nullptr)
+			if(ModuleFormatLoaders[f].prober != nullptr && (candidates & (uint64(1) << f)))
 			{
-				MPT_DO_PROBE(result, format.prober(file, pfilesize));
+				MPT_DO_PROBE(result, ModuleFormatLoaders[f].prober(file, pfilesize));
 			}
 		}
 	}
@@ -414,11 +506,35 @@ bool CSoundFile::Create(FileReader file, ModLoadingFlags loadFlags)
 				return false;
 			}
 
-			// Try all module format loaders
+#ifndef MODPLUG_TRACKER
+			// With lazy sample decoding, loaders may postpone decoding of sample data, which then still needs to be read after loading.
+			// fileName is only valid during loading, but ReadOrDeferSample() never hands the file name on to the postponed decoders.
+			FileReader moduleFile = file;
+			mpt::PathString fileName = file.GetFileName();
+			if(m_lazySampleDecoding && (loadFlags & loadSampleData))
+			{
+				file.Rewind();
+				FileReader::PinnedRawDataView fileData = file.GetPinnedRawDataView(file.GetLength());
+				if(m_lazySampleFileData == nullptr || m_lazySampleFileData->data() != fileData.data() || m_lazySampleFileData->size() != fileData.size())
+					m_lazySampleFileData = std::make_shared<const std::vector<mpt::byte>>(fileData.begin(), fileData.end());
+				moduleFile = FileReader(mpt::as_span(*m_lazySampleFileData), &fileName);
+			}
+#else
+			FileReader &moduleFile = file;
+#endif // !MODPLUG_TRACKER
+
+			// Try all module format loaders, skipping those whose magic bytes are not found in the file
+			const ModuleFormatIndex &formatIndex = ModuleFormatIndex::Get();
+			mpt::byte header[PROBE_RECOMMENDED_SIZE];
+			file.Rewind();
+			const std::size_t headerSize = file.GetRaw(mpt::as_span(header, formatIndex.signatureSize));
+			const uint64 candidates = formatIndex.GetCandidates(mpt::span<const mpt::byte>(header, headerSize), true);
 			bool loaderSuccess = false;
-			for(const auto &format : ModuleFormatLoaders)
+			for(std::size_t f = 0; f < CountOf(ModuleFormatLoaders); f++)
 			{
-				loaderSuccess = (this->*(format.loader))(file, loadFlags);
+				if(!(candidates & (uint64(1) << f)))
+					continue;
+				loaderSuccess = (this->*(ModuleFormatLoaders[f].loader))(moduleFile, loadFlags);
 				if(loaderSuccess)
 					break;
 			}
@@ -428,6 +544,10 @@ bool CSoundFile::Create(FileReader file, ModLoadingFlags loadFlags)
 				m_nType = MOD_TYPE_NONE;
 				m_ContainerType = MOD_CONTAINERTYPE_NONE;
 			}
+			if(m_pendingSampleDecoders.empty())
+			{
+				m_lazySampleFileData.reset();
+			}
 			if(loadFlags == onlyVerifyHeader)
 			{
 				return loaderSuccess;
@@ -442,7 +562,12 @@ bool CSoundFile::Create(FileReader file, ModLoadingFlags loadFlags)
 			// Read archive comment if there is no song comment
 			if(m_songMessage.empty())
 			{
-				m_songMessage.assign(mpt::ToCharset(mpt::CharsetLocale, unarchiver.GetComment()));
+				// Avoid the (comparatively expensive) charset conversion if there is no comment at all
+				const mpt::ustring comment = unarchiver.GetComment();
+				if(!comment.empty())
+				{
+					m_songMessage.assign(mpt::ToCharset(mpt::CharsetLocale, comment));
+				}
 			}
 #endif
 		} MPT_EXCEPTION_CATCH_OUT_OF_MEMORY(e)
@@ -556,6 +681,8 @@ bool CSoundFile::Create(FileReader file, ModLoadingFlags loadFlags)
 
 	RecalculateSamplesPerTick();
 	visitedSongRows.Initialize(true);
+	if(m_seekIndex != nullptr)
+		m_seekIndex->Clear();
 
 	for(auto &order : Order)
 	{
@@ -658,6 +785,12 @@ bool CSoundFile::Create(FileReader file, ModLoadingFlags loadFlags)
 	{
 		UpgradeModule();
 	}
+
+	// Build the filter cutoff table now rather than when the first filtered note is rendered
+	if((loadFlags & loadPatternData) && UsesResonantFilter())
+	{
+		UpdateCutoffFrequencyCache();
+	}
 	return true;
 }
 
@@ -673,15 +806,26 @@ bool CSoundFile::Destroy()
 	}
 
 	Patterns.DestroyPatterns();
+#if defined(MPT_ENABLE_THREAD)
+	m_backgroundSampleDecoder.reset();
+#endif // MPT_ENABLE_THREAD
+	m_pendingSampleDecoders.clear();
+	m_lazySampleFileData.reset();
 
 	m_songName.clear();
 	m_songArtist.clear();
 	m_songMessage.clear();
 	m_FileHistory.clear();
 
-	for(auto &smp : Samples)
+	if(m_sharedSamples)
+	{
+		m_sharedSamples->Detach(*this);
+		m_sharedSamples.reset();
+	}
+	for(SAMPLEINDEX smp = 0; smp < MAX_SAMPLES; smp++)
 	{
-		smp.FreeSample();
+		if(Samples.is_allocated(smp))
+			Samples[smp].FreeSample();
 	}
 	for(auto &ins : Instruments)
 	{
@@ -695,6 +839,9 @@ bool CSoundFile::Destroy()
 	}
 #endif // NO_PLUGINS
 
+	if(m_seekIndex != nullptr)
+		m_seekIndex->Clear();
+
 	m_nType = MOD_TYPE_NONE;
 	m_ContainerType = MOD_CONTAINERTYPE_NONE;
 	m_nChannels = m_nSamples = m_nInstruments = 0;
@@ -702,6 +849,151 @@ bool CSoundFile::Destroy()
 }
 
 
+void CSoundFile::ShareSampleData(const std::string &key)
+{
+	if(m_sharedSamples)
+	{
+		m_sharedSamples->Detach(*this);
+	}
+	m_sharedSamples = SharedSampleData::Share(*this, key);
+}
+
+
+void CSoundFile::DecodePendingSample(SAMPLEINDEX smp)
+{
+	if(smp >= m_pendingSampleDecoders.size() || !m_pendingSampleDecoders[smp])
+		return;
+
+	// Only try once, even if decoding fails
+	PendingSampleDecoder decoder;
+	decoder.swap(m_pendingSampleDecoders[smp]);
+
+	ModSample decodedSample = Samples[smp];
+	decodedSample.pData.pSample = nullptr;
+	std::vector<std::pair<LogLevel, mpt::ustring>> messages;
+	bool success = false;
+#if defined(MPT_ENABLE_THREAD)
+	if(m_backgroundSampleDecoder == nullptr || !m_backgroundSampleDecoder->Take(smp, decodedSample, messages, success))
+#endif // MPT_ENABLE_THREAD
+	{
+		try
+		{
+			success = decoder(decodedSample, messages);
+		} catch(...)
+		{
+			decodedSample.FreeSample();
+			throw;
+		}
+	}
+	FinishPendingSample(smp, decodedSample, success, messages);
+}
+
+
+void CSoundFile::DecodePendingSamplesInBackground()
+{
+#if defined(MPT_ENABLE_THREAD)
+	if(m_pendingSampleDecoders.empty() || m_backgroundSampleDecoder != nullptr)
+		return;
+	std::vector<BackgroundSampleDecoder::Job> jobs;
+	for(SAMPLEINDEX smp = 1; smp < m_pendingSampleDecoders.size(); smp++)
+	{
+		if(m_pendingSampleDecoders[smp])
+			jobs.emplace_back(smp, Samples[smp], m_pendingSampleDecoders[smp]);
+	}
+	m_backgroundSampleDecoder = std::make_unique<BackgroundSampleDecoder>(std::move(jobs));
+#endif // MPT_ENABLE_THREAD
+}
+
+
+void CSoundFile::FinishBackgroundDecodedSamples()
+{
+#if defined(MPT_ENABLE_THREAD)
+	SAMPLEINDEX smp;
+	ModSample decodedSample;
+	std::vector<std::pair<LogLevel, mpt::ustring>> messages;
+	bool success;
+	while(m_backgroundSampleDecoder != nullptr && m_backgroundSampleDecoder->TakeFinished(smp, decodedSample, messages, success))
+	{
+		if(smp < m_pendingSampleDecoders.size() && m_pendingSampleDecoders[smp])
+		{
+			m_pendingSampleDecoders[smp] = nullptr;
+			FinishPendingSample(smp, decodedSample, success, messages);
+		} else
+		{
+			// The sample has been deleted in the meantime.
+			decodedSample.FreeSample();
+		}
+	}
+#endif // MPT_ENABLE_THREAD
+}
+
+
+void CSoundFile::FinishPendingSample(SAMPLEINDEX smp, ModSample &decodedSample, bool success, const std::vector<std::pair<LogLevel, mpt::ustring>> &messages)
+{
+	for(const auto &message : messages)
+	{
+		AddToLog(message.first, message.second);
+	}
+
+	ModSample &sample = Samples[smp];
+	if(!success)
+	{
+		AddToLog(LogWarning, mpt::format(U_("Sample %1 could not be decoded."))(smp));
+	} else if(decodedSample.HasSampleData() && sample.HasSampleData() && decodedSample.nLength == sample.nLength && decodedSample.GetBytesPerSample() == sample.GetBytesPerSample())
+	{
+		// Channels that are about to play this sample may already point to the allocated sample memory, so copy the decoded sample over.
+		// The silent placeholder data might be shared with other modules.
+		if(m_sharedSamples == nullptr || m_sharedSamples->Unshare(smp, sample))
+		{
+			memcpy(sample.samplev(), decodedSample.samplev(), sample.GetSampleSizeInBytes());
+			sample.PrecomputeLoops(*this, false);
+		}
+	}
+	decodedSample.FreeSample();
+
+	if(std::find_if(m_pendingSampleDecoders.begin(), m_pendingSampleDecoders.end(), [](const PendingSampleDecoder &f) { return static_cast<bool>(f); }) != m_pendingSampleDecoders.end())
+		return;
+	m_pendingSampleDecoders.clear();
+#if defined(MPT_ENABLE_THREAD)
+	m_backgroundSampleDecoder.reset();
+#endif // MPT_ENABLE_THREAD
+	// This was the last decoder that could read from the module data.
+	m_lazySampleFileData.reset();
+}
+
+
+bool CSoundFile::ReadOrDeferSample(SAMPLEINDEX smp, const SampleIO &sampleIO, FileReader &file)
+{
+	ModSample &sample = Samples[smp];
+	if(!m_lazySampleDecoding || !sampleIO.UsesFileReaderForDecoding() || m_lazySampleFileData == nullptr || !file.CanRead(1))
+	{
+		sampleIO.ReadSample(sample, file);
+		return true;
+	}
+	// Decoding can only be postponed if the sample data is part of our copy of the module data,
+	// and not e.g. part of a temporary buffer that a loader has unpacked it to.
+	const mpt::byte *fileData = m_lazySampleFileData->data(), *sampleData = file.GetPinnedRawDataView(1).data();
+	if(sampleData < fileData || sampleData >= fileData + m_lazySampleFileData->size())
+	{
+		sampleIO.ReadSample(sample, file);
+		return true;
+	}
+
+	if(!sampleIO.PrepareSample(sample, file.BytesLeft()))
+		return false;
+	if(m_pendingSampleDecoders.size() <= smp)
+		m_pendingSampleDecoders.resize(smp + 1);
+	// Decode from a chunk rather than from file itself: Chunks carry no file name, which points to memory that does not outlive loading.
+	FileReader sampleFile = file.GetChunkAt(file.GetPosition(), file.BytesLeft());
+	m_pendingSampleDecoders[smp] = [sampleIO, sampleFile](ModSample &sample, std::vector<std::pair<LogLevel, mpt::ustring>> &) mutable
+	{
+		sampleIO.ReadSample(sample, sampleFile);
+		return sample.HasSampleData();
+	};
+	return false;
+}
+
+
 //////////////////////////////////////////////////////////////////////////
 // Misc functions
 
@@ -1406,6 +1698,8 @@ bool CSoundFile::DestroySample(SAMPLEINDEX nSample)
 	}
 
 	ModSample &sample = Samples[nSample];
+	if(nSample < m_pendingSampleDecoders.size())
+		m_pendingSampleDecoders[nSample] = nullptr;
 
 	for(auto &chn : m_PlayState.Chn)
 	{
@@ -1417,6 +1711,8 @@ bool CSoundFile::DestroySample(SAMPLEINDEX nSample)
 		}
 	}
 
+	if(m_sharedSamples != nullptr && m_sharedSamples->IsShared(nSample, sample))
+		sample.pData.pSample = nullptr;
 	sample.FreeSample();
 	sample.nLength = 0;
 	sample.uFlags.reset(CHN_16BIT | CHN_STEREO);
@@ -17,9 +17,11 @@
 #include "MixerSettings.h"
 #include "../common/misc_util.h"
 #include "../common/mptRandom.h"
+#include "../common/mptPagedArray.h"
 #include "../common/version.h"
 #include <vector>
 #include <bitset>
+#include <functional>
 #include <set>
 #include "Snd_defs.h"
 #include "tuningbase.h"
@@ -30,6 +32,7 @@
 
 #include "Mixer.h"
 #include "Resampler.h"
+#include "MixerInterface.h"
 #ifndef NO_REVERB
 #include "../sounddsp/Reverb.h"
 #endif
@@ -213,6 +216,11 @@ class CTuningCollection;
 typedef Tuning::CTuningCollection CTuningCollection;
 struct CModSpecifications;
 class OPL;
+class SeekIndex;
+class SharedSampleData;
+class SampleIO;
+class MixThreadPool;
+class BackgroundSampleDecoder;
 #ifdef MODPLUG_TRACKER
 class CModDoc;
 #endif // MODPLUG_TRACKER
@@ -294,9 +302,17 @@ public:
 typedef MPT_UCHAR_TYPE NoteName[4];
 
 
+// Decodes a sample whose decoding has been postponed, see CSoundFile::SetLazySampleDecoding().
+// The decoder receives a copy of the sample properties without sample memory and allocates the sample itself.
+// It must not access the module, so that it can run on any thread; log messages are returned through the second parameter.
+// Returns false if the sample could not be decoded.
+typedef std::function<bool(ModSample &, std::vector<std::pair<LogLevel, mpt::ustring>> &)> PendingSampleDecoder;
+
+
 class CSoundFile
 {
 	friend class GetLengthMemory;
+	friend class SharedSampleData;
 
 public:
 #ifdef MODPLUG_TRACKER
@@ -351,14 +367,26 @@ private: //Misc data
 	const CModSpecifications *m_pModSpecs;
 
 private:
-	// Interleaved Front Mix Buffer (Also room for interleaved rear mix)
-	mixsample_t MixSoundBuffer[MIXBUFFERSIZE * 4];
-	mixsample_t MixRearBuffer[MIXBUFFERSIZE * 2];
-	// Non-interleaved plugin processing buffer
+	// Maximum number of frames that are mixed at once, see SetMixBlockSize()
+	uint32 m_mixBlockSize = MIXBUFFERSIZE;
+	// Voices below this level are not mixed, see SetVoiceCullThreshold()
+	double m_voiceCullThreshold = 0.0;
+	int32 m_voiceCullVolume = 0;	// Same in mixer volume units (ModChannel::leftVol / rightVol), 0 = disabled
+	// Mix voices that share the same mix function in groups, see SetMultiVoiceMixing()
+	bool m_multiVoiceMixing = true;
+	// Cutoff frequencies for every value of cutoff * (envModifier + 256), built after loading and in InitPlayer() if the module uses filters, see UpdateCutoffFrequencyCache()
+	mutable std::vector<uint16> m_cutoffFrequencyCache;
+	mutable uint32 m_cutoffFrequencyCacheMixingFreq = 0;	// Mixing frequency and filter range that the cache was built for
+	mutable uint8 m_cutoffFrequencyCacheRange = 0;
+	// Interleaved Front Mix Buffer (Also room for interleaved rear mix), m_mixBlockSize frames
+	mpt::aligned_buffer<mixsample_t, 16> MixSoundBuffer{MIXBUFFERSIZE * 4};
+	mpt::aligned_buffer<mixsample_t, 16> MixRearBuffer{MIXBUFFERSIZE * 2};
+	// Non-interleaved plugin processing buffer (plugins are always processed in chunks of at most MIXBUFFERSIZE frames)
 	float MixFloatBuffer[2][MIXBUFFERSIZE];
 	mixsample_t gnDryLOfsVol = 0;
 	mixsample_t gnDryROfsVol = 0;
-	mixsample_t MixInputBuffer[NUMMIXINPUTBUFFERS][MIXBUFFERSIZE];
+	// NUMMIXINPUTBUFFERS non-interleaved buffers of m_mixBlockSize frames
+	mpt::aligned_buffer<mixsample_t, 16> MixInputBuffer{NUMMIXINPUTBUFFERS * MIXBUFFERSIZE};
 
 public:
 	MixerSettings m_MixerSettings;
@@ -432,14 +460,14 @@ public:
 	CPatternContainer Patterns;
 	ModSequenceSet Order;								// Pattern sequences (order lists)
 protected:
-	ModSample Samples[MAX_SAMPLES];						// Sample Headers
+	mpt::paged_array<ModSample, MAX_SAMPLES> Samples;	// Sample Headers, only allocated for slots that are actually used
 public:
 	ModInstrument *Instruments[MAX_INSTRUMENTS];		// Instrument Headers
 	MIDIMacroConfig m_MidiCfg;							// MIDI Macro config table
 #ifndef NO_PLUGINS
 	SNDMIXPLUGIN m_MixPlugins[MAX_MIXPLUGINS];			// Mix plugins
 #endif
-	mpt::charbuf<MAX_SAMPLENAME> m_szNames[MAX_SAMPLES];  // Sample names
+	mpt::paged_array<mpt::charbuf<MAX_SAMPLENAME>, MAX_SAMPLES> m_szNames;  // Sample names
 
 	Version m_dwCreatedWithVersion;
 	Version m_dwLastSavedWithVersion;
@@ -458,7 +486,8 @@ protected:
 	MixLevels m_nMixLevels;
 
 public:
-	struct PlayState
+	// Global playback state, i.e. everything but the channel arrays
+	struct PlayStateGlobals
 	{
 		friend class CSoundFile;
 	protected:
@@ -497,6 +526,25 @@ public:
 	public:
 		bool m_bPositionChanged = true; // Report to plugins that we jumped around in the module
 
+		// Copy the state that is simulated by GetLength() from a seek index checkpoint.
+		// The mixer state (buffer position, global volume ramp) and the sequence override are not simulated and are kept as they are.
+		void RestoreSimulatedState(const PlayStateGlobals &checkpoint)
+		{
+			const PlayStateGlobals live = *this;
+			*this = checkpoint;
+			m_nBufferCount = live.m_nBufferCount;
+			m_dBufferDiff = live.m_dBufferDiff;
+			m_nSeqOverride = live.m_nSeqOverride;
+			m_nSamplesToGlobalVolRampDest = live.m_nSamplesToGlobalVolRampDest;
+			m_nGlobalVolumeRampAmount = live.m_nGlobalVolumeRampAmount;
+			m_nGlobalVolumeDestination = live.m_nGlobalVolumeDestination;
+			m_lHighResRampingGlobalVolume = live.m_lHighResRampingGlobalVolume;
+		}
+	};
+
+	struct PlayState : public PlayStateGlobals
+	{
+		friend class CSoundFile;
 	public:
 		CHANNELINDEX ChnMix[MAX_CHANNELS]; // Channels to be mixed
 		ModChannel Chn[MAX_CHANNELS];      // Mixing channels... First m_nChannels channels are master channels (i.e. they are never NNA channels)!
@@ -513,6 +561,38 @@ public:
 protected:
 	// For handling backwards jumps and stuff to prevent infinite loops when counting the mod length or rendering to wav.
 	RowVisitor visitedSongRows;
+	// Playback state checkpoints for faster seeking in GetLength(), only allocated if enabled.
+	std::unique_ptr<SeekIndex> m_seekIndex;
+	// Sample data that is shared with other modules loaded from the same file, only allocated if enabled.
+	std::shared_ptr<SharedSampleData> m_sharedSamples;
+	// Decoders for samples that are decoded when they are played for the first time (indexed by sample), see SetLazySampleDecoding().
+	std::vector<PendingSampleDecoder> m_pendingSampleDecoders;
+	// Copy of the module data that pending decoders may read from, as the original data is not guaranteed to outlive loading.
+	std::shared_ptr<const std::vector<mpt::byte>> m_lazySampleFileData;
+#if defined(MPT_ENABLE_THREAD)
+	// Worker thread that decodes pending samples ahead of time, see DecodePendingSamplesInBackground().
+	// Declared after m_lazySampleFileData, as the worker may read from it until it is destroyed.
+	std::unique_ptr<BackgroundSampleDecoder> m_backgroundSampleDecoder;
+#endif // MPT_ENABLE_THREAD
+	uint32 m_sampleDecodeThreads = 1;
+	bool m_lazySampleDecoding = false;
+#if defined(MPT_ENABLE_THREAD) && defined(MPT_INTMIXER)
+	// Worker threads for mixing channels in parallel, only allocated if enabled.
+	std::unique_ptr<MixThreadPool> m_mixThreadPool;
+#endif // MPT_ENABLE_THREAD && MPT_INTMIXER
+#ifndef NO_PLUGINS
+	// All slots that currently hold a plugin, in processing order. As plugins can only send their output to plugins in higher slots,
+	// slot order is also a valid processing order for the routing graph.
+	struct PluginGraphNode
+	{
+		IMixPlugin *plugin;
+		uint32 outputRouting;	// Copy of the slot's output routing, for detecting routing changes
+		PLUGINDEX slot;
+		bool hasPluginInput;	// Another active plugin sends its output to this plugin
+	};
+	std::vector<PluginGraphNode> m_pluginGraph;
+	bool m_pluginGraphValid = false;
+#endif // NO_PLUGINS
 
 public:
 #ifdef MODPLUG_TRACKER
@@ -586,6 +666,7 @@ public:
 		loadPluginInstance = 0x08, // If unset, plugins are not instanciated.
 		skipContainer      = 0x10,
 		skipModules        = 0x20,
+		onlyMetadata       = 0x40, // Read the module header, names and song message even if none of the other load flags are set
 
 		// Shortcuts
 		loadCompleteModule = loadSampleData | loadPatternData | loadPluginData | loadPluginInstance,
@@ -615,7 +696,9 @@ public:
 
 	static ProbeResult ProbeAdditionalSize(MemoryFileReader &file, const uint64 *pfilesize, uint64 minimumAdditionalSize);
 
-	static ProbeResult Probe(ProbeFlags flags, mpt::span<const mpt::byte> data, const uint64 *pfilesize);
+	// If useFormatIndex is false, all module format probers are tried instead of only those whose magic bytes match.
+	// The result is the same either way.
+	static ProbeResult Probe(ProbeFlags flags, mpt::span<const mpt::byte> data, const uint64 *pfilesize, bool useFormatIndex = true);
 
 public:
 
@@ -687,6 +770,48 @@ public:
 
 	// Get song duration in various cases: total length, length to specific order & row, etc.
 	std::vector<GetLengthType> GetLength(enmGetLengthResetMode adjustMode, GetLengthTarget target = GetLengthTarget());
+	// Store a checkpoint of the playback state every few seconds while calculating song lengths, so that later seeks do not have to start from the beginning of the song.
+	// An interval of 0 disables the seek index. The index must be disabled if the module may be modified.
+	void SetSeekIndexInterval(double seconds);
+	double GetSeekIndexInterval() const;
+	// Get the lengths of all sub songs of all sequences, i.e. GetLength(eNoAdjust, GetLengthTarget(true).StartPos(seq, 0, 0)) for each sequence.
+	// Sequences are scanned on up to numThreads threads at once (0 = one per CPU core). The result does not depend on the number of threads.
+	std::vector<std::vector<GetLengthType>> GetLengthOfAllSequences(uint32 numThreads = 1);
+	// Share sample data with other modules that were loaded with the same key (e.g. a hash of the file contents and load flags) to save memory.
+	// Only byte-identical sample data is shared. Sample data must not be modified afterwards, except through the Invert Loop effect.
+	void ShareSampleData(const std::string &key);
+	bool HasSharedSampleData() const { return m_sharedSamples != nullptr; }
+	// Decode compressed samples on up to numThreads threads at once while loading (0 = one per CPU core, 1 = decode on the calling thread only).
+	// The result does not depend on the number of threads. Must be set before loading; currently only used by the MO3 loader.
+	void SetSampleDecodeThreads(uint32 numThreads) { m_sampleDecodeThreads = numThreads; }
+	uint32 GetSampleDecodeThreads() const { return m_sampleDecodeThreads; }
+	// Postpone decoding of compressed samples until they are played for the first time, which makes loading faster.
+	// Memory for the samples is still allocated while loading. Must be set before loading; currently used for Ogg Vorbis samples in MO3 files
+	// and for compressed samples that are read through ReadOrDeferSample().
+	// Only suitable for playback: Sample data is not available until the sample has been played.
+	// Note that the whole module file is copied while loading (even if it is already in memory, e.g. memory-mapped, as there is no way
+	// to tell whether that memory outlives the module), and the copy is kept until the last postponed sample has been decoded.
+	void SetLazySampleDecoding(bool lazy) { m_lazySampleDecoding = lazy; }
+	bool GetLazySampleDecoding() const { return m_lazySampleDecoding; }
+	// With lazy sample decoding, a copy of the module data is made while loading. If the caller keeps its own copy of the data anyway,
+	// it can pass it here and load the module from it instead, so that no additional copy is made. Must be set before loading.
+	void SetLazySampleFileData(std::shared_ptr<const std::vector<mpt::byte>> data) { m_lazySampleFileData = std::move(data); }
+	// Decode a sample now if its decoding has been postponed.
+	void DecodePendingSample(SAMPLEINDEX smp);
+	// Start decoding all postponed samples on a worker thread, so that they are ready before they are played.
+	// Decoded samples are put in place by the next call to Read() or when they are needed for playback, so sample memory
+	// is never modified behind the back of the thread that renders the module. Samples that are needed before the worker
+	// thread got to them are decoded on demand as usual. Without thread support, this does nothing.
+	void DecodePendingSamplesInBackground();
+	bool HasPendingSamples() const { return !m_pendingSampleDecoders.empty(); }
+	// Read sample data like SampleIO::ReadSample(), but with lazy sample decoding enabled, decoding of compressed sample data is postponed.
+	// As the size of compressed sample data is only known after decoding it, the file position is not advanced in that case and false is returned.
+	bool ReadOrDeferSample(SAMPLEINDEX smp, const SampleIO &sampleIO, FileReader &file);
+protected:
+	// Put a sample that has been decoded by a PendingSampleDecoder in place and free the decoded copy.
+	void FinishPendingSample(SAMPLEINDEX smp, ModSample &decodedSample, bool success, const std::vector<std::pair<LogLevel, mpt::ustring>> &messages);
+	// Put all samples in place that have been decoded in the background so far.
+	void FinishBackgroundDecodedSamples();
 
 public:
 	void RecalculateSamplesPerTick();
@@ -851,11 +976,50 @@ public:
 	samplecount_t Read(samplecount_t count, IAudioReadTarget &target) { AudioSourceNone source; return Read(count, target, source); }
 	samplecount_t Read(samplecount_t count, IAudioReadTarget &target, IAudioSource &source);
 private:
+	// Where the output of a channel is mixed to
+	struct MixTarget
+	{
+		mixsample_t *buffer;
+		mixsample_t *ofsR, *ofsL;
+		PLUGINDEX plugin;	// Plugin that this channel is routed to (1-based), 0 if none
+		bool pluginBuffer;	// buffer is the plugin's input buffer
+	};
+	MixTarget GetChannelMixTarget(CHANNELINDEX channel, int count);
+	bool MixChannel(ModChannel &chn, const MixFuncInterface *mixFunctions, mixsample_t *pbuffer, mixsample_t &ofsR, mixsample_t &ofsL, int count, bool tooManyChannels) const;
 	void CreateStereoMix(int count);
+#if defined(MPT_ENABLE_THREAD) && defined(MPT_INTMIXER)
+	void CreateStereoMixParallel(int count, const MixFuncInterface *mixFunctions);
+#endif // MPT_ENABLE_THREAD && MPT_INTMIXER
+public:
+	static constexpr uint32 MaxMixThreads = 16;
+	// Distribute channel mixing over several threads. 0 = use all available CPU cores, 1 = mix on the calling thread only (default).
+	// The output is identical to single-threaded mixing. Has no effect if threads are not supported by the build.
+	void SetMixThreads(uint32 numThreads);
+	uint32 GetMixThreads() const;
+	static constexpr uint32 MinMixBlockSize = 16;
+	static constexpr uint32 MaxMixBlockSize = 16384;
+	// Maximum number of frames that are rendered at once (rounded up to a multiple of MinMixBlockSize, 0 = default).
+	// Larger blocks reduce the per-block overhead when rendering offline, as a whole tick can be processed in one go.
+	// Blocks are still limited to MIXBUFFERSIZE frames while mix plugins are loaded, as those always process fixed-size blocks.
+	void SetMixBlockSize(uint32 frames);
+	uint32 GetMixBlockSize() const { return m_mixBlockSize; }
+	// Voices whose peak level stays below this threshold (in dBFS, before master gain, DSP effects and plugins) are not mixed;
+	// only their play position is advanced. Ramping and filtered voices are always mixed. Values >= 0 disable culling of quiet voices.
+	void SetVoiceCullThreshold(double dB);
+	double GetVoiceCullThreshold() const { return m_voiceCullThreshold; }
+	// Mix several non-ramping, unfiltered voices with nearest or linear resampling in one pass (integer mixer only, enabled by default).
+	// The output is identical either way; disabling it forces every voice through the per-voice mixer.
+	void SetMultiVoiceMixing(bool enable) { m_multiVoiceMixing = enable; }
+	bool GetMultiVoiceMixing() const { return m_multiVoiceMixing; }
 public:
 	bool FadeSong(uint32 msec);
+#ifndef NO_PLUGINS
+	// Must be called when a plugin is placed into a previously empty slot. Removed plugins and routing changes are detected automatically.
+	void InvalidatePluginGraph() { m_pluginGraphValid = false; }
+#endif // NO_PLUGINS
 private:
 	void ProcessDSP(uint32 countChunk);
+	void UpdatePluginGraph();
 	void ProcessPlugins(uint32 nCount);
 	void ProcessInputChannels(IAudioSource &source, std::size_t countChunk);
 public:
@@ -979,12 +1143,18 @@ protected:
 	void SendMIDINote(CHANNELINDEX chn, uint16 note, uint16 volume);
 
 	int SetupChannelFilter(ModChannel &chn, bool bReset, int envModifier = 256) const;
+	// Same as CutOffToFrequency, but looked up from a table that is only rebuilt when the mixing frequency or filter range changes
+	uint32 CutOffToFrequencyCached(uint32 nCutOff, int envModifier) const;
+	// Build the table used by CutOffToFrequencyCached if it is missing or outdated
+	void UpdateCutoffFrequencyCache() const;
 
 	// Low-Level effect processing
 	void DoFreqSlide(ModChannel &chn, int32 nFreqSlide) const;
 	void UpdateTimeSignature();
 
 public:
+	// Check if any instrument or MIDI macro in the patterns can enable the resonant filter
+	bool UsesResonantFilter() const;
 	// Convert frequency to IT cutoff (0...127)
 	uint8 FrequencyToCutOff(double frequency) const;
 	// Convert IT cutoff (0...127 + modifier) to frequency
@@ -1091,8 +1261,8 @@ public:
 	uint32 GetPeriodFromNote(uint32 note, int32 nFineTune, uint32 nC5Speed) const;
 	uint32 GetFreqFromPeriod(uint32 period, uint32 c5speed, int32 nPeriodFrac = 0) const;
 	// Misc functions
-	ModSample &GetSample(SAMPLEINDEX sample) { MPT_ASSERT(sample <= m_nSamples && sample < CountOf(Samples)); return Samples[sample]; }
-	const ModSample &GetSample(SAMPLEINDEX sample) const { MPT_ASSERT(sample <= m_nSamples && sample < CountOf(Samples)); return Samples[sample]; }
+	ModSample &GetSample(SAMPLEINDEX sample) { MPT_ASSERT(sample <= m_nSamples && sample < Samples.size()); return Samples[sample]; }
+	const ModSample &GetSample(SAMPLEINDEX sample) const { MPT_ASSERT(sample <= m_nSamples && sample < Samples.size()); return Samples[sample]; }
 
 	uint32 MapMidiInstrument(uint8 program, uint16 bank, uint8 midiChannel, uint8 note, bool isXG, std::bitset<16> drumChns);
 	size_t ITInstrToMPT(FileReader &file, ModInstrument &ins, uint16 trkvers);
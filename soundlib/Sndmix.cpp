@@ -23,6 +23,8 @@
 #include "plugins/PlugInterface.h"
 #endif // NO_PLUGINS
 #include "OPL.h"
+#include "MixThreadPool.h"
+#include <cmath>
 
 OPENMPT_NAMESPACE_BEGIN
 
@@ -111,6 +113,11 @@ void CSoundFile::InitPlayer(bool bReset)
 	{
 		m_opl->Initialize(m_MixerSettings.gdwMixingFreq);
 	}
+	// The mixing frequency may have changed, so the filter cutoff table may have to be rebuilt
+	if(UsesResonantFilter())
+	{
+		UpdateCutoffFrequencyCache();
+	}
 }
 
 
@@ -190,14 +197,11 @@ static void ApplyStereoSeparation(mixsample_t *SoundFrontBuffer, mixsample_t *So
 
 void CSoundFile::ProcessInputChannels(IAudioSource &source, std::size_t countChunk)
 {
-	for(std::size_t channel = 0; channel < NUMMIXINPUTBUFFERS; ++channel)
-	{
-		std::fill(&(MixInputBuffer[channel][0]), &(MixInputBuffer[channel][countChunk]), 0);
-	}
 	mixsample_t * buffers[NUMMIXINPUTBUFFERS];
 	for(std::size_t channel = 0; channel < NUMMIXINPUTBUFFERS; ++channel)
 	{
-		buffers[channel] = MixInputBuffer[channel];
+		buffers[channel] = MixInputBuffer.data() + channel * m_mixBlockSize;
+		std::fill(buffers[channel], buffers[channel] + countChunk, 0);
 	}
 	source.FillCallback(buffers, m_MixerSettings.NumInputChannels, countChunk);
 }
@@ -207,18 +211,21 @@ CSoundFile::samplecount_t CSoundFile::Read(samplecount_t count, IAudioReadTarget
 {
 	MPT_ASSERT_ALWAYS(m_MixerSettings.IsValid());
 
+#if defined(MPT_ENABLE_THREAD)
+	// Put samples in place that have been decoded in the background in the meantime
+	if(m_backgroundSampleDecoder != nullptr)
+		FinishBackgroundDecodedSamples();
+#endif // MPT_ENABLE_THREAD
+
 	bool mixPlugins = false;
 #ifndef NO_PLUGINS
-	for(const auto &plug : m_MixPlugins)
-	{
-		if(plug.pMixPlugin)
-		{
-			mixPlugins = true;
-			break;
-		}
-	}
+	UpdatePluginGraph();
+	mixPlugins = !m_pluginGraph.empty();
 #endif // NO_PLUGINS
 
+	// Plugins always process blocks of at most MIXBUFFERSIZE frames
+	const samplecount_t maxCountChunk = mixPlugins ? std::min<samplecount_t>(m_mixBlockSize, MIXBUFFERSIZE) : m_mixBlockSize;
+
 	samplecount_t countRendered = 0;
 	samplecount_t countToRender = count;
 
@@ -290,7 +297,7 @@ CSoundFile::samplecount_t CSoundFile::Read(samplecount_t count, IAudioReadTarget
 
 		MPT_ASSERT(m_PlayState.m_nBufferCount > 0); // assert that we have actually something to do
 
-		const samplecount_t countChunk = std::min<samplecount_t>({ MIXBUFFERSIZE, m_PlayState.m_nBufferCount, countToRender });
+		const samplecount_t countChunk = std::min<samplecount_t>({ maxCountChunk, m_PlayState.m_nBufferCount, countToRender });
 
 		if(m_MixerSettings.NumInputChannels > 0)
 		{
@@ -301,11 +308,11 @@ CSoundFile::samplecount_t CSoundFile::Read(samplecount_t count, IAudioReadTarget
 
 		if(m_opl)
 		{
-			m_opl->Mix(MixSoundBuffer, countChunk, m_OPLVolumeFactor * m_nVSTiVolume / 48);
+			m_opl->Mix(MixSoundBuffer.data(), countChunk, m_OPLVolumeFactor * m_nVSTiVolume / 48);
 		}
 
 		#ifndef NO_REVERB
-			m_Reverb.Process(MixSoundBuffer, countChunk);
+			m_Reverb.Process(MixSoundBuffer.data(), countChunk);
 		#endif // NO_REVERB
 
 		if(mixPlugins)
@@ -315,7 +322,7 @@ CSoundFile::samplecount_t CSoundFile::Read(samplecount_t count, IAudioReadTarget
 
 		if(m_MixerSettings.gnChannels == 1)
 		{
-			MonoFromStereo(MixSoundBuffer, countChunk);
+			MonoFromStereo(MixSoundBuffer.data(), countChunk);
 		}
 
 		if(m_PlayConfig.getGlobalVolumeAppliesToMaster())
@@ -335,10 +342,10 @@ CSoundFile::samplecount_t CSoundFile::Read(samplecount_t count, IAudioReadTarget
 
 		if(m_MixerSettings.gnChannels == 4)
 		{
-			InterleaveFrontRear(MixSoundBuffer, MixRearBuffer, countChunk);
+			InterleaveFrontRear(MixSoundBuffer.data(), MixRearBuffer.data(), countChunk);
 		}
 
-		target.DataCallback(MixSoundBuffer, m_MixerSettings.gnChannels, countChunk);
+		target.DataCallback(MixSoundBuffer.data(), m_MixerSettings.gnChannels, countChunk);
 
 		// Buffer ready
 		countRendered += countChunk;
@@ -370,33 +377,69 @@ CSoundFile::samplecount_t CSoundFile::Read(samplecount_t count, IAudioReadTarget
 }
 
 
+void CSoundFile::SetMixBlockSize(uint32 frames)
+{
+	if(frames == 0)
+		frames = MIXBUFFERSIZE;
+	Limit(frames, MinMixBlockSize, MaxMixBlockSize);
+	frames = Util::AlignUp(frames, MinMixBlockSize);
+	if(frames == m_mixBlockSize)
+		return;
+	MixSoundBuffer.destructive_resize(frames * 4);
+	MixRearBuffer.destructive_resize(frames * 2);
+	MixInputBuffer.destructive_resize(NUMMIXINPUTBUFFERS * frames);
+#ifndef NO_REVERB
+	m_Reverb.SetBlockSize(frames);
+#endif // NO_REVERB
+#if defined(MPT_ENABLE_THREAD) && defined(MPT_INTMIXER)
+	if(m_mixThreadPool != nullptr)
+		m_mixThreadPool->SetBlockSize(frames);
+#endif // MPT_ENABLE_THREAD && MPT_INTMIXER
+	m_mixBlockSize = frames;
+}
+
+
+void CSoundFile::SetVoiceCullThreshold(double dB)
+{
+	m_voiceCullThreshold = 0.0;
+	m_voiceCullVolume = 0;
+	if(dB < 0.0)
+	{
+		// A full-scale 16-bit sample played at this volume reaches full scale in the mix buffer
+		const double fullScaleVolume = static_cast<double>(1 << (MIXING_FRACTIONAL_BITS - 15));
+		m_voiceCullThreshold = dB;
+		m_voiceCullVolume = mpt::saturate_cast<int32>(std::ceil(fullScaleVolume * std::pow(10.0, dB / 20.0)));
+	}
+}
+
+
 void CSoundFile::ProcessDSP(uint32 countChunk)
 {
 	#ifndef NO_DSP
 		if(m_MixerSettings.DSPMask & SNDDSP_SURROUND)
 		{
-			m_Surround.Process(MixSoundBuffer, MixRearBuffer, countChunk, m_MixerSettings.gnChannels);
+			m_Surround.Process(MixSoundBuffer.data(), MixRearBuffer.data(), countChunk, m_MixerSettings.gnChannels);
 		}
 	#endif // NO_DSP
 
 	#ifndef NO_DSP
 		if(m_MixerSettings.DSPMask & SNDDSP_MEGABASS)
 		{
-			m_MegaBass.Process(MixSoundBuffer, MixRearBuffer, countChunk, m_MixerSettings.gnChannels);
+			m_MegaBass.Process(MixSoundBuffer.data(), MixRearBuffer.data(), countChunk, m_MixerSettings.gnChannels);
 		}
 	#endif // NO_DSP
 
 	#ifndef NO_EQ
 		if(m_MixerSettings.DSPMask & SNDDSP_EQ)
 		{
-			m_EQ.Process(MixSoundBuffer, MixRearBuffer, countChunk, m_MixerSettings.gnChannels);
+			m_EQ.Process(MixSoundBuffer.data(), MixRearBuffer.data(), countChunk, m_MixerSettings.gnChannels);
 		}
 	#endif // NO_EQ
 
 	#ifndef NO_AGC
 		if(m_MixerSettings.DSPMask & SNDDSP_AGC)
 		{
-			m_AGC.Process(MixSoundBuffer, MixRearBuffer, countChunk, m_MixerSettings.gnChannels);
+			m_AGC.Process(MixSoundBuffer.data(), MixRearBuffer.data(), countChunk, m_MixerSettings.gnChannels);
 		}
 	#endif // NO_AGC
 	#if defined(NO_DSP) && defined(NO_EQ) && defined(NO_AGC)
@@ -2311,6 +2354,11 @@ bool CSoundFile::ReadNote()
 		if (chn.nRightVU > VUMETER_DECAY) chn.nRightVU -= VUMETER_DECAY; else chn.nRightVU = 0;
 
 		chn.newLeftVol = chn.newRightVol = 0;
+		if(!m_pendingSampleDecoders.empty() && chn.pModSample != nullptr && chn.IsSamplePlaying())
+		{
+			// Lazy sample decoding: The sample is played for the first time
+			DecodePendingSample(static_cast<SAMPLEINDEX>(Samples.index_of(chn.pModSample)));
+		}
 		chn.pCurrentSample = (chn.pModSample && chn.pModSample->HasSampleData() && chn.nLength && chn.IsSamplePlaying()) ? chn.pModSample->samplev() : nullptr;
 		if (chn.pCurrentSample || (chn.HasMIDIOutput() && !chn.dwFlags[CHN_KEYOFF | CHN_NOTEFADE]))
 		{
@@ -2667,13 +2715,13 @@ void CSoundFile::ProcessGlobalVolume(long lCount)
 	// apply volume and ramping
 	if(m_MixerSettings.gnChannels == 1)
 	{
-		ApplyGlobalVolumeWithRamping<1>(MixSoundBuffer, MixRearBuffer, lCount, m_PlayState.m_nGlobalVolume, step, m_PlayState.m_nSamplesToGlobalVolRampDest, m_PlayState.m_lHighResRampingGlobalVolume);
+		ApplyGlobalVolumeWithRamping<1>(MixSoundBuffer.data(), MixRearBuffer.data(), lCount, m_PlayState.m_nGlobalVolume, step, m_PlayState.m_nSamplesToGlobalVolRampDest, m_PlayState.m_lHighResRampingGlobalVolume);
 	} else if(m_MixerSettings.gnChannels == 2)
 	{
-		ApplyGlobalVolumeWithRamping<2>(MixSoundBuffer, MixRearBuffer, lCount, m_PlayState.m_nGlobalVolume, step, m_PlayState.m_nSamplesToGlobalVolRampDest, m_PlayState.m_lHighResRampingGlobalVolume);
+		ApplyGlobalVolumeWithRamping<2>(MixSoundBuffer.data(), MixRearBuffer.data(), lCount, m_PlayState.m_nGlobalVolume, step, m_PlayState.m_nSamplesToGlobalVolRampDest, m_PlayState.m_lHighResRampingGlobalVolume);
 	} else if(m_MixerSettings.gnChannels == 4)
 	{
-		ApplyGlobalVolumeWithRamping<4>(MixSoundBuffer, MixRearBuffer, lCount, m_PlayState.m_nGlobalVolume, step, m_PlayState.m_nSamplesToGlobalVolRampDest, m_PlayState.m_lHighResRampingGlobalVolume);
+		ApplyGlobalVolumeWithRamping<4>(MixSoundBuffer.data(), MixRearBuffer.data(), lCount, m_PlayState.m_nGlobalVolume, step, m_PlayState.m_nSamplesToGlobalVolRampDest, m_PlayState.m_lHighResRampingGlobalVolume);
 	}
 
 }
@@ -2681,7 +2729,7 @@ void CSoundFile::ProcessGlobalVolume(long lCount)
 
 void CSoundFile::ProcessStereoSeparation(long countChunk)
 {
-	ApplyStereoSeparation(MixSoundBuffer, MixRearBuffer, m_MixerSettings.gnChannels, countChunk, m_MixerSettings.m_nStereoSeparation);
+	ApplyStereoSeparation(MixSoundBuffer.data(), MixRearBuffer.data(), m_MixerSettings.gnChannels, countChunk, m_MixerSettings.m_nStereoSeparation);
 }
 
 
@@ -337,6 +337,8 @@ void CSoundFile::UpgradeModule()
 		// Convert ANSI plugin path names to UTF-8 (irrelevant in probably 99% of all cases anyway, I think I've never seen a VST plugin with a non-ASCII file name)
 		for(auto &plugin : m_MixPlugins)
 		{
+			if(plugin.Info.szLibraryName.empty())
+				continue;
 #if defined(MODPLUG_TRACKER)
 			const std::string name = mpt::ToCharset(mpt::CharsetUTF8, mpt::CharsetLocale, plugin.Info.szLibraryName);
 #else
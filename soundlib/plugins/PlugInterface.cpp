@@ -77,6 +77,7 @@ IMixPlugin::~IMixPlugin()
 void IMixPlugin::InsertIntoFactoryList()
 {
 	m_pMixStruct->pMixPlugin = this;
+	m_SndFile.InvalidatePluginGraph();
 
 	m_pNext = m_Factory.pPluginsList;
 	if(m_Factory.pPluginsList)
@@ -0,0 +1,188 @@
+/*
+ * benchmark.cpp
+ * -------------
+ * Purpose: Performance measurements for the mixer, sample conversion, IT sample compression and format probing.
+ *          This file contains the shared helpers, the mix block size benchmark and the list of all benchmarks.
+ * Notes  : Not part of the unit tests and not built by default. Build and run it with "make benchmark",
+ *          or pass the names of the benchmarks to run to bin/libopenmpt_benchmark.
+ *          Every benchmark prints the best of several runs, so compare builds on the same, otherwise idle machine.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+#include "benchmark.h"
+
+#include "../../common/FileReader.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+namespace Benchmark {
+
+
+volatile uint64 g_sink = 0;
+
+
+std::vector<mpt::byte> ReadFileContents(const char *filename)
+{
+	std::ifstream f(filename, std::ios::binary);
+	const std::vector<char> data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+	const mpt::byte *begin = mpt::byte_cast<const mpt::byte *>(data.data());
+	return std::vector<mpt::byte>(begin, begin + data.size());
+}
+
+
+void CreateVoiceTestModule(CSoundFile &sndFile, ResamplingMode resampling, bool longTails)
+{
+	std::mt19937 rng(1);
+	sndFile.Create(FileReader(), CSoundFile::loadCompleteModule);
+	sndFile.m_nChannels = 64;
+	sndFile.m_nType = MOD_TYPE_IT;
+	sndFile.m_playBehaviour = CSoundFile::GetDefaultPlaybackBehaviour(MOD_TYPE_IT);
+	sndFile.m_nDefaultSpeed = 3;
+
+	const SAMPLEINDEX numSamples = 32;
+	sndFile.m_nSamples = numSamples;
+	sndFile.m_nInstruments = numSamples;
+	for(SAMPLEINDEX smp = 1; smp <= numSamples; smp++)
+	{
+		ModSample &sample = sndFile.GetSample(smp);
+		sample.Initialize(MOD_TYPE_IT);
+		sample.uFlags.set(CHN_16BIT | CHN_LOOP);
+		if(smp % 4 == 0)
+			sample.uFlags.set(CHN_STEREO);
+		sample.nLength = 20000 + smp * 1500;
+		sample.nLoopStart = sample.nLength / 3;
+		sample.nLoopEnd = sample.nLength;
+		sample.AllocateSample();
+		for(SmpLength i = 0; i < sample.nLength * sample.GetNumChannels(); i++)
+		{
+			sample.sample16()[i] = static_cast<int16>(rng());
+		}
+		sample.PrecomputeLoops(sndFile, false);
+
+		ModInstrument *ins = sndFile.AllocateInstrument(smp, smp);
+		ins->nNNA = NNA_CONTINUE;
+		ins->nFadeOut = 8;
+		ins->resampling = resampling;
+		ins->VolEnv.dwFlags.set(ENV_ENABLED);
+		ins->VolEnv.push_back(0, 64);
+		if(longTails)
+		{
+			ins->VolEnv.push_back(10, 16);
+			ins->VolEnv.push_back(40, 4);
+			ins->VolEnv.push_back(120, 1);
+		}
+		ins->VolEnv.push_back(400, 0);
+	}
+
+	sndFile.Patterns.Insert(0, 64);
+	for(ROWINDEX row = 0; row < 64; row++)
+	{
+		for(CHANNELINDEX chn = 0; chn < sndFile.GetNumChannels(); chn++)
+		{
+			if((row + chn) % 2)
+				continue;
+			ModCommand &m = *sndFile.Patterns[0].GetpModCommand(row, chn);
+			m.note = static_cast<ModCommand::NOTE>(NOTE_MIDDLEC - 24 + (rng() % 48));
+			m.instr = static_cast<ModCommand::INSTR>(1 + rng() % numSamples);
+			m.volcmd = VOLCMD_PANNING;
+			m.vol = static_cast<ModCommand::VOL>(rng() % 65);
+		}
+	}
+	sndFile.Order().assign(1, 0);
+}
+
+
+const char *ResamplingName(ResamplingMode resampling)
+{
+	switch(resampling)
+	{
+	case SRCMODE_NEAREST: return "nearest";
+	case SRCMODE_LINEAR: return "linear";
+	case SRCMODE_CUBIC: return "cubic";
+	case SRCMODE_SINC8: return "sinc8";
+	case SRCMODE_SINC8LP: return "sinc8lp";
+	default: return "default";
+	}
+}
+
+
+// Render the voice test module at 192 kHz in large reads with different maximum mix block sizes.
+static void MixBlockSize()
+{
+	for(uint32 blockSize : { 512u, 1024u, 2048u, 4096u, 16384u })
+	{
+		const uint32 seconds = 10;
+		uint64 checksum = 0;
+		CHANNELINDEX maxVoices = 0;
+		const double ms = RenderVoiceTestModule(SRCMODE_DEFAULT, false, 192000, seconds, 16384, checksum, maxVoices, [blockSize](CSoundFile &sndFile) { sndFile.SetMixBlockSize(blockSize); });
+		std::printf("blocksize %5u: %.1f ms for %us, %.0fx realtime (checksum %016llx)\n", blockSize, ms, seconds, seconds * 1000.0 / ms, static_cast<unsigned long long>(checksum));
+	}
+}
+
+
+struct BenchmarkEntry
+{
+	const char *name;
+	void (*function)();
+};
+
+static const BenchmarkEntry Benchmarks[] =
+{
+	{ "blocksize", MixBlockSize },
+	{ "memory", MemoryFootprint },
+	{ "probe", Probe },
+	{ "itcompression", ITSampleCompression },
+	{ "sampleconversion", SampleConversion },
+	{ "multivoice", MultiVoiceMixing },
+	{ "culling", VoiceCulling },
+	{ "paula", AmigaResampler },
+};
+
+
+} // namespace Benchmark
+
+
+OPENMPT_NAMESPACE_END
+
+
+int main(int argc, char *argv[])
+{
+	using namespace OPENMPT_NAMESPACE::Benchmark;
+	int result = 0;
+	for(const auto &benchmark : Benchmarks)
+	{
+		bool run = (argc <= 1);
+		for(int i = 1; i < argc; i++)
+		{
+			if(!std::strcmp(argv[i], benchmark.name))
+				run = true;
+		}
+		if(run)
+		{
+			benchmark.function();
+			std::fflush(stdout);
+		}
+	}
+	for(int i = 1; i < argc; i++)
+	{
+		if(std::none_of(std::begin(Benchmarks), std::end(Benchmarks), [&](const BenchmarkEntry &benchmark) { return !std::strcmp(argv[i], benchmark.name); }))
+		{
+			std::fprintf(stderr, "Unknown benchmark: %s\n", argv[i]);
+			result = 1;
+		}
+	}
+	return result;
+}
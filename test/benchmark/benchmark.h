@@ -0,0 +1,125 @@
+/*
+ * benchmark.h
+ * -----------
+ * Purpose: Helpers shared by the performance measurements in test/benchmark.
+ * Notes  : Every benchmark is a function without parameters that prints its results, and is listed in the Benchmarks table in benchmark.cpp.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "BuildSettings.h"
+
+#include "../../soundlib/Sndfile.h"
+#include "../../soundlib/AudioReadTarget.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+namespace Benchmark {
+
+
+typedef std::chrono::steady_clock Clock;
+
+
+// Returns the shortest duration of fn() in milliseconds
+template <typename Tfn>
+double BestOf(int runs, Tfn fn)
+{
+	double best = 1e30;
+	for(int run = 0; run < runs; run++)
+	{
+		const auto start = Clock::now();
+		fn();
+		best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+	}
+	return best;
+}
+
+
+// Keeps the compiler from optimizing away results that are otherwise unused
+extern volatile uint64 g_sink;
+
+template <typename T>
+void Consume(const std::vector<T> &data)
+{
+	uint64 sum = 0;
+	for(const auto &v : data)
+	{
+		sum += static_cast<uint64>(v);
+	}
+	g_sink = g_sink + sum;
+}
+
+
+struct DiscardTarget : public IAudioReadTarget
+{
+	uint64 checksum = 0;
+	void DataCallback(int32 *MixSoundBuffer, std::size_t channels, std::size_t countChunk) override
+	{
+		for(std::size_t i = 0; i < channels * countChunk; i++)
+		{
+			checksum = checksum * 31 + static_cast<uint32>(MixSoundBuffer[i]);
+		}
+	}
+};
+
+
+std::vector<mpt::byte> ReadFileContents(const char *filename);
+
+
+// 64-channel IT module in which every note continues as a NNA voice, resulting in up to 256 voices.
+// With longTails, the volume envelope fades out slowly, so that many voices are audible but very quiet.
+void CreateVoiceTestModule(CSoundFile &sndFile, ResamplingMode resampling, bool longTails);
+
+
+// Render seconds of the voice test module in reads of readSize frames, returns the duration in milliseconds
+template <typename Tsetup>
+double RenderVoiceTestModule(ResamplingMode resampling, bool longTails, uint32 sampleRate, uint32 seconds, uint32 readSize, uint64 &checksum, CHANNELINDEX &maxVoices, Tsetup setup)
+{
+	return BestOf(3, [&]()
+	{
+		std::unique_ptr<CSoundFile> sndFile = std::make_unique<CSoundFile>();
+		MixerSettings mixerSettings;
+		mixerSettings.gdwMixingFreq = sampleRate;
+		sndFile->SetMixerSettings(mixerSettings);
+		CreateVoiceTestModule(*sndFile, resampling, longTails);
+		sndFile->SetRepeatCount(-1);
+		setup(*sndFile);
+		DiscardTarget target;
+		maxVoices = 0;
+		for(uint32 frames = 0; frames < sampleRate * seconds; frames += readSize)
+		{
+			sndFile->Read(readSize, target);
+			maxVoices = std::max(maxVoices, sndFile->GetMixStat());
+			sndFile->ResetMixStat();
+		}
+		checksum = target.checksum;
+	});
+}
+
+
+const char *ResamplingName(ResamplingMode resampling);
+
+
+// Benchmarks that are implemented in their own files
+void MemoryFootprint();
+void Probe();
+void ITSampleCompression();
+void SampleConversion();
+void MultiVoiceMixing();
+void VoiceCulling();
+void AmigaResampler();
+
+
+} // namespace Benchmark
+
+
+OPENMPT_NAMESPACE_END
@@ -0,0 +1,42 @@
+/*
+ * culling.cpp
+ * -----------
+ * Purpose: The whole mixer with and without culling of quiet voices.
+ * Notes  : (currently none)
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+#include "benchmark.h"
+
+#include <cstdio>
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+namespace Benchmark {
+
+
+// The whole mixer with and without culling of quiet voices. The module uses long envelope tails, so many voices are quiet but not silent.
+void VoiceCulling()
+{
+	for(ResamplingMode resampling : { SRCMODE_DEFAULT, SRCMODE_LINEAR })
+	{
+		for(double threshold : { 0.0, -30.0 })
+		{
+			uint64 checksum = 0;
+			CHANNELINDEX maxVoices = 0;
+			const double ms = RenderVoiceTestModule(resampling, true, 48000, 20, 1000, checksum, maxVoices, [threshold](CSoundFile &sndFile) { sndFile.SetVoiceCullThreshold(threshold); });
+			std::printf("culling %-7s threshold %3.0f dB: %.1f ms for 20s, up to %u mixed voices (checksum %016llx)\n", ResamplingName(resampling), threshold, ms, maxVoices, static_cast<unsigned long long>(checksum));
+		}
+	}
+}
+
+
+} // namespace Benchmark
+
+
+OPENMPT_NAMESPACE_END
@@ -0,0 +1,82 @@
+/*
+ * itcompression.cpp
+ * -----------------
+ * Purpose: IT sample compression and decompression.
+ * Notes  : (currently none)
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+#include "benchmark.h"
+
+#include "../../common/mptBufferIO.h"
+#include "../../soundlib/ITCompression.h"
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+namespace Benchmark {
+
+
+// Compress and decompress 4M frames of synthetic sample data.
+void ITSampleCompression()
+{
+	const SmpLength length = 4 * 1024 * 1024;
+	std::mt19937 rng(1);
+	std::vector<int16> data16(length);
+	std::vector<int8> data8(length);
+	// A random walk with varying step sizes makes use of all bit widths
+	int32 value = 0;
+	for(SmpLength i = 0; i < length; i++)
+	{
+		const int step = 1 << ((i / 4096) % 12);
+		value = Clamp(value + static_cast<int32>(rng() % (2 * step + 1)) - step, int32(-32768), int32(32767));
+		data16[i] = static_cast<int16>(value);
+		data8[i] = static_cast<int8>(value >> 8);
+	}
+
+	for(bool is16Bit : { false, true })
+	{
+		for(bool it215 : { false, true })
+		{
+			ModSample sample;
+			sample.uFlags.set(CHN_16BIT, is16Bit);
+			sample.nLength = length;
+			sample.pData.pSample = is16Bit ? static_cast<void *>(data16.data()) : static_cast<void *>(data8.data());
+
+			std::string compressed;
+			const double compressMs = BestOf(3, [&]()
+			{
+				mpt::ostringstream f;
+				ITCompression compression(sample, it215, &f);
+				compressed = f.str();
+			});
+
+			std::vector<int16> decoded16(is16Bit ? length : 0);
+			std::vector<int8> decoded8(is16Bit ? 0 : length);
+			sample.pData.pSample = is16Bit ? static_cast<void *>(decoded16.data()) : static_cast<void *>(decoded8.data());
+			const double decompressMs = BestOf(5, [&]()
+			{
+				FileReader file(mpt::byte_cast<mpt::const_byte_span>(mpt::as_span(compressed)));
+				ITDecompression decompression(file, sample, it215);
+			});
+			const bool identical = is16Bit ? (decoded16 == data16) : (decoded8 == data8);
+
+			std::printf("itcompression %2d-bit %s: compression %.1f ms, decompression %.1f ms (%s)\n", is16Bit ? 16 : 8, it215 ? "IT2.15" : "IT2.14", compressMs, decompressMs, identical ? "identical" : "MISMATCH");
+		}
+	}
+}
+
+
+} // namespace Benchmark
+
+
+OPENMPT_NAMESPACE_END
@@ -0,0 +1,193 @@
+/*
+ * memory.cpp
+ * ----------
+ * Purpose: Memory footprint of loaded modules.
+ * Notes  : The global allocation functions are replaced by counting versions for the whole benchmark program,
+ *          so allocations in the other benchmarks are slightly slower than in the library as well.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+#include "benchmark.h"
+
+#include "../../common/FileReader.h"
+#include "../../common/Logging.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+
+namespace
+{
+
+// Number of bytes currently allocated through operator new
+std::atomic<std::size_t> g_allocatedBytes(0);
+
+// Every allocation is preceded by its size
+const std::size_t AllocationHeaderSize = alignof(std::max_align_t);
+
+void *CountedAlloc(std::size_t size) noexcept
+{
+	void *p = std::malloc(AllocationHeaderSize + size);
+	if(p == nullptr)
+		return nullptr;
+	*static_cast<std::size_t *>(p) = size;
+	g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+	return static_cast<char *>(p) + AllocationHeaderSize;
+}
+
+void CountedFree(void *p) noexcept
+{
+	if(p == nullptr)
+		return;
+	p = static_cast<char *>(p) - AllocationHeaderSize;
+	g_allocatedBytes.fetch_sub(*static_cast<std::size_t *>(p), std::memory_order_relaxed);
+	std::free(p);
+}
+
+} // namespace
+
+
+void *operator new(std::size_t size)
+{
+	void *p = CountedAlloc(size);
+	if(p == nullptr)
+		throw std::bad_alloc();
+	return p;
+}
+
+void *operator new[](std::size_t size)
+{
+	void *p = CountedAlloc(size);
+	if(p == nullptr)
+		throw std::bad_alloc();
+	return p;
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept { return CountedAlloc(size); }
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept { return CountedAlloc(size); }
+void operator delete(void *p) noexcept { CountedFree(p); }
+void operator delete[](void *p) noexcept { CountedFree(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { CountedFree(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { CountedFree(p); }
+void operator delete(void *p, std::size_t) noexcept { CountedFree(p); }
+void operator delete[](void *p, std::size_t) noexcept { CountedFree(p); }
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+namespace Benchmark {
+
+
+// 4-channel ProTracker module with 8 of its 31 sample slots in use
+static std::vector<mpt::byte> CreateModFile()
+{
+	std::vector<uint8> data(20 + 31 * 30 + 2 + 128 + 4);
+	uint8 *header = data.data() + 20;
+	for(int smp = 0; smp < 8; smp++, header += 30)
+	{
+		header[22] = 1000 >> 8;	// Length in words, big-endian
+		header[23] = 1000 & 0xFF;
+		header[25] = 64;	// Volume
+		header[29] = 1;	// Loop length 1 = no loop
+	}
+	data[20 + 31 * 30] = 1;	// One order
+	data[20 + 31 * 30 + 1] = 127;
+	std::copy_n("M.K.", 4, data.end() - 4);
+	for(int row = 0; row < 64; row++)
+	{
+		for(int chn = 0; chn < 4; chn++)
+		{
+			const int smp = 1 + (row + chn) % 8, period = 428;
+			const uint8 note[4] = { static_cast<uint8>((smp & 0xF0) | (period >> 8)), static_cast<uint8>(period & 0xFF), static_cast<uint8>((smp & 0x0F) << 4), 0 };
+			data.insert(data.end(), std::begin(note), std::end(note));
+		}
+	}
+	for(int i = 0; i < 8 * 2000; i++)
+	{
+		data.push_back(static_cast<uint8>(i * 7));
+	}
+	const mpt::byte *begin = mpt::byte_cast<const mpt::byte *>(data.data());
+	return std::vector<mpt::byte>(begin, begin + data.size());
+}
+
+
+// test.mptm refers to an external sample, which cannot be loaded by the library
+struct SilentLog : public ILog
+{
+	void AddToLog(LogLevel, const mpt::ustring &) const override { }
+};
+
+
+// Load many instances of the test modules at once and report the average memory that each instance occupies.
+// For comparison, the footprint with all MAX_SAMPLES slots of the sample tables allocated (as they were before they were paged) is also shown.
+void MemoryFootprint()
+{
+	struct Input
+	{
+		const char *name;
+		std::vector<mpt::byte> data;
+	};
+	const Input inputs[] =
+	{
+		{ "MOD (generated)", CreateModFile() },
+		{ "test/test.xm", ReadFileContents("test/test.xm") },
+		{ "test/test.s3m", ReadFileContents("test/test.s3m") },
+		{ "test/test.mptm", ReadFileContents("test/test.mptm") },
+	};
+
+	const int instances = 100;
+	SilentLog log;
+	for(const auto &input : inputs)
+	{
+		if(input.data.empty())
+		{
+			std::printf("memory %-15s: not found\n", input.name);
+			continue;
+		}
+		const std::size_t baseBytes = g_allocatedBytes;
+		std::vector<std::unique_ptr<CSoundFile>> modules;
+		modules.reserve(instances);
+		for(int i = 0; i < instances; i++)
+		{
+			modules.push_back(std::make_unique<CSoundFile>());
+			modules.back()->SetCustomLog(&log);
+			modules.back()->Create(FileReader(mpt::as_span(input.data)), CSoundFile::loadCompleteModule);
+		}
+		const std::size_t perInstance = (g_allocatedBytes - baseBytes - instances * sizeof(modules[0])) / instances;
+		// Touch all sample slots of one instance, so that the sample tables are fully allocated
+		CSoundFile &sndFile = *modules.front();
+		const std::size_t pagedBytes = g_allocatedBytes;
+		const SAMPLEINDEX numSamples = sndFile.GetNumSamples();
+		sndFile.m_nSamples = MAX_SAMPLES - 1;
+		for(SAMPLEINDEX smp = 0; smp < MAX_SAMPLES; smp++)
+		{
+			sndFile.GetSample(smp);
+			sndFile.m_szNames[smp];
+		}
+		sndFile.m_nSamples = numSamples;
+		const std::size_t fullTableBytes = g_allocatedBytes - pagedBytes;
+
+		std::size_t sampleData = 0;
+		for(SAMPLEINDEX smp = 1; smp <= sndFile.GetNumSamples(); smp++)
+		{
+			sampleData += sndFile.GetSample(smp).GetSampleSizeInBytes();
+		}
+		std::printf("memory %-15s: %7zu bytes per instance, %7zu with full sample tables (%zu bytes of sample data, %u samples)\n",
+			input.name, perInstance, perInstance + fullTableBytes, sampleData, static_cast<unsigned int>(sndFile.GetNumSamples()));
+	}
+}
+
+
+} // namespace Benchmark
+
+
+OPENMPT_NAMESPACE_END
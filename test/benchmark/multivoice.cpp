@@ -0,0 +1,107 @@
+/*
+ * multivoice.cpp
+ * --------------
+ * Purpose: Multi-voice mix functions and the whole mixer with and without multi-voice mixing.
+ * Notes  : (currently none)
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+#include "benchmark.h"
+
+#include "../../soundlib/MixFuncTable.h"
+#include "../../soundlib/Resampler.h"
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+namespace Benchmark {
+
+
+// Generic per-voice mix functions against the multi-voice mix functions, and the whole mixer with and without multi-voice mixing.
+void MultiVoiceMixing()
+{
+#ifdef MPT_INTMIXER
+	CResampler resampler;
+	std::mt19937 rng(1);
+	std::vector<int16> data(1 << 16);
+	for(auto &smp : data)
+	{
+		smp = static_cast<int16>(rng());
+	}
+
+	const uint32 count = 512;
+	const int numVoices = 8;
+	std::vector<mixsample_t> buffer(count * 2);
+	const char * const formats[] = { " 8m", "16m", " 8s", "16s" };
+	for(uint32 resampling : { uint32(MixFuncTable::ndxNoInterpolation), uint32(MixFuncTable::ndxLinear) })
+	{
+		for(uint32 format = 0; format < 4; format++)
+		{
+			const uint32 functionNdx = resampling | format;
+			const MixMultiVoiceFuncInterface multiVoiceFunction = MixFuncTable::MultiVoiceFunctions[MixFuncTable::ToMultiVoiceIndex(functionNdx)];
+			if(multiVoiceFunction == nullptr)
+				continue;
+			ModChannel voices[numVoices];
+			const auto resetVoices = [&]()
+			{
+				for(int v = 0; v < numVoices; v++)
+				{
+					voices[v] = ModChannel();
+					voices[v].pCurrentSample = data.data() + v * 1000;
+					voices[v].increment = SamplePosition(0, 0x80000000u + v * 0x1000000u);
+					voices[v].leftVol = 1000 + v;
+					voices[v].rightVol = 2000 - v;
+				}
+			};
+			const double singleMs = BestOf(3000, [&]()
+			{
+				resetVoices();
+				for(auto &chn : voices)
+				{
+					MixFuncTable::Functions[MixFuncTable::isGeneric][functionNdx](chn, resampler, buffer.data(), count);
+				}
+			});
+			const double multiMs = BestOf(3000, [&]()
+			{
+				resetVoices();
+				for(int v = 0; v < numVoices; v += MixFuncTable::numMultiVoices)
+				{
+					ModChannel *group[MixFuncTable::numMultiVoices];
+					for(int i = 0; i < MixFuncTable::numMultiVoices; i++)
+					{
+						group[i] = &voices[v + i];
+					}
+					multiVoiceFunction(group, resampler, buffer.data(), count);
+				}
+			});
+			std::printf("multivoice %-7s %s: %.2f ns per voice, %.2f ns multi-voice (per frame, %d voices x %u frames)\n", resampling ? "linear" : "nearest", formats[format],
+				singleMs * 1e6 / (numVoices * count), multiMs * 1e6 / (numVoices * count), numVoices, count);
+		}
+	}
+#endif // MPT_INTMIXER
+
+	for(ResamplingMode resampling : { SRCMODE_NEAREST, SRCMODE_LINEAR })
+	{
+		for(bool multiVoice : { false, true })
+		{
+			uint64 checksum = 0;
+			CHANNELINDEX maxVoices = 0;
+			const double ms = RenderVoiceTestModule(resampling, false, 48000, 20, 1000, checksum, maxVoices, [multiVoice](CSoundFile &sndFile) { sndFile.SetMultiVoiceMixing(multiVoice); });
+			std::printf("multivoice render %-7s %-9s: %.1f ms for 20s, up to %u voices (checksum %016llx)\n", ResamplingName(resampling), multiVoice ? "grouped" : "per-voice", ms, maxVoices, static_cast<unsigned long long>(checksum));
+		}
+	}
+}
+
+
+} // namespace Benchmark
+
+
+OPENMPT_NAMESPACE_END
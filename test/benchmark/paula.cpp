@@ -0,0 +1,80 @@
+/*
+ * paula.cpp
+ * ---------
+ * Purpose: Amiga BLEP resampler.
+ * Notes  : (currently none)
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+#include "benchmark.h"
+
+#include "../../soundlib/MixFuncTable.h"
+#include "../../soundlib/Resampler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+namespace Benchmark {
+
+
+// Mono Amiga BLEP mix functions at different sample rates
+void AmigaResampler()
+{
+	CResampler resampler;
+	std::mt19937 rng(1);
+	std::vector<int16> data(1 << 18);
+	for(auto &smp : data)
+	{
+		smp = static_cast<int16>(rng());
+	}
+
+	const uint32 count = 512, blocks = 8;
+	std::vector<mixsample_t> buffer(count * 2);
+	const SamplePosition increments[] = { SamplePosition(0, 0x2C9A0000u), SamplePosition(0, 0x80000000u), SamplePosition(1, 0xC0000000u) };
+	for(uint32 format : { 0u, uint32(MixFuncTable::ndx16Bit) })
+	{
+		for(const auto &increment : increments)
+		{
+			for(bool filter : { false, true })
+			{
+				uint64 checksum = 0;
+				const double ms = BestOf(400, [&]()
+				{
+					ModChannel chn{};
+					chn.paulaState = Paula::State(48000);
+					chn.pCurrentSample = data.data();
+					chn.increment = increment;
+					chn.leftVol = 1000;
+					chn.rightVol = 2000;
+					chn.dwFlags.set(CHN_AMIGAFILTER, filter);
+					std::fill(buffer.begin(), buffer.end(), 0);
+					for(uint32 block = 0; block < blocks; block++)
+					{
+						MixFuncTable::Functions[MixFuncTable::isGeneric][MixFuncTable::ndxAmigaBlep | format](chn, resampler, buffer.data(), count);
+					}
+					checksum = 0;
+					for(auto v : buffer)
+					{
+						checksum = checksum * 31 + static_cast<uint32>(v);
+					}
+				});
+				std::printf("paula %s increment %.3f%s: %.1f ns per sample (checksum %016llx)\n", format ? "16m" : " 8m", increment.GetRaw() / 4294967296.0, filter ? ", A500 filter" : "", ms * 1e6 / (blocks * count), static_cast<unsigned long long>(checksum));
+			}
+		}
+	}
+}
+
+
+} // namespace Benchmark
+
+
+OPENMPT_NAMESPACE_END
@@ -0,0 +1,75 @@
+/*
+ * probe.cpp
+ * ---------
+ * Purpose: Format probing with and without the format index.
+ * Notes  : (currently none)
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+#include "benchmark.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+namespace Benchmark {
+
+
+static const char * const ProbeFiles[] = { "test/test.xm", "test/test.s3m", "test/test.mptm" };
+
+
+// Probe the test modules and random data, with and without the format index.
+void Probe()
+{
+	std::vector<std::vector<mpt::byte>> inputs;
+	for(const char *filename : ProbeFiles)
+	{
+		std::vector<mpt::byte> data = ReadFileContents(filename);
+		data.resize(std::min<std::size_t>(data.size(), 2048));
+		if(!data.empty())
+			inputs.push_back(std::move(data));
+	}
+	std::mt19937 rng(1);
+	for(int i = 0; i < 32; i++)
+	{
+		std::vector<mpt::byte> data(2048);
+		for(auto &b : data)
+		{
+			b = mpt::byte_cast<mpt::byte>(static_cast<uint8>(rng()));
+		}
+		inputs.push_back(std::move(data));
+	}
+
+	const int iterations = 2000;
+	for(bool useIndex : { false, true })
+	{
+		int successes = 0;
+		const double ms = BestOf(3, [&]()
+		{
+			successes = 0;
+			for(int i = 0; i < iterations; i++)
+			{
+				for(const auto &data : inputs)
+				{
+					if(CSoundFile::Probe(CSoundFile::ProbeModules, mpt::as_span(data), nullptr, useIndex) == CSoundFile::ProbeSuccess)
+						successes++;
+				}
+			}
+		});
+		std::printf("probe %-9s: %.0f probes/s (%d successes)\n", useIndex ? "indexed" : "full scan", iterations * inputs.size() * 1000.0 / ms, successes);
+	}
+}
+
+
+} // namespace Benchmark
+
+
+OPENMPT_NAMESPACE_END
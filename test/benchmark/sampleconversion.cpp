@@ -0,0 +1,98 @@
+/*
+ * sampleconversion.cpp
+ * --------------------
+ * Purpose: Block sample format converters against the scalar conversion functors.
+ * Notes  : (currently none)
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+#include "benchmark.h"
+
+#include "../../soundbase/SampleFormatConverters.h"
+#include "../../soundbase/SampleFormatCopySIMD.h"
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+namespace Benchmark {
+
+
+template <typename Tfunctor, typename Toutput>
+static MPT_NOINLINE void DecodeScalar(Toutput *dst, const mpt::byte *src, std::size_t count)
+{
+	Tfunctor conv;
+	for(std::size_t i = 0; i < count; i++)
+	{
+		dst[i] = conv(src + i * Tfunctor::input_inc);
+	}
+}
+
+
+template <int fractionalBits, typename Toutput>
+static MPT_NOINLINE void ConvertOutputScalar(Toutput *dst, const int32 *src, std::size_t count)
+{
+	SC::ConvertFixedPoint<Toutput, int32, fractionalBits, false> conv;
+	for(std::size_t i = 0; i < count; i++)
+	{
+		dst[i] = conv(src[i]);
+	}
+}
+
+
+// Raw sample decoding and mix buffer output conversion, block converters against the scalar functors.
+// The block converters fall back to the scalar functors for the remainder, or entirely if there are no vectorized versions for this build.
+void SampleConversion()
+{
+	const std::size_t count = 1024 * 1024;
+	std::mt19937 rng(1);
+	std::vector<mpt::byte> raw(count * 2);
+	for(auto &b : raw)
+	{
+		b = mpt::byte_cast<mpt::byte>(static_cast<uint8>(rng()));
+	}
+	std::vector<int8> out8(count);
+	std::vector<int16> out16(count);
+
+	const auto report = [](const char *name, double blockMs, double scalarMs)
+	{
+		std::printf("sampleconversion %-22s: %8.1f us block, %8.1f us scalar\n", name, blockMs * 1000.0, scalarMs * 1000.0);
+	};
+
+	report("8-bit delta, 1M", BestOf(7, [&]() { uint8 delta = 0; const std::size_t done = SC::DecodeInt8DeltaBlock(out8.data(), raw.data(), count, delta); SC::DecodeInt8Delta conv; conv.delta = delta; for(std::size_t i = done; i < count; i++) out8[i] = conv(&raw[i]); Consume(out8); }),
+		BestOf(7, [&]() { DecodeScalar<SC::DecodeInt8Delta>(out8.data(), raw.data(), count); Consume(out8); }));
+	report("16-bit delta, 1M", BestOf(7, [&]() { uint16 delta = 0; const std::size_t done = SC::DecodeInt16DeltaBlock(out16.data(), raw.data(), count, false, delta); SC::DecodeInt16Delta<0, 1> conv; conv.delta = delta; for(std::size_t i = done; i < count; i++) out16[i] = conv(&raw[i * 2]); Consume(out16); }),
+		BestOf(7, [&]() { DecodeScalar<SC::DecodeInt16Delta<0, 1>>(out16.data(), raw.data(), count); Consume(out16); }));
+	report("unsigned 8-bit, 1M", BestOf(7, [&]() { const std::size_t done = SC::DecodeInt8Block(out8.data(), raw.data(), count, 0x80); DecodeScalar<SC::DecodeUint8>(out8.data() + done, raw.data() + done, count - done); Consume(out8); }),
+		BestOf(7, [&]() { DecodeScalar<SC::DecodeUint8>(out8.data(), raw.data(), count); Consume(out8); }));
+	report("16-bit big-endian, 1M", BestOf(7, [&]() { const std::size_t done = SC::DecodeInt16Block(out16.data(), raw.data(), count, true, 0); DecodeScalar<SC::DecodeInt16<0, 1, 0>>(out16.data() + done, raw.data() + done * 2, count - done); Consume(out16); }),
+		BestOf(7, [&]() { DecodeScalar<SC::DecodeInt16<0, 1, 0>>(out16.data(), raw.data(), count); Consume(out16); }));
+
+	// One mix buffer of stereo output, repeated to get measurable durations
+	const std::size_t mixCount = 1024 * 2, repeat = 1000;
+	std::vector<int32> mixBuffer(mixCount);
+	for(auto &v : mixBuffer)
+	{
+		v = static_cast<int32>(rng()) >> 3;
+	}
+	std::vector<int16> outInt16(mixCount);
+	std::vector<float32> outFloat(mixCount);
+	const int shiftBits = SC::ConvertFixedPoint<int16, int32, MIXING_FRACTIONAL_BITS, false>::shiftBits;
+	report("int16 output, 1k x 1k", BestOf(7, [&]() { for(std::size_t r = 0; r < repeat; r++) { const std::size_t done = SC::ConvertFixedPointToInt16Block(outInt16.data(), mixBuffer.data(), mixCount, shiftBits); ConvertOutputScalar<MIXING_FRACTIONAL_BITS>(outInt16.data() + done, mixBuffer.data() + done, mixCount - done); } Consume(outInt16); }),
+		BestOf(7, [&]() { for(std::size_t r = 0; r < repeat; r++) ConvertOutputScalar<MIXING_FRACTIONAL_BITS>(outInt16.data(), mixBuffer.data(), mixCount); Consume(outInt16); }));
+	report("float output, 1k x 1k", BestOf(7, [&]() { for(std::size_t r = 0; r < repeat; r++) { const std::size_t done = SC::ConvertFixedPointToFloat32Block(outFloat.data(), mixBuffer.data(), mixCount, 1.0f / static_cast<float>(1 << MIXING_FRACTIONAL_BITS), false); ConvertOutputScalar<MIXING_FRACTIONAL_BITS>(outFloat.data() + done, mixBuffer.data() + done, mixCount - done); } Consume(outFloat); }),
+		BestOf(7, [&]() { for(std::size_t r = 0; r < repeat; r++) ConvertOutputScalar<MIXING_FRACTIONAL_BITS>(outFloat.data(), mixBuffer.data(), mixCount); Consume(outFloat); }));
+}
+
+
+} // namespace Benchmark
+
+
+OPENMPT_NAMESPACE_END
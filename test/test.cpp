@@ -21,6 +21,7 @@
 #include "../common/mptStringBuffer.h"
 #include "../common/serialization_utils.h"
 #include "../common/mptUUID.h"
+#include "../common/mptPagedArray.h"
 #include "../soundlib/Sndfile.h"
 #include "../common/FileReader.h"
 #include "../soundlib/mod_specifications.h"
@@ -30,6 +31,8 @@
 #include "../soundbase/SampleFormatCopy.h"
 #include "../soundlib/ModSampleCopy.h"
 #include "../soundlib/ITCompression.h"
+#include "../soundlib/ITTools.h"
+#include "../soundlib/MixFuncTable.h"
 #include "../soundlib/tuningcollection.h"
 #include "../soundlib/tuning.h"
 #ifdef MODPLUG_TRACKER
@@ -43,9 +46,14 @@
 #include "../common/mptFileIO.h"
 #ifdef LIBOPENMPT_BUILD
 #include "../libopenmpt/libopenmpt_version.h"
+#include "../libopenmpt/libopenmpt.h"
+#include "../libopenmpt/libopenmpt.hpp"
 #endif // LIBOPENMPT_BUILD
 #ifndef NO_PLUGINS
 #include "../soundlib/plugins/PlugInterface.h"
+#ifdef LIBOPENMPT_BUILD
+#include "../soundlib/AudioReadTarget.h"
+#endif // LIBOPENMPT_BUILD
 #endif
 #include "../common/mptBufferIO.h"
 #include <limits>
@@ -61,6 +69,10 @@
 #if MPT_OS_WINDOWS
 #include <windows.h>
 #endif
+#if defined(MPT_FILEREADER_MMAP)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 #if defined(MPT_WITH_ZLIB)
 #include <zlib.h>
 #elif defined(MPT_WITH_MINIZ)
@@ -106,6 +118,27 @@ static MPT_NOINLINE void TestStringIO();
 static MPT_NOINLINE void TestMIDIEvents();
 static MPT_NOINLINE void TestSampleConversion();
 static MPT_NOINLINE void TestITCompression();
+static MPT_NOINLINE void TestMixFunctions();
+static MPT_NOINLINE void TestPaula();
+static MPT_NOINLINE void TestMixThreads();
+static MPT_NOINLINE void TestMultiVoiceMixing();
+static MPT_NOINLINE void TestMixBlockSize();
+static MPT_NOINLINE void TestVoiceCulling();
+static MPT_NOINLINE void TestFilterCutoffCache();
+static MPT_NOINLINE void TestPluginGraph();
+static MPT_NOINLINE void TestSequenceLengths();
+static MPT_NOINLINE void TestSeekIndex();
+static MPT_NOINLINE void TestSampleDataPool();
+static MPT_NOINLINE void TestFormatIndex();
+static MPT_NOINLINE void TestMetadataLoading();
+static MPT_NOINLINE void TestMO3SampleDecoding();
+static MPT_NOINLINE void TestLazySampleDecoding();
+static MPT_NOINLINE void TestIntegerOutput();
+static MPT_NOINLINE void TestLibopenmptFileLoading();
+static MPT_NOINLINE void TestLibopenmptSubsongsCache();
+static MPT_NOINLINE void TestLibopenmptProgressiveLoading();
+static MPT_NOINLINE void TestLibopenmptIntegerOutput();
+static MPT_NOINLINE void TestLibopenmptMetadata();
 static MPT_NOINLINE void TestTunings();
 static MPT_NOINLINE void TestPCnoteSerialization();
 static MPT_NOINLINE void TestLoadSaveFile();
@@ -206,6 +239,27 @@ void DoTests()
 	DO_TEST(TestMIDIEvents);
 	DO_TEST(TestSampleConversion);
 	DO_TEST(TestITCompression);
+	DO_TEST(TestMixFunctions);
+	DO_TEST(TestPaula);
+	DO_TEST(TestMixThreads);
+	DO_TEST(TestMultiVoiceMixing);
+	DO_TEST(TestMixBlockSize);
+	DO_TEST(TestVoiceCulling);
+	DO_TEST(TestFilterCutoffCache);
+	DO_TEST(TestPluginGraph);
+	DO_TEST(TestSequenceLengths);
+	DO_TEST(TestSeekIndex);
+	DO_TEST(TestSampleDataPool);
+	DO_TEST(TestFormatIndex);
+	DO_TEST(TestMetadataLoading);
+	DO_TEST(TestMO3SampleDecoding);
+	DO_TEST(TestLazySampleDecoding);
+	DO_TEST(TestIntegerOutput);
+	DO_TEST(TestLibopenmptFileLoading);
+	DO_TEST(TestLibopenmptSubsongsCache);
+	DO_TEST(TestLibopenmptProgressiveLoading);
+	DO_TEST(TestLibopenmptIntegerOutput);
+	DO_TEST(TestLibopenmptMetadata);
 	DO_TEST(TestTunings);
 
 	// slower tests, require opening a CModDoc
@@ -2237,6 +2291,34 @@ static MPT_NOINLINE void TestMisc2()
 
 #endif // MODPLUG_TRACKER
 
+	{
+		mpt::paged_array<uint32, 1000, 16> arr;
+		VERIFY_EQUAL(arr.size(), 1000u);
+		VERIFY_EQUAL(arr.allocated_bytes(), 0u);
+		VERIFY_EQUAL(arr.is_allocated(999), false);
+		const auto &constArr = arr;
+		VERIFY_EQUAL(constArr[999], 0u);
+		VERIFY_EQUAL(arr.is_allocated(999), true);
+		VERIFY_EQUAL(arr.is_allocated(0), false);
+		VERIFY_EQUAL(arr.allocated_bytes(), 16 * sizeof(uint32));
+		uint32 *first = &arr[0];
+		arr[0] = 1;
+		arr[17] = 2;
+		VERIFY_EQUAL(arr.allocated_bytes(), 3 * 16 * sizeof(uint32));
+		VERIFY_EQUAL(first, &arr[0]);
+		VERIFY_EQUAL(arr[0], 1u);
+		VERIFY_EQUAL(arr[1], 0u);
+		VERIFY_EQUAL(arr[17], 2u);
+		VERIFY_EQUAL(arr.index_of(&arr[17]), 17u);
+		VERIFY_EQUAL(arr.index_of(&arr[999]), 999u);
+		uint32 notInArray = 0;
+		VERIFY_EQUAL(arr.index_of(&notInArray), 1000u);
+		Clear(arr);
+		VERIFY_EQUAL(first, &arr[0]);
+		VERIFY_EQUAL(arr[0], 0u);
+		VERIFY_EQUAL(arr[17], 0u);
+	}
+
 	// https://github.com/kripken/emscripten/issues/4251
 	#if MPT_OS_EMSCRIPTEN
 		volatile int transpose = 32;
@@ -3930,6 +4012,35 @@ static MPT_NOINLINE void TestLoadSaveFile()
 		}
 		VERIFY_EQUAL_EPS(totalDuration, 3674.38, 1.0);
 
+		// Seeking through the seek index must give the same results as simulating from the song start
+		{
+			const double seekTimes[] = { 5.0, 1800.0, 19.0, 1234.5, 3000.0, 0.5 };
+			std::vector<GetLengthType> expected;
+			std::vector<std::tuple<uint32, TEMPO, int32>> expectedGlobals;
+			for(double seekTime : seekTimes)
+			{
+				expected.push_back(sndFile.GetLength(eNoAdjust, GetLengthTarget(seekTime)).back());
+				sndFile.GetLength(eAdjust, GetLengthTarget(expected.back().lastOrder, expected.back().lastRow));
+				expectedGlobals.push_back(std::make_tuple(sndFile.m_PlayState.m_nMusicSpeed, sndFile.m_PlayState.m_nMusicTempo, sndFile.m_PlayState.m_nGlobalVolume));
+			}
+
+			sndFile.SetSeekIndexInterval(1.0);
+			for(int pass = 0; pass < 2; pass++)
+			{
+				for(size_t i = 0; i < CountOf(seekTimes); i++)
+				{
+					const GetLengthType result = sndFile.GetLength(eNoAdjust, GetLengthTarget(seekTimes[i])).back();
+					VERIFY_EQUAL_NONCONT(result.targetReached, expected[i].targetReached);
+					VERIFY_EQUAL_NONCONT(result.lastOrder, expected[i].lastOrder);
+					VERIFY_EQUAL_NONCONT(result.lastRow, expected[i].lastRow);
+					VERIFY_EQUAL_NONCONT(result.duration, expected[i].duration);
+					sndFile.GetLength(eAdjust, GetLengthTarget(result.lastOrder, result.lastRow));
+					VERIFY_EQUAL_NONCONT(std::make_tuple(sndFile.m_PlayState.m_nMusicSpeed, sndFile.m_PlayState.m_nMusicTempo, sndFile.m_PlayState.m_nGlobalVolume) == expectedGlobals[i], true);
+				}
+			}
+			sndFile.SetSeekIndexInterval(0.0);
+		}
+
 		#ifndef MODPLUG_NO_FILESAVE
 			// Test file saving
 			sndFile.ChnSettings[1].dwFlags.set(CHN_MUTE);
@@ -3940,6 +4051,23 @@ static MPT_NOINLINE void TestLoadSaveFile()
 		DestroySoundFileContainer(sndFileContainer);
 	}
 
+#if defined(MPT_FILEREADER_MMAP)
+	// Test loading from a memory-mapped file
+	{
+		int fd = open((filenameBaseSrc + P_("s3m")).AsNative().c_str(), O_RDONLY);
+		VERIFY_EQUAL_NONCONT(fd >= 0, true);
+		std::shared_ptr<FileDataContainerMappedFile> mapping = std::make_shared<FileDataContainerMappedFile>(fd);
+		close(fd);
+		VERIFY_EQUAL_NONCONT(mapping->IsValid(), true);
+		VERIFY_EQUAL_NONCONT(mapping->HasPinnedView(), true);
+
+		FileReader file(mapping);
+		std::unique_ptr<CSoundFile> sndFile = std::make_unique<CSoundFile>();
+		VERIFY_EQUAL_NONCONT(sndFile->Create(file, CSoundFile::loadCompleteModule), true);
+		TestLoadS3MFile(*sndFile, false);
+	}
+#endif // MPT_FILEREADER_MMAP
+
 	// Reload the saved file and test if everything is still working correctly.
 	#ifndef MODPLUG_NO_FILESAVE
 	{
@@ -4113,6 +4241,20 @@ static void RunITCompressionTest(const std::vector<int8> &sampleData, FlagSet<Ch
 		ITDecompression decompression(file, smp, it215);
 		VERIFY_EQUAL_NONCONT(memcmp(sampleData.data(), sampleDataNew.data(), sampleData.size()), 0);
 	}
+
+	if(!smp.uFlags[CHN_STEREO])
+	{
+		// Truncated data must decode to a correct prefix of the sample, leaving the rest untouched
+		FileReader file(mpt::byte_cast<mpt::const_byte_span>(mpt::as_span(data.data(), data.size() - data.size() / 3)));
+
+		std::vector<int8> sampleDataNew(sampleData.size(), 0);
+		smp.pData.pSample = sampleDataNew.data();
+
+		ITDecompression decompression(file, smp, it215);
+		const auto firstMismatch = std::mismatch(sampleData.begin(), sampleData.end(), sampleDataNew.begin());
+		VERIFY_EQUAL_NONCONT(firstMismatch.first != sampleData.begin(), true);
+		VERIFY_EQUAL_NONCONT(std::count(firstMismatch.second, sampleDataNew.end(), int8(0)), sampleDataNew.end() - firstMismatch.second);
+	}
 }
 
 
@@ -4127,209 +4269,1913 @@ static MPT_NOINLINE void TestITCompression()
 		sampleData[i] = mpt::random<int8>(*s_PRNG);
 	}
 
+	// Smooth waveforms with varying amplitude make use of all bit widths
+	std::vector<int8> smoothData(sampleDataSize, 0);
+	for(int i = 0; i < sampleDataSize / 2; i++)
+	{
+		const int16 v = static_cast<int16>(std::sin(i * 0.02) * (i % 5000) * 6 + mpt::random<int8>(*s_PRNG) / ((i % 7) + 1));
+		smoothData[i * 2] = static_cast<int8>(v & 0xFF);
+		smoothData[i * 2 + 1] = static_cast<int8>(v >> 8);
+	}
+
 	// Run each compression test with IT215 compression and without.
 	for(int i = 0; i < 2; i++)
 	{
-		RunITCompressionTest(sampleData, ChannelFlags(0), i == 0);
-		RunITCompressionTest(sampleData, CHN_16BIT, i == 0);
-		RunITCompressionTest(sampleData, CHN_STEREO, i == 0);
-		RunITCompressionTest(sampleData, CHN_16BIT | CHN_STEREO, i == 0);
+		for(const auto &data : { sampleData, smoothData })
+		{
+			RunITCompressionTest(data, ChannelFlags(0), i == 0);
+			RunITCompressionTest(data, CHN_16BIT, i == 0);
+			RunITCompressionTest(data, CHN_STEREO, i == 0);
+			RunITCompressionTest(data, CHN_16BIT | CHN_STEREO, i == 0);
+		}
 	}
 }
 
 
 
-#if 0
-
-static bool RatioEqual(CTuningBase::RATIOTYPE a, CTuningBase::RATIOTYPE b)
+static MPT_NOINLINE void TestMixFunctions()
 {
-	if(a == CTuningBase::RATIOTYPE(0) && b == CTuningBase::RATIOTYPE(0))
+	// Instruction set specific mix functions must produce exactly the same output as the generic implementation
+	CResampler resampler;
+	std::vector<int16> sampleData(4096);
+	for(auto &smp : sampleData)
 	{
-		return true;
+		smp = mpt::random<int16>(*s_PRNG);
 	}
-	if(a == CTuningBase::RATIOTYPE(0) || b == CTuningBase::RATIOTYPE(0))
+
+	const SamplePosition increments[] = { SamplePosition(0, 0x6C000000u), SamplePosition(1, 0x40000000u), SamplePosition(1, 0xC0000000u), SamplePosition(-1, 0x20000000u) };
+	const MixFuncTable::InstructionSetIndex supportedSet = MixFuncTable::GetInstructionSetIndex();
+#if defined(MPT_INTMIXER) && defined(ENABLE_SSE2_BASELINE)
+	VERIFY_EQUAL(supportedSet >= MixFuncTable::isSSE2, true);
+#endif
+	for(int instructionSet = MixFuncTable::isGeneric + 1; instructionSet <= supportedSet; instructionSet++)
 	{
-		return false;
+		for(uint32 functionNdx = 0; functionNdx < CountOf(MixFuncTable::Functions[0]); functionNdx++)
+		{
+			if(MixFuncTable::Functions[instructionSet][functionNdx] == MixFuncTable::Functions[MixFuncTable::isGeneric][functionNdx])
+			{
+				continue;
+			}
+			for(const auto &increment : increments)
+			{
+				const uint32 numSamples = 256;
+				mixsample_t expected[numSamples * 2], actual[numSamples * 2];
+				ModChannel expectedChn{}, actualChn{};
+				for(auto chn : { &expectedChn, &actualChn })
+				{
+					chn->pCurrentSample = sampleData.data() + sampleData.size() / 2;
+					chn->position = SamplePosition(0, mpt::random<uint32>(*s_PRNG));
+					chn->increment = increment;
+					chn->leftVol = 3000;
+					chn->rightVol = 1000;
+					chn->rampLeftVol = 1000 << VOLUMERAMPPRECISION;
+					chn->rampRightVol = 3000 << VOLUMERAMPPRECISION;
+					chn->leftRamp = 1;
+					chn->rightRamp = -1;
+					chn->nFilter_A0 = 1 << 22;
+					chn->nFilter_B0 = 1 << 23;
+					chn->nFilter_B1 = -(1 << 21);
+				}
+				actualChn.position = expectedChn.position;
+				std::fill(std::begin(expected), std::end(expected), 0);
+				std::fill(std::begin(actual), std::end(actual), 0);
+
+				MixFuncTable::Functions[MixFuncTable::isGeneric][functionNdx](expectedChn, resampler, expected, numSamples);
+				MixFuncTable::Functions[instructionSet][functionNdx](actualChn, resampler, actual, numSamples);
+				VERIFY_EQUAL_NONCONT(std::equal(std::begin(expected), std::end(expected), std::begin(actual)), true);
+				VERIFY_EQUAL_NONCONT(expectedChn.position.GetRaw(), actualChn.position.GetRaw());
+			}
+		}
 	}
-	return (std::fabs(CTuningBase::RATIOTYPE(1) - (a/b)) < CTuningBase::RATIOTYPE(0.0001));
+
+#ifdef MPT_INTMIXER
+	// Mixing several voices at once must produce exactly the same output as mixing them one after another
+	for(uint32 multiVoiceNdx = 0; multiVoiceNdx < CountOf(MixFuncTable::MultiVoiceFunctions); multiVoiceNdx++)
+	{
+		const uint32 functionNdx = ((multiVoiceNdx & ~3u) << 2) | (multiVoiceNdx & 3u);
+		VERIFY_EQUAL(MixFuncTable::ToMultiVoiceIndex(functionNdx), multiVoiceNdx);
+		if(MixFuncTable::MultiVoiceFunctions[multiVoiceNdx] == nullptr)
+		{
+			continue;
+		}
+
+		const uint32 numSamples = 256;
+		mixsample_t expected[numSamples * 2], actual[numSamples * 2];
+		ModChannel expectedChn[MixFuncTable::numMultiVoices] = {}, actualChn[MixFuncTable::numMultiVoices] = {};
+		ModChannel *actualVoices[MixFuncTable::numMultiVoices];
+		for(int v = 0; v < MixFuncTable::numMultiVoices; v++)
+		{
+			for(auto chn : { &expectedChn[v], &actualChn[v] })
+			{
+				chn->pCurrentSample = sampleData.data() + sampleData.size() / 2;
+				chn->increment = increments[v % CountOf(increments)];
+				chn->leftVol = 1000 + 1000 * v;
+				chn->rightVol = 3000 - 1000 * v;
+			}
+			expectedChn[v].position = actualChn[v].position = SamplePosition(0, mpt::random<uint32>(*s_PRNG));
+			actualVoices[v] = &actualChn[v];
+		}
+		for(uint32 i = 0; i < numSamples * 2; i++)
+		{
+			expected[i] = actual[i] = mpt::random<int16>(*s_PRNG);
+		}
+
+		for(auto &chn : expectedChn)
+		{
+			chn.nROfs = -expected[numSamples * 2 - 2];
+			chn.nLOfs = -expected[numSamples * 2 - 1];
+			MixFuncTable::Functions[MixFuncTable::isGeneric][functionNdx](chn, resampler, expected, numSamples);
+			chn.nROfs += expected[numSamples * 2 - 2];
+			chn.nLOfs += expected[numSamples * 2 - 1];
+		}
+		MixFuncTable::MultiVoiceFunctions[multiVoiceNdx](actualVoices, resampler, actual, numSamples);
+
+		VERIFY_EQUAL_NONCONT(std::equal(std::begin(expected), std::end(expected), std::begin(actual)), true);
+		for(int v = 0; v < MixFuncTable::numMultiVoices; v++)
+		{
+			VERIFY_EQUAL_NONCONT(expectedChn[v].position.GetRaw(), actualChn[v].position.GetRaw());
+			VERIFY_EQUAL_NONCONT(expectedChn[v].nROfs, actualChn[v].nROfs);
+			VERIFY_EQUAL_NONCONT(expectedChn[v].nLOfs, actualChn[v].nLOfs);
+		}
+	}
+#endif // MPT_INTMIXER
 }
 
 
-static void CheckEqualTuningCollections(const CTuningCollection &a, const CTuningCollection &b)
+static MPT_NOINLINE void TestPaula()
 {
-	VERIFY_EQUAL(a.GetName(), b.GetName());
-	VERIFY_EQUAL(a.GetNumTunings(), b.GetNumTunings());
-	for(std::size_t tuning = 0; tuning < std::min(a.GetNumTunings(), b.GetNumTunings()); ++tuning)
+	// Feed a deterministic pseudo-random sequence through the BLEP synthesis and checksum the output.
+	// Sample changes are sparse at first and become more frequent later, so that more than MAX_BLEPS bleps are active in the end.
+	mpt::crc32 crc;
+	uint32 seed = 1;
+	const auto nextRandom = [&seed]() { seed = seed * 1664525u + 1013904223u; return seed >> 8; };
+	for(bool filter : { false, true })
 	{
-		VERIFY_EQUAL(a.GetTuning(tuning).GetName(), b.GetTuning(tuning).GetName());
-		VERIFY_EQUAL(a.GetTuning(tuning).GetType(), b.GetTuning(tuning).GetType());
-		VERIFY_EQUAL(a.GetTuning(tuning).GetGroupSize(), b.GetTuning(tuning).GetGroupSize());
-		VERIFY_EQUAL(a.GetTuning(tuning).GetFineStepCount(), b.GetTuning(tuning).GetFineStepCount());
-		VERIFY_EQUAL(RatioEqual(a.GetTuning(tuning).GetGroupRatio(), b.GetTuning(tuning).GetGroupRatio()), true);
-		VERIFY_EQUAL(a.GetTuning(tuning).GetValidityRange(), b.GetTuning(tuning).GetValidityRange());
-		for(ModCommand::NOTE note = NOTE_MIN; note <= NOTE_MAX; ++note)
+		Paula::State paula(48000);
+		int16 sample = 0;
+		for(int i = 0; i < 20000; i++)
 		{
-			VERIFY_EQUAL(a.GetTuning(tuning).GetNoteName(note - NOTE_MIDDLEC), b.GetTuning(tuning).GetNoteName(note - NOTE_MIDDLEC));
-			VERIFY_EQUAL(RatioEqual(a.GetTuning(tuning).GetRatio(note - NOTE_MIDDLEC), b.GetTuning(tuning).GetRatio(note - NOTE_MIDDLEC)), true);
+			const uint32 changeInterval = (i < 10000) ? 64 : ((i < 15000) ? 8 : 1);
+			if(nextRandom() % changeInterval == 0)
+				sample = static_cast<int16>(static_cast<int32>(nextRandom() % 16384u) - 8192);
+			paula.InputSample(sample);
+			paula.Clock((i % 7 == 0) ? static_cast<int>(nextRandom() % Paula::MINIMUM_INTERVAL) : Paula::MINIMUM_INTERVAL);
+			if(i % 5 == 0)
+			{
+				const uint32 out = static_cast<uint32>(paula.OutputSample(filter));
+				for(int b = 0; b < 4; b++)
+					crc(static_cast<unsigned char>(out >> (b * 8)));
+			}
+			if(i == 12345)
+				paula.Reset();
 		}
 	}
+	// Reference checksum of the original implementation, which aged every single blep on every clock
+	VERIFY_EQUAL(crc.result(), 0xE04BDBB6u);
 }
 
-#endif
-
 
-static MPT_NOINLINE void TestTunings()
+// Random 16-bit sample data for CreateMixTestModule
+static std::vector<int16> CreateMixTestSampleData()
 {
+	std::vector<int16> sampleData(1000);
+	for(auto &smp : sampleData)
+	{
+		smp = mpt::random<int16>(*s_PRNG);
+	}
+	return sampleData;
+}
 
-	// nothing for now
 
+static void CreateMixTestModule(CSoundFile &sndFile, const std::vector<int16> &sampleData)
+{
+	sndFile.Create(FileReader(), CSoundFile::loadCompleteModule);
+	sndFile.m_nChannels = 32;
+	sndFile.m_nType = MOD_TYPE_IT;
+	sndFile.m_playBehaviour = CSoundFile::GetDefaultPlaybackBehaviour(MOD_TYPE_IT);
+
+	sndFile.m_nSamples = 1;
+	ModSample &sample = sndFile.GetSample(1);
+	sample.Initialize(MOD_TYPE_IT);
+	sample.uFlags.set(CHN_16BIT | CHN_LOOP);
+	sample.nLength = static_cast<SmpLength>(sampleData.size());
+	sample.nLoopStart = 0;
+	sample.nLoopEnd = sample.nLength;
+	sample.AllocateSample();
+	std::copy(sampleData.begin(), sampleData.end(), sample.sample16());
+	sample.PrecomputeLoops(sndFile, false);
+
+	sndFile.Patterns.Insert(0, 64);
+	for(CHANNELINDEX chn = 0; chn < sndFile.GetNumChannels(); chn++)
+	{
+		ModCommand &m = *sndFile.Patterns[0].GetpModCommand(chn % 4, chn);
+		m.note = static_cast<ModCommand::NOTE>(NOTE_MIDDLEC - 12 + chn);
+		m.instr = 1;
+		m.volcmd = VOLCMD_PANNING;
+		m.vol = static_cast<ModCommand::VOL>(chn * 2);
+	}
+	sndFile.Order().assign(1, 0);
 }
 
 
-
-static double Rand01()
+// Collects the interleaved mix output of CSoundFile::Read
+struct MixTestTarget : public IAudioReadTarget
 {
-	return mpt::random(*s_PRNG, 0.0, 1.0);
-}
+	std::vector<int32> data;
+	void DataCallback(int32 *MixSoundBuffer, std::size_t channels, std::size_t countChunk) override
+	{
+		data.insert(data.end(), MixSoundBuffer, MixSoundBuffer + channels * countChunk);
+	}
+};
 
-template <class T>
-T Rand(const T min, const T max)
+
+static MPT_NOINLINE void TestMixThreads()
 {
-	return mpt::saturate_round<T>(min + Rand01() * (max - min));
+	// Multi-threaded mixing must produce exactly the same output as single-threaded mixing
+	const std::vector<int16> sampleData = CreateMixTestSampleData();
+
+	for(uint32 numThreads : { 2u, 3u, 8u })
+	{
+		std::unique_ptr<CSoundFile> serial = std::make_unique<CSoundFile>(), parallel = std::make_unique<CSoundFile>();
+		CreateMixTestModule(*serial, sampleData);
+		CreateMixTestModule(*parallel, sampleData);
+		parallel->SetMixThreads(numThreads);
+		VERIFY_EQUAL_NONCONT(parallel->GetMixThreads() <= numThreads, true);
+
+		MixTestTarget serialTarget, parallelTarget;
+		for(int i = 0; i < 20; i++)
+		{
+			serial->Read(1000, serialTarget);
+			parallel->Read(1000, parallelTarget);
+		}
+		VERIFY_EQUAL_NONCONT(serialTarget.data.size(), parallelTarget.data.size());
+		VERIFY_EQUAL_NONCONT(serialTarget.data == parallelTarget.data, true);
+		VERIFY_EQUAL_NONCONT(std::count(serialTarget.data.begin(), serialTarget.data.end(), 0) < static_cast<std::ptrdiff_t>(serialTarget.data.size()), true);
+	}
 }
 
-static void GenerateCommands(CPattern& pat, const double dProbPcs, const double dProbPc)
+
+static MPT_NOINLINE void TestMultiVoiceMixing()
 {
-	const double dPcxProb = dProbPcs + dProbPc;
-	for(auto &m : pat)
+	// Mixing several voices in one pass must produce exactly the same output as mixing every voice on its own,
+	// including voices that ramp, stop at the sample end while ramping or fade out while ramping.
+	const std::vector<int16> sampleData = CreateMixTestSampleData();
+
+	for(ResamplingMode resampling : { SRCMODE_NEAREST, SRCMODE_LINEAR })
 	{
-		const double rand = Rand01();
-		if(rand < dPcxProb)
+		std::unique_ptr<CSoundFile> reference = std::make_unique<CSoundFile>(), sndFile = std::make_unique<CSoundFile>();
+		for(auto file : { reference.get(), sndFile.get() })
 		{
-			if(rand < dProbPcs)
-				m.note = NOTE_PCS;
-			else
-				m.note = NOTE_PC;
+			// Long ramps and short ticks, so that many chunks start with a ramp
+			MixerSettings mixerSettings;
+			mixerSettings.SetVolumeRampUpMicroseconds(5000);
+			mixerSettings.SetVolumeRampDownMicroseconds(5000);
+			file->SetMixerSettings(mixerSettings);
+			CreateMixTestModule(*file, sampleData);
+			// One-shot sample, so that voices also stop at the sample end
+			file->GetSample(1).uFlags.reset(CHN_LOOP);
+			file->m_nInstruments = 1;
+			ModInstrument *ins = file->AllocateInstrument(1, 1);
+			ins->nFadeOut = 8192;
+			ins->resampling = resampling;
+			for(ROWINDEX row = 0; row < file->Patterns[0].GetNumRows(); row++)
+			{
+				for(CHANNELINDEX chn = 0; chn < file->GetNumChannels(); chn++)
+				{
+					ModCommand &m = *file->Patterns[0].GetpModCommand(row, chn);
+					if(row == 8 + chn % 8u)
+						m.note = NOTE_FADE;
+					else if(row == 24 + chn % 4u)
+						m = *file->Patterns[0].GetpModCommand(chn % 4u, chn);
+					m.command = CMD_CHANNELVOLUME;
+					m.param = static_cast<ModCommand::PARAM>(((row + chn) % 3u) ? (1 + (row * 7 + chn * 3) % 64u) : 0);
+				}
+			}
+			file->m_nDefaultSpeed = 1;
+			file->m_nDefaultTempo.Set(255);
+			file->ResetPlayPos();
+		}
+		reference->SetMultiVoiceMixing(false);
+		VERIFY_EQUAL(reference->GetMultiVoiceMixing(), false);
+		VERIFY_EQUAL(sndFile->GetMultiVoiceMixing(), true);
 
-			m.instr = Rand<ModCommand::INSTR>(0, MAX_MIXPLUGINS);
-			m.SetValueVolCol(Rand<uint16>(0, ModCommand::maxColumnValue));
-			m.SetValueEffectCol(Rand<uint16>(0, ModCommand::maxColumnValue));
+		MixTestTarget referenceTarget, target;
+		for(int i = 0; i < 12; i++)
+		{
+			reference->Read(5000, referenceTarget);
+			sndFile->Read(5000, target);
 		}
-		else
-			m.Clear();
+		VERIFY_EQUAL_NONCONT(referenceTarget.data.size(), target.data.size());
+		VERIFY_EQUAL_NONCONT(referenceTarget.data == target.data, true);
+		VERIFY_EQUAL_NONCONT(std::count(target.data.begin(), target.data.end(), 0) < static_cast<std::ptrdiff_t>(target.data.size()), true);
 	}
 }
 
 
-// Test PC note serialization
-static MPT_NOINLINE void TestPCnoteSerialization()
+static MPT_NOINLINE void TestMixBlockSize()
 {
-	FileReader file;
-	std::unique_ptr<CSoundFile> pSndFile = std::make_unique<CSoundFile>();
-	CSoundFile &sndFile = *pSndFile.get();
-	sndFile.m_nType = MOD_TYPE_MPT;
-	sndFile.Patterns.DestroyPatterns();
-	sndFile.m_nChannels = ModSpecs::mptm.channelsMax;
+	// Rendering in larger or smaller blocks must produce exactly the same output as rendering in blocks of MIXBUFFERSIZE frames
+	const std::vector<int16> sampleData = CreateMixTestSampleData();
 
-	sndFile.Patterns.Insert(0, ModSpecs::mptm.patternRowsMin);
-	sndFile.Patterns.Insert(1, 64);
-	GenerateCommands(sndFile.Patterns[1], 0.3, 0.3);
-	sndFile.Patterns.Insert(2, ModSpecs::mptm.patternRowsMax);
-	GenerateCommands(sndFile.Patterns[2], 0.5, 0.5);
+	for(uint32 channels : { 2u, 4u })
+	{
+		for(uint32 blockSize : { 16u, 100u, 1024u, 4096u, 100000u })
+		{
+			std::unique_ptr<CSoundFile> reference = std::make_unique<CSoundFile>(), sndFile = std::make_unique<CSoundFile>();
+			MixerSettings mixerSettings;
+			mixerSettings.gnChannels = channels;
+#ifndef NO_REVERB
+			mixerSettings.DSPMask |= SNDDSP_REVERB;
+#endif // NO_REVERB
+			for(auto file : { reference.get(), sndFile.get() })
+			{
+				file->SetMixerSettings(mixerSettings);
+				CreateMixTestModule(*file, sampleData);
+			}
+			sndFile->SetMixBlockSize(blockSize);
+			VERIFY_EQUAL_NONCONT(sndFile->GetMixBlockSize() % CSoundFile::MinMixBlockSize, 0u);
+			VERIFY_EQUAL_NONCONT(sndFile->GetMixBlockSize() >= std::min(blockSize, CSoundFile::MaxMixBlockSize), true);
 
-	// Copy pattern data for comparison.
-	CPatternContainer patterns{ sndFile.Patterns };
+			MixTestTarget referenceTarget, target;
+			for(int i = 0; i < 4; i++)
+			{
+				reference->Read(5000, referenceTarget);
+				sndFile->Read(5000, target);
+			}
+			VERIFY_EQUAL_NONCONT(referenceTarget.data.size(), target.data.size());
+			VERIFY_EQUAL_NONCONT(referenceTarget.data == target.data, true);
+		}
+	}
 
-	mpt::stringstream mem;
-	WriteModPatterns(mem, sndFile.Patterns);
+	CSoundFile sndFile;
+	sndFile.SetMixBlockSize(0);
+	VERIFY_EQUAL(sndFile.GetMixBlockSize(), static_cast<uint32>(MIXBUFFERSIZE));
+}
 
-	VERIFY_EQUAL_NONCONT( mem.good(), true );
 
-	// Clear patterns.
-	sndFile.Patterns[0].ClearCommands();
-	sndFile.Patterns[1].ClearCommands();
-	sndFile.Patterns[2].ClearCommands();
+static MPT_NOINLINE void TestVoiceCulling()
+{
+	// Voices that are not mixed because they are too quiet must end up at exactly the same play position as if they had been mixed
+	const std::vector<int16> sampleData = CreateMixTestSampleData();
 
-	// Read data back.
-	ReadModPatterns(mem, sndFile.Patterns);
+	for(int loopType = 0; loopType < 3; loopType++)
+	{
+		for(bool highPitch : { true, false })
+		{
+			std::unique_ptr<CSoundFile> reference = std::make_unique<CSoundFile>(), sndFile = std::make_unique<CSoundFile>();
+			for(auto file : { reference.get(), sndFile.get() })
+			{
+				CreateMixTestModule(*file, sampleData);
+				// Short loop and high pitch, so that the loop is wrapped around many times per rendered block.
+				// At low pitch, every turn of a ping-pong loop overshoots the loop end by less than one sample.
+				ModSample &sample = file->GetSample(1);
+				sample.nLoopStart = 950;
+				if(highPitch)
+					sample.nC5Speed *= 8;
+				else
+					sample.nC5Speed /= 3;
+				sample.uFlags.set(CHN_PINGPONGLOOP, loopType != 0);
+				file->m_playBehaviour.set(kITPingPongMode, loopType == 2);
+				sample.PrecomputeLoops(*file, false);
+			}
+
+			MixTestTarget referenceTarget, target;
+			reference->Read(5000, referenceTarget);
+			reference->Read(5000, referenceTarget);
+
+			// Cull (nearly) everything
+			sndFile->SetVoiceCullThreshold(-0.01);
+			VERIFY_EQUAL(sndFile->GetVoiceCullThreshold(), -0.01);
+			sndFile->Read(5000, target);
+			sndFile->SetVoiceCullThreshold(0.0);
+			VERIFY_EQUAL(sndFile->GetVoiceCullThreshold(), 0.0);
+			sndFile->Read(5000, target);
+
+			VERIFY_EQUAL_NONCONT(referenceTarget.data.size(), target.data.size());
+			const auto half = referenceTarget.data.size() / 2;
+			VERIFY_EQUAL_NONCONT(std::equal(referenceTarget.data.begin(), referenceTarget.data.begin() + half, target.data.begin()), false);
+			VERIFY_EQUAL_NONCONT(std::equal(referenceTarget.data.begin() + half, referenceTarget.data.end(), target.data.begin() + half), true);
+		}
+	}
 
-	// Compare.
-	VERIFY_EQUAL_NONCONT( sndFile.Patterns[0].GetNumRows(), ModSpecs::mptm.patternRowsMin);
-	VERIFY_EQUAL_NONCONT( sndFile.Patterns[1].GetNumRows(), 64);
-	VERIFY_EQUAL_NONCONT( sndFile.Patterns[2].GetNumRows(), ModSpecs::mptm.patternRowsMax);
-	for(int i = 0; i < 3; i++)
 	{
-		VERIFY_EQUAL(sndFile.Patterns[i], patterns[i]);
+		// A voice that becomes too quiet to be heard while it is being mixed must be faded out like a stopped voice, not cut off
+		const std::vector<int16> dcData(1000, 8192);
+		std::unique_ptr<CSoundFile> reference = std::make_unique<CSoundFile>(), sndFile = std::make_unique<CSoundFile>();
+		for(auto file : { reference.get(), sndFile.get() })
+		{
+			CreateMixTestModule(*file, dcData);
+			file->Patterns[0].ClearCommands();
+			ModCommand &note = *file->Patterns[0].GetpModCommand(0, 0);
+			note.note = NOTE_MIDDLEC;
+			note.instr = 1;
+			note.volcmd = VOLCMD_VOLUME;
+			note.vol = 64;
+			ModCommand &quiet = *file->Patterns[0].GetpModCommand(2, 0);
+			quiet.volcmd = VOLCMD_VOLUME;
+			quiet.vol = 1;
+		}
+		sndFile->SetVoiceCullThreshold(-30.0);
+
+		MixTestTarget referenceTarget, target;
+		for(int i = 0; i < 6; i++)
+		{
+			reference->Read(5000, referenceTarget);
+			sndFile->Read(5000, target);
+		}
+		VERIFY_EQUAL_NONCONT(referenceTarget.data.size(), target.data.size());
+		// The quiet voice is really culled in the end...
+		const int32 quietLevel = std::abs(referenceTarget.data.back());
+		VERIFY_EQUAL_NONCONT(quietLevel > 0, true);
+		VERIFY_EQUAL_NONCONT(std::abs(target.data.back()) < quietLevel / 16, true);
+		// ...but there is no step in the output that is any larger than a step in the reference output
+		int32 maxStep = 0;
+		for(std::size_t i = 2; i < target.data.size(); i++)
+		{
+			const int32 step = std::abs(target.data[i] - target.data[i - 2]) - std::abs(referenceTarget.data[i] - referenceTarget.data[i - 2]);
+			maxStep = std::max(maxStep, step);
+		}
+		VERIFY_EQUAL_NONCONT(maxStep < quietLevel / 16, true);
 	}
+
+	CSoundFile sndFile;
+	sndFile.SetVoiceCullThreshold(6.0);
+	VERIFY_EQUAL(sndFile.GetVoiceCullThreshold(), 0.0);
 }
 
 
-static inline std::size_t strnlen(const char *str, std::size_t n)
+static MPT_NOINLINE void TestFilterCutoffCache()
 {
-#if MPT_COMPILER_MSVC
-	return ::strnlen(str, n);
-#else
-	if(n >= std::numeric_limits<std::size_t>::max())
+	// Filter cutoff frequencies must be recomputed when the mixing frequency or the filter range changes
+	const std::vector<int16> sampleData = CreateMixTestSampleData();
+
+	const auto createModule = [&sampleData](CSoundFile &sndFile, uint32 mixingFreq, bool extendedRange)
 	{
-		return std::strlen(str);
-	}
-	for(std::size_t i = 0; i < n; ++i)
+		MixerSettings mixerSettings;
+		mixerSettings.gdwMixingFreq = mixingFreq;
+		sndFile.SetMixerSettings(mixerSettings);
+		CreateMixTestModule(sndFile, sampleData);
+		sndFile.m_SongFlags.set(SONG_EXFILTERRANGE, extendedRange);
+		// Resonant filter with a filter envelope sweeping through the whole cutoff range
+		sndFile.m_nInstruments = 1;
+		ModInstrument *ins = sndFile.AllocateInstrument(1, 1);
+		ins->SetCutoff(127, true);
+		ins->SetResonance(100, true);
+		ins->PitchEnv.dwFlags.set(ENV_ENABLED | ENV_FILTER);
+		ins->PitchEnv.push_back(0, ENVELOPE_MAX);
+		ins->PitchEnv.push_back(20, 0);
+	};
+
+	for(bool changeRange : { false, true })
 	{
-		if(str[i] == '\0')
+		std::unique_ptr<CSoundFile> reference = std::make_unique<CSoundFile>(), sndFile = std::make_unique<CSoundFile>();
+		createModule(*reference, 8000, true);
+		createModule(*sndFile, changeRange ? 8000 : 48000, !changeRange);
+
+		MixTestTarget referenceTarget, target;
+		reference->Read(5000, referenceTarget);
+		sndFile->Read(5000, target);
+
+		// Restart playback with the same settings as the reference
+		if(changeRange)
 		{
-			return i;
+			sndFile->m_SongFlags.set(SONG_EXFILTERRANGE);
+		} else
+		{
+			MixerSettings mixerSettings = sndFile->m_MixerSettings;
+			mixerSettings.gdwMixingFreq = 8000;
+			sndFile->SetMixerSettings(mixerSettings);
 		}
+		referenceTarget.data.clear();
+		target.data.clear();
+		reference->ResetPlayPos();
+		sndFile->ResetPlayPos();
+		reference->Read(5000, referenceTarget);
+		sndFile->Read(5000, target);
+
+		VERIFY_EQUAL_NONCONT(referenceTarget.data.size(), target.data.size());
+		VERIFY_EQUAL_NONCONT(referenceTarget.data == target.data, true);
+	}
+
+	// The table is only built up front for modules that can make use of the filter
+	{
+		std::unique_ptr<CSoundFile> sndFile = std::make_unique<CSoundFile>();
+		CreateMixTestModule(*sndFile, sampleData);
+		VERIFY_EQUAL(sndFile->UsesResonantFilter(), false);
+		sndFile->Patterns[0].GetpModCommand(8, 3)->command = CMD_MIDI;
+		VERIFY_EQUAL(sndFile->UsesResonantFilter(), true);
+		sndFile->Patterns[0].GetpModCommand(8, 3)->command = CMD_SMOOTHMIDI;
+		VERIFY_EQUAL(sndFile->UsesResonantFilter(), true);
+		sndFile->Patterns[0].GetpModCommand(8, 3)->command = CMD_NONE;
+
+		createModule(*sndFile, 44100, false);
+		VERIFY_EQUAL(sndFile->UsesResonantFilter(), true);
+		sndFile->Instruments[1]->SetCutoff(127, false);
+		sndFile->Instruments[1]->SetResonance(0, false);
+		VERIFY_EQUAL(sndFile->UsesResonantFilter(), true);	// Filter envelope
+		sndFile->Instruments[1]->PitchEnv.dwFlags.reset(ENV_FILTER);
+		VERIFY_EQUAL(sndFile->UsesResonantFilter(), false);
 	}
-	return n;
-#endif
 }
 
 
-// Test String I/O functionality
-static MPT_NOINLINE void TestStringIO()
+static MPT_NOINLINE void TestPluginGraph()
 {
-	char src0[4] = { '\0', 'X', ' ', 'X' };		// Weird empty buffer
-	char src1[4] = { 'X', ' ', '\0', 'X' };		// Weird buffer (hello Impulse Tracker)
-	char src2[4] = { 'X', 'Y', 'Z', ' ' };		// Full buffer, last character space
-	char src3[4] = { 'X', 'Y', 'Z', '!' };		// Full buffer, last character non-space
-	char src4[4] = { 'x', 'y', '\t', '\n' };	// Full buffer containing non-space whitespace
-	char dst1[6];	// Destination buffer, larger than source buffer
-	char dst2[3];	// Destination buffer, smaller than source buffer
+#ifndef NO_PLUGINS
+	// Plugins that are added, removed or re-routed during playback must be picked up by the mixer
+	const auto createEcho = [](CSoundFile &sndFile, PLUGINDEX plug, PLUGINDEX output)
+	{
+		SNDMIXPLUGIN &plugin = sndFile.m_MixPlugins[plug];
+		plugin.Destroy();
+		memcpy(&plugin.Info.dwPluginId1, "DBM0", 4);
+		memcpy(&plugin.Info.dwPluginId2, "Echo", 4);
+		plugin.Info.szLibraryName = "DigiBooster Pro Echo";
+		if(output != PLUGINDEX_INVALID)
+			plugin.SetOutputPlugin(output);
+		else
+			plugin.SetOutputToMaster();
+		CreateMixPluginProc(plugin, sndFile);
+		VERIFY_EQUAL_NONCONT(plugin.pMixPlugin != nullptr, true);
+	};
 
-#define ReadTest(mode, dst, src, expectedResult) \
-	std::memset(dst, 0x7f, sizeof(dst)); \
-	mpt::String::WriteAutoBuf(dst) = mpt::String::ReadBuf(mpt::String:: mode , src); \
-	VERIFY_EQUAL_NONCONT(strncmp(dst, expectedResult, mpt::size(dst)), 0); /* Ensure that the strings are identical */ \
-	for(size_t i = strlen(dst); i < mpt::size(dst); i++) \
-		VERIFY_EQUAL_NONCONT(dst[i], '\0'); /* Ensure that rest of the buffer is completely nulled */ \
-	/**/
+	const std::vector<int16> sampleData = CreateMixTestSampleData();
 
-#define WriteTest(mode, dst, src, expectedResult) \
-	std::memset(dst, 0x7f, sizeof(dst)); \
-	mpt::String::WriteBuf(mpt::String:: mode , dst) = mpt::String::ReadAutoBuf(src); \
-	VERIFY_EQUAL_NONCONT(strncmp(dst, expectedResult, mpt::size(dst)), 0);  /* Ensure that the strings are identical */ \
-	for(size_t i = Test::strnlen(dst, mpt::size(dst)); i < mpt::size(dst); i++) \
-		VERIFY_EQUAL_NONCONT(dst[i], '\0'); /* Ensure that rest of the buffer is completely nulled */ \
-	/**/
+	std::unique_ptr<CSoundFile> reference = std::make_unique<CSoundFile>(), sndFile = std::make_unique<CSoundFile>();
+	for(auto file : { reference.get(), sndFile.get() })
+	{
+		CreateMixTestModule(*file, sampleData);
+		for(CHANNELINDEX chn = 0; chn < file->GetNumChannels(); chn++)
+		{
+			file->ChnSettings[chn].nMixPlugin = 1;
+		}
+	}
 
-	// Check reading of null-terminated string into larger buffer
-	ReadTest(nullTerminated, dst1, src0, "");
-	ReadTest(nullTerminated, dst1, src1, "X ");
-	ReadTest(nullTerminated, dst1, src2, "XYZ");
-	ReadTest(nullTerminated, dst1, src3, "XYZ");
-	ReadTest(nullTerminated, dst1, src4, "xy\t");
+	// All channels are sent through a chain of two plugins; the second one only receives input from the first one.
+	createEcho(*reference, 0, 2);
+	createEcho(*reference, 2, PLUGINDEX_INVALID);
+	MixTestTarget referenceTarget, target;
+	reference->Read(5000, referenceTarget);
 
-	// Check reading of string that should be null-terminated, but is maybe too long to still hold the null character.
-	ReadTest(maybeNullTerminated, dst1, src0, "");
-	ReadTest(maybeNullTerminated, dst1, src1, "X ");
-	ReadTest(maybeNullTerminated, dst1, src2, "XYZ ");
-	ReadTest(maybeNullTerminated, dst1, src3, "XYZ!");
-	ReadTest(maybeNullTerminated, dst1, src4, "xy\t\n");
+	// Start playback without plugins, then add them
+	sndFile->Read(0, target);
+	createEcho(*sndFile, 0, 2);
+	createEcho(*sndFile, 2, PLUGINDEX_INVALID);
+	sndFile->Read(5000, target);
 
-	// Check reading of space-padded strings with ignored last character
-	ReadTest(spacePaddedNull, dst1, src0, " X");
-	ReadTest(spacePaddedNull, dst1, src1, "X");
-	ReadTest(spacePaddedNull, dst1, src2, "XYZ");
+	VERIFY_EQUAL_NONCONT(referenceTarget.data == target.data, true);
+	VERIFY_EQUAL_NONCONT(std::any_of(target.data.begin(), target.data.end(), [](int32 v) { return v != 0; }), true);
+
+	// Remove the end of the chain, the first plugin should now be heard directly
+	for(auto file : { reference.get(), sndFile.get() })
+	{
+		file->m_MixPlugins[2].Destroy();
+	}
+	reference->Read(5000, referenceTarget);
+	sndFile->Read(5000, target);
+
+	// Re-route the first plugin into a new plugin
+	createEcho(*reference, 3, PLUGINDEX_INVALID);
+	reference->m_MixPlugins[0].SetOutputPlugin(3);
+	reference->Read(5000, referenceTarget);
+	sndFile->m_MixPlugins[0].SetOutputPlugin(3);
+	createEcho(*sndFile, 3, PLUGINDEX_INVALID);
+	sndFile->Read(5000, target);
+
+	VERIFY_EQUAL_NONCONT(referenceTarget.data.size(), target.data.size());
+	VERIFY_EQUAL_NONCONT(referenceTarget.data == target.data, true);
+#endif // NO_PLUGINS
+}
+
+
+static MPT_NOINLINE void TestSequenceLengths()
+{
+	// Scanning sequences in parallel must produce the same sub songs as scanning them one after another
+	CSoundFile sndFile;
+	sndFile.Create(FileReader(), CSoundFile::loadCompleteModule);
+	sndFile.m_nChannels = 4;
+	sndFile.m_nType = MOD_TYPE_MPT;
+	sndFile.m_playBehaviour = CSoundFile::GetDefaultPlaybackBehaviour(MOD_TYPE_MPT);
+
+	const PATTERNINDEX numPatterns = 8;
+	for(PATTERNINDEX pat = 0; pat < numPatterns; pat++)
+	{
+		sndFile.Patterns.Insert(pat, 16 + pat * 8);
+		ModCommand &m = *sndFile.Patterns[pat].GetpModCommand(0, 0);
+		m.command = CMD_SPEED;
+		m.param = static_cast<ModCommand::PARAM>(2 + pat);
+	}
+
+	const SEQUENCEINDEX numSequences = 13;
+	for(SEQUENCEINDEX seq = 0; seq < numSequences; seq++)
+	{
+		if(seq > 0)
+			VERIFY_EQUAL_NONCONT(sndFile.Order.AddSequence(false), seq);
+		ModSequence &order = sndFile.Order(seq);
+		for(PATTERNINDEX pat = 0; pat <= seq % numPatterns; pat++)
+		{
+			order.push_back((pat + seq) % numPatterns);
+		}
+		if(seq % 3 == 0)
+		{
+			// Second sub song
+			order.push_back(order.GetInvalidPatIndex());
+			order.push_back(seq % numPatterns);
+		}
+	}
+	VERIFY_EQUAL(sndFile.Order.GetNumSequences(), numSequences);
+
+	const auto serial = sndFile.GetLengthOfAllSequences(1);
+	VERIFY_EQUAL(serial.size(), numSequences);
+	for(SEQUENCEINDEX seq = 0; seq < numSequences; seq++)
+	{
+		const auto lengths = sndFile.GetLength(eNoAdjust, GetLengthTarget(true).StartPos(seq, 0, 0));
+		VERIFY_EQUAL_NONCONT(serial[seq].size(), lengths.size());
+		VERIFY_EQUAL_NONCONT(serial[seq].size(), (seq % 3 == 0) ? 2u : 1u);
+	}
+
+	for(uint32 numThreads : { 0u, 2u, 4u, 64u })
+	{
+		const auto parallel = sndFile.GetLengthOfAllSequences(numThreads);
+		VERIFY_EQUAL_NONCONT(parallel.size(), serial.size());
+		for(SEQUENCEINDEX seq = 0; seq < std::min(parallel.size(), serial.size()); seq++)
+		{
+			VERIFY_EQUAL_NONCONT(parallel[seq].size(), serial[seq].size());
+			for(size_t i = 0; i < std::min(parallel[seq].size(), serial[seq].size()); i++)
+			{
+				VERIFY_EQUAL_NONCONT(parallel[seq][i].duration, serial[seq][i].duration);
+				VERIFY_EQUAL_NONCONT(parallel[seq][i].startOrder, serial[seq][i].startOrder);
+				VERIFY_EQUAL_NONCONT(parallel[seq][i].startRow, serial[seq][i].startRow);
+				VERIFY_EQUAL_NONCONT(parallel[seq][i].endOrder, serial[seq][i].endOrder);
+				VERIFY_EQUAL_NONCONT(parallel[seq][i].endRow, serial[seq][i].endRow);
+			}
+		}
+	}
+
+	// Sequences can also be scanned in parallel while the seek index is being built
+	sndFile.SetSeekIndexInterval(0.5);
+	for(uint32 numThreads : { 1u, 4u })
+	{
+		const auto indexed = sndFile.GetLengthOfAllSequences(numThreads);
+		VERIFY_EQUAL_NONCONT(indexed.size(), serial.size());
+		for(SEQUENCEINDEX seq = 0; seq < std::min(indexed.size(), serial.size()); seq++)
+		{
+			VERIFY_EQUAL_NONCONT(indexed[seq].size(), serial[seq].size());
+			for(size_t i = 0; i < std::min(indexed[seq].size(), serial[seq].size()); i++)
+			{
+				VERIFY_EQUAL_NONCONT(indexed[seq][i].duration, serial[seq][i].duration);
+				VERIFY_EQUAL_NONCONT(indexed[seq][i].startOrder, serial[seq][i].startOrder);
+				VERIFY_EQUAL_NONCONT(indexed[seq][i].startRow, serial[seq][i].startRow);
+			}
+		}
+	}
+	sndFile.SetSeekIndexInterval(0.0);
+}
+
+
+static void CreateSeekTestModule(CSoundFile &sndFile, const std::vector<int16> &sampleData)
+{
+	sndFile.Create(FileReader(), CSoundFile::loadCompleteModule);
+	sndFile.m_nChannels = 8;
+	sndFile.m_nType = MOD_TYPE_IT;
+	sndFile.m_playBehaviour = CSoundFile::GetDefaultPlaybackBehaviour(MOD_TYPE_IT);
+
+	sndFile.m_nSamples = 1;
+	ModSample &sample = sndFile.GetSample(1);
+	sample.Initialize(MOD_TYPE_IT);
+	sample.uFlags.set(CHN_16BIT | CHN_LOOP);
+	sample.nLength = static_cast<SmpLength>(sampleData.size());
+	sample.nLoopStart = 0;
+	sample.nLoopEnd = sample.nLength;
+	sample.AllocateSample();
+	std::copy(sampleData.begin(), sampleData.end(), sample.sample16());
+	sample.PrecomputeLoops(sndFile, false);
+
+	// Notes, global volume and tempo change throughout the song, so that every part of it sounds different.
+	const PATTERNINDEX numPatterns = 16;
+	for(PATTERNINDEX pat = 0; pat < numPatterns; pat++)
+	{
+		sndFile.Patterns.Insert(pat, 64);
+		for(ROWINDEX row = 0; row < 64; row += 8)
+		{
+			for(CHANNELINDEX chn = 0; chn < sndFile.GetNumChannels(); chn++)
+			{
+				ModCommand &m = *sndFile.Patterns[pat].GetpModCommand(row + chn % 4, chn);
+				m.note = static_cast<ModCommand::NOTE>(NOTE_MIDDLEC - 12 + (pat * 5 + row + chn * 3) % 36);
+				m.instr = 1;
+				m.volcmd = VOLCMD_VOLUME;
+				m.vol = static_cast<ModCommand::VOL>(16 + (pat + row + chn) % 48);
+			}
+			ModCommand &global = *sndFile.Patterns[pat].GetpModCommand(row + 4, 0);
+			global.command = CMD_GLOBALVOLUME;
+			global.param = static_cast<ModCommand::PARAM>(32 + (pat * 13 + row) % 96);
+		}
+		ModCommand &tempo = *sndFile.Patterns[pat].GetpModCommand(0, 1);
+		tempo.command = CMD_TEMPO;
+		tempo.param = static_cast<ModCommand::PARAM>(100 + pat * 7);
+		sndFile.Order().push_back(pat);
+	}
+}
+
+
+static MPT_NOINLINE void TestSeekIndex()
+{
+	// Seeking through the seek index must play exactly the same as seeking without it.
+	// The index is built at a different point of playback than the seeks happen, so that any mixer state that is
+	// restored from a checkpoint instead of being kept would change the rendered output.
+	const std::vector<int16> sampleData = CreateMixTestSampleData();
+
+	std::unique_ptr<CSoundFile> indexed = std::make_unique<CSoundFile>(), reference = std::make_unique<CSoundFile>();
+	for(auto file : { indexed.get(), reference.get() })
+	{
+		CreateSeekTestModule(*file, sampleData);
+		MixTestTarget target;
+		file->Read(777, target);
+	}
+	indexed->SetSeekIndexInterval(1.0);
+
+	// The song length calculation builds the index, which must also be used by the following seeks.
+	const auto indexedLength = indexed->GetLength(eNoAdjust, GetLengthTarget(true));
+	const auto referenceLength = reference->GetLength(eNoAdjust, GetLengthTarget(true));
+	VERIFY_EQUAL_NONCONT(indexedLength.size(), referenceLength.size());
+	VERIFY_EQUAL_NONCONT(indexedLength.back().duration, referenceLength.back().duration);
+	VERIFY_EQUAL_NONCONT(indexedLength.back().duration > 30.0, true);
+
+	const std::pair<ORDERINDEX, ROWINDEX> seekTargets[] = { { 3, 16 }, { 10, 0 }, { 1, 41 }, { 15, 56 }, { 7, 9 }, { 12, 33 }, { 0, 0 } };
+	for(int pass = 0; pass < 2; pass++)
+	{
+		for(const auto &seekTarget : seekTargets)
+		{
+			MixTestTarget indexedOutput, referenceOutput;
+			indexed->Read(1234, indexedOutput);
+			reference->Read(1234, referenceOutput);
+
+			indexed->GetLength(eAdjust, GetLengthTarget(seekTarget.first, seekTarget.second));
+			reference->GetLength(eAdjust, GetLengthTarget(seekTarget.first, seekTarget.second));
+			VERIFY_EQUAL_NONCONT(indexed->m_PlayState.m_nMusicSpeed, reference->m_PlayState.m_nMusicSpeed);
+			VERIFY_EQUAL_NONCONT(indexed->m_PlayState.m_nMusicTempo, reference->m_PlayState.m_nMusicTempo);
+			VERIFY_EQUAL_NONCONT(indexed->m_PlayState.m_nGlobalVolume, reference->m_PlayState.m_nGlobalVolume);
+
+			indexed->Read(2000, indexedOutput);
+			reference->Read(2000, referenceOutput);
+			VERIFY_EQUAL_NONCONT(indexedOutput.data == referenceOutput.data, true);
+			VERIFY_EQUAL_NONCONT(std::count(indexedOutput.data.begin(), indexedOutput.data.end(), 0) < static_cast<std::ptrdiff_t>(indexedOutput.data.size()), true);
+		}
+	}
+}
+
+
+static void CreateInvertLoopTestModule(CSoundFile &sndFile, const std::vector<int8> &sampleData)
+{
+	sndFile.Create(FileReader(), CSoundFile::loadCompleteModule);
+	sndFile.m_nChannels = 4;
+	sndFile.m_nType = MOD_TYPE_MOD;
+	sndFile.m_playBehaviour = CSoundFile::GetDefaultPlaybackBehaviour(MOD_TYPE_MOD);
+
+	sndFile.m_nSamples = 1;
+	ModSample &sample = sndFile.GetSample(1);
+	sample.Initialize(MOD_TYPE_MOD);
+	sample.uFlags.set(CHN_LOOP);
+	sample.nLength = static_cast<SmpLength>(sampleData.size());
+	sample.nLoopStart = 0;
+	sample.nLoopEnd = sample.nLength;
+	sample.AllocateSample();
+	std::copy(sampleData.begin(), sampleData.end(), sample.sample8());
+	sample.PrecomputeLoops(sndFile, false);
+
+	sndFile.Patterns.Insert(0, 64);
+	ModCommand &m = *sndFile.Patterns[0].GetpModCommand(0, 0);
+	m.note = NOTE_MIDDLEC;
+	m.instr = 1;
+	m.command = CMD_MODCMDEX;
+	m.param = 0xFF;	// Invert Loop
+	sndFile.Order().assign(1, 0);
+}
+
+
+static MPT_NOINLINE void TestSampleDataPool()
+{
+	// Modules loaded with the same key must share identical sample data, without affecting playback
+	const std::vector<int16> sampleData = CreateMixTestSampleData();
+	std::vector<int16> otherSampleData = sampleData;
+	otherSampleData[500] ^= 1;
+
+	{
+		std::unique_ptr<CSoundFile> first = std::make_unique<CSoundFile>(), second = std::make_unique<CSoundFile>(), other = std::make_unique<CSoundFile>(), reference = std::make_unique<CSoundFile>();
+		CreateMixTestModule(*first, sampleData);
+		CreateMixTestModule(*second, sampleData);
+		CreateMixTestModule(*other, otherSampleData);
+		CreateMixTestModule(*reference, sampleData);
+		first->ShareSampleData("TestSampleDataPool");
+		second->ShareSampleData("TestSampleDataPool");
+		other->ShareSampleData("TestSampleDataPool");
+		VERIFY_EQUAL(first->HasSharedSampleData(), true);
+		VERIFY_EQUAL(first->GetSample(1).samplev() == second->GetSample(1).samplev(), true);
+		// Same key, but different data
+		VERIFY_EQUAL(first->GetSample(1).samplev() == other->GetSample(1).samplev(), false);
+
+		// The shared data must stay valid as long as any module is using it
+		first.reset();
+		MixTestTarget referenceTarget, target;
+		for(int i = 0; i < 4; i++)
+		{
+			reference->Read(5000, referenceTarget);
+			second->Read(5000, target);
+		}
+		VERIFY_EQUAL_NONCONT(referenceTarget.data.size(), target.data.size());
+		VERIFY_EQUAL_NONCONT(referenceTarget.data == target.data, true);
+	}
+
+	// Modifying sample data through the Invert Loop effect must not affect other modules
+	std::vector<int8> sampleData8(1000);
+	for(auto &smp : sampleData8)
+	{
+		smp = mpt::random<int8>(*s_PRNG);
+	}
+	std::unique_ptr<CSoundFile> modified = std::make_unique<CSoundFile>(), unmodified = std::make_unique<CSoundFile>(), reference = std::make_unique<CSoundFile>();
+	CreateInvertLoopTestModule(*modified, sampleData8);
+	CreateInvertLoopTestModule(*unmodified, sampleData8);
+	CreateInvertLoopTestModule(*reference, sampleData8);
+	modified->ShareSampleData("TestSampleDataPool-InvertLoop");
+	unmodified->ShareSampleData("TestSampleDataPool-InvertLoop");
+	VERIFY_EQUAL(modified->GetSample(1).samplev() == unmodified->GetSample(1).samplev(), true);
+
+	MixTestTarget referenceTarget, target;
+	for(int i = 0; i < 10; i++)
+	{
+		reference->Read(5000, referenceTarget);
+		modified->Read(5000, target);
+	}
+	VERIFY_EQUAL_NONCONT(referenceTarget.data == target.data, true);
+	VERIFY_EQUAL(modified->GetSample(1).samplev() == unmodified->GetSample(1).samplev(), false);
+	VERIFY_EQUAL(std::equal(sampleData8.begin(), sampleData8.end(), unmodified->GetSample(1).sample8()), true);
+	VERIFY_EQUAL(std::equal(sampleData8.begin(), sampleData8.end(), reference->GetSample(1).sample8()), false);
+}
+
+
+static MPT_NOINLINE void TestFormatIndex()
+{
+	// Skipping formats based on their magic bytes must not change the outcome of probing
+	const auto VerifyProbe = [](const std::vector<mpt::byte> &data, std::size_t size)
+	{
+		const mpt::span<const mpt::byte> span(data.data(), size);
+		const uint64 fileSize = data.size(), truncatedFileSize = size;
+		VERIFY_EQUAL_QUIET_NONCONT(static_cast<int>(CSoundFile::Probe(CSoundFile::ProbeModules, span, nullptr, true)), static_cast<int>(CSoundFile::Probe(CSoundFile::ProbeModules, span, nullptr, false)));
+		VERIFY_EQUAL_QUIET_NONCONT(static_cast<int>(CSoundFile::Probe(CSoundFile::ProbeModules, span, &fileSize, true)), static_cast<int>(CSoundFile::Probe(CSoundFile::ProbeModules, span, &fileSize, false)));
+		VERIFY_EQUAL_QUIET_NONCONT(static_cast<int>(CSoundFile::Probe(CSoundFile::ProbeModules, span, &truncatedFileSize, true)), static_cast<int>(CSoundFile::Probe(CSoundFile::ProbeModules, span, &truncatedFileSize, false)));
+	};
+
+	if(ShouldRunTests())
+	{
+		for(const auto &extension : { P_("mptm"), P_("xm"), P_("s3m") })
+		{
+			mpt::ifstream stream(GetTestFilenameBase() + extension, std::ios::binary);
+			FileReader file = make_FileReader(&stream);
+			const std::vector<mpt::byte> data = file.ReadRawDataAsByteVector();
+			for(std::size_t size = 0; size <= std::min(data.size(), std::size_t(CSoundFile::ProbeRecommendedSize)); size++)
+			{
+				VerifyProbe(data, size);
+			}
+#ifndef MODPLUG_TRACKER
+			VERIFY_EQUAL(static_cast<int>(CSoundFile::Probe(CSoundFile::ProbeModules, mpt::as_span(data), nullptr)), static_cast<int>(CSoundFile::ProbeSuccess));
+#endif
+		}
+	}
+
+	// Random data with some real magic bytes sprinkled in, including partial matches
+	static const char * const magicBytes[] = { "Extended Module: ", "IMPM", "tpm.", "MMD0", "MTM", "DMDL", "DBM0", "FAR\xFE", "Extreme", "AMShdr\x1A", "OKTASONG", "MAS_UTrack_V001", "DDMF", "RIFF", "DSMF", "ASYLUM Music Format V1.0", "AMF", "PSM ", "PSM\xFE", "MT20", "pti.", "GDM\xFE", "DIGI Booster module", "D.T.", "PLM\x1A", "MUSE", "FORM", "STP3", "if", "JN", "MO3", "EX" };
+	std::vector<mpt::byte> data(1600);
+	for(int i = 0; i < 2000; i++)
+	{
+		for(auto &b : data)
+		{
+			b = mpt::byte_cast<mpt::byte>(static_cast<uint8>(mpt::random<uint8>(*s_PRNG) & 0x7F));
+		}
+		const char *magic = magicBytes[mpt::random<uint32>(*s_PRNG) % CountOf(magicBytes)];
+		std::memcpy(data.data(), magic, std::strlen(magic));
+		if(i & 1)
+			std::memcpy(data.data() + 44, (i & 2) ? "SCRM" : "PTMF", 4);
+		if(i & 4)
+			std::memcpy(data.data() + 60, "IM10", 4);
+		if(i & 8)
+			std::memcpy(data.data() + 1464, (i & 16) ? "MTN\0" : "IT10", 4);
+		VerifyProbe(data, mpt::random<uint32>(*s_PRNG) % (data.size() + 1));
+	}
+}
+
+static MPT_NOINLINE void TestMetadataLoading()
+{
+	// Loading only the metadata must yield the same names and song message as loading the complete module, without any sample or pattern data
+	if(!ShouldRunTests())
+		return;
+	for(const auto &extension : { P_("mptm"), P_("xm"), P_("s3m") })
+	{
+		mpt::ifstream stream(GetTestFilenameBase() + extension, std::ios::binary);
+		FileReader file = make_FileReader(&stream);
+		std::unique_ptr<CSoundFile> complete = std::make_unique<CSoundFile>(), metadata = std::make_unique<CSoundFile>(), withPatterns = std::make_unique<CSoundFile>();
+		VERIFY_EQUAL_NONCONT(complete->Create(file, CSoundFile::loadCompleteModule), true);
+		VERIFY_EQUAL_NONCONT(metadata->Create(file, CSoundFile::onlyMetadata), true);
+		VERIFY_EQUAL_NONCONT(withPatterns->Create(file, static_cast<CSoundFile::ModLoadingFlags>(CSoundFile::onlyMetadata | CSoundFile::loadPatternData)), true);
+
+		VERIFY_EQUAL(metadata->GetType(), complete->GetType());
+		VERIFY_EQUAL(metadata->GetTitle(), complete->GetTitle());
+		VERIFY_EQUAL(metadata->m_songArtist, complete->m_songArtist);
+		VERIFY_EQUAL(metadata->m_songMessage.GetFormatted(SongMessage::leLF), complete->m_songMessage.GetFormatted(SongMessage::leLF));
+		VERIFY_EQUAL(metadata->GetNumChannels(), complete->GetNumChannels());
+		VERIFY_EQUAL(metadata->GetNumSamples(), complete->GetNumSamples());
+		VERIFY_EQUAL(metadata->GetNumInstruments(), complete->GetNumInstruments());
+		for(SAMPLEINDEX smp = 1; smp <= complete->GetNumSamples(); smp++)
+		{
+			VERIFY_EQUAL(std::string(metadata->GetSampleName(smp)), std::string(complete->GetSampleName(smp)));
+			// OPL instruments always have a tiny dummy sample
+			VERIFY_EQUAL(metadata->GetSample(smp).HasSampleData(), metadata->GetSample(smp).uFlags[CHN_ADLIB]);
+		}
+		for(INSTRUMENTINDEX ins = 1; ins <= complete->GetNumInstruments(); ins++)
+		{
+			VERIFY_EQUAL(std::string(metadata->GetInstrumentName(ins)), std::string(complete->GetInstrumentName(ins)));
+		}
+		VERIFY_EQUAL(metadata->Patterns.GetNumPatterns(), 0);
+
+		// Pattern data is sufficient for determining the song length
+		VERIFY_EQUAL(withPatterns->GetLength(eNoAdjust).back().duration, complete->GetLength(eNoAdjust).back().duration);
+	}
+}
+
+static MPT_NOINLINE void TestMO3SampleDecoding()
+{
+	// Compressed MO3 samples must not depend on the number of threads they are decoded with.
+	// The music data of the test file is stored as literals only, and the compressed sample data is just random data.
+	const uint16 sampleFlags[] = { 0x2000, 0x2001, 0x4000, 0x4001, 0x2400, 0x4401 };	// Delta / delta prediction, 8 / 16 bit, mono / stereo
+	const SAMPLEINDEX numSamples = 2 * CountOf(sampleFlags) + 2;
+	std::vector<std::vector<uint8>> compressedData;
+
+	mpt::ostringstream music(std::ios::binary);
+	mpt::IO::WriteRaw(music, "\0\0", 2);	// Song name and message
+	mpt::IO::WriteIntLE<uint8>(music, 1);	// Channels
+	mpt::IO::WriteIntLE<uint16>(music, 1);	// Orders
+	mpt::IO::WriteIntLE<uint16>(music, 0);	// Restart position
+	mpt::IO::WriteIntLE<uint16>(music, 0);	// Patterns
+	mpt::IO::WriteIntLE<uint16>(music, 0);	// Tracks
+	mpt::IO::WriteIntLE<uint16>(music, 0);	// Instruments
+	mpt::IO::WriteIntLE<uint16>(music, numSamples);
+	mpt::IO::WriteIntLE<uint8>(music, 6);	// Speed
+	mpt::IO::WriteIntLE<uint8>(music, 125);	// Tempo
+	mpt::IO::WriteIntLE<uint32>(music, 0x20100);	// IT
+	for(int i = 0; i < 3 + 64 + 64; i++)
+		mpt::IO::WriteIntLE<uint8>(music, 64);	// Global volume, panning separation, sample volume, channel volume and panning
+	for(int i = 0; i < 16 + 256; i++)
+		mpt::IO::WriteIntLE<uint8>(music, 0);	// MIDI macros
+	mpt::IO::WriteIntLE<uint8>(music, 0xFF);	// Order list
+	for(SAMPLEINDEX smp = 1; smp <= numSamples; smp++)
+	{
+		int32 compressedSize;
+		uint16 flags = 0;
+		if(smp <= 2 * CountOf(sampleFlags))
+		{
+			flags = sampleFlags[(smp - 1) % CountOf(sampleFlags)];
+			compressedData.emplace_back(mpt::random<uint16>(*s_PRNG) % 4000u + 1000u);
+			for(auto &b : compressedData.back())
+				b = mpt::random<uint8>(*s_PRNG);
+			compressedSize = static_cast<int32>(compressedData.back().size());
+		} else
+		{
+			// Duplicates of a compressed sample and of a duplicate
+			compressedSize = -2;
+		}
+		mpt::IO::WriteRaw(music, "\0\0", 2);	// Name and filename
+		mpt::IO::WriteIntLE<int32>(music, 8363);
+		mpt::IO::WriteIntLE<uint8>(music, 0);
+		mpt::IO::WriteIntLE<uint8>(music, 64);
+		mpt::IO::WriteIntLE<uint16>(music, 0xFFFF);
+		mpt::IO::WriteIntLE<uint32>(music, 20000);	// Length
+		mpt::IO::WriteIntLE<uint32>(music, 0);
+		mpt::IO::WriteIntLE<uint32>(music, 0);
+		mpt::IO::WriteIntLE<uint16>(music, flags);
+		mpt::IO::WriteIntLE<uint32>(music, 0);
+		mpt::IO::WriteIntLE<uint8>(music, 64);
+		mpt::IO::WriteIntLE<uint32>(music, 0);
+		mpt::IO::WriteIntLE<uint32>(music, 0);
+		mpt::IO::WriteIntLE<int32>(music, compressedSize);
+		mpt::IO::WriteIntLE<uint16>(music, 0);
+	}
+
+	// Every control byte is followed by up to eight literals
+	const std::string musicData = music.str();
+	std::string packedMusic(1, musicData[0]);
+	for(std::size_t i = 1; i < musicData.size(); i += 8)
+	{
+		packedMusic += '\0';
+		packedMusic += musicData.substr(i, 8);
+	}
+	mpt::ostringstream mo3(std::ios::binary);
+	mpt::IO::WriteRaw(mo3, "MO3\x05", 4);
+	mpt::IO::WriteIntLE<uint32>(mo3, static_cast<uint32>(musicData.size()));
+	mpt::IO::WriteIntLE<uint32>(mo3, static_cast<uint32>(packedMusic.size()));
+	mpt::IO::WriteRaw(mo3, packedMusic.data(), packedMusic.size());
+	for(const auto &data : compressedData)
+		mpt::IO::WriteRaw(mo3, data.data(), data.size());
+	const std::string mo3Data = mo3.str();
+
+	std::unique_ptr<CSoundFile> serial = std::make_unique<CSoundFile>(), parallel = std::make_unique<CSoundFile>();
+	parallel->SetSampleDecodeThreads(4);
+	FileReader file(mpt::as_span(mo3Data));
+	VERIFY_EQUAL_NONCONT(serial->Create(file, CSoundFile::loadCompleteModule), true);
+	VERIFY_EQUAL_NONCONT(parallel->Create(file, CSoundFile::loadCompleteModule), true);
+	VERIFY_EQUAL_NONCONT(serial->GetNumSamples(), numSamples);
+	VERIFY_EQUAL_NONCONT(parallel->GetNumSamples(), numSamples);
+	for(SAMPLEINDEX smp = 1; smp <= std::min(serial->GetNumSamples(), parallel->GetNumSamples()); smp++)
+	{
+		const ModSample &serialSample = serial->GetSample(smp), &parallelSample = parallel->GetSample(smp);
+		VERIFY_EQUAL_NONCONT(serialSample.HasSampleData(), true);
+		VERIFY_EQUAL_NONCONT(parallelSample.HasSampleData(), true);
+		VERIFY_EQUAL(parallelSample.nLength, serialSample.nLength);
+		VERIFY_EQUAL(parallelSample.GetBytesPerSample(), serialSample.GetBytesPerSample());
+		if(serialSample.HasSampleData() && parallelSample.HasSampleData() && parallelSample.nLength == serialSample.nLength && parallelSample.GetBytesPerSample() == serialSample.GetBytesPerSample())
+			VERIFY_EQUAL(memcmp(parallelSample.sampleb(), serialSample.sampleb(), serialSample.GetSampleSizeInBytes()), 0);
+	}
+	// Duplicates are copied from the decoded sample
+	const ModSample &original = serial->GetSample(numSamples - 2), &duplicate = serial->GetSample(numSamples);
+	VERIFY_EQUAL_NONCONT(duplicate.nLength, original.nLength);
+	if(duplicate.HasSampleData() && original.HasSampleData() && duplicate.nLength == original.nLength)
+		VERIFY_EQUAL(memcmp(duplicate.sampleb(), original.sampleb(), original.GetSampleSizeInBytes()), 0);
+}
+
+static MPT_NOINLINE void TestLazySampleDecoding()
+{
+	// IT-compressed samples whose decoding is postponed must be decoded to the same data as when decoding them while loading.
+	const uint8 sampleFlags[] = { 0, ITSample::sample16Bit, ITSample::sampleStereo, ITSample::sample16Bit | ITSample::sampleStereo };
+	const SAMPLEINDEX numSamples = CountOf(sampleFlags);
+	std::vector<std::vector<int8>> sampleData;
+	std::vector<std::string> compressedData;
+	for(uint8 flags : sampleFlags)
+	{
+		ModSample smp;
+		smp.uFlags.set(CHN_16BIT, (flags & ITSample::sample16Bit) != 0);
+		smp.uFlags.set(CHN_STEREO, (flags & ITSample::sampleStereo) != 0);
+		smp.nLength = 20000;
+		sampleData.emplace_back(smp.GetSampleSizeInBytes());
+		for(std::size_t i = 0; i < sampleData.back().size(); i++)
+			sampleData.back()[i] = static_cast<int8>(std::sin(i * 0.01) * 100 + mpt::random<int8>(*s_PRNG) / 8);
+		smp.pData.pSample = sampleData.back().data();
+		mpt::ostringstream f(std::ios::binary);
+		ITCompression compression(smp, (flags & ITSample::sample16Bit) != 0, &f);
+		compressedData.push_back(f.str());
+	}
+
+	ITFileHeader fileHeader;
+	MemsetZero(fileHeader);
+	memcpy(fileHeader.id, "IMPM", 4);
+	fileHeader.ordnum = 1;
+	fileHeader.smpnum = numSamples;
+	fileHeader.cwtv = 0x0214;
+	fileHeader.cmwt = 0x0214;
+	fileHeader.flags = ITFileHeader::useStereoPlayback;
+	fileHeader.globalvol = 128;
+	fileHeader.mv = 48;
+	fileHeader.speed = 6;
+	fileHeader.tempo = 125;
+	fileHeader.sep = 128;
+	std::fill(std::begin(fileHeader.chnpan), std::end(fileHeader.chnpan), uint8(32));
+	std::fill(std::begin(fileHeader.chnvol), std::end(fileHeader.chnvol), uint8(64));
+
+	mpt::ostringstream f(std::ios::binary);
+	mpt::IO::Write(f, fileHeader);
+	mpt::IO::WriteIntLE<uint8>(f, 0xFF);	// Order list
+	uint32 offset = static_cast<uint32>(sizeof(ITFileHeader) + 1 + 4 * numSamples);
+	for(SAMPLEINDEX smp = 0; smp < numSamples; smp++)
+		mpt::IO::WriteIntLE<uint32>(f, offset + smp * sizeof(ITSample));
+	offset += numSamples * sizeof(ITSample);
+	for(SAMPLEINDEX smp = 0; smp < numSamples; smp++)
+	{
+		ITSample sampleHeader;
+		MemsetZero(sampleHeader);
+		memcpy(sampleHeader.id, "IMPS", 4);
+		sampleHeader.gvl = 64;
+		sampleHeader.vol = 64;
+		sampleHeader.flags = ITSample::sampleDataPresent | ITSample::sampleCompressed | sampleFlags[smp];
+		// Use IT 2.15 compression for the 16-bit samples
+		sampleHeader.cvt = ITSample::cvtSignedSample | ((sampleFlags[smp] & ITSample::sample16Bit) ? ITSample::cvtDelta : 0);
+		sampleHeader.dfp = 32;
+		sampleHeader.length = 20000;
+		sampleHeader.C5Speed = 8363;
+		sampleHeader.samplepointer = offset;
+		offset += static_cast<uint32>(compressedData[smp].size());
+		mpt::IO::Write(f, sampleHeader);
+	}
+	for(const auto &data : compressedData)
+		mpt::IO::WriteRaw(f, data.data(), data.size());
+
+	std::unique_ptr<CSoundFile> eager = std::make_unique<CSoundFile>(), lazy = std::make_unique<CSoundFile>(), background = std::make_unique<CSoundFile>();
+	lazy->SetLazySampleDecoding(true);
+	background->SetLazySampleDecoding(true);
+	{
+		// The module data does not need to outlive loading
+		const std::string fileData = f.str();
+		VERIFY_EQUAL_NONCONT(eager->Create(FileReader(mpt::as_span(fileData)), CSoundFile::loadCompleteModule), true);
+		VERIFY_EQUAL_NONCONT(lazy->Create(FileReader(mpt::as_span(fileData)), CSoundFile::loadCompleteModule), true);
+		VERIFY_EQUAL_NONCONT(background->Create(FileReader(mpt::as_span(fileData)), CSoundFile::loadCompleteModule), true);
+	}
+	VERIFY_EQUAL_NONCONT(eager->GetNumSamples(), numSamples);
+	VERIFY_EQUAL_NONCONT(lazy->GetNumSamples(), numSamples);
+	VERIFY_EQUAL_NONCONT(background->GetNumSamples(), numSamples);
+	VERIFY_EQUAL(eager->HasPendingSamples(), false);
+	VERIFY_EQUAL(lazy->HasPendingSamples(), true);
+	// Samples that are still queued, being decoded or already decoded by the background thread must all end up the same.
+	background->DecodePendingSamplesInBackground();
+	for(SAMPLEINDEX smp = 1; smp <= std::min(eager->GetNumSamples(), lazy->GetNumSamples()); smp++)
+	{
+		const ModSample &eagerSample = eager->GetSample(smp), &lazySample = lazy->GetSample(smp);
+		VERIFY_EQUAL_NONCONT(eagerSample.HasSampleData(), true);
+		VERIFY_EQUAL_NONCONT(lazySample.HasSampleData(), true);
+		VERIFY_EQUAL(lazySample.nLength, eagerSample.nLength);
+		VERIFY_EQUAL(lazySample.GetBytesPerSample(), eagerSample.GetBytesPerSample());
+		if(!eagerSample.HasSampleData() || !lazySample.HasSampleData() || lazySample.GetSampleSizeInBytes() != eagerSample.GetSampleSizeInBytes())
+			continue;
+		VERIFY_EQUAL(memcmp(eagerSample.sampleb(), sampleData[smp - 1].data(), eagerSample.GetSampleSizeInBytes()), 0);
+		// Silent until the sample is needed
+		VERIFY_EQUAL(std::count(lazySample.sampleb(), lazySample.sampleb() + lazySample.GetSampleSizeInBytes(), mpt::byte(0)), static_cast<std::ptrdiff_t>(lazySample.GetSampleSizeInBytes()));
+		const void *sampleMemory = lazySample.samplev();
+		lazy->DecodePendingSample(smp);
+		VERIFY_EQUAL(lazySample.samplev() == sampleMemory, true);
+		VERIFY_EQUAL(memcmp(lazySample.sampleb(), eagerSample.sampleb(), eagerSample.GetSampleSizeInBytes()), 0);
+
+		const ModSample &backgroundSample = background->GetSample(smp);
+		VERIFY_EQUAL_NONCONT(backgroundSample.GetSampleSizeInBytes(), eagerSample.GetSampleSizeInBytes());
+		if(!backgroundSample.HasSampleData() || backgroundSample.GetSampleSizeInBytes() != eagerSample.GetSampleSizeInBytes())
+			continue;
+		sampleMemory = backgroundSample.samplev();
+		background->DecodePendingSample(smp);
+		VERIFY_EQUAL(backgroundSample.samplev() == sampleMemory, true);
+		VERIFY_EQUAL(memcmp(backgroundSample.sampleb(), eagerSample.sampleb(), eagerSample.GetSampleSizeInBytes()), 0);
+	}
+	VERIFY_EQUAL(lazy->HasPendingSamples(), false);
+	VERIFY_EQUAL(background->HasPendingSamples(), false);
+}
+
+static MPT_NOINLINE void TestIntegerOutput()
+{
+#ifdef LIBOPENMPT_BUILD
+	// 32-bit and 24-bit output must be converted from the same mix buffer as 16-bit and floating point output
+	const std::vector<int16> sampleData = CreateMixTestSampleData();
+
+	const std::size_t frames = 15000, channels = 2;
+	std::vector<int16> out16(frames * channels);
+	std::vector<int24> out24(frames * channels), out24Left(frames), out24Right(frames);
+	std::vector<int32> out32(frames * channels);
+	std::vector<float> outFloat(frames * channels);
+
+	const auto render = [&](auto *interleaved, auto *left, auto *right)
+	{
+		typedef typename std::remove_pointer<decltype(interleaved)>::type Tsample;
+		CSoundFile sndFile;
+		MixerSettings mixerSettings;
+		mixerSettings.gnChannels = channels;
+		sndFile.SetMixerSettings(mixerSettings);
+		CreateMixTestModule(sndFile, sampleData);
+		Dither dither(*s_PRNG);
+		dither.SetMode(DitherNone);
+		std::size_t offset = 0;
+		while(offset < frames)
+		{
+			Tsample * const buffers[4] = { left ? left + offset : nullptr, right ? right + offset : nullptr, nullptr, nullptr };
+			AudioReadTargetGainBuffer<Tsample> target(dither, interleaved ? interleaved + offset * channels : nullptr, left ? buffers : nullptr, 1.0f);
+			const std::size_t count = sndFile.Read(static_cast<CSoundFile::samplecount_t>(std::min(frames - offset, std::size_t(5000))), target);
+			VERIFY_EQUAL_NONCONT(count > 0, true);
+			if(count == 0)
+				break;
+			offset += count;
+		}
+	};
+	render(out16.data(), static_cast<int16 *>(nullptr), static_cast<int16 *>(nullptr));
+	render(out24.data(), static_cast<int24 *>(nullptr), static_cast<int24 *>(nullptr));
+	render(static_cast<int24 *>(nullptr), out24Left.data(), out24Right.data());
+	render(out32.data(), static_cast<int32 *>(nullptr), static_cast<int32 *>(nullptr));
+	render(outFloat.data(), static_cast<float *>(nullptr), static_cast<float *>(nullptr));
+
+	bool nonSilent = false, equal16 = true, equal24 = true, equal24Planar = true, equalFloat = true;
+	for(std::size_t i = 0; i < frames * channels; i++)
+	{
+		// 32-bit output is the mix buffer shifted to full scale
+		const int32 mix = out32[i] >> (31 - MIXING_FRACTIONAL_BITS);
+		if(mix != 0)
+			nonSilent = true;
+		if(out16[i] != Clamp((mix + (1 << (MIXING_FRACTIONAL_BITS - 16))) >> (MIXING_FRACTIONAL_BITS + 1 - 16), int16_min, int16_max))
+			equal16 = false;
+		if(static_cast<int>(out24[i]) != Clamp((mix + (1 << (MIXING_FRACTIONAL_BITS - 24))) >> (MIXING_FRACTIONAL_BITS + 1 - 24), int24_min, int24_max))
+			equal24 = false;
+		if(static_cast<int>(out24[i]) != static_cast<int>((i % channels) ? out24Right[i / channels] : out24Left[i / channels]))
+			equal24Planar = false;
+		// Floating point output is not clipped
+		const bool clipped = (mix <= -((1 << MIXING_FRACTIONAL_BITS) - 1) || mix >= (1 << MIXING_FRACTIONAL_BITS) - 1);
+		if(!clipped && outFloat[i] != static_cast<float>(mix) * (1.0f / static_cast<float>(1 << MIXING_FRACTIONAL_BITS)))
+			equalFloat = false;
+	}
+	VERIFY_EQUAL(nonSilent, true);
+	VERIFY_EQUAL(equal16, true);
+	VERIFY_EQUAL(equal24, true);
+	VERIFY_EQUAL(equal24Planar, true);
+	VERIFY_EQUAL(equalFloat, true);
+#endif // LIBOPENMPT_BUILD
+}
+
+
+static MPT_NOINLINE void TestLibopenmptFileLoading()
+{
+#if defined(LIBOPENMPT_BUILD) && MPT_TEST_HAS_FILESYSTEM
+	if(!ShouldRunTests())
+	{
+		return;
+	}
+
+	// Modules loaded by file name or from a file descriptor must be complete, and failures must be reported as errors
+	const mpt::PathString filename = GetTestFilenameBase() + P_("s3m");
+	const auto verifyModule = [](openmpt_module *mod, int error)
+	{
+		VERIFY_EQUAL_NONCONT(mod != nullptr, true);
+		VERIFY_EQUAL_NONCONT(error, OPENMPT_ERROR_OK);
+		if(!mod)
+			return;
+		const char *title = openmpt_module_get_metadata(mod, "title");
+		VERIFY_EQUAL_NONCONT(std::string(title ? title : ""), "S3M_Test__________________X");
+		openmpt_free_string(title);
+		VERIFY_EQUAL_NONCONT(openmpt_module_get_num_channels(mod), 4);
+		VERIFY_EQUAL_NONCONT(openmpt_module_get_num_samples(mod), 4);
+		openmpt_module_destroy(mod);
+	};
+
+	int error = OPENMPT_ERROR_OK;
+	openmpt_module *mod = openmpt_module_create_from_filename(filename.ToUTF8().c_str(), openmpt_log_func_silent, nullptr, nullptr, nullptr, &error, nullptr, nullptr);
+	verifyModule(mod, error);
+
+	error = OPENMPT_ERROR_OK;
+	mod = openmpt_module_create_from_filename((filename + P_(".missing")).ToUTF8().c_str(), openmpt_log_func_silent, nullptr, nullptr, nullptr, &error, nullptr, nullptr);
+	VERIFY_EQUAL(mod == nullptr, true);
+	VERIFY_EQUAL(error != OPENMPT_ERROR_OK, true);
+	if(mod)
+		openmpt_module_destroy(mod);
+
+#if defined(MPT_FILEREADER_MMAP)
+	int fd = open(filename.AsNative().c_str(), O_RDONLY);
+	VERIFY_EQUAL(fd >= 0, true);
+	error = OPENMPT_ERROR_OK;
+	mod = openmpt_module_create_from_fd(fd, openmpt_log_func_silent, nullptr, nullptr, nullptr, &error, nullptr, nullptr);
+	close(fd);
+	verifyModule(mod, error);
+
+	error = OPENMPT_ERROR_OK;
+	mod = openmpt_module_create_from_fd(-1, openmpt_log_func_silent, nullptr, nullptr, nullptr, &error, nullptr, nullptr);
+	VERIFY_EQUAL(mod == nullptr, true);
+	VERIFY_EQUAL(error != OPENMPT_ERROR_OK, true);
+	if(mod)
+		openmpt_module_destroy(mod);
+#endif // MPT_FILEREADER_MMAP
+#endif // LIBOPENMPT_BUILD && MPT_TEST_HAS_FILESYSTEM
+}
+
+
+static MPT_NOINLINE void TestLibopenmptSubsongsCache()
+{
+#if defined(LIBOPENMPT_BUILD) && MPT_TEST_HAS_FILESYSTEM
+	if(!ShouldRunTests())
+	{
+		return;
+	}
+
+	const std::string filename = (GetTestFilenameBase() + P_("mptm")).ToUTF8();
+	std::ostringstream log;
+	typedef std::vector<std::tuple<double, std::int32_t, std::int32_t>> SubsongInfo;
+	const auto getSubsongs = [](openmpt::module &mod)
+	{
+		SubsongInfo subsongs;
+		for(std::int32_t i = 0; i < mod.get_num_subsongs(); i++)
+		{
+			mod.select_subsong(i);
+			subsongs.emplace_back(mod.get_duration_seconds(), mod.get_current_order(), mod.get_current_row());
+		}
+		return subsongs;
+	};
+	const auto loadWithCache = [&](const std::string &cache, bool skipPlugins = false)
+	{
+		std::map<std::string, std::string> ctls;
+		ctls["load.subsongs_cache"] = cache;
+		if(skipPlugins)
+			ctls["load.skip_plugins"] = "1";
+		return std::make_unique<openmpt::module>(filename, log, ctls);
+	};
+
+	openmpt::module scanned(filename, log);
+	const SubsongInfo expected = getSubsongs(scanned);
+	VERIFY_EQUAL(scanned.ctl_get("load.subsongs_cache"), "");
+
+	// A cache saved by one instance restores identical sub-songs in another one
+	const std::string cache = loadWithCache("")->ctl_get("load.subsongs_cache");
+	VERIFY_EQUAL(cache.empty(), false);
+	VERIFY_EQUAL(cache.length() % 2u, 0u);
+	{
+		auto cached = loadWithCache(cache);
+		VERIFY_EQUAL(getSubsongs(*cached) == expected, true);
+		VERIFY_EQUAL(cached->ctl_get("load.subsongs_cache"), cache);
+	}
+
+	// Use a cache with a different duration for the last sub-song, so that it can be told whether the cache was used.
+	// The last 20 bytes of the cache are the last sub-song, starting with its duration as a little-endian double.
+	std::string tampered = cache;
+	{
+		const IEEE754binary64LE durationLE(1234.5);
+		mpt::byte durationBytes[8];
+		for(std::size_t i = 0; i < 8; i++)
+		{
+			durationBytes[i] = durationLE.GetByte(i);
+		}
+		const mpt::ustring duration = Util::BinToHex(mpt::as_span(durationBytes));
+		tampered.replace(tampered.length() - 40, 16, mpt::ToCharset(mpt::CharsetUTF8, duration));
+		auto cached = loadWithCache(tampered);
+		cached->select_subsong(cached->get_num_subsongs() - 1);
+		VERIFY_EQUAL(cached->get_duration_seconds(), 1234.5);
+	}
+
+	// Caches that do not belong to the module as it is loaded, or that are malformed, must be ignored
+	std::vector<std::string> invalidCaches;
+	std::string wrongKey = tampered;
+	wrongKey[20] = (wrongKey[20] == '0') ? '1' : '0';
+	invalidCaches.push_back(wrongKey);
+	invalidCaches.push_back(tampered.substr(0, tampered.length() - 2));
+	invalidCaches.push_back(tampered.substr(0, tampered.length() - 1));
+	invalidCaches.push_back(tampered + "0");
+	invalidCaches.push_back(tampered + "zz");
+	std::string nonHex = tampered;
+	nonHex[nonHex.length() - 30] = 'g';
+	invalidCaches.push_back(nonHex);
+	invalidCaches.push_back("zz" + tampered.substr(2));
+	for(const auto &invalid : invalidCaches)
+	{
+		auto cached = loadWithCache(invalid);
+		VERIFY_EQUAL_NONCONT(getSubsongs(*cached) == expected, true);
+		VERIFY_EQUAL_NONCONT(cached->ctl_get("load.subsongs_cache"), cache);
+	}
+	{
+		// Different load flags
+		auto cached = loadWithCache(tampered, true);
+		VERIFY_EQUAL(getSubsongs(*cached) == expected, true);
+		VERIFY_EQUAL(cached->ctl_get("load.subsongs_cache") != cache, true);
+	}
+#endif // LIBOPENMPT_BUILD && MPT_TEST_HAS_FILESYSTEM
+}
+
+
+static MPT_NOINLINE void TestLibopenmptProgressiveLoading()
+{
+#if defined(LIBOPENMPT_BUILD) && MPT_TEST_HAS_FILESYSTEM
+	if(!ShouldRunTests())
+	{
+		return;
+	}
+
+	// Modules that are loaded progressively must render the same audio and report the same sub-songs as modules that are loaded completely
+	std::ostringstream log;
+	std::map<std::string, std::string> ctls;
+	ctls["load.progressive"] = "1";
+	bool nonSilent = false;
+	for(const auto &extension : { P_("mptm"), P_("xm"), P_("s3m") })
+	{
+		const std::string filename = (GetTestFilenameBase() + extension).ToUTF8();
+		openmpt::module complete(filename, log);
+		openmpt::module progressive(filename, log, ctls);
+		VERIFY_EQUAL_NONCONT(progressive.ctl_get("load.progressive"), "1");
+		VERIFY_EQUAL_NONCONT(complete.ctl_get("load.progressive"), "0");
+
+		// Render before asking for any sub-song information, so that the sub-song scan may still be running in the background
+		std::vector<float> completeAudio(2 * 1024), progressiveAudio(2 * 1024);
+		bool sameAudio = true;
+		for(int block = 0; block < 8; block++)
+		{
+			const std::size_t completeCount = complete.read_interleaved_stereo(48000, 1024, completeAudio.data());
+			const std::size_t progressiveCount = progressive.read_interleaved_stereo(48000, 1024, progressiveAudio.data());
+			if(completeCount != progressiveCount || completeAudio != progressiveAudio)
+				sameAudio = false;
+			if(std::any_of(completeAudio.begin(), completeAudio.end(), [](float v) { return v != 0.0f; }))
+				nonSilent = true;
+		}
+		VERIFY_EQUAL_NONCONT(sameAudio, true);
+		VERIFY_EQUAL_NONCONT(progressive.get_position_seconds(), complete.get_position_seconds());
+
+		VERIFY_EQUAL_NONCONT(progressive.get_num_subsongs(), complete.get_num_subsongs());
+		VERIFY_EQUAL_NONCONT(progressive.get_subsong_names() == complete.get_subsong_names(), true);
+		for(std::int32_t i = 0; i < std::min(complete.get_num_subsongs(), progressive.get_num_subsongs()); i++)
+		{
+			complete.select_subsong(i);
+			progressive.select_subsong(i);
+			VERIFY_EQUAL_NONCONT(progressive.get_duration_seconds(), complete.get_duration_seconds());
+			VERIFY_EQUAL_NONCONT(progressive.get_current_order(), complete.get_current_order());
+			VERIFY_EQUAL_NONCONT(progressive.get_current_row(), complete.get_current_row());
+		}
+	}
+	VERIFY_EQUAL(nonSilent, true);
+
+	// Destroying a module while the sub-song scan and sample decoding may still be running in the background must be safe
+	const std::string filename = (GetTestFilenameBase() + P_("mptm")).ToUTF8();
+	for(int i = 0; i < 20; i++)
+	{
+		openmpt::module mod(filename, log, ctls);
+		if(i % 2)
+		{
+			std::vector<float> audio(2 * 256);
+			mod.read_interleaved_stereo(48000, 256, audio.data());
+		}
+	}
+#endif // LIBOPENMPT_BUILD && MPT_TEST_HAS_FILESYSTEM
+}
+
+
+#if defined(LIBOPENMPT_BUILD) && MPT_TEST_HAS_FILESYSTEM
+// Render the beginning of a module in several calls of read(count, interleaved, planar), which writes to either the interleaved or the planar buffers.
+// The result is always interleaved.
+template <typename T, typename Tread>
+static std::vector<T> RenderLibopenmptOutput(std::size_t channels, bool interleaved, Tread read)
+{
+	const std::size_t frames = 8192;
+	std::vector<T> output(frames * channels), planar[4];
+	for(auto &buffer : planar)
+	{
+		buffer.resize(frames);
+	}
+	std::size_t offset = 0;
+	while(offset < frames)
+	{
+		T * const buffers[4] = { planar[0].data() + offset, planar[1].data() + offset, planar[2].data() + offset, planar[3].data() + offset };
+		const std::size_t count = read(std::min(frames - offset, std::size_t(1000)), output.data() + offset * channels, buffers);
+		VERIFY_EQUAL_NONCONT(count > 0, true);
+		if(count == 0)
+			break;
+		offset += count;
+	}
+	if(!interleaved)
+	{
+		for(std::size_t i = 0; i < frames * channels; i++)
+		{
+			output[i] = planar[i % channels][i / channels];
+		}
+	}
+	return output;
+}
+#endif // LIBOPENMPT_BUILD && MPT_TEST_HAS_FILESYSTEM
+
+
+static MPT_NOINLINE void TestLibopenmptIntegerOutput()
+{
+#if defined(LIBOPENMPT_BUILD) && MPT_TEST_HAS_FILESYSTEM
+	if(!ShouldRunTests())
+	{
+		return;
+	}
+
+	// The public 32-bit and 24-bit output functions must render the same mix as the 16-bit and floating point functions
+	const std::string filename = (GetTestFilenameBase() + P_("s3m")).ToUTF8();
+	const std::int32_t rate = 48000;
+
+	// Every render call uses a newly loaded module without dithering
+	const auto renderC = [&filename](auto sampleType, std::size_t channels, bool interleaved, auto read)
+	{
+		openmpt_module *mod = openmpt_module_create_from_filename(filename.c_str(), openmpt_log_func_silent, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr);
+		VERIFY_EQUAL_NONCONT(mod != nullptr, true);
+		if(mod)
+			VERIFY_EQUAL_NONCONT(openmpt_module_ctl_set(mod, "dither", "0"), 1);
+		const auto output = RenderLibopenmptOutput<decltype(sampleType)>(channels, interleaved, [&](std::size_t count, decltype(sampleType) *interleavedBuffer, decltype(sampleType) *const *planar)
+		{
+			return mod ? read(mod, count, interleavedBuffer, planar) : std::size_t(0);
+		});
+		if(mod)
+			openmpt_module_destroy(mod);
+		return output;
+	};
+	const auto renderCpp = [&filename](auto sampleType, std::size_t channels, bool interleaved, auto read)
+	{
+		std::ostringstream log;
+		std::map<std::string, std::string> ctls;
+		ctls["dither"] = "0";
+		openmpt::module mod(filename, log, ctls);
+		return RenderLibopenmptOutput<decltype(sampleType)>(channels, interleaved, [&](std::size_t count, decltype(sampleType) *interleavedBuffer, decltype(sampleType) *const *planar)
+		{
+			return read(mod, count, interleavedBuffer, planar);
+		});
+	};
+	const auto bytes = [](int24 *buffer) { return reinterpret_cast<std::uint8_t *>(buffer); };
+
+	bool nonSilent = false;
+	for(std::size_t channels : { 1, 2, 4 })
+	{
+		const auto out32 = renderC(int32(), channels, false, [rate, channels](openmpt_module *mod, std::size_t count, int32 *, int32 *const *planar)
+		{
+			if(channels == 1)
+				return openmpt_module_read_int32_mono(mod, rate, count, planar[0]);
+			else if(channels == 2)
+				return openmpt_module_read_int32_stereo(mod, rate, count, planar[0], planar[1]);
+			else
+				return openmpt_module_read_int32_quad(mod, rate, count, planar[0], planar[1], planar[2], planar[3]);
+		});
+		const auto out24 = renderC(int24(), channels, false, [rate, channels, bytes](openmpt_module *mod, std::size_t count, int24 *, int24 *const *planar)
+		{
+			if(channels == 1)
+				return openmpt_module_read_int24_mono(mod, rate, count, bytes(planar[0]));
+			else if(channels == 2)
+				return openmpt_module_read_int24_stereo(mod, rate, count, bytes(planar[0]), bytes(planar[1]));
+			else
+				return openmpt_module_read_int24_quad(mod, rate, count, bytes(planar[0]), bytes(planar[1]), bytes(planar[2]), bytes(planar[3]));
+		});
+		const auto out32Cpp = renderCpp(int32(), channels, false, [rate, channels](openmpt::module &mod, std::size_t count, int32 *, int32 *const *planar)
+		{
+			if(channels == 1)
+				return mod.read(rate, count, planar[0]);
+			else if(channels == 2)
+				return mod.read(rate, count, planar[0], planar[1]);
+			else
+				return mod.read(rate, count, planar[0], planar[1], planar[2], planar[3]);
+		});
+		const auto out24Cpp = renderCpp(int24(), channels, false, [rate, channels, bytes](openmpt::module &mod, std::size_t count, int24 *, int24 *const *planar)
+		{
+			if(channels == 1)
+				return mod.read_int24(rate, count, bytes(planar[0]));
+			else if(channels == 2)
+				return mod.read_int24(rate, count, bytes(planar[0]), bytes(planar[1]));
+			else
+				return mod.read_int24(rate, count, bytes(planar[0]), bytes(planar[1]), bytes(planar[2]), bytes(planar[3]));
+		});
+		const auto out16 = renderCpp(int16(), channels, false, [rate, channels](openmpt::module &mod, std::size_t count, int16 *, int16 *const *planar)
+		{
+			if(channels == 1)
+				return mod.read(rate, count, planar[0]);
+			else if(channels == 2)
+				return mod.read(rate, count, planar[0], planar[1]);
+			else
+				return mod.read(rate, count, planar[0], planar[1], planar[2], planar[3]);
+		});
+		const auto outFloat = renderCpp(float(), channels, false, [rate, channels](openmpt::module &mod, std::size_t count, float *, float *const *planar)
+		{
+			if(channels == 1)
+				return mod.read(rate, count, planar[0]);
+			else if(channels == 2)
+				return mod.read(rate, count, planar[0], planar[1]);
+			else
+				return mod.read(rate, count, planar[0], planar[1], planar[2], planar[3]);
+		});
+
+		VERIFY_EQUAL_NONCONT(out32Cpp == out32, true);
+		VERIFY_EQUAL_NONCONT(out16.size(), out32.size());
+		VERIFY_EQUAL_NONCONT(outFloat.size(), out32.size());
+		VERIFY_EQUAL_NONCONT(out24.size(), out32.size());
+		VERIFY_EQUAL_NONCONT(out24Cpp.size(), out32.size());
+		if(out16.size() != out32.size() || outFloat.size() != out32.size() || out24.size() != out32.size() || out24Cpp.size() != out32.size())
+			continue;
+
+		if(channels > 1)
+		{
+			const auto out32Interleaved = renderC(int32(), channels, true, [rate, channels](openmpt_module *mod, std::size_t count, int32 *interleaved, int32 *const *)
+			{
+				return (channels == 2) ? openmpt_module_read_interleaved_int32_stereo(mod, rate, count, interleaved) : openmpt_module_read_interleaved_int32_quad(mod, rate, count, interleaved);
+			});
+			const auto out24Interleaved = renderC(int24(), channels, true, [rate, channels, bytes](openmpt_module *mod, std::size_t count, int24 *interleaved, int24 *const *)
+			{
+				return (channels == 2) ? openmpt_module_read_interleaved_int24_stereo(mod, rate, count, bytes(interleaved)) : openmpt_module_read_interleaved_int24_quad(mod, rate, count, bytes(interleaved));
+			});
+			const auto out32InterleavedCpp = renderCpp(int32(), channels, true, [rate, channels](openmpt::module &mod, std::size_t count, int32 *interleaved, int32 *const *)
+			{
+				return (channels == 2) ? mod.read_interleaved_stereo(rate, count, interleaved) : mod.read_interleaved_quad(rate, count, interleaved);
+			});
+			const auto out24InterleavedCpp = renderCpp(int24(), channels, true, [rate, channels, bytes](openmpt::module &mod, std::size_t count, int24 *interleaved, int24 *const *)
+			{
+				return (channels == 2) ? mod.read_interleaved_int24_stereo(rate, count, bytes(interleaved)) : mod.read_interleaved_int24_quad(rate, count, bytes(interleaved));
+			});
+			VERIFY_EQUAL_NONCONT(out32Interleaved == out32, true);
+			VERIFY_EQUAL_NONCONT(out32InterleavedCpp == out32, true);
+			VERIFY_EQUAL_NONCONT(out24Interleaved.size(), out24.size());
+			VERIFY_EQUAL_NONCONT(out24InterleavedCpp.size(), out24.size());
+			bool equal24Interleaved = true;
+			for(std::size_t i = 0; i < std::min({ out24.size(), out24Interleaved.size(), out24InterleavedCpp.size() }); i++)
+			{
+				if(static_cast<int>(out24Interleaved[i]) != static_cast<int>(out24[i]) || static_cast<int>(out24InterleavedCpp[i]) != static_cast<int>(out24[i]))
+					equal24Interleaved = false;
+			}
+			VERIFY_EQUAL_NONCONT(equal24Interleaved, true);
+		}
+
+		bool equal16 = true, equal24 = true, equalFloat = true;
+		for(std::size_t i = 0; i < out32.size(); i++)
+		{
+			// 32-bit output is the mix buffer shifted to full scale
+			const int32 mix = out32[i] >> (31 - MIXING_FRACTIONAL_BITS);
+			if(mix != 0)
+				nonSilent = true;
+			if(out16[i] != Clamp((mix + (1 << (MIXING_FRACTIONAL_BITS - 16))) >> (MIXING_FRACTIONAL_BITS + 1 - 16), int16_min, int16_max))
+				equal16 = false;
+			const int expected24 = Clamp((mix + (1 << (MIXING_FRACTIONAL_BITS - 24))) >> (MIXING_FRACTIONAL_BITS + 1 - 24), int24_min, int24_max);
+			if(static_cast<int>(out24[i]) != expected24 || static_cast<int>(out24Cpp[i]) != expected24)
+				equal24 = false;
+			// Floating point output is not clipped
+			const bool clipped = (mix <= -((1 << MIXING_FRACTIONAL_BITS) - 1) || mix >= (1 << MIXING_FRACTIONAL_BITS) - 1);
+			if(!clipped && outFloat[i] != static_cast<float>(mix) * (1.0f / static_cast<float>(1 << MIXING_FRACTIONAL_BITS)))
+				equalFloat = false;
+		}
+		VERIFY_EQUAL_NONCONT(equal16, true);
+		VERIFY_EQUAL_NONCONT(equal24, true);
+		VERIFY_EQUAL_NONCONT(equalFloat, true);
+	}
+	VERIFY_EQUAL(nonSilent, true);
+#endif // LIBOPENMPT_BUILD && MPT_TEST_HAS_FILESYSTEM
+}
+
+
+static MPT_NOINLINE void TestLibopenmptMetadata()
+{
+#if defined(LIBOPENMPT_BUILD) && MPT_TEST_HAS_FILESYSTEM
+	if(!ShouldRunTests())
+	{
+		return;
+	}
+
+	// Metadata read through the C API must match the metadata of the completely loaded module
+	for(const auto &extension : { P_("mptm"), P_("xm"), P_("s3m") })
+	{
+		mpt::ifstream stream(GetTestFilenameBase() + extension, std::ios::binary);
+		FileReader file = make_FileReader(&stream);
+		const std::vector<mpt::byte> data = file.ReadRawDataAsByteVector();
+
+		openmpt_module *mod = openmpt_module_create_from_memory2(data.data(), data.size(), openmpt_log_func_silent, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr);
+		VERIFY_EQUAL_NONCONT(mod != nullptr, true);
+		if(!mod)
+			continue;
+
+		for(uint64 flags : { uint64(OPENMPT_READ_METADATA_FLAGS_DEFAULT), uint64(OPENMPT_READ_METADATA_FLAGS_DURATION) })
+		{
+			int error = OPENMPT_ERROR_OK;
+			const char *errorMessage = nullptr;
+			openmpt_module_metadata *metadata = openmpt_read_metadata_from_memory(data.data(), data.size(), flags, openmpt_log_func_silent, nullptr, nullptr, nullptr, &error, &errorMessage);
+			VERIFY_EQUAL_NONCONT(metadata != nullptr, true);
+			VERIFY_EQUAL_NONCONT(error, OPENMPT_ERROR_OK);
+			VERIFY_EQUAL_NONCONT(errorMessage == nullptr, true);
+			openmpt_free_string(errorMessage);
+			if(!metadata)
+				continue;
+
+			const std::pair<const char *, const char *> strings[] =
+			{
+				{ "type", metadata->type },
+				{ "type_long", metadata->type_long },
+				{ "container", metadata->container },
+				{ "tracker", metadata->tracker },
+				{ "artist", metadata->artist },
+				{ "title", metadata->title },
+				{ "message_raw", metadata->message },
+			};
+			for(const auto &str : strings)
+			{
+				const char *expected = openmpt_module_get_metadata(mod, str.first);
+				VERIFY_EQUAL_NONCONT(str.second != nullptr, true);
+				VERIFY_EQUAL_NONCONT(std::string(str.second ? str.second : ""), std::string(expected ? expected : ""));
+				openmpt_free_string(expected);
+			}
+
+			VERIFY_EQUAL_NONCONT(metadata->num_channels, openmpt_module_get_num_channels(mod));
+			VERIFY_EQUAL_NONCONT(metadata->num_samples, openmpt_module_get_num_samples(mod));
+			VERIFY_EQUAL_NONCONT(metadata->num_instruments, openmpt_module_get_num_instruments(mod));
+			const auto verifyNames = [mod](const char * const *names, std::int32_t count, const char *(*getName)(openmpt_module *, std::int32_t))
+			{
+				VERIFY_EQUAL_NONCONT(names != nullptr, true);
+				if(!names)
+					return;
+				for(std::int32_t i = 0; i < count; i++)
+				{
+					const char *expected = getName(mod, i);
+					VERIFY_EQUAL_NONCONT(names[i] != nullptr, true);
+					VERIFY_EQUAL_NONCONT(std::string(names[i] ? names[i] : ""), std::string(expected ? expected : ""));
+					openmpt_free_string(expected);
+					if(!names[i])
+						return;
+				}
+				// The lists are terminated by a null pointer
+				VERIFY_EQUAL_NONCONT(names[count] == nullptr, true);
+			};
+			verifyNames(metadata->sample_names, metadata->num_samples, &openmpt_module_get_sample_name);
+			verifyNames(metadata->instrument_names, metadata->num_instruments, &openmpt_module_get_instrument_name);
+
+			if(flags & OPENMPT_READ_METADATA_FLAGS_DURATION)
+			{
+				VERIFY_EQUAL_NONCONT(metadata->duration_seconds > 0.0, true);
+				VERIFY_EQUAL_NONCONT(metadata->duration_seconds, openmpt_module_get_duration_seconds(mod));
+			} else
+			{
+				VERIFY_EQUAL_NONCONT(metadata->duration_seconds, -1.0);
+			}
+			openmpt_free_metadata(metadata);
+		}
+		openmpt_module_destroy(mod);
+	}
+
+	// Invalid data must be reported as an error, and freeing no metadata must be harmless
+	const char invalid[] = "This is not a module file";
+	int error = OPENMPT_ERROR_OK;
+	const char *errorMessage = nullptr;
+	openmpt_module_metadata *metadata = openmpt_read_metadata_from_memory(invalid, sizeof(invalid), OPENMPT_READ_METADATA_FLAGS_DURATION, openmpt_log_func_silent, nullptr, nullptr, nullptr, &error, &errorMessage);
+	VERIFY_EQUAL(metadata == nullptr, true);
+	VERIFY_EQUAL(error != OPENMPT_ERROR_OK, true);
+	VERIFY_EQUAL(errorMessage != nullptr, true);
+	openmpt_free_string(errorMessage);
+	openmpt_free_metadata(metadata);
+	openmpt_free_metadata(nullptr);
+#endif // LIBOPENMPT_BUILD && MPT_TEST_HAS_FILESYSTEM
+}
+
+
+
+#if 0
+
+static bool RatioEqual(CTuningBase::RATIOTYPE a, CTuningBase::RATIOTYPE b)
+{
+	if(a == CTuningBase::RATIOTYPE(0) && b == CTuningBase::RATIOTYPE(0))
+	{
+		return true;
+	}
+	if(a == CTuningBase::RATIOTYPE(0) || b == CTuningBase::RATIOTYPE(0))
+	{
+		return false;
+	}
+	return (std::fabs(CTuningBase::RATIOTYPE(1) - (a/b)) < CTuningBase::RATIOTYPE(0.0001));
+}
+
+
+static void CheckEqualTuningCollections(const CTuningCollection &a, const CTuningCollection &b)
+{
+	VERIFY_EQUAL(a.GetName(), b.GetName());
+	VERIFY_EQUAL(a.GetNumTunings(), b.GetNumTunings());
+	for(std::size_t tuning = 0; tuning < std::min(a.GetNumTunings(), b.GetNumTunings()); ++tuning)
+	{
+		VERIFY_EQUAL(a.GetTuning(tuning).GetName(), b.GetTuning(tuning).GetName());
+		VERIFY_EQUAL(a.GetTuning(tuning).GetType(), b.GetTuning(tuning).GetType());
+		VERIFY_EQUAL(a.GetTuning(tuning).GetGroupSize(), b.GetTuning(tuning).GetGroupSize());
+		VERIFY_EQUAL(a.GetTuning(tuning).GetFineStepCount(), b.GetTuning(tuning).GetFineStepCount());
+		VERIFY_EQUAL(RatioEqual(a.GetTuning(tuning).GetGroupRatio(), b.GetTuning(tuning).GetGroupRatio()), true);
+		VERIFY_EQUAL(a.GetTuning(tuning).GetValidityRange(), b.GetTuning(tuning).GetValidityRange());
+		for(ModCommand::NOTE note = NOTE_MIN; note <= NOTE_MAX; ++note)
+		{
+			VERIFY_EQUAL(a.GetTuning(tuning).GetNoteName(note - NOTE_MIDDLEC), b.GetTuning(tuning).GetNoteName(note - NOTE_MIDDLEC));
+			VERIFY_EQUAL(RatioEqual(a.GetTuning(tuning).GetRatio(note - NOTE_MIDDLEC), b.GetTuning(tuning).GetRatio(note - NOTE_MIDDLEC)), true);
+		}
+	}
+}
+
+#endif
+
+
+static MPT_NOINLINE void TestTunings()
+{
+
+	// nothing for now
+
+}
+
+
+
+static double Rand01()
+{
+	return mpt::random(*s_PRNG, 0.0, 1.0);
+}
+
+template <class T>
+T Rand(const T min, const T max)
+{
+	return mpt::saturate_round<T>(min + Rand01() * (max - min));
+}
+
+static void GenerateCommands(CPattern& pat, const double dProbPcs, const double dProbPc)
+{
+	const double dPcxProb = dProbPcs + dProbPc;
+	for(auto &m : pat)
+	{
+		const double rand = Rand01();
+		if(rand < dPcxProb)
+		{
+			if(rand < dProbPcs)
+				m.note = NOTE_PCS;
+			else
+				m.note = NOTE_PC;
+
+			m.instr = Rand<ModCommand::INSTR>(0, MAX_MIXPLUGINS);
+			m.SetValueVolCol(Rand<uint16>(0, ModCommand::maxColumnValue));
+			m.SetValueEffectCol(Rand<uint16>(0, ModCommand::maxColumnValue));
+		}
+		else
+			m.Clear();
+	}
+}
+
+
+// Test PC note serialization
+static MPT_NOINLINE void TestPCnoteSerialization()
+{
+	FileReader file;
+	std::unique_ptr<CSoundFile> pSndFile = std::make_unique<CSoundFile>();
+	CSoundFile &sndFile = *pSndFile.get();
+	sndFile.m_nType = MOD_TYPE_MPT;
+	sndFile.Patterns.DestroyPatterns();
+	sndFile.m_nChannels = ModSpecs::mptm.channelsMax;
+
+	sndFile.Patterns.Insert(0, ModSpecs::mptm.patternRowsMin);
+	sndFile.Patterns.Insert(1, 64);
+	GenerateCommands(sndFile.Patterns[1], 0.3, 0.3);
+	sndFile.Patterns.Insert(2, ModSpecs::mptm.patternRowsMax);
+	GenerateCommands(sndFile.Patterns[2], 0.5, 0.5);
+
+	// Copy pattern data for comparison.
+	CPatternContainer patterns{ sndFile.Patterns };
+
+	mpt::stringstream mem;
+	WriteModPatterns(mem, sndFile.Patterns);
+
+	VERIFY_EQUAL_NONCONT( mem.good(), true );
+
+	// Clear patterns.
+	sndFile.Patterns[0].ClearCommands();
+	sndFile.Patterns[1].ClearCommands();
+	sndFile.Patterns[2].ClearCommands();
+
+	// Read data back.
+	ReadModPatterns(mem, sndFile.Patterns);
+
+	// Compare.
+	VERIFY_EQUAL_NONCONT( sndFile.Patterns[0].GetNumRows(), ModSpecs::mptm.patternRowsMin);
+	VERIFY_EQUAL_NONCONT( sndFile.Patterns[1].GetNumRows(), 64);
+	VERIFY_EQUAL_NONCONT( sndFile.Patterns[2].GetNumRows(), ModSpecs::mptm.patternRowsMax);
+	for(int i = 0; i < 3; i++)
+	{
+		VERIFY_EQUAL(sndFile.Patterns[i], patterns[i]);
+	}
+}
+
+
+static inline std::size_t strnlen(const char *str, std::size_t n)
+{
+#if MPT_COMPILER_MSVC
+	return ::strnlen(str, n);
+#else
+	if(n >= std::numeric_limits<std::size_t>::max())
+	{
+		return std::strlen(str);
+	}
+	for(std::size_t i = 0; i < n; ++i)
+	{
+		if(str[i] == '\0')
+		{
+			return i;
+		}
+	}
+	return n;
+#endif
+}
+
+
+// Test String I/O functionality
+static MPT_NOINLINE void TestStringIO()
+{
+	char src0[4] = { '\0', 'X', ' ', 'X' };		// Weird empty buffer
+	char src1[4] = { 'X', ' ', '\0', 'X' };		// Weird buffer (hello Impulse Tracker)
+	char src2[4] = { 'X', 'Y', 'Z', ' ' };		// Full buffer, last character space
+	char src3[4] = { 'X', 'Y', 'Z', '!' };		// Full buffer, last character non-space
+	char src4[4] = { 'x', 'y', '\t', '\n' };	// Full buffer containing non-space whitespace
+	char dst1[6];	// Destination buffer, larger than source buffer
+	char dst2[3];	// Destination buffer, smaller than source buffer
+
+#define ReadTest(mode, dst, src, expectedResult) \
+	std::memset(dst, 0x7f, sizeof(dst)); \
+	mpt::String::WriteAutoBuf(dst) = mpt::String::ReadBuf(mpt::String:: mode , src); \
+	VERIFY_EQUAL_NONCONT(strncmp(dst, expectedResult, mpt::size(dst)), 0); /* Ensure that the strings are identical */ \
+	for(size_t i = strlen(dst); i < mpt::size(dst); i++) \
+		VERIFY_EQUAL_NONCONT(dst[i], '\0'); /* Ensure that rest of the buffer is completely nulled */ \
+	/**/
+
+#define WriteTest(mode, dst, src, expectedResult) \
+	std::memset(dst, 0x7f, sizeof(dst)); \
+	mpt::String::WriteBuf(mpt::String:: mode , dst) = mpt::String::ReadAutoBuf(src); \
+	VERIFY_EQUAL_NONCONT(strncmp(dst, expectedResult, mpt::size(dst)), 0);  /* Ensure that the strings are identical */ \
+	for(size_t i = Test::strnlen(dst, mpt::size(dst)); i < mpt::size(dst); i++) \
+		VERIFY_EQUAL_NONCONT(dst[i], '\0'); /* Ensure that rest of the buffer is completely nulled */ \
+	/**/
+
+	// Check reading of null-terminated string into larger buffer
+	ReadTest(nullTerminated, dst1, src0, "");
+	ReadTest(nullTerminated, dst1, src1, "X ");
+	ReadTest(nullTerminated, dst1, src2, "XYZ");
+	ReadTest(nullTerminated, dst1, src3, "XYZ");
+	ReadTest(nullTerminated, dst1, src4, "xy\t");
+
+	// Check reading of string that should be null-terminated, but is maybe too long to still hold the null character.
+	ReadTest(maybeNullTerminated, dst1, src0, "");
+	ReadTest(maybeNullTerminated, dst1, src1, "X ");
+	ReadTest(maybeNullTerminated, dst1, src2, "XYZ ");
+	ReadTest(maybeNullTerminated, dst1, src3, "XYZ!");
+	ReadTest(maybeNullTerminated, dst1, src4, "xy\t\n");
+
+	// Check reading of space-padded strings with ignored last character
+	ReadTest(spacePaddedNull, dst1, src0, " X");
+	ReadTest(spacePaddedNull, dst1, src1, "X");
+	ReadTest(spacePaddedNull, dst1, src2, "XYZ");
 	ReadTest(spacePaddedNull, dst1, src3, "XYZ");
 	ReadTest(spacePaddedNull, dst1, src4, "xy\t");
 
@@ -4742,6 +6588,139 @@ static MPT_NOINLINE void TestSampleConversion()
 
 	}
 
+	// Sample data that is already in the internal format (signed 8-bit, native-endian 16-bit) is copied as a whole
+	{
+		std::vector<uint8> source(65536 * 2);
+		for(size_t i = 0; i < 65536; i++)
+		{
+			source[i * 2 + 0] = static_cast<uint8>(i & 0xFF);
+			source[i * 2 + 1] = static_cast<uint8>(i >> 8);
+		}
+
+		ModSample sample;
+		sample.Initialize();
+
+		// Truncated 16-bit little-endian mono data: The missing part of the sample must be silent
+		sample.nLength = 65536;
+		FileReader file16(mpt::as_span(source.data(), 65536 * 2 - 1000));
+		VERIFY_EQUAL_NONCONT(SampleIO(SampleIO::_16bit, SampleIO::mono, SampleIO::littleEndian, SampleIO::signedPCM).ReadSample(sample, file16), 65536 * 2 - 1000);
+		for(size_t i = 0; i < 65536; i++)
+		{
+			VERIFY_EQUAL_QUIET_NONCONT(sample.sample16()[i], static_cast<int16>(i < 65036 ? i : 0));
+		}
+		sample.FreeSample();
+
+		// 8-bit stereo interleaved data
+		sample.nLength = 65536;
+		FileReader file8(mpt::as_span(source));
+		VERIFY_EQUAL_NONCONT(SampleIO(SampleIO::_8bit, SampleIO::stereoInterleaved, SampleIO::littleEndian, SampleIO::signedPCM).ReadSample(sample, file8), 65536 * 2);
+		for(size_t i = 0; i < 65536; i++)
+		{
+			VERIFY_EQUAL_QUIET_NONCONT(sample.sample8()[i * 2 + 0], static_cast<int8>(i & 0xFF));
+			VERIFY_EQUAL_QUIET_NONCONT(sample.sample8()[i * 2 + 1], static_cast<int8>(i >> 8));
+		}
+		sample.FreeSample();
+	}
+
+	// Vectorized block converters must give the same results as the scalar functors, including their carried state
+	{
+		const size_t count = 1001;
+		std::vector<mpt::byte> source(count * 2);
+		for(auto &b : source)
+		{
+			b = mpt::byte_cast<mpt::byte>(mpt::random<uint8>(*s_PRNG));
+		}
+		std::vector<int8> block8(count), scalar8(count);
+		std::vector<int16> block16(count), scalar16(count);
+
+#ifdef ENABLE_SSE2_BASELINE
+		// The vectorized variants must actually be used where SSE2 is always available
+		VERIFY_EQUAL_NONCONT(SC::DecodeInt8Block(block8.data(), source.data(), count, 0) > 0, true);
+		VERIFY_EQUAL_NONCONT(SC::DecodeInt16Block(block16.data(), source.data(), count, false, 0) > 0, true);
+#endif
+
+		{
+			SC::DecodeUint8 conv;
+			size_t n = SC::DecodeInt8Block(block8.data(), source.data(), count, 0x80);
+			VERIFY_EQUAL_NONCONT(n <= count, true);
+			for(size_t i = 0; i < count; i++)
+			{
+				scalar8[i] = conv(&source[i]);
+				if(i >= n)
+					block8[i] = scalar8[i];
+			}
+			VERIFY_EQUAL_NONCONT(block8 == scalar8, true);
+		}
+		{
+			SC::DecodeInt8Delta conv, blockConv;
+			size_t n = SC::DecodeInt8DeltaBlock(block8.data(), source.data(), count, blockConv.delta);
+			VERIFY_EQUAL_NONCONT(n <= count, true);
+			for(size_t i = 0; i < count; i++)
+			{
+				scalar8[i] = conv(&source[i]);
+				if(i >= n)
+					block8[i] = blockConv(&source[i]);
+			}
+			VERIFY_EQUAL_NONCONT(block8 == scalar8, true);
+		}
+		{
+			SC::DecodeInt16<0x8000u, bigEndian16> conv;
+			size_t n = SC::DecodeInt16Block(block16.data(), source.data(), count, mpt::endian_is_little(), 0x8000u);
+			VERIFY_EQUAL_NONCONT(n <= count, true);
+			for(size_t i = 0; i < count; i++)
+			{
+				scalar16[i] = conv(&source[i * 2]);
+				if(i >= n)
+					block16[i] = scalar16[i];
+			}
+			VERIFY_EQUAL_NONCONT(block16 == scalar16, true);
+		}
+		{
+			SC::DecodeInt16Delta<littleEndian16> conv, blockConv;
+			size_t n = SC::DecodeInt16DeltaBlock(block16.data(), source.data(), count, mpt::endian_is_big(), blockConv.delta);
+			VERIFY_EQUAL_NONCONT(n <= count, true);
+			for(size_t i = 0; i < count; i++)
+			{
+				scalar16[i] = conv(&source[i * 2]);
+				if(i >= n)
+					block16[i] = blockConv(&source[i * 2]);
+			}
+			VERIFY_EQUAL_NONCONT(block16 == scalar16, true);
+		}
+
+		// Mix buffer to output conversions, including values that have to be clipped
+		const int fractionalBits = 27;
+		std::vector<int32> mix(count * 2);
+		for(auto &v : mix)
+		{
+			v = mpt::random<int32>(*s_PRNG) >> (1 + mpt::random<uint8, 2>(*s_PRNG));
+		}
+		std::vector<int16> out16(count * 2), out16L(count), out16R(count);
+		std::vector<float32> outFloat(count * 2), outFloatClip(count * 2), outFloatL(count), outFloatR(count);
+		int16 * const buffers16[2] = { out16L.data(), out16R.data() };
+		float32 * const buffersFloat[2] = { outFloatL.data(), outFloatR.data() };
+		ConvertInterleavedFixedPointToInterleaved<fractionalBits, false>(out16.data(), mix.data(), 2, count);
+		ConvertInterleavedFixedPointToNonInterleaved<fractionalBits, false>(buffers16, mix.data(), 2, count);
+		ConvertInterleavedFixedPointToInterleaved<fractionalBits, false>(outFloat.data(), mix.data(), 2, count);
+		ConvertInterleavedFixedPointToInterleaved<fractionalBits, true>(outFloatClip.data(), mix.data(), 2, count);
+		ConvertInterleavedFixedPointToNonInterleaved<fractionalBits, true>(buffersFloat, mix.data(), 2, count);
+		SC::ConvertFixedPoint<int16, int32, fractionalBits, false> conv16;
+		SC::ConvertFixedPoint<float32, int32, fractionalBits, false> convFloat;
+		SC::ConvertFixedPoint<float32, int32, fractionalBits, true> convFloatClip;
+		bool equal16 = true, equalFloat = true;
+		for(size_t i = 0; i < count * 2; i++)
+		{
+			const int16 expected16 = conv16(mix[i]);
+			if(out16[i] != expected16 || (i % 2 ? out16R : out16L)[i / 2] != expected16)
+				equal16 = false;
+			const float32 expectedFloatClip = convFloatClip(mix[i]);
+			if(outFloat[i] != convFloat(mix[i]) || outFloatClip[i] != expectedFloatClip || (i % 2 ? outFloatR : outFloatL)[i / 2] != expectedFloatClip)
+				equalFloat = false;
+		}
+		VERIFY_EQUAL_NONCONT(equal16, true);
+		VERIFY_EQUAL_NONCONT(equalFloat, true);
+	}
+
 	// Signed 24-Bit Integer PCM
 	{
 		uint8 *source24 = sourceBuf;